@@ -1,5 +1,9 @@
+#ifndef EMF2SVG_H
+#define EMF2SVG_H
+
 #include <stdbool.h>
 #include <stddef.h> /* for offsetof() macro */
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -8,7 +12,165 @@
 extern "C" {
 #endif
 
-// structure containing generator arguments
+// time spent in the phases of a conversion, in seconds
+typedef struct {
+    // first pass over the records (object table, image bounds)
+    double analyse;
+    // second pass over the records, writing the svg (images and fonts
+    // included)
+    double draw;
+    // conversion of the bitmaps to png and base64 encoding
+    double images;
+    // font file lookups (glyph indexes to unicode)
+    double fonts;
+    // number of records drawn
+    size_t records;
+} generatorTimings;
+
+// number of EMF record types (iType 1 to 122), unknown types are counted
+// at index 0
+#define EMF2SVG_RECORD_TYPES 123
+
+// statistics of a record type
+typedef struct {
+    // number of records
+    size_t count;
+    // size of the records, in bytes
+    size_t bytes;
+    // time spent drawing the records, in seconds
+    double time;
+    // svg bytes written while drawing the records (shapes merged or
+    // deferred to a later record are counted there), 0 with emf2svg_tiles()
+    size_t output;
+} generatorRecordStats;
+
+// statistics of a conversion, by record type
+typedef struct {
+    // indexed by iType
+    generatorRecordStats records[EMF2SVG_RECORD_TYPES];
+    // allocations of the svg output and style buffers and of the device
+    // context copies (the other allocations of the conversion, as the
+    // object and interned tables, images or clipping paths, are not counted)
+    size_t bufferAllocations;
+    // font file lookups (glyph indexes to unicode)
+    size_t fontLookups;
+    // bitmaps converted to png or base64 encoded
+    size_t imageEncodes;
+} generatorStats;
+
+// support status of a record, as in the verbose output
+typedef enum {
+    EMF2SVG_TRACE_UNKNOWN = 0,
+    EMF2SVG_TRACE_SUPPORTED,
+    EMF2SVG_TRACE_PARTIAL,
+    EMF2SVG_TRACE_IGNORED,
+    EMF2SVG_TRACE_UNUSED,
+    // outside of the image or of the clipping rectangle (options->cull)
+    EMF2SVG_TRACE_CULLED,
+    // warning or error of the conversion (event message)
+    EMF2SVG_TRACE_ERROR,
+} generatorTraceStatus;
+
+// decoded field of a record ("Bounds", "{0,0} {10,10}")
+typedef struct {
+    const char *name;
+    const char *value;
+} generatorTraceField;
+
+// trace event, sent after each record (pointers only valid in the callback)
+typedef struct {
+    // index of the record in the file
+    size_t index;
+    // record type (iType) and name ("U_EMR_...")
+    uint32_t type;
+    const char *name;
+    // offset and size (nSize) of the record, in bytes
+    size_t offset;
+    uint32_t size;
+    generatorTraceStatus status;
+    // decoded fields, only with options->traceFields
+    const generatorTraceField *fields;
+    size_t fieldCount;
+    // set on EMF2SVG_TRACE_ERROR events, NULL otherwise
+    const char *message;
+} generatorTraceEvent;
+
+// trace callback, called in the converting thread
+typedef void (*generatorTraceCallback)(const generatorTraceEvent *event,
+                                       void *ctx);
+
+// resource budget exceeded by a conversion (options->budgetExceeded)
+typedef enum {
+    EMF2SVG_BUDGET_NONE = 0,
+    EMF2SVG_BUDGET_TIME,
+    EMF2SVG_BUDGET_OUTPUT,
+    EMF2SVG_BUDGET_RECORDS,
+    EMF2SVG_BUDGET_IMAGE_PIXELS,
+    EMF2SVG_BUDGET_MEMORY,
+} generatorBudget;
+
+// progress callback, called with the offset of the record about to be
+// drawn, the size of the EMF and the number of records drawn, returns true
+// to cancel the conversion
+typedef bool (*generatorProgressCallback)(size_t offset, size_t length,
+                                          size_t records, void *ctx);
+
+// SAVEDC or RESTOREDC record of a generatorIndex
+typedef struct {
+    // record number
+    uint32_t record;
+    // number of saved device contexts after the record
+    int32_t depth;
+} generatorIndexSave;
+
+// BEGINPATH/ENDPATH span of a generatorIndex
+typedef struct {
+    // record numbers of the BEGINPATH and of the ENDPATH (UINT32_MAX if the
+    // path is not closed)
+    uint32_t begin;
+    uint32_t end;
+} generatorIndexPath;
+
+// object creation record (CREATEPEN, EXTCREATEFONTINDIRECTW...) of a
+// generatorIndex
+typedef struct {
+    // record number
+    uint32_t record;
+    // record type
+    uint32_t type;
+    // object table index (ihObject, ihPen, ihBrush...)
+    uint32_t handle;
+} generatorIndexObject;
+
+// index of the records of an EMF, built in one validated pass by
+// emf2svg_index() and reusable by the conversions of the same contents
+// (options->index)
+typedef struct {
+    // size of the indexed EMF
+    size_t length;
+    // false if the pass stopped on an invalid record before the EOF record
+    // (the conversions then fail on it)
+    bool complete;
+    // records, offsets[i] and types[i] are the offset and type of record i
+    // (0 for types above 255, unknown to EMF)
+    uint32_t count;
+    size_t *offsets;
+    uint8_t *types;
+    // SAVEDC and RESTOREDC records, in order
+    uint32_t saveCount;
+    generatorIndexSave *saves;
+    // paths, in order
+    uint32_t pathCount;
+    generatorIndexPath *paths;
+    // object creations, in order
+    uint32_t objectCount;
+    generatorIndexObject *objects;
+    // private, what the conversions need of each path
+    void *pathData;
+} generatorIndex;
+
+// structure containing generator arguments, to be zeroed before use (new
+// fields are added at the end, their size is part of the soname version)
 typedef struct {
     // SVG namespace (the '<something>:' before each fields)
     char *nameSpace;
@@ -22,18 +184,190 @@ typedef struct {
     double imgHeight;
     // width of the target image
     double imgWidth;
+    // max deviation (in pixels) allowed when flattening curves to compute
+    // clipping regions (0 for default: 0.25)
+    double flatteningTolerance;
+    // skip the records drawn outside of the image or of the current
+    // rectangle clipping region (using the bounding box of the records)
+    bool culling;
+    // set by emf2svg(): number of records skipped by culling
+    size_t culledRecords;
+    // region of interest, in px of the target image (ignored if
+    // roiWidth or roiHeight is 0, requires svgDelimiter): only the records
+    // intersecting it are drawn and the svg viewBox is set to it
+    double roiX;
+    double roiY;
+    double roiWidth;
+    double roiHeight;
+    // maximum number of object handles (pens, brushes, fonts...) used by
+    // the file (0 for default: 65536), the object table is allocated on
+    // demand up to this size, whatever the header claims (the objects
+    // above it are ignored)
+    unsigned int maxObjects;
+    // draw consecutive polygons, lines and rectangles sharing the same
+    // pen, brush and clipping as the subpaths of a single <path> element
+    bool mergePaths;
+    // max deviation (in pixels) allowed when simplifying the points of
+    // polylines and polygons (0 to disable simplification)
+    double simplifyTolerance;
+    // write compact path data: relative coordinates, no repeated commands,
+    // 1 decimal if logical units are at least a pixel, 2 otherwise
+    bool compactPaths;
+    // gzip the output while converting (svgz), ignored by emf2svg_tiles()
+    bool svgz;
+    // compression level, 1 (fastest) to 9 (smallest), 0 for zlib default
+    int svgzLevel;
+    // compress blocks of the output over this number of threads (0 or 1
+    // for a single deflate stream in the converting thread)
+    unsigned int svgzThreads;
+    // if set, filled by the convert functions with the time of each phase
+    generatorTimings *timings;
+    // if set, filled by the convert functions with statistics by record
+    // type (costs a clock read per record)
+    generatorStats *stats;
+    // if set, called with a trace event for each record (instead of the
+    // verbose output on stdout), with traceCtx as context
+    generatorTraceCallback trace;
+    void *traceCtx;
+    // decode the fields of the records in the trace events (formats them as
+    // the verbose output does, slower)
+    bool traceFields;
+    // resource budgets of a conversion, 0 for no limit
+    // wall-clock time in seconds (checked between records and images)
+    double maxTime;
+    // svg bytes written (before compression)
+    size_t maxOutput;
+    // EMF and EMF+ records drawn
+    size_t maxRecords;
+    // pixels of the bitmaps decoded (converted to png)
+    uint64_t maxImagePixels;
+    // estimate of the memory used by the svg buffers, the device context
+    // copies and the bitmap being decoded, in bytes
+    size_t maxMemory;
+    // set by the convert functions, the budget exceeded if it made them
+    // fail (EMF2SVG_BUDGET_NONE otherwise)
+    generatorBudget budgetExceeded;
+    // if set, called every progressInterval records (1024 if 0), with
+    // progressCtx as context
+    generatorProgressCallback progress;
+    void *progressCtx;
+    unsigned int progressInterval;
+    // set by the convert functions if the progress callback cancelled the
+    // conversion (they then return 0)
+    bool cancelled;
+    // index of contents (emf2svg_index()), saves the first pass over the
+    // records of each conversion
+    generatorIndex *index;
+    // convert ranges of records over this number of threads (0 or 1 to
+    // convert in the calling thread), the output is the same as the
+    // sequential conversion but is kept in memory until the end; ignored
+    // with verbose, trace, stats, maxMemory, progress, emfplus, mergePaths
+    // and by emf2svg_tiles()
+    unsigned int drawThreads;
+    // set by the convert functions: number of ranges converted over the
+    // drawThreads threads, 1 if the conversion was sequential
+    unsigned int drawRanges;
 } generatorOptions;
 
-// convert function
+// convert function (with options->svgz, out is the gzip data, out_length
+// bytes long), returns 1 on success, 0 on error (if a budget was exceeded
+// or the conversion cancelled, see options->budgetExceeded and
+// options->cancelled, out then holds the svg converted so far)
 #ifdef _MSC_VER
 __declspec(dllexport)
 #endif
 int emf2svg(char *contents, size_t length, char **out, size_t *out_length,
             generatorOptions *options);
 
-// check if emf file contains emf+ records
+// callback receiving the svg by chunks, must return size on success
+typedef size_t (*emf2svg_write_callback)(const char *data, size_t size,
+                                         void *ctx);
+
+// convert function writing the svg to file
+#ifdef _MSC_VER
+__declspec(dllexport)
+#endif
+int emf2svg_file(char *contents, size_t length, FILE *file,
+                 generatorOptions *options);
+
+// convert function passing the svg by chunks to callback
+#ifdef _MSC_VER
+__declspec(dllexport)
+#endif
+int emf2svg_stream(char *contents, size_t length,
+                   emf2svg_write_callback callback, void *ctx,
+                   generatorOptions *options);
+
+// convert function splitting the image (or the region of interest) in a
+// grid of columns x rows svg tiles, in one pass over the records.
+// out and out_length must have room for columns * rows elements,
+// tile (column, row) is at index row * columns + column, none is kept on
+// error.
+#ifdef _MSC_VER
+__declspec(dllexport)
+#endif
+int emf2svg_tiles(char *contents, size_t length, unsigned int columns,
+                  unsigned int rows, char **out, size_t *out_length,
+                  generatorOptions *options);
+
+// name of an EMF record type ("U_EMR_..."), for generatorStats
+const char *emf2svg_record_name(unsigned int iType);
+
+// check if emf file contains emf+ records (stops at the first one)
 int emf2svg_is_emfplus(char *contents, size_t length, bool *is_emfp);
 
+typedef struct {
+    int32_t left;
+    int32_t top;
+    int32_t right;
+    int32_t bottom;
+} generatorRect;
+
+typedef struct {
+    int32_t cx;
+    int32_t cy;
+} generatorSize;
+
+// EMF header information (emf2svg_probe())
+typedef struct {
+    // rclBounds, bounding rectangle of the drawing in device units
+    generatorRect bounds;
+    // rclFrame, bounding rectangle of the picture in 0.01 mm
+    generatorRect frame;
+    // szlDevice, reference device size in pixels
+    generatorSize device;
+    // szlMillimeters, reference device size in mm
+    generatorSize millimeters;
+    // nBytes (size of the metafile as declared), nRecords and nHandles
+    uint32_t bytes;
+    uint32_t records;
+    uint16_t handles;
+    // size of the data given to emf2svg_probe()
+    size_t length;
+    // description, application and picture names in UTF-8 (truncated)
+    char application[256];
+    char title[256];
+    // EMF+ records (the first comment, right after the header, is an EMF+
+    // header), and if the EMF records are a fallback (EMF+ dual)
+    bool emfplus;
+    bool emfplusDual;
+} generatorProbe;
+
+// read the EMF header (and the record following it), without going
+// through the rest of the file nor modifying it, returns 0 if contents
+// does not start with a valid EMF header
+int emf2svg_probe(const char *contents, size_t length, generatorProbe *probe);
+
+// build the record index of an EMF (checking the record sizes), messages
+// go to the verbose output or trace callback of options (can be NULL),
+// returns NULL if contents is not an EMF or on allocation failure.
+// Big endian machines swap the contents in the conversions, NULL there.
+generatorIndex *emf2svg_index(const char *contents, size_t length,
+                              generatorOptions *options);
+
+// free an index returned by emf2svg_index()
+void emf2svg_index_free(generatorIndex *index);
+
 // scan a list of directories to build a font index (index[<FONT_NAME>] =
 // <FONT_PATH>)
 int emf2svg_gen_font_index(char **font_paths, void *font_index);
@@ -46,4 +380,5 @@ int emf2svg_free_font_index(void *font_index);
 }
 #endif
 
+#endif /* EMF2SVG_H */
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -32,16 +32,28 @@ extern "C" {
 #define KCYN "\x1B[36m"
 #define KWHT "\x1B[37m"
 
+// the verbose output can be compiled out (NO_VERBOSE, cmake -DNOVERBOSE=ON),
+// the tests are then constant and the printing code is dropped
+#ifdef NO_VERBOSE
+#define isVerbose(states) false
+#else
+#define isVerbose(states) ((states)->verbose)
+#endif
+// printed on stdout, or kept for the trace event of the record
 #define verbose_printf(...)                                                    \
-    if (states->verbose)                                                       \
-        printf(__VA_ARGS__);
+    if (isVerbose(states))                                                     \
+        verbose_print(states, __VA_ARGS__);
 #define FLAG_SUPPORTED                                                         \
+    states->trace.status = EMF2SVG_TRACE_SUPPORTED;                            \
     verbose_printf("   Status:         %sSUPPORTED%s\n", KGRN, KNRM);
 #define FLAG_IGNORED                                                           \
+    states->trace.status = EMF2SVG_TRACE_IGNORED;                              \
     verbose_printf("   Status:         %sIGNORED%s\n", KRED, KNRM);
 #define FLAG_PARTIAL                                                           \
+    states->trace.status = EMF2SVG_TRACE_PARTIAL;                              \
     verbose_printf("   Status:         %sPARTIAL SUPPORT%s\n", KYEL, KNRM);
 #define FLAG_UNUSED                                                            \
+    states->trace.status = EMF2SVG_TRACE_UNUSED;                               \
     verbose_printf("   Status:         %sUNUSED%s\n", KMAG, KNRM);
 #define FLAG_RESET verbose_printf("%s", KNRM);
 
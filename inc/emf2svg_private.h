@@ -2,6 +2,8 @@
 extern "C" {
 #endif
 
+#include "emf2svg.h"
+#include "emf2svg_writer.h"
 #include "uemf.h"
 #include <stddef.h> /* for offsetof() macro */
 #include <stdio.h>
@@ -17,16 +19,28 @@ extern "C" {
 #define KCYN "\x1B[36m"
 #define KWHT "\x1B[37m"
 
+// the verbose output can be compiled out (NO_VERBOSE, cmake -DNOVERBOSE=ON),
+// the tests are then constant and the printing code is dropped
+#ifdef NO_VERBOSE
+#define isVerbose(states) false
+#else
+#define isVerbose(states) ((states)->verbose)
+#endif
+// printed on stdout, or kept for the trace event of the record
 #define verbose_printf(...)                                                    \
-    if (states->verbose)                                                       \
-        printf(__VA_ARGS__);
+    if (isVerbose(states))                                                     \
+        verbose_print(states, __VA_ARGS__);
 #define FLAG_SUPPORTED                                                         \
+    states->trace.status = EMF2SVG_TRACE_SUPPORTED;                            \
     verbose_printf("   Status:         %sSUPPORTED%s\n", KGRN, KNRM);
 #define FLAG_IGNORED                                                           \
+    states->trace.status = EMF2SVG_TRACE_IGNORED;                              \
     verbose_printf("   Status:         %sIGNORED%s\n", KRED, KNRM);
 #define FLAG_PARTIAL                                                           \
+    states->trace.status = EMF2SVG_TRACE_PARTIAL;                              \
     verbose_printf("   Status:         %sPARTIAL SUPPORT%s\n", KYEL, KNRM);
 #define FLAG_UNUSED                                                            \
+    states->trace.status = EMF2SVG_TRACE_UNUSED;                               \
     verbose_printf("   Status:         %sUNUSED%s\n", KMAG, KNRM);
 #define FLAG_RESET verbose_printf("%s", KNRM);
 
@@ -65,6 +79,25 @@ typedef struct {
     double y;
 } POINT_D;
 
+typedef struct {
+    double left;
+    double top;
+    double right;
+    double bottom;
+} RECT_D;
+
+// tiled output, see emf2svg_tiles()
+typedef struct {
+    // number of tiles (columns * rows)
+    unsigned int count;
+    unsigned int columns;
+    // visible area of each tile (same coordinates as drawingStates.viewport)
+    RECT_D *viewports;
+    // if the current record is visible in each tile
+    bool *visible;
+    svgWriter *writers;
+} emfTiles;
+
 typedef struct _PATH_SECTION {
     uint8_t type;
     POINT_D *points;
@@ -76,128 +109,215 @@ typedef struct _PATH {
     struct _PATH *next;
 } PATH;
 
-typedef struct emf_graph_object {
-    bool font_set;
-    char *font_name;
-    char *font_family;
-    uint32_t font_height;
-    uint32_t font_width;
-    bool font_italic;
-    bool font_underline;
-    bool font_strikeout;
-    uint32_t font_weight;
-    uint32_t font_escapement;
-    uint32_t font_orientation;
-    uint8_t font_charset;
-
-    bool stroke_set;
-    int stroke_mode;   // enumeration from drawmode, not used if fill_set is not
-                       // True
-    int stroke_idx;    // used with DRAW_PATTERN and DRAW_IMAGE to return the
-                       // appropriate fill
-    int stroke_recidx; // record used to regenerate hatch when it needs to be
-                       // redone due to bkmode, textmode, etc. change
-    // stroke color
-    uint8_t stroke_red;
-    uint8_t stroke_blue;
-    uint8_t stroke_green;
-    double stroke_width;
-
-    bool fill_set;
-    int fill_mode;   // enumeration from drawmode, not used if fill_set is not
-                     // True
-    int fill_idx;    // used with DRAW_PATTERN and DRAW_IMAGE to return the
-                     // appropriate fill
-    int fill_recidx; // record used to regenerate hatch when it needs to be
-                     // redone due to bkmode, textmode, etc. change
-    // filling colors
-    uint8_t fill_red;
-    uint8_t fill_blue;
-    uint8_t fill_green;
-    uint16_t fill_hatch_style;
-
-    // text properties
-    uint8_t text_red;
-    uint8_t text_blue;
-    uint8_t text_green;
-    uint16_t text_align;
+// Clip library, each distinct clipping region is emitted only once
+typedef struct clipLibrary {
+    int id;
+    uint32_t hash;
+    PATH *path;
+    // path drawn with the evenodd clip rule (inverted regions)
+    bool evenodd;
+    // true once the <clipPath> definition has been written
+    bool drawn;
+    struct clipLibrary *next;
+} emfClipLibrary;
 
-    // bk propertier
-    uint8_t bk_red;
-    uint8_t bk_blue;
-    uint8_t bk_green;
-    uint16_t bk_mode;
+#define CLIP_LIBRARY_BUCKETS 256
+
+// position of an element relatively to the clipping region
+#define CLIP_PARTIAL 0
+#define CLIP_INSIDE 1
+#define CLIP_OUTSIDE 2
+
+// interned table of fixed size items (pens, brushes, fonts) or of strings:
+// equal items share the same id, id 0 is the zeroed item (NULL string)
+typedef struct {
+    char *items;
+    size_t itemSize;
+    uint32_t count;
+    uint32_t size;
+    bool strings;
+    // open addressing hash table of ids + 1 (0 is a free slot)
+    uint32_t *slots;
+    uint32_t slotCount;
+} emfInternTable;
+
+// pen, brush and font attributes (no padding, compared with memcmp)
+typedef struct {
+    U_COLORREF color;
+    int mode; // pen style, not used if the pen is U_PS_NULL
+    double width;
+} emfPen;
+
+typedef struct {
+    U_COLORREF color;
+    int mode; // brush style
+    int idx;  // image id of U_BS_MONOPATTERN brushes
+} emfBrush;
+
+typedef struct {
+    // ids in the interned strings table, 0 if not set
+    uint32_t name;
+    uint32_t family;
+    uint32_t height;
+    uint32_t width;
+    uint32_t weight;
+    uint32_t escapement;
+    uint32_t orientation;
+    bool italic;
+    bool underline;
+    bool strikeout;
+    uint8_t charset;
+} emfFont;
+
+// EMR_GRADIENTFILL linear gradient (bounding box units, rounded as in the
+// output)
+typedef struct {
+    U_COLORREF from;
+    U_COLORREF to;
+    double x1;
+    double y1;
+    double x2;
+    double y2;
+} emfGradient;
+
+// pixel of EMR_SETPIXELV (logical coordinates)
+typedef struct {
+    int32_t x;
+    int32_t y;
+    U_COLORREF color;
+} emfPixel;
+
+// consecutive EMR_SETPIXELV pixels, drawn together as one image
+typedef struct {
+    emfPixel *pixels;
+    size_t count;
+    size_t size;
+    // bounding box of the pixels (inclusive)
+    U_RECTL box;
+} emfPixelRun;
+
+// consecutive POLY*, LINETO and RECTANGLE records of the same style, drawn together
+// as the subpaths of one <path> (see emf2svg_path_utils.c)
+typedef struct {
+    // number of records in the path
+    size_t count;
+    // path data
+    svgWriter d;
+    // fill and stroke attributes, serialized with the first record
+    svgWriter style;
+    // filled shapes (POLYGON...) or lines (POLYLINE, LINETO...)
+    bool filled;
+    // style and clipping group of the records
+    uint32_t pen;
+    uint32_t brush;
+    uint32_t miterLimit;
+    int clipGroupID;
+    // boxes of the painted shapes, which must not overlap, and their union
+    RECT_D *boxes;
+    size_t boxCount;
+    size_t boxSize;
+    RECT_D box;
+} emfPathRun;
+
+// path data writer (see emf2svg_path_utils.c): absolute commands as before,
+// or compact path data (relative coordinates, no repeated command letters
+// or unneeded separators, fixed number of decimals)
+typedef struct {
+    bool compact;
+    // decimals of the coordinates (compact), and 10^precision
+    int precision;
+    int64_t scale;
+    // command of the next points, number of points written for it, last
+    // command letter written
+    char cmd;
+    int arg;
+    char last;
+    // current point, start of the current segment and of the subpath, in
+    // 1/scale px (relative coordinates are computed on rounded values)
+    int64_t x, y;
+    int64_t baseX, baseY;
+    int64_t startX, startY;
+    // last number written: a separator is needed before the next one,
+    // and if it has a '.' a number starting with '.' does not need it
+    bool sep;
+    bool dot;
+} emfPathData;
+
+// scratch buffers of the polyline simplification (see emf2svg_path_utils.c)
+typedef struct {
+    // transformed points
+    POINT_D *points;
+    // points kept, and ranges of points left to simplify
+    bool *keep;
+    uint32_t *stack;
+    size_t size;
+} emfSimplify;
+
+// type of the objects of the object table
+#define OBJECT_NONE 0
+#define OBJECT_PEN 1
+#define OBJECT_BRUSH 2
+#define OBJECT_FONT 3
 
+typedef struct emf_graph_object {
+    uint32_t type;
+    // id in the interned table of its type (pens, brushes or fonts)
+    uint32_t id;
 } emfGraphObject;
 
 // EMF Device Context structure
 typedef struct emf_device_context {
-    bool font_set;
-    char *font_name;
-    char *font_family;
-    uint32_t font_height;
-    uint32_t font_width;
-    bool font_italic;
-    bool font_underline;
-    bool font_strikeout;
-    uint32_t font_weight;
-    uint32_t font_escapement;
-    uint32_t font_orientation;
-    uint8_t font_charset;
+    // selected pen, brush and font, ids in the interned tables of
+    // drawingStates (see currentPen(), currentBrush() and currentFont())
+    uint32_t pen;
+    uint32_t brush;
+    uint32_t font;
 
+    U_COLORREF text_color;
+    U_COLORREF bk_color;
+    uint16_t text_align;
+    uint16_t bk_mode;
+    int fill_polymode;
     uint32_t stretchMode;
     uint32_t miterLimit;
-
+    int dirty; // holds the dirty bits for text, stroke, fill (DC_DIRTY_*)
     int16_t arcdir;
 
-    bool stroke_set;
-    int stroke_mode;   // enumeration from drawmode, not used if fill_set is not
-                       // True
-    int stroke_idx;    // used with DRAW_PATTERN and DRAW_IMAGE to return the
-                       // appropriate fill
-    int stroke_recidx; // record used to regenerate hatch when it needs to be
-                       // redone due to bkmode, textmode, etc. change
-    // stroke color
-    uint8_t stroke_red;
-    uint8_t stroke_blue;
-    uint8_t stroke_green;
-    double stroke_width;
-
-    bool fill_set;
-    int fill_mode;   // enumeration from drawmode, not used if fill_set is not
-                     // True
-    int fill_idx;    // used with DRAW_PATTERN and DRAW_IMAGE to return the
-                     // appropriate fill
-    int fill_recidx; // record used to regenerate hatch when it needs to be
-                     // redone due to bkmode, textmode, etc. change
-    int fill_polymode;
-    // filling colors
-    uint8_t fill_red;
-    uint8_t fill_blue;
-    uint8_t fill_green;
-    uint16_t fill_hatch_style;
-    int dirty; // holds the dirty bits for text, stroke, fill
-
-    // text properties
-    uint8_t text_red;
-    uint8_t text_blue;
-    uint8_t text_green;
-    uint16_t text_align;
-
-    // bk propertier
-    uint8_t bk_red;
-    uint8_t bk_blue;
-    uint8_t bk_green;
-    uint16_t bk_mode;
-
     U_XFORM worldTransform;
 
     // clipping structures
     PATH *clipRGN;
+    // clip library entry of the current clipping region
+    emfClipLibrary *clipEntry;
+    RECT_D *clipRects;
+    size_t clipRectsCount;
     // if set to zero, clip is not set
     int clipID;
+    // true if the clipping region is only made of the (disjoint)
+    // rectangles of clipRects
+    bool clipRectOnly;
+    // true if the clipping region is everything but clipRGN
+    bool clipInverted;
 } EMF_DEVICE_CONTEXT, *PEMF_DEVICE_CONTEXT;
 
+// dirty bits of EMF_DEVICE_CONTEXT, set when the serialized style of the
+// device context (see emfStyleCache) must be rebuilt
+#define DC_DIRTY_STROKE 0x1
+#define DC_DIRTY_FILL 0x2
+#define DC_DIRTY_TEXT 0x4
+#define DC_DIRTY_ALL (DC_DIRTY_STROKE | DC_DIRTY_FILL | DC_DIRTY_TEXT)
+
+// style attributes of the current device context, in serialized form
+typedef struct {
+    svgWriter stroke;
+    bool stroked;
+    svgWriter fill;
+    // font family and color
+    svgWriter text;
+    // writing mode, font style, decorations, weight and anchor
+    svgWriter textLayout;
+} emfStyleCache;
+
 // Stack of EMF Device Contexts
 typedef struct dc_stack {
     EMF_DEVICE_CONTEXT DeviceContext;
@@ -220,23 +340,84 @@ typedef struct {
     U_XFORM wtAfterxForm;
 } pathStruct;
 
-typedef struct pathstack {
-    pathStruct pathStruct;
-    struct pathstack *next;
-} pathStack;
-
+// paths of the record index (generatorIndex pathData), taken in order by
+// BEGINPATH and ENDPATH
 typedef struct {
-    pathStack *pathStack;
-    struct pathstack *pathStackLast;
+    pathStruct *paths;
+    uint32_t count;
+    // path of the next BEGINPATH/ENDPATH
+    uint32_t next;
 } emfStruct;
 
 // Image library for images used as fill patterns
 typedef struct imageLibrary {
     int id;
     PU_BITMAPINFOHEADER content;
+    size_t size;
     struct imageLibrary *next;
 } emfImageLibrary;
 
+
+// trace callback and the event of the record being drawn
+typedef struct {
+    generatorTraceCallback callback;
+    void *ctx;
+    // status set by the FLAG_* macros
+    generatorTraceStatus status;
+    // verbose output of the record (traceFields), split in fields
+    svgWriter text;
+    generatorTraceField *fields;
+    size_t count;
+    size_t size;
+} emfTrace;
+
+// resource budgets (options->max*) and the resources used
+typedef struct {
+    // at least one budget set
+    bool enabled;
+    // e2s_clock() deadline, 0 for none
+    double deadline;
+    size_t maxOutput;
+    size_t maxRecords;
+    uint64_t maxImagePixels;
+    size_t maxMemory;
+    size_t records;
+    uint64_t imagePixels;
+    // svg bytes of the ranges before out (parallel_draw())
+    size_t outputBase;
+    // device context copies (the other buffers are counted when checking)
+    size_t memory;
+    generatorBudget exceeded;
+} emfBudget;
+
+// the time and the memory are checked every BUDGET_INTERVAL records
+#define BUDGET_INTERVAL 256
+
+// fill rules used by the region engine
+#define RGN_FILL_NONZERO 0
+#define RGN_FILL_EVENODD 1
+// default curve flattening tolerance (in output pixels)
+#define RGN_DEFAULT_TOLERANCE 0.25
+
+// number of objects per page of the object table
+#define OBJECT_TABLE_PAGE 32
+// default maximum number of objects in the object table
+#define OBJECT_TABLE_MAX 65536
+// ids a record can take (see get_id())
+#define IDS_PER_RECORD 16
+
+// pen, brush and font selected in the current device context
+#define currentPen(states)                                                     \
+    ((const emfPen *)(states)->pens.items + (states)->currentDeviceContext.pen)
+#define currentBrush(states)                                                   \
+    ((const emfBrush *)(states)->brushes.items +                               \
+     (states)->currentDeviceContext.brush)
+#define currentFont(states)                                                    \
+    ((const emfFont *)(states)->fonts.items +                                  \
+     (states)->currentDeviceContext.font)
+// interned string of id
+#define internedString(states, id) (((char **)(states)->strings.items)[(id)])
+
 // structure recording drawing states
 typedef struct {
     // unique ID (simple increment)
@@ -269,13 +450,27 @@ typedef struct {
     bool inPath;
     // flag to know if we have start to draw the path
     bool pathDrawn;
-    // object table
-    emfGraphObject *objectTable;
+    // object table, by pages of OBJECT_TABLE_PAGE objects
+    // a page (and the array of pages) is only allocated when one of its
+    // objects is created, use getObject() and newObject() to access it
+    emfGraphObject **objectTable;
     // size of the object table (warning, could be negative)
     // initialized to -1
     // the "real" object table is objectTableSize + 1
     // reason: (indexes in emf files start a 1 and not 0)
     int64_t objectTableSize;
+    // maximum size of the object table, whatever the header claims
+    uint32_t maxObjects;
+    // handles claimed by the header (-1 before it), the objects above
+    // maxObjects are ignored, the ones above the handles are errors
+    int64_t objectHandles;
+    // interned pens, brushes, fonts and font names
+    emfInternTable pens;
+    emfInternTable brushes;
+    emfInternTable fonts;
+    emfInternTable strings;
+    // gradients of EMR_GRADIENTFILL, defined in the output when first used
+    emfInternTable gradients;
     // scaling ratio
     double scaling;
     double RefX;
@@ -314,6 +509,64 @@ typedef struct {
     // image library for pattern support
     int count_images;
     emfImageLibrary *library;
+    // clip library (hash buckets), used to reuse clipPath definitions
+    emfClipLibrary *clipLibrary[CLIP_LIBRARY_BUCKETS];
+    // visible area (after world transform, before the translation of the
+    // top group), set by the header, used for culling
+    RECT_D viewport;
+    bool viewportSet;
+    // skip records outside of the visible area
+    bool culling;
+    // number of records skipped by culling
+    size_t culledRecords;
+    // region of interest (same coordinates as viewport)
+    RECT_D roi;
+    bool roiSet;
+    // tiled output, NULL if disabled
+    emfTiles *tiles;
+    // end of the clipping output of the current record (tiled output)
+    size_t fragmentMark;
+    // tolerance used to flatten curves when computing clipping regions
+    double flatteningTolerance;
+    // clip ID of the currently opened <g clip-path="..."> group
+    // if set to zero, no clipping group is opened
+    int clipGroupID;
+    // serialized style of currentDeviceContext, rebuilt when dirty
+    emfStyleCache styleCache;
+    // EMR_SETPIXELV pixels not drawn yet
+    emfPixelRun pixelRun;
+    // merge consecutive shapes of the same style in one path
+    bool mergePaths;
+    // shapes not drawn yet (mergePaths)
+    emfPathRun pathRun;
+    // max deviation of simplified polylines (0 if disabled)
+    double simplifyTolerance;
+    emfSimplify simplify;
+    // write compact path data
+    bool compactPaths;
+    // path data writer of the path being drawn
+    emfPathData pathData;
+    // time spent on images and fonts (if options->timings is set)
+    bool timing;
+    double imagesTime;
+    double fontsTime;
+    // statistics by record type, NULL if not requested
+    generatorStats *stats;
+    // trace events (options->trace), callback NULL if not requested
+    emfTrace trace;
+    // resource budgets, budget.enabled false if none is set
+    emfBudget budget;
+    // set when the progress callback cancelled the conversion
+    bool cancelled;
+    // snapshot pass of a parallel conversion: the drawing records flagged
+    // in replay are skipped
+    const uint8_t *replay;
+    // ids are derived from the record taking them (see get_id()): random
+    // base of the conversion, record being drawn and ids it took so far
+    // (at most IDS_PER_RECORD by record, clip_library_add() takes one)
+    uint32_t idBase;
+    uint32_t idRecord;
+    uint32_t idIndex;
 } drawingStates;
 
 typedef struct cmap_collection {
@@ -336,16 +589,101 @@ void copyDeviceContext(EMF_DEVICE_CONTEXT *dest, EMF_DEVICE_CONTEXT *src);
 void restoreDeviceContext(drawingStates *states, int32_t index);
 // free the device context stack
 void freeDeviceContextStack(drawingStates *states);
+// copy the device context stack of src in dest (false if out of memory)
+bool copyDeviceContextStack(drawingStates *dest, drawingStates *src);
+void freeStyleCache(drawingStates *states);
+// interned tables (emf2svg_intern_utils.c)
+bool intern_init(emfInternTable *table, size_t itemSize, bool strings);
+void intern_free(emfInternTable *table);
+// copy of src in dest (false if out of memory, dest is then to be freed)
+bool intern_copy(emfInternTable *dest, const emfInternTable *src);
+// id of item in table, added if needed (0 and states->Error on failure)
+uint32_t intern_item(drawingStates *states, emfInternTable *table,
+                     const void *item);
+// same for a string allocated with malloc, freed or kept by the table
+uint32_t intern_string(drawingStates *states, emfInternTable *table,
+                       char *string);
+// EMR_GRADIENTFILL shapes (emf2svg_gradient_utils.c)
+void gradient_fill_draw(drawingStates *states, svgWriter *out,
+                        const U_TRIVERTEX *vertices, uint32_t nVertices,
+                        const char *objects, uint32_t nObjects,
+                        uint32_t mode);
+// compound paths (emf2svg_path_utils.c)
+void path_run_poly(drawingStates *states, svgWriter *out,
+                   const char *contents);
+void path_run_line(drawingStates *states, svgWriter *out,
+                   const char *contents);
+void path_run_rect(drawingStates *states, svgWriter *out, POINT_D LT,
+                   POINT_D RB);
+void path_run_flush(drawingStates *states, svgWriter *out);
+void path_run_free(drawingStates *states);
+// write count points (U_POINT16 if is16, else U_POINT) as path data,
+// starting with a moveto if move, simplified if simplifyTolerance is set
+void poly_points_draw(drawingStates *states, svgWriter *out, const char *pts,
+                      bool is16, uint32_t count, bool move);
+void simplify_free(drawingStates *states);
+// time in seconds (options->timings)
+double e2s_clock(void);
+#if defined(__GNUC__)
+__attribute__((format(printf, 2, 3)))
+#endif
+void verbose_print(drawingStates *states, const char *fmt, ...);
+void trace_record(drawingStates *states, const char *contents, int recnum,
+                  size_t off);
+void trace_message(drawingStates *states, int recnum, size_t off,
+                   const char *message);
+void trace_free(drawingStates *states);
+// first pass over the records, building index (returns 0 on error, states
+// can be NULL)
+int index_build(const char *contents, size_t length, generatorIndex *index,
+                drawingStates *states);
+void index_clear(generatorIndex *index);
+// drawing states of a conversion of contents (NULL if out of memory)
+drawingStates *states_new(char *contents, size_t length, emfTiles *tiles,
+                          generatorOptions *options);
+void states_free(drawingStates *states);
+// copy of states between two records (NULL if out of memory, or if states
+// has merged paths pending, a trace or tiles, which are not copied)
+drawingStates *states_copy(drawingStates *src);
+// true if the records of index can be converted over options->drawThreads
+bool parallel_enabled(drawingStates *states, generatorIndex *index,
+                      generatorOptions *options);
+// convert the records of index over options->drawThreads, the first range
+// with states (returns 0 on error, recnum: records converted)
+int parallel_draw(char *contents, size_t length, generatorIndex *index,
+                  svgWriter *out, drawingStates *states,
+                  generatorOptions *options, int *recnum);
+// draw only what the record changes in states in the snapshot pass (returns
+// false if the record must be drawn)
+bool parallel_skip(drawingStates *states, const char *contents,
+                   svgWriter *out);
+void budget_init(drawingStates *states, generatorOptions *options);
+bool budget_check(drawingStates *states, svgWriter *out);
+bool budget_image(drawingStates *states, svgWriter *out, uint64_t width,
+                  uint64_t height);
+// start the path data of a d attribute
+void path_data_start(drawingStates *states, emfPathData *pd);
+// command ('M', 'L', 'C', 'A' or 'Z') of the next points
+void path_data_cmd(emfPathData *pd, svgWriter *out, char cmd);
+// point (in px) of the current command
+void path_data_point(emfPathData *pd, svgWriter *out, POINT_D pt);
+// elliptical arc, radii and end in px
+void path_data_arc(emfPathData *pd, svgWriter *out, POINT_D radii,
+                   int largeArc, int sweep, POINT_D end);
+// end of the d attribute (closing the subpath first if close)
+void path_data_end(emfPathData *pd, svgWriter *out, bool close);
 // stroke shape
-void stroke_draw(drawingStates *states, FILE *out, bool *filled, bool *stroked);
-void point16_draw(drawingStates *states, U_POINT16 pt, FILE *out);
-void point_draw(drawingStates *states, U_POINT pt, FILE *out);
-void freePathStack(pathStack *stack);
+void stroke_draw(drawingStates *states, svgWriter *out, bool *filled,
+                 bool *stroked);
+void point16_draw(drawingStates *states, U_POINT16 pt, svgWriter *out);
+void point_draw(drawingStates *states, U_POINT pt, svgWriter *out);
 // checks if address is outside the memory containing the emf file
 bool checkOutOfEMF(drawingStates *states, uintptr_t address);
-// checks if index is greater than the object table size
+// checks if index is greater than the object table size (an error if it
+// is greater than the handles of the header)
 bool checkOutOfOTIndex(drawingStates *states, int64_t index);
-void fill_draw(drawingStates *states, FILE *out, bool *filled, bool *stroked);
+void fill_draw(drawingStates *states, svgWriter *out, bool *filled,
+               bool *stroked);
 double scaleY(drawingStates *states, double y);
 double scaleX(drawingStates *states, double x);
 
@@ -353,7 +691,7 @@ double scaleX(drawingStates *states, double x);
 void hexbytes_draw(drawingStates *states, uint8_t *buf, unsigned int num);
 void colorref_draw(drawingStates *states, U_COLORREF color);
 void rgbquad_draw(drawingStates *states, U_RGBQUAD color);
-void rectl_draw(drawingStates *states, FILE *out, U_RECTL rect);
+void rectl_draw(drawingStates *states, svgWriter *out, U_RECTL rect);
 void sizel_draw(drawingStates *states, U_SIZEL sz);
 void pointl_draw(drawingStates *states, U_POINTL pt);
 void lcs_gamma_draw(drawingStates *states, U_LCS_GAMMA lg);
@@ -384,245 +722,270 @@ void pixelformatdescriptor_draw(drawingStates *states,
                                 U_PIXELFORMATDESCRIPTOR pfd);
 void emrtext_draw(drawingStates *states, const char *emt, const char *record,
                   int type);
-void arc_circle_draw(const char *contents, FILE *out, drawingStates *states);
+void arc_circle_draw(const char *contents, svgWriter *out,
+                     drawingStates *states);
 void addFormToStack(drawingStates *states);
 bool transform_set(drawingStates *states, U_XFORM xform, uint32_t iMode);
-void transform_draw(drawingStates *states, FILE *out);
-void arc_draw(const char *contents, FILE *out, drawingStates *states, int type);
-void newPathStruct(drawingStates *states);
+void transform_draw(drawingStates *states, svgWriter *out);
+void arc_draw(const char *contents, svgWriter *out, drawingStates *states,
+              int type);
 void setTransformIdentity(drawingStates *states);
 void freeObjectTable(drawingStates *states);
-void freePathStack(pathStack *stack);
+bool copyObjectTable(drawingStates *dest, drawingStates *src);
 void freeDeviceContext(EMF_DEVICE_CONTEXT *dc);
 POINT_D point_cal(drawingStates *states, double x, double y);
-void text_draw(const char *contents, FILE *out, drawingStates *states,
+void text_draw(const char *contents, svgWriter *out, drawingStates *states,
                uint8_t type);
 void lineto_draw(const char *name, const char *field1, const char *field2,
-                 const char *contents, FILE *out, drawingStates *states);
-void cubic_bezier_draw(const char *name, const char *contents, FILE *out,
+                 const char *contents, svgWriter *out, drawingStates *states);
+void cubic_bezier_draw(const char *name, const char *contents, svgWriter *out,
                        drawingStates *states, int startingPoint);
-void startPathDraw(drawingStates *states, FILE *out);
-void point_draw_d(drawingStates *states, POINT_D pt, FILE *out);
-void point_draw(drawingStates *states, U_POINT pt, FILE *out);
-void endPathDraw(drawingStates *states, FILE *out);
+void startPathDraw(drawingStates *states, svgWriter *out);
+void point_draw_d(drawingStates *states, POINT_D pt, svgWriter *out);
+void point_draw(drawingStates *states, U_POINT pt, svgWriter *out);
+void endPathDraw(drawingStates *states, svgWriter *out);
 POINT_D int_el_rad(U_POINTL pt, U_RECTL rect);
-void endFormDraw(drawingStates *states, FILE *out);
-void color_stroke(drawingStates *states, FILE *out);
-void width_stroke(drawingStates *states, FILE *out, double width);
-void freeObject(drawingStates *states, uint16_t index);
-void cubic_bezier16_draw(const char *name, const char *contents, FILE *out,
+void endFormDraw(drawingStates *states, svgWriter *out);
+void color_stroke(drawingStates *states, svgWriter *out);
+void width_stroke(drawingStates *states, svgWriter *out, double width);
+void freeObject(drawingStates *states, uint32_t index);
+// object at index, NULL if it was never created
+emfGraphObject *getObject(drawingStates *states, uint32_t index);
+// object at index, allocating its page if needed (NULL on error)
+emfGraphObject *newObject(drawingStates *states, uint32_t index);
+void cubic_bezier16_draw(const char *name, const char *contents, svgWriter *out,
                          drawingStates *states, int startingPoint);
-void polyline_draw(const char *name, const char *contents, FILE *out,
+void polyline_draw(const char *name, const char *contents, svgWriter *out,
                    drawingStates *states, bool polygon);
-void polypolygon16_draw(const char *name, const char *contents, FILE *out,
+void polypolygon16_draw(const char *name, const char *contents, svgWriter *out,
                         drawingStates *states, bool polygon);
 void U_swap4(void *ul, unsigned int count);
 void moveto_draw(const char *name, const char *field1, const char *field2,
-                 const char *contents, FILE *out, drawingStates *states);
-void polypolygon_draw(const char *name, const char *contents, FILE *out,
+                 const char *contents, svgWriter *out, drawingStates *states);
+void polypolygon_draw(const char *name, const char *contents, svgWriter *out,
                       drawingStates *states, bool polygon);
-void polyline16_draw(const char *name, const char *contents, FILE *out,
+void polyline16_draw(const char *name, const char *contents, svgWriter *out,
                      drawingStates *states, bool polygon);
 char *base64_encode(const unsigned char *data, size_t input_length,
                     size_t *output_length);
 
 /* prototypes for EMR records */
-void U_EMRNOTIMPLEMENTED_draw(const char *name, const char *contents, FILE *out,
-                              drawingStates *states);
-void U_EMRHEADER_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRPOLYBEZIER_draw(const char *contents, FILE *out,
+void U_EMRNOTIMPLEMENTED_draw(const char *name, const char *contents,
+                              svgWriter *out, drawingStates *states);
+void U_EMRHEADER_draw(const char *contents, svgWriter *out,
+                      drawingStates *states);
+void U_EMRPOLYBEZIER_draw(const char *contents, svgWriter *out,
                           drawingStates *states);
-void U_EMRPOLYGON_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRPOLYLINE_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRPOLYBEZIERTO_draw(const char *contents, FILE *out,
+void U_EMRPOLYGON_draw(const char *contents, svgWriter *out,
+                       drawingStates *states);
+void U_EMRPOLYLINE_draw(const char *contents, svgWriter *out,
+                        drawingStates *states);
+void U_EMRPOLYBEZIERTO_draw(const char *contents, svgWriter *out,
                             drawingStates *states);
-void U_EMRPOLYLINETO_draw(const char *contents, FILE *out,
+void U_EMRPOLYLINETO_draw(const char *contents, svgWriter *out,
                           drawingStates *states);
-void U_EMRPOLYPOLYLINE_draw(const char *contents, FILE *out,
+void U_EMRPOLYPOLYLINE_draw(const char *contents, svgWriter *out,
                             drawingStates *states);
-void U_EMRPOLYPOLYGON_draw(const char *contents, FILE *out,
+void U_EMRPOLYPOLYGON_draw(const char *contents, svgWriter *out,
                            drawingStates *states);
-void U_EMRSETWINDOWEXTEX_draw(const char *contents, FILE *out,
+void U_EMRSETWINDOWEXTEX_draw(const char *contents, svgWriter *out,
                               drawingStates *states);
-void U_EMRSETWINDOWORGEX_draw(const char *contents, FILE *out,
+void U_EMRSETWINDOWORGEX_draw(const char *contents, svgWriter *out,
                               drawingStates *states);
-void U_EMRSETVIEWPORTEXTEX_draw(const char *contents, FILE *out,
+void U_EMRSETVIEWPORTEXTEX_draw(const char *contents, svgWriter *out,
                                 drawingStates *states);
-void U_EMRSETVIEWPORTORGEX_draw(const char *contents, FILE *out,
+void U_EMRSETVIEWPORTORGEX_draw(const char *contents, svgWriter *out,
                                 drawingStates *states);
-void U_EMRSETBRUSHORGEX_draw(const char *contents, FILE *out,
+void U_EMRSETBRUSHORGEX_draw(const char *contents, svgWriter *out,
                              drawingStates *states);
-void U_EMREOF_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRSETPIXELV_draw(const char *contents, FILE *out,
+void U_EMREOF_draw(const char *contents, svgWriter *out, drawingStates *states);
+void U_EMRSETPIXELV_draw(const char *contents, svgWriter *out,
                          drawingStates *states);
-void U_EMRSETMAPPERFLAGS_draw(const char *contents, FILE *out,
+void U_EMRSETMAPPERFLAGS_draw(const char *contents, svgWriter *out,
                               drawingStates *states);
-void U_EMRSETMAPMODE_draw(const char *contents, FILE *out,
+void U_EMRSETMAPMODE_draw(const char *contents, svgWriter *out,
                           drawingStates *states);
-void U_EMRSETBKMODE_draw(const char *contents, FILE *out,
+void U_EMRSETBKMODE_draw(const char *contents, svgWriter *out,
                          drawingStates *states);
-void U_EMRSETPOLYFILLMODE_draw(const char *contents, FILE *out,
+void U_EMRSETPOLYFILLMODE_draw(const char *contents, svgWriter *out,
                                drawingStates *states);
-void U_EMRSETROP2_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRSETSTRETCHBLTMODE_draw(const char *contents, FILE *out,
+void U_EMRSETROP2_draw(const char *contents, svgWriter *out,
+                       drawingStates *states);
+void U_EMRSETSTRETCHBLTMODE_draw(const char *contents, svgWriter *out,
                                  drawingStates *states);
-void U_EMRSETTEXTALIGN_draw(const char *contents, FILE *out,
+void U_EMRSETTEXTALIGN_draw(const char *contents, svgWriter *out,
                             drawingStates *states);
-void U_EMRSETCOLORADJUSTMENT_draw(const char *contents, FILE *out,
+void U_EMRSETCOLORADJUSTMENT_draw(const char *contents, svgWriter *out,
                                   drawingStates *states);
-void U_EMRSETTEXTCOLOR_draw(const char *contents, FILE *out,
+void U_EMRSETTEXTCOLOR_draw(const char *contents, svgWriter *out,
                             drawingStates *states);
-void U_EMRSETBKCOLOR_draw(const char *contents, FILE *out,
+void U_EMRSETBKCOLOR_draw(const char *contents, svgWriter *out,
                           drawingStates *states);
-void U_EMROFFSETCLIPRGN_draw(const char *contents, FILE *out,
+void U_EMROFFSETCLIPRGN_draw(const char *contents, svgWriter *out,
                              drawingStates *states);
-void U_EMRMOVETOEX_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRSETMETARGN_draw(const char *contents, FILE *out,
+void U_EMRMOVETOEX_draw(const char *contents, svgWriter *out,
+                        drawingStates *states);
+void U_EMRSETMETARGN_draw(const char *contents, svgWriter *out,
                           drawingStates *states);
-void U_EMREXCLUDECLIPRECT_draw(const char *contents, FILE *out,
+void U_EMREXCLUDECLIPRECT_draw(const char *contents, svgWriter *out,
                                drawingStates *states);
-void U_EMRINTERSECTCLIPRECT_draw(const char *contents, FILE *out,
+void U_EMRINTERSECTCLIPRECT_draw(const char *contents, svgWriter *out,
                                  drawingStates *states);
-void U_EMRSCALEVIEWPORTEXTEX_draw(const char *contents, FILE *out,
+void U_EMRSCALEVIEWPORTEXTEX_draw(const char *contents, svgWriter *out,
                                   drawingStates *states);
-void U_EMRSCALEWINDOWEXTEX_draw(const char *contents, FILE *out,
+void U_EMRSCALEWINDOWEXTEX_draw(const char *contents, svgWriter *out,
                                 drawingStates *states);
-void U_EMRSAVEDC_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRRESTOREDC_draw(const char *contents, FILE *out,
+void U_EMRSAVEDC_draw(const char *contents, svgWriter *out,
+                      drawingStates *states);
+void U_EMRRESTOREDC_draw(const char *contents, svgWriter *out,
                          drawingStates *states);
-void U_EMRSETWORLDTRANSFORM_draw(const char *contents, FILE *out,
+void U_EMRSETWORLDTRANSFORM_draw(const char *contents, svgWriter *out,
                                  drawingStates *states);
-void U_EMRMODIFYWORLDTRANSFORM_draw(const char *contents, FILE *out,
+void U_EMRMODIFYWORLDTRANSFORM_draw(const char *contents, svgWriter *out,
                                     drawingStates *states);
-void U_EMRSELECTOBJECT_draw(const char *contents, FILE *out,
+void U_EMRSELECTOBJECT_draw(const char *contents, svgWriter *out,
                             drawingStates *states);
-void U_EMRCREATEPEN_draw(const char *contents, FILE *out,
+void U_EMRCREATEPEN_draw(const char *contents, svgWriter *out,
                          drawingStates *states);
-void U_EMRCREATEBRUSHINDIRECT_draw(const char *contents, FILE *out,
+void U_EMRCREATEBRUSHINDIRECT_draw(const char *contents, svgWriter *out,
                                    drawingStates *states);
-void U_EMRDELETEOBJECT_draw(const char *contents, FILE *out,
+void U_EMRDELETEOBJECT_draw(const char *contents, svgWriter *out,
                             drawingStates *states);
-void U_EMRANGLEARC_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRELLIPSE_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRRECTANGLE_draw(const char *contents, FILE *out,
+void U_EMRANGLEARC_draw(const char *contents, svgWriter *out,
+                        drawingStates *states);
+void U_EMRELLIPSE_draw(const char *contents, svgWriter *out,
+                       drawingStates *states);
+void U_EMRRECTANGLE_draw(const char *contents, svgWriter *out,
                          drawingStates *states);
-void U_EMRROUNDRECT_draw(const char *contents, FILE *out,
+void U_EMRROUNDRECT_draw(const char *contents, svgWriter *out,
                          drawingStates *states);
-void U_EMRARC_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRCHORD_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRPIE_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRSELECTPALETTE_draw(const char *contents, FILE *out,
+void U_EMRARC_draw(const char *contents, svgWriter *out, drawingStates *states);
+void U_EMRCHORD_draw(const char *contents, svgWriter *out,
+                     drawingStates *states);
+void U_EMRPIE_draw(const char *contents, svgWriter *out, drawingStates *states);
+void U_EMRSELECTPALETTE_draw(const char *contents, svgWriter *out,
                              drawingStates *states);
-void U_EMRCREATEPALETTE_draw(const char *contents, FILE *out,
+void U_EMRCREATEPALETTE_draw(const char *contents, svgWriter *out,
                              drawingStates *states);
-void U_EMRSETPALETTEENTRIES_draw(const char *contents, FILE *out,
+void U_EMRSETPALETTEENTRIES_draw(const char *contents, svgWriter *out,
                                  drawingStates *states);
-void U_EMRRESIZEPALETTE_draw(const char *contents, FILE *out,
+void U_EMRRESIZEPALETTE_draw(const char *contents, svgWriter *out,
                              drawingStates *states);
-void U_EMRREALIZEPALETTE_draw(const char *contents, FILE *out,
+void U_EMRREALIZEPALETTE_draw(const char *contents, svgWriter *out,
                               drawingStates *states);
-void U_EMREXTFLOODFILL_draw(const char *contents, FILE *out,
+void U_EMREXTFLOODFILL_draw(const char *contents, svgWriter *out,
                             drawingStates *states);
-void U_EMRLINETO_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRARCTO_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRPOLYDRAW_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRSETARCDIRECTION_draw(const char *contents, FILE *out,
+void U_EMRLINETO_draw(const char *contents, svgWriter *out,
+                      drawingStates *states);
+void U_EMRARCTO_draw(const char *contents, svgWriter *out,
+                     drawingStates *states);
+void U_EMRPOLYDRAW_draw(const char *contents, svgWriter *out,
+                        drawingStates *states);
+void U_EMRSETARCDIRECTION_draw(const char *contents, svgWriter *out,
                                drawingStates *states);
-void U_EMRSETMITERLIMIT_draw(const char *contents, FILE *out,
+void U_EMRSETMITERLIMIT_draw(const char *contents, svgWriter *out,
                              drawingStates *states);
-void U_EMRBEGINPATH_draw(const char *contents, FILE *out,
+void U_EMRBEGINPATH_draw(const char *contents, svgWriter *out,
                          drawingStates *states);
-void U_EMRENDPATH_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRCLOSEFIGURE_draw(const char *contents, FILE *out,
+void U_EMRENDPATH_draw(const char *contents, svgWriter *out,
+                       drawingStates *states);
+void U_EMRCLOSEFIGURE_draw(const char *contents, svgWriter *out,
                            drawingStates *states);
-void U_EMRFILLPATH_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRSTROKEANDFILLPATH_draw(const char *contents, FILE *out,
+void U_EMRFILLPATH_draw(const char *contents, svgWriter *out,
+                        drawingStates *states);
+void U_EMRSTROKEANDFILLPATH_draw(const char *contents, svgWriter *out,
                                  drawingStates *states);
-void U_EMRSTROKEPATH_draw(const char *contents, FILE *out,
+void U_EMRSTROKEPATH_draw(const char *contents, svgWriter *out,
                           drawingStates *states);
-void U_EMRFLATTENPATH_draw(const char *contents, FILE *out,
+void U_EMRFLATTENPATH_draw(const char *contents, svgWriter *out,
                            drawingStates *states);
-void U_EMRWIDENPATH_draw(const char *contents, FILE *out,
+void U_EMRWIDENPATH_draw(const char *contents, svgWriter *out,
                          drawingStates *states);
-void U_EMRSELECTCLIPPATH_draw(const char *contents, FILE *out,
+void U_EMRSELECTCLIPPATH_draw(const char *contents, svgWriter *out,
                               drawingStates *states);
-void U_EMRABORTPATH_draw(const char *contents, FILE *out,
+void U_EMRABORTPATH_draw(const char *contents, svgWriter *out,
                          drawingStates *states);
 bool U_EMRCOMMENT_is_emfplus(const char *contents, const char *blimit);
-void U_EMRCOMMENT_draw(const char *contents, FILE *out, drawingStates *states,
-                       const char *blimit, size_t off);
-void U_EMRFILLRGN_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRFRAMERGN_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRINVERTRGN_draw(const char *contents, FILE *out,
+void U_EMRCOMMENT_draw(const char *contents, svgWriter *out,
+                       drawingStates *states, const char *blimit, size_t off);
+void U_EMRFILLRGN_draw(const char *contents, svgWriter *out,
+                       drawingStates *states);
+void U_EMRFRAMERGN_draw(const char *contents, svgWriter *out,
+                        drawingStates *states);
+void U_EMRINVERTRGN_draw(const char *contents, svgWriter *out,
                          drawingStates *states);
-void U_EMRPAINTRGN_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMREXTSELECTCLIPRGN_draw(const char *contents, FILE *out,
+void U_EMRPAINTRGN_draw(const char *contents, svgWriter *out,
+                        drawingStates *states);
+void U_EMREXTSELECTCLIPRGN_draw(const char *contents, svgWriter *out,
                                 drawingStates *states);
-void U_EMRBITBLT_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRSTRETCHBLT_draw(const char *contents, FILE *out,
+void U_EMRBITBLT_draw(const char *contents, svgWriter *out,
+                      drawingStates *states);
+void U_EMRSTRETCHBLT_draw(const char *contents, svgWriter *out,
                           drawingStates *states);
-void U_EMRMASKBLT_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRPLGBLT_draw(const char *contents, FILE *out, drawingStates *states);
-void U_EMRSETDIBITSTODEVICE_draw(const char *contents, FILE *out,
+void U_EMRMASKBLT_draw(const char *contents, svgWriter *out,
+                       drawingStates *states);
+void U_EMRPLGBLT_draw(const char *contents, svgWriter *out,
+                      drawingStates *states);
+void U_EMRSETDIBITSTODEVICE_draw(const char *contents, svgWriter *out,
                                  drawingStates *states);
-void U_EMRSTRETCHDIBITS_draw(const char *contents, FILE *out,
+void U_EMRSTRETCHDIBITS_draw(const char *contents, svgWriter *out,
                              drawingStates *states);
-void U_EMREXTCREATEFONTINDIRECTW_draw(const char *contents, FILE *out,
+void U_EMREXTCREATEFONTINDIRECTW_draw(const char *contents, svgWriter *out,
                                       drawingStates *states);
-void U_EMREXTTEXTOUTA_draw(const char *contents, FILE *out,
+void U_EMREXTTEXTOUTA_draw(const char *contents, svgWriter *out,
                            drawingStates *states);
-void U_EMREXTTEXTOUTW_draw(const char *contents, FILE *out,
+void U_EMREXTTEXTOUTW_draw(const char *contents, svgWriter *out,
                            drawingStates *states);
-void U_EMRPOLYBEZIER16_draw(const char *contents, FILE *out,
+void U_EMRPOLYBEZIER16_draw(const char *contents, svgWriter *out,
                             drawingStates *states);
-void U_EMRPOLYGON16_draw(const char *contents, FILE *out,
+void U_EMRPOLYGON16_draw(const char *contents, svgWriter *out,
                          drawingStates *states);
-void U_EMRPOLYLINE16_draw(const char *contents, FILE *out,
+void U_EMRPOLYLINE16_draw(const char *contents, svgWriter *out,
                           drawingStates *states);
-void U_EMRPOLYBEZIERTO16_draw(const char *contents, FILE *out,
+void U_EMRPOLYBEZIERTO16_draw(const char *contents, svgWriter *out,
                               drawingStates *states);
-void U_EMRPOLYLINETO16_draw(const char *contents, FILE *out,
+void U_EMRPOLYLINETO16_draw(const char *contents, svgWriter *out,
                             drawingStates *states);
-void U_EMRPOLYPOLYLINE16_draw(const char *contents, FILE *out,
+void U_EMRPOLYPOLYLINE16_draw(const char *contents, svgWriter *out,
                               drawingStates *states);
-void U_EMRPOLYPOLYGON16_draw(const char *contents, FILE *out,
+void U_EMRPOLYPOLYGON16_draw(const char *contents, svgWriter *out,
                              drawingStates *states);
-void U_EMRPOLYDRAW16_draw(const char *contents, FILE *out,
+void U_EMRPOLYDRAW16_draw(const char *contents, svgWriter *out,
                           drawingStates *states);
-void U_EMRCREATEMONOBRUSH_draw(const char *contents, FILE *out,
+void U_EMRCREATEMONOBRUSH_draw(const char *contents, svgWriter *out,
                                drawingStates *states);
-void U_EMRCREATEDIBPATTERNBRUSHPT_draw(const char *contents, FILE *out,
+void U_EMRCREATEDIBPATTERNBRUSHPT_draw(const char *contents, svgWriter *out,
                                        drawingStates *states);
-void U_EMREXTCREATEPEN_draw(const char *contents, FILE *out,
+void U_EMREXTCREATEPEN_draw(const char *contents, svgWriter *out,
                             drawingStates *states);
-void U_EMRSETICMMODE_draw(const char *contents, FILE *out,
+void U_EMRSETICMMODE_draw(const char *contents, svgWriter *out,
                           drawingStates *states);
-void U_EMRCREATECOLORSPACE_draw(const char *contents, FILE *out,
+void U_EMRCREATECOLORSPACE_draw(const char *contents, svgWriter *out,
                                 drawingStates *states);
-void U_EMRSETCOLORSPACE_draw(const char *contents, FILE *out,
+void U_EMRSETCOLORSPACE_draw(const char *contents, svgWriter *out,
                              drawingStates *states);
-void U_EMRDELETECOLORSPACE_draw(const char *contents, FILE *out,
+void U_EMRDELETECOLORSPACE_draw(const char *contents, svgWriter *out,
                                 drawingStates *states);
-void U_EMRPIXELFORMAT_draw(const char *contents, FILE *out,
+void U_EMRPIXELFORMAT_draw(const char *contents, svgWriter *out,
                            drawingStates *states);
-void U_EMRSMALLTEXTOUT_draw(const char *contents, FILE *out,
+void U_EMRSMALLTEXTOUT_draw(const char *contents, svgWriter *out,
                             drawingStates *states);
-void U_EMRALPHABLEND_draw(const char *contents, FILE *out,
+void U_EMRALPHABLEND_draw(const char *contents, svgWriter *out,
                           drawingStates *states);
-void U_EMRSETLAYOUT_draw(const char *contents, FILE *out,
+void U_EMRSETLAYOUT_draw(const char *contents, svgWriter *out,
                          drawingStates *states);
-void U_EMRTRANSPARENTBLT_draw(const char *contents, FILE *out,
+void U_EMRTRANSPARENTBLT_draw(const char *contents, svgWriter *out,
                               drawingStates *states);
-void U_EMRGRADIENTFILL_draw(const char *contents, FILE *out,
+void U_EMRGRADIENTFILL_draw(const char *contents, svgWriter *out,
                             drawingStates *states);
-void U_EMRCREATECOLORSPACEW_draw(const char *contents, FILE *out,
+void U_EMRCREATECOLORSPACEW_draw(const char *contents, svgWriter *out,
                                  drawingStates *states);
 int U_emf_onerec_draw(const char *contents, const char *blimit, int recnum,
-                      size_t off, FILE *out, drawingStates *states);
-void dib_img_writer(const char *contents, FILE *out, drawingStates *states,
+                      size_t off, svgWriter *out, drawingStates *states);
+void dib_img_writer(const char *contents, svgWriter *out, drawingStates *states,
                     PU_BITMAPINFOHEADER BmiSrc, const unsigned char *BmpSrc,
                     size_t size, bool assign_mono_colors_from_dc);
-emfImageLibrary *image_library_writer(const char *contents, FILE *out,
+emfImageLibrary *image_library_writer(const char *contents, svgWriter *out,
                                       drawingStates *states,
                                       PU_BITMAPINFOHEADER BmiSrc, size_t size,
                                       const unsigned char *BmpSrc);
@@ -633,13 +996,20 @@ emfImageLibrary *image_library_add(drawingStates *states,
 emfImageLibrary *image_library_find(emfImageLibrary *lib,
                                     PU_BITMAPINFOHEADER BmiSrc, size_t size);
 void freeEmfImageLibrary(drawingStates *states);
-void text_style_draw(FILE *out, drawingStates *states, POINT_D Org);
+bool image_library_copy(drawingStates *dest, drawingStates *src);
+// EMR_SETPIXELV pixels, drawn as one image by pixel_run_flush()
+void pixel_run_add(drawingStates *states, svgWriter *out, U_POINTL pt,
+                   U_COLORREF color);
+void pixel_run_flush(drawingStates *states, svgWriter *out);
+void pixel_run_free(drawingStates *states);
+bool pixel_run_copy(drawingStates *dest, drawingStates *src);
+void text_style_draw(svgWriter *out, drawingStates *states, POINT_D Org);
 void char_to_utf16(char *in, size_t size_in, char **out);
 void text_convert(char *in, size_t size_in, char **out, size_t *size_out,
                   uint8_t type, drawingStates *states);
-void text_draw(const char *contents, FILE *out, drawingStates *states,
+void text_draw(const char *contents, svgWriter *out, drawingStates *states,
                uint8_t type);
-void clipset_draw(drawingStates *states, FILE *out);
+void clipset_draw(drawingStates *states, svgWriter *out);
 void free_path(PATH **path);
 void add_new_seg(PATH **path, uint8_t type);
 POINT_D point_s(drawingStates *states, U_POINT pt);
@@ -649,11 +1019,50 @@ void pointCurrPathAddD(drawingStates *states, POINT_D pt, int index);
 void pointCurrPathAdd(drawingStates *states, U_POINT pt, int index);
 void pointCurrPathAdd16(drawingStates *states, U_POINT16 pt, int index);
 void clip_rgn_mix(drawingStates *states, PATH *path, uint32_t mode);
-void clip_rgn_draw(drawingStates *states, FILE *out);
+void clip_rgn_draw(drawingStates *states, svgWriter *out);
+void clip_rgn_rect_mix(drawingStates *states, RECT_D rect, uint32_t mode);
+void clip_rgn_offset(drawingStates *states, POINT_D pt);
+void clip_rects_free(EMF_DEVICE_CONTEXT *dc);
+void clip_rects_copy(EMF_DEVICE_CONTEXT *dest, EMF_DEVICE_CONTEXT *src);
+RECT_D rect_d(POINT_D a, POINT_D b);
+int clip_rect_test(drawingStates *states, RECT_D box);
+bool record_view_box(drawingStates *states, const char *contents,
+                     RECT_D *view, bool *clipped);
+bool view_outside(RECT_D box, RECT_D viewport);
+bool cull_record(drawingStates *states, const char *contents);
+void svg_start_draw(drawingStates *states, svgWriter *out,
+                    const RECT_D *view);
+void tiles_start_draw(drawingStates *states);
+void tiles_record_start(drawingStates *states, const char *contents);
+void tiles_record_end(drawingStates *states, svgWriter *out);
+void tiles_mark(drawingStates *states, svgWriter *out);
+void tiles_record_all(drawingStates *states);
+bool clipset_draw_box(drawingStates *states, svgWriter *out, RECT_D box,
+                      bool stroked);
+int clipset_box_group(drawingStates *states, RECT_D box, bool stroked);
+double stroke_margin(drawingStates *states);
+bool poly_box(drawingStates *states, const char *contents, bool is16,
+              bool polypolygon, RECT_D *box);
+bool clipset_draw_poly(drawingStates *states, svgWriter *out,
+                       const char *contents, bool is16, bool polypolygon);
+void clip_library_draw(drawingStates *states, svgWriter *out,
+                       emfClipLibrary *clip);
+PATH *region_mix(PATH *a, int fill_a, PATH *b, int fill_b, uint32_t mode,
+                 double tolerance, bool *error);
+void clip_group_close(drawingStates *states, svgWriter *out);
+uint32_t hash_path(PATH *in);
+bool equal_path(PATH *a, PATH *b);
+emfClipLibrary *clip_library_find(drawingStates *states, PATH *path,
+                                  uint32_t hash, bool evenodd);
+emfClipLibrary *clip_library_add(drawingStates *states, PATH *path,
+                                 uint32_t hash, bool evenodd);
+void freeEmfClipLibrary(drawingStates *states);
+// copy the clip library of src in dest, and move the clip entries of the
+// device contexts of dest (copied from src) to the copy
+bool clip_library_copy(drawingStates *dest, drawingStates *src);
 void copy_path(PATH *in, PATH **out);
 void offset_path(PATH *in, POINT_D pt);
-void draw_path(PATH *in, FILE *out);
-void point_draw_raw_d(POINT_D pt, FILE *out);
+void draw_path(drawingStates *states, PATH *in, svgWriter *out);
 int get_id(drawingStates *states);
 //! \endcond
 
@@ -0,0 +1,153 @@
+#ifndef EMF2SVG_WRITER_H
+#define EMF2SVG_WRITER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// size of the chunks written to a FILE or a callback
+#define SVG_WRITER_CHUNK 65536
+
+// same as emf2svg_write_callback
+typedef size_t (*svgWriterCallback)(const char *data, size_t size, void *ctx);
+
+// gzip stage between a writer and its output (emf2svg_gzip.c)
+typedef struct svgGzip svgGzip;
+
+// output of the svg: a growable buffer, flushed by chunks to a FILE or to
+// a callback if one of them is set, kept in memory otherwise
+typedef struct {
+    char *buf;
+    size_t len;
+    size_t size;
+    FILE *file;
+    svgWriterCallback callback;
+    void *ctx;
+    // set on allocation or write failure (the output is incomplete)
+    bool error;
+    // bytes flushed to the FILE or the callback
+    size_t written;
+    // allocations of the buffer
+    size_t allocations;
+    // set by svg_writer_gzip(), the chunks are compressed before output
+    svgGzip *gzip;
+} svgWriter;
+
+bool svg_writer_init(svgWriter *w, FILE *file, svgWriterCallback callback,
+                     void *ctx);
+bool svg_writer_grow(svgWriter *w, size_t n);
+bool svg_writer_flush(svgWriter *w);
+bool svg_writer_close(svgWriter *w);
+void svg_writer_free(svgWriter *w);
+// compress the output of an initialized writer to a gzip stream,
+// level 1 to 9 (0 for zlib default), in blocks over threads if threads > 1
+bool svg_writer_gzip(svgWriter *w, int level, unsigned int threads);
+bool svg_gzip_finish(svgWriter *w);
+void svg_gzip_free(svgGzip *gz);
+#if defined(__GNUC__)
+__attribute__((format(printf, 2, 3)))
+#endif
+void svg_printf(svgWriter *w, const char *fmt, ...);
+void svg_vprintf(svgWriter *w, const char *fmt, va_list ap);
+void svg_append_number_slow(svgWriter *w, double v);
+
+// make room for n bytes, false if the writer failed (it may have no buffer)
+static inline bool svg_reserve(svgWriter *w, size_t n) {
+    if (w->error)
+        return false;
+    if (w->size - w->len >= n)
+        return true;
+    return svg_writer_grow(w, n);
+}
+
+static inline void svg_append(svgWriter *w, const char *s, size_t n) {
+    // nothing to copy (a zeroed writer has no buffer yet)
+    if (n == 0 || !svg_reserve(w, n))
+        return;
+    memcpy(w->buf + w->len, s, n);
+    w->len += n;
+}
+
+// string literals only
+#define svg_append_literal(w, s) svg_append((w), (s), sizeof(s) - 1)
+
+static inline void svg_append_string(svgWriter *w, const char *s) {
+    svg_append(w, s, strlen(s));
+}
+
+static inline void svg_append_int(svgWriter *w, int64_t v) {
+    char tmp[24];
+    int i = sizeof(tmp);
+    uint64_t n = v < 0 ? -(uint64_t)v : (uint64_t)v;
+    do {
+        tmp[--i] = '0' + n % 10;
+        n /= 10;
+    } while (n);
+    if (v < 0)
+        tmp[--i] = '-';
+    svg_append(w, tmp + i, sizeof(tmp) - i);
+}
+
+// same output as "#%02X%02X%02X"
+static inline void svg_append_color(svgWriter *w, uint8_t r, uint8_t g,
+                                    uint8_t b) {
+    static const char hex[] = "0123456789ABCDEF";
+    char tmp[7] = {'#',          hex[r >> 4], hex[r & 15], hex[g >> 4],
+                   hex[g & 15], hex[b >> 4], hex[b & 15]};
+    svg_append(w, tmp, sizeof(tmp));
+}
+
+// same output as "%.4f"
+static inline void svg_append_number(svgWriter *w, double v) {
+    double a = fabs(v) * 10000;
+    // below 2^32 the error of the product is under 1e-6, the rounding is
+    // only ambiguous close to ties, left to snprintf (as NaN and infinity)
+    if (!(a < 4294967296.0)) {
+        svg_append_number_slow(w, v);
+        return;
+    }
+    uint64_t n = (uint64_t)a;
+    double frac = a - (double)n;
+    if (fabs(frac - 0.5) < 1e-5) {
+        svg_append_number_slow(w, v);
+        return;
+    }
+    if (frac > 0.5)
+        n++;
+    char tmp[24];
+    int i = sizeof(tmp);
+    for (int d = 0; d < 4; d++) {
+        tmp[--i] = '0' + n % 10;
+        n /= 10;
+    }
+    tmp[--i] = '.';
+    do {
+        tmp[--i] = '0' + n % 10;
+        n /= 10;
+    } while (n);
+    if (signbit(v))
+        tmp[--i] = '-';
+    svg_append(w, tmp + i, sizeof(tmp) - i);
+}
+
+// "x,y " point of path data
+static inline void svg_append_point(svgWriter *w, double x, double y) {
+    svg_append_number(w, x);
+    svg_append_literal(w, ",");
+    svg_append_number(w, y);
+    svg_append_literal(w, " ");
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EMF2SVG_WRITER_H */
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
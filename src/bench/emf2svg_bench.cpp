@@ -0,0 +1,299 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+
+/* emf2svg-bench
+ * converts a set of EMF files N times and reports the throughput and the
+ * time spent in each phase of the conversion as JSON
+ */
+
+#include "emf2svg.h"
+#include <algorithm>
+#include <chrono>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+// needs to be at the end #define in argp.h messing with other includes
+#include <argp.h>
+
+using namespace std;
+
+#define __STRINGIFY__(V) __STR__(V)
+#define __STR__(V) #V
+
+const char *argp_program_version = __STRINGIFY__(E2S_VERSION);
+
+const char *argp_program_bug_address =
+    "https://github.com/kakwa/libemf2svg/issues";
+
+static char doc[] =
+    "emf2svg-bench -- benchmark of the EMF to SVG conversion\v"
+    "PATH can be EMF files or directories (every *.emf file in them), "
+    "tests/resources/emf by default. Times are in seconds, averaged over "
+    "the iterations.";
+
+static struct argp_option options[] = {
+    {"iterations", 'n', "N", 0, "Convert each file N times (default: 5)"},
+    {"output", 'o', "FILE", 0, "Write the JSON report to FILE (default: stdout)"},
+    {"emfplus", 'p', 0, 0, "Handle EMF+ records"},
+    {"compact", 'C', 0, 0, "Write compact path data"},
+    {"merge", 'm', 0, 0, "Merge consecutive shapes of the same style"},
+    {"svgz", 'z', 0, 0, "Write a gzip compressed svg"},
+    {0}};
+
+static char args_doc[] = "[PATH...]";
+
+struct arguments {
+    vector<string> paths;
+    unsigned int iterations;
+    char *output;
+    bool emfplus, compact, merge, svgz;
+};
+
+static error_t parse_opt(int key, char *arg, struct argp_state *state) {
+    struct arguments *arguments = (struct arguments *)state->input;
+
+    switch (key) {
+    case 'n':
+        arguments->iterations = atoi(arg);
+        if (arguments->iterations == 0)
+            argp_error(state, "invalid iterations '%s'", arg);
+        break;
+    case 'o':
+        arguments->output = arg;
+        break;
+    case 'p':
+        arguments->emfplus = 1;
+        break;
+    case 'C':
+        arguments->compact = 1;
+        break;
+    case 'm':
+        arguments->merge = 1;
+        break;
+    case 'z':
+        arguments->svgz = 1;
+        break;
+    case ARGP_KEY_ARG:
+        arguments->paths.push_back(arg);
+        break;
+    default:
+        return ARGP_ERR_UNKNOWN;
+    }
+    return 0;
+}
+
+static struct argp argp = {options, parse_opt, args_doc, doc};
+
+// results of a file (or of the whole run), times per conversion
+struct result {
+    string file;
+    bool ok;
+    size_t files;
+    size_t failed;
+    size_t input;
+    size_t output;
+    size_t records;
+    double time;
+    generatorTimings phases;
+};
+
+static void add_files(const string &path, vector<string> &files) {
+    struct stat s;
+    if (stat(path.c_str(), &s) != 0) {
+        cerr << "[ERROR] Impossible to access '" << path << "'" << endl;
+        return;
+    }
+    if (!S_ISDIR(s.st_mode)) {
+        files.push_back(path);
+        return;
+    }
+    DIR *dir = opendir(path.c_str());
+    if (dir == NULL) {
+        cerr << "[ERROR] Impossible to open directory '" << path << "'"
+             << endl;
+        return;
+    }
+    vector<string> found;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        string name(entry->d_name);
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".emf") == 0)
+            found.push_back(path + "/" + name);
+    }
+    closedir(dir);
+    sort(found.begin(), found.end());
+    files.insert(files.end(), found.begin(), found.end());
+}
+
+static bool read_file(const string &file, vector<char> &contents) {
+    ifstream in(file, ios::binary);
+    if (!in.is_open())
+        return false;
+    in.seekg(0, ios::end);
+    contents.resize(in.tellg());
+    in.seekg(0, ios::beg);
+    in.read(contents.data(), contents.size());
+    return !in.fail();
+}
+
+static result bench_file(const string &file, unsigned int iterations,
+                         generatorOptions *options) {
+    result r = result();
+    r.file = file;
+    r.files = 1;
+    vector<char> contents;
+    if (!read_file(file, contents)) {
+        r.failed = 1;
+        return r;
+    }
+    r.input = contents.size();
+    // the conversion swaps the bytes in place on big endian machines
+    vector<char> work(contents.size());
+    generatorTimings phases;
+    options->timings = &phases;
+    r.ok = true;
+    for (unsigned int i = 0; i < iterations; i++) {
+        copy(contents.begin(), contents.end(), work.begin());
+        phases = generatorTimings();
+        char *svg_out = NULL;
+        size_t svg_len = 0;
+        auto start = chrono::steady_clock::now();
+        int ret = emf2svg(work.data(), work.size(), &svg_out, &svg_len,
+                          options);
+        auto end = chrono::steady_clock::now();
+        free(svg_out);
+        r.ok = r.ok && ret != 0;
+        r.output = svg_len;
+        r.records = phases.records;
+        r.time += chrono::duration<double>(end - start).count();
+        r.phases.analyse += phases.analyse;
+        r.phases.draw += phases.draw;
+        r.phases.images += phases.images;
+        r.phases.fonts += phases.fonts;
+    }
+    options->timings = NULL;
+    r.failed = !r.ok;
+    r.time /= iterations;
+    r.phases.analyse /= iterations;
+    r.phases.draw /= iterations;
+    r.phases.images /= iterations;
+    r.phases.fonts /= iterations;
+    return r;
+}
+
+static void add_result(result &total, const result &r) {
+    total.files += r.files;
+    total.failed += r.failed;
+    total.input += r.input;
+    total.output += r.output;
+    total.records += r.records;
+    total.time += r.time;
+    total.phases.analyse += r.phases.analyse;
+    total.phases.draw += r.phases.draw;
+    total.phases.images += r.phases.images;
+    total.phases.fonts += r.phases.fonts;
+}
+
+static void json_string(FILE *f, const string &s) {
+    fputc('"', f);
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\')
+            fprintf(f, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(f, "\\u%04x", c);
+        else
+            fputc(c, f);
+    }
+    fputc('"', f);
+}
+
+static void json_result(FILE *f, const result &r, const char *indent) {
+    double time = r.time > 0 ? r.time : 1e-9;
+    fprintf(f,
+            "%s\"input_bytes\": %zu,\n"
+            "%s\"output_bytes\": %zu,\n"
+            "%s\"records\": %zu,\n"
+            "%s\"time\": %.6f,\n"
+            "%s\"analyse\": %.6f,\n"
+            "%s\"draw\": %.6f,\n"
+            "%s\"images\": %.6f,\n"
+            "%s\"fonts\": %.6f,\n"
+            "%s\"input_mb_per_s\": %.3f,\n"
+            "%s\"records_per_s\": %.0f\n",
+            indent, r.input, indent, r.output, indent, r.records, indent,
+            r.time, indent, r.phases.analyse, indent, r.phases.draw, indent,
+            r.phases.images, indent, r.phases.fonts, indent,
+            r.input / time / 1e6, indent, r.records / time);
+}
+
+int main(int argc, char *argv[]) {
+    struct arguments arguments;
+    arguments.iterations = 5;
+    arguments.output = NULL;
+    arguments.emfplus = 0;
+    arguments.compact = 0;
+    arguments.merge = 0;
+    arguments.svgz = 0;
+
+    argp_parse(&argp, argc, argv, 0, 0, &arguments);
+    if (arguments.paths.empty())
+        arguments.paths.push_back("tests/resources/emf");
+
+    vector<string> files;
+    for (const string &path : arguments.paths)
+        add_files(path, files);
+    if (files.empty()) {
+        cerr << "[ERROR] No EMF file to convert" << endl;
+        return 1;
+    }
+
+    generatorOptions *options =
+        (generatorOptions *)calloc(1, sizeof(generatorOptions));
+    options->svgDelimiter = true;
+    options->emfplus = arguments.emfplus;
+    options->compactPaths = arguments.compact;
+    options->mergePaths = arguments.merge;
+    options->svgz = arguments.svgz;
+
+    vector<result> results;
+    result total = result();
+    for (const string &file : files) {
+        results.push_back(bench_file(file, arguments.iterations, options));
+        add_result(total, results.back());
+    }
+    free(options);
+
+    FILE *f = stdout;
+    if (arguments.output != NULL) {
+        f = fopen(arguments.output, "w");
+        if (f == NULL) {
+            cerr << "[ERROR] "
+                 << "Impossible to open output file '" << arguments.output
+                 << endl;
+            return 1;
+        }
+    }
+    fprintf(f, "{\n  \"version\": ");
+    json_string(f, __STRINGIFY__(E2S_VERSION));
+    fprintf(f, ",\n  \"iterations\": %u,\n  \"files\": [\n",
+            arguments.iterations);
+    for (size_t i = 0; i < results.size(); i++) {
+        fprintf(f, "    {\n      \"file\": ");
+        json_string(f, results[i].file);
+        fprintf(f, ",\n      \"ok\": %s,\n", results[i].ok ? "true" : "false");
+        json_result(f, results[i], "      ");
+        fprintf(f, "    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ],\n  \"total\": {\n    \"files\": %zu,\n"
+               "    \"failed\": %zu,\n",
+            total.files, total.failed);
+    json_result(f, total, "    ");
+    fprintf(f, "  }\n}\n");
+    if (f != stdout)
+        fclose(f);
+
+    return total.failed ? 1 : 0;
+}
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,380 @@
+/* emf2svg-gen
+ * generates large synthetic EMF files (scaling tests) with the libuemf
+ * record builders, the output only depends on the parameters and the seed
+ */
+
+#ifndef DARWIN
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "uemf.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+// needs to be at the end #define in argp.h messing with other includes
+#include <argp.h>
+
+const char *argp_program_version = E2S_VERSION;
+
+const char *argp_program_bug_address =
+    "https://github.com/kakwa/libemf2svg/issues";
+
+static char doc[] =
+    "emf2svg-gen -- synthetic EMF generator for scaling tests\v"
+    "Profiles (COUNT default):\n"
+    "  polyline  COUNT points in POLYLINE16 records of CHUNK points "
+    "(1000000)\n"
+    "  text      COUNT EXTTEXTOUTW records (100000)\n"
+    "  bitmap    COUNT STRETCHDIBITS records of SIZExSIZE px (10000)\n"
+    "  savedc    COUNT SAVEDC/CREATEPEN/SELECTOBJECT/LINETO groups nested "
+    "DEPTH deep, then restored and deleted (100000)\n"
+    "  path      one path of COUNT bezier points in POLYBEZIERTO16 records "
+    "of CHUNK points (300000)";
+
+static struct argp_option options[] = {
+    {"profile", 'P', "PROFILE", 0,
+     "polyline, text, bitmap, savedc or path (default: polyline)"},
+    {"count", 'n', "COUNT", 0, "Size of the profile (see below)"},
+    {"chunk", 'c', "CHUNK", 0, "Points per record (default: 1000)"},
+    {"depth", 'd', "DEPTH", 0, "SAVEDC nesting depth (default: 1000)"},
+    {"size", 'b', "SIZE", 0, "Bitmap width and height in px (default: 16)"},
+    {"seed", 's', "SEED", 0, "Seed of the pseudo random data (default: 1)"},
+    {"output", 'o', "FILE", 0, "Output EMF file"},
+    {0}};
+
+static char args_doc[] = "-o FILE";
+
+enum { POLYLINE, TEXT, BITMAP, SAVEDC, PATH };
+
+static const char *profiles[] = {"polyline", "text", "bitmap", "savedc",
+                                 "path"};
+static const uint32_t default_counts[] = {1000000, 100000, 10000, 100000,
+                                          300000};
+
+struct arguments {
+    int profile;
+    uint32_t count;
+    uint32_t chunk;
+    uint32_t depth;
+    uint32_t size;
+    uint32_t seed;
+    char *output;
+};
+
+static error_t parse_opt(int key, char *arg, struct argp_state *state) {
+    struct arguments *arguments = (struct arguments *)state->input;
+
+    switch (key) {
+    case 'P':
+        arguments->profile = -1;
+        for (int i = 0; i < (int)(sizeof(profiles) / sizeof(profiles[0]));
+             i++) {
+            if (strcmp(arg, profiles[i]) == 0)
+                arguments->profile = i;
+        }
+        if (arguments->profile < 0)
+            argp_error(state, "unknown profile '%s'", arg);
+        break;
+    case 'n':
+        arguments->count = strtoul(arg, NULL, 10);
+        break;
+    case 'c':
+        arguments->chunk = strtoul(arg, NULL, 10);
+        if (arguments->chunk == 0)
+            argp_error(state, "invalid chunk '%s'", arg);
+        break;
+    case 'd':
+        arguments->depth = strtoul(arg, NULL, 10);
+        if (arguments->depth == 0)
+            argp_error(state, "invalid depth '%s'", arg);
+        break;
+    case 'b':
+        arguments->size = strtoul(arg, NULL, 10);
+        if (arguments->size == 0 || arguments->size > 4096)
+            argp_error(state, "invalid size '%s'", arg);
+        break;
+    case 's':
+        arguments->seed = strtoul(arg, NULL, 10);
+        break;
+    case 'o':
+        arguments->output = arg;
+        break;
+    default:
+        return ARGP_ERR_UNKNOWN;
+    }
+    return 0;
+}
+
+static struct argp argp = {options, parse_opt, args_doc, doc};
+
+// A4 landscape at 96 dpi, one logical unit per pixel (MM_TEXT)
+#define GEN_WIDTH_MM 297
+#define GEN_HEIGHT_MM 210
+#define GEN_DPMM 3.7795276f
+#define GEN_WIDTH 1122
+#define GEN_HEIGHT 793
+
+// xorshift32, same sequence on every platform
+static uint32_t rng_state;
+
+static uint32_t rng(void) {
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    return x;
+}
+
+static int32_t rng_range(int32_t max) { return (int32_t)(rng() % max); }
+
+static bool append(char *rec, EMFTRACK *et) {
+    if (rec == NULL)
+        return false;
+    return emf_append((PU_ENHMETARECORD)rec, et, U_REC_FREE) == 0;
+}
+
+// bounded random walk
+static U_POINT16 walk(U_POINT16 pt) {
+    int32_t x = pt.x + rng_range(21) - 10;
+    int32_t y = pt.y + rng_range(21) - 10;
+    x = x < 0 ? 0 : (x >= GEN_WIDTH ? GEN_WIDTH - 1 : x);
+    y = y < 0 ? 0 : (y >= GEN_HEIGHT ? GEN_HEIGHT - 1 : y);
+    return point16_set((int16_t)x, (int16_t)y);
+}
+
+static bool gen_pen(EMFTRACK *et, EMFHANDLES *eht, uint32_t *pen) {
+    U_COLORREF color = colorref_set(rng() & 0xff, rng() & 0xff, rng() & 0xff);
+    U_LOGPEN lp = logpen_set(U_PS_SOLID, point32_set(1, 1), color);
+    return append(createpen_set(pen, eht, lp), et) &&
+           append(selectobject_set(*pen, eht), et);
+}
+
+static bool gen_polyline(EMFTRACK *et, EMFHANDLES *eht,
+                         struct arguments *args) {
+    uint32_t pen = 0;
+    U_POINT16 *points = (U_POINT16 *)malloc(args->chunk * sizeof(U_POINT16));
+    bool ok = points != NULL && gen_pen(et, eht, &pen);
+    U_POINT16 pt = point16_set(GEN_WIDTH / 2, GEN_HEIGHT / 2);
+    for (uint32_t done = 0; ok && done < args->count;) {
+        uint32_t n = args->count - done;
+        n = n > args->chunk ? args->chunk : n;
+        // a polyline needs 2 points
+        n = n < 2 ? 2 : n;
+        for (uint32_t i = 0; i < n; i++) {
+            pt = walk(pt);
+            points[i] = pt;
+        }
+        ok = append(U_EMRPOLYLINE16_set(U_RCL_DEF, n, points), et);
+        done += n;
+    }
+    free(points);
+    return ok;
+}
+
+static bool gen_text(EMFTRACK *et, EMFHANDLES *eht, struct arguments *args) {
+    uint32_t font = 0;
+    uint16_t *name = U_Utf8ToUtf16le("Courier New", 0, NULL);
+    uint16_t *style = U_Utf8ToUtf16le("Normal", 0, NULL);
+    U_LOGFONT lf = logfont_set(-12, 0, 0, 0, U_FW_NORMAL, U_FW_NOITALIC,
+                               U_FW_NOUNDERLINE, U_FW_NOSTRIKEOUT,
+                               U_ANSI_CHARSET, U_OUT_DEFAULT_PRECIS,
+                               U_CLIP_DEFAULT_PRECIS, U_DEFAULT_QUALITY,
+                               U_DEFAULT_PITCH, name);
+    U_LOGFONT_PANOSE elfw = logfont_panose_set(lf, name, style, 0, U_PAN_ALL1);
+    free(name);
+    free(style);
+    bool ok = append(extcreatefontindirectw_set(&font, eht, NULL,
+                                                (char *)&elfw),
+                     et) &&
+              append(selectobject_set(font, eht), et) &&
+              append(U_EMRSETBKMODE_set(U_TRANSPARENT), et);
+    for (uint32_t i = 0; ok && i < args->count; i++) {
+        char text[32];
+        snprintf(text, sizeof(text), "record %u: %08x", i, rng());
+        uint16_t *text16 = U_Utf8ToUtf16le(text, 0, NULL);
+        int len = wchar16len(text16);
+        uint32_t *dx = dx_set(-12, U_FW_NORMAL, len);
+        U_POINTL org = point32_set(rng_range(GEN_WIDTH - 100),
+                                   12 + rng_range(GEN_HEIGHT - 12));
+        char *emrtext =
+            emrtext_set(org, len, 2, text16, U_ETO_NONE, U_RCL_DEF, dx);
+        ok = emrtext != NULL &&
+             append(U_EMREXTTEXTOUTW_set(U_RCL_DEF, U_GM_COMPATIBLE, 1.0, 1.0,
+                                         (PU_EMRTEXT)emrtext),
+                    et);
+        free(emrtext);
+        free(dx);
+        free(text16);
+    }
+    return ok;
+}
+
+static bool gen_bitmap(EMFTRACK *et, EMFHANDLES *eht,
+                       struct arguments *args) {
+    uint32_t size = args->size;
+    char *rgba_px = (char *)malloc((size_t)size * size * 4);
+    bool ok = rgba_px != NULL;
+    for (uint32_t i = 0; ok && i < args->count; i++) {
+        // a gradient with a random tint, no two images are the same
+        uint32_t tint = rng();
+        for (uint32_t p = 0; p < size * size; p++) {
+            char *px = rgba_px + 4 * (size_t)p;
+            px[0] = (char)((p % size) * 255 / size ^ (tint & 0xff));
+            px[1] = (char)((p / size) * 255 / size ^ ((tint >> 8) & 0xff));
+            px[2] = (char)((tint >> 16) & 0xff);
+            px[3] = (char)0xff;
+        }
+        char *px = NULL;
+        uint32_t cbPx = 0;
+        PU_RGBQUAD ct = NULL;
+        int numCt = 0;
+        ok = RGBA_to_DIB(&px, &cbPx, &ct, &numCt, rgba_px, size, size,
+                         size * 4, U_BCBM_COLOR24, U_CT_NO,
+                         U_ROW_ORDER_INVERT) == 0;
+        if (ok) {
+            U_BITMAPINFOHEADER bmih = bitmapinfoheader_set(
+                size, size, 1, U_BCBM_COLOR24, U_BI_RGB, 0, 3780, 3780,
+                numCt, 0);
+            PU_BITMAPINFO bmi = bitmapinfo_set(bmih, ct);
+            U_POINTL dest = point32_set(rng_range(GEN_WIDTH - 32),
+                                        rng_range(GEN_HEIGHT - 32));
+            ok = append(U_EMRSTRETCHDIBITS_set(
+                            U_RCL_DEF, dest, point32_set(32, 32),
+                            point32_set(0, 0), point32_set(size, size),
+                            U_DIB_RGB_COLORS, U_SRCCOPY, bmi, cbPx, px),
+                        et);
+            free(bmi);
+        }
+        free(px);
+        free(ct);
+    }
+    free(rgba_px);
+    (void)eht;
+    return ok;
+}
+
+static bool gen_savedc(EMFTRACK *et, EMFHANDLES *eht,
+                       struct arguments *args) {
+    uint32_t *pens = (uint32_t *)calloc(args->depth, sizeof(uint32_t));
+    bool ok = pens != NULL;
+    U_POINT16 pt = point16_set(GEN_WIDTH / 2, GEN_HEIGHT / 2);
+    ok = ok && append(U_EMRMOVETOEX_set(point32_set(pt.x, pt.y)), et);
+    for (uint32_t done = 0; ok && done < args->count;) {
+        uint32_t depth = args->count - done;
+        depth = depth > args->depth ? args->depth : depth;
+        for (uint32_t i = 0; ok && i < depth; i++) {
+            pt = walk(pt);
+            ok = append(U_EMRSAVEDC_set(), et) && gen_pen(et, eht, &pens[i]) &&
+                 append(U_EMRLINETO_set(point32_set(pt.x, pt.y)), et);
+        }
+        // back to the outer state, the pens can be deleted
+        ok = ok && append(U_EMRRESTOREDC_set(-(int32_t)depth), et) &&
+             append(selectobject_set(U_BLACK_PEN, eht), et);
+        for (uint32_t i = 0; ok && i < depth; i++)
+            ok = append(deleteobject_set(&pens[i], eht), et);
+        done += depth;
+    }
+    free(pens);
+    return ok;
+}
+
+static bool gen_path(EMFTRACK *et, EMFHANDLES *eht, struct arguments *args) {
+    uint32_t pen = 0;
+    // bezier points go by 3
+    uint32_t chunk = args->chunk < 3 ? 3 : args->chunk - args->chunk % 3;
+    U_POINT16 *points = (U_POINT16 *)malloc(chunk * sizeof(U_POINT16));
+    U_POINT16 pt = point16_set(GEN_WIDTH / 2, GEN_HEIGHT / 2);
+    bool ok = points != NULL && gen_pen(et, eht, &pen) &&
+              append(U_EMRBEGINPATH_set(), et) &&
+              append(U_EMRMOVETOEX_set(point32_set(pt.x, pt.y)), et);
+    for (uint32_t done = 0; ok && done < args->count;) {
+        uint32_t n = args->count - done;
+        n = n > chunk ? chunk : n - n % 3;
+        n = n < 3 ? 3 : n;
+        for (uint32_t i = 0; i < n; i++) {
+            pt = walk(pt);
+            points[i] = pt;
+        }
+        ok = append(U_EMRPOLYBEZIERTO16_set(U_RCL_DEF, n, points), et);
+        done += n;
+    }
+    U_RECTL frame = rectl_set(point32_set(0, 0),
+                              point32_set(GEN_WIDTH - 1, GEN_HEIGHT - 1));
+    ok = ok && append(U_EMRCLOSEFIGURE_set(), et) &&
+         append(U_EMRENDPATH_set(), et) &&
+         append(U_EMRSTROKEPATH_set(frame), et);
+    free(points);
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    struct arguments arguments;
+    arguments.profile = POLYLINE;
+    arguments.count = 0;
+    arguments.chunk = 1000;
+    arguments.depth = 1000;
+    arguments.size = 16;
+    arguments.seed = 1;
+    arguments.output = NULL;
+
+    argp_parse(&argp, argc, argv, 0, 0, &arguments);
+
+    if (arguments.output == NULL) {
+        fprintf(stderr, "[ERROR] Missing --output=FILE argument\n");
+        return 1;
+    }
+    if (arguments.count == 0)
+        arguments.count = default_counts[arguments.profile];
+    // xorshift needs a non zero state
+    rng_state = arguments.seed ? arguments.seed : 0x9e3779b9;
+
+    EMFTRACK *et = NULL;
+    EMFHANDLES *eht = NULL;
+    if (emf_start(arguments.output, 1000000, 1000000, &et) ||
+        emf_htable_create(128, 128, &eht)) {
+        fprintf(stderr, "[ERROR] Impossible to open output file '%s'\n",
+                arguments.output);
+        return 1;
+    }
+
+    U_SIZEL szlDev, szlMm;
+    U_RECTL rclBounds, rclFrame;
+    device_size(GEN_WIDTH_MM, GEN_HEIGHT_MM, GEN_DPMM, &szlDev, &szlMm);
+    drawing_size(GEN_WIDTH_MM, GEN_HEIGHT_MM, GEN_DPMM, &rclBounds, &rclFrame);
+    bool ok = append(U_EMRHEADER_set(rclBounds, rclFrame, NULL, 0, NULL,
+                                     szlDev, szlMm, 0),
+                     et) &&
+              append(U_EMRSETMAPMODE_set(U_MM_TEXT), et);
+
+    switch (arguments.profile) {
+    case POLYLINE:
+        ok = ok && gen_polyline(et, eht, &arguments);
+        break;
+    case TEXT:
+        ok = ok && gen_text(et, eht, &arguments);
+        break;
+    case BITMAP:
+        ok = ok && gen_bitmap(et, eht, &arguments);
+        break;
+    case SAVEDC:
+        ok = ok && gen_savedc(et, eht, &arguments);
+        break;
+    case PATH:
+        ok = ok && gen_path(et, eht, &arguments);
+        break;
+    }
+    ok = ok && append(U_EMREOF_set(0, NULL, et), et);
+    ok = ok && emf_finish(et, eht) == 0;
+    emf_free(&et);
+    emf_htable_free(&eht);
+    if (!ok) {
+        fprintf(stderr, "[ERROR] Failed to generate '%s'\n", arguments.output);
+        remove(arguments.output);
+        return 1;
+    }
+    return 0;
+}
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -17,10 +17,14 @@
 // <<<<<<<<<<<<<<<<<<< END ORIGINAL HEADER >>>>>>>>>>>>>>>>>>>>>>>>>>>
 
 #include "emf2svg.h"
+#include <algorithm>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <signal.h>
 #include <sstream>
 #include <string.h>
+#include <vector>
 // needs to be at the end #define in argp.h messing with other includes
 #include <argp.h>
 
@@ -34,16 +38,61 @@ const char *argp_program_version = __STRINGIFY__(E2S_VERSION);
 const char *argp_program_bug_address =
     "https://github.com/kakwa/libemf2svg/issues";
 
-static char doc[] = "emf2svg -- Enhanced Metafile to SVG converter";
+static char doc[] = "emf2svg -- Enhanced Metafile to SVG converter\v"
+                    "Exits with 2 if one of the --max-* budgets is exceeded, 130 if cancelled.";
+
+// keys of the long only options
+enum {
+    OPT_MAX_TIME = 0x100,
+    OPT_MAX_OUTPUT,
+    OPT_MAX_RECORDS,
+    OPT_MAX_PIXELS,
+    OPT_MAX_MEMORY,
+};
 
 static struct argp_option options[] = {
     {"verbose", 'v', 0, 0, "Produce verbose output"},
     {"version", 'V', 0, 0, "Print emf2svg version"},
     {"emfplus", 'p', 0, 0, "Handle EMF+ records"},
     {"input", 'i', "FILE", 0, "Input EMF file"},
+    {"info", 'I', 0, 0,
+     "Print the header information of the input file (no conversion)"},
     {"output", 'o', "FILE", 0, "Output SVG file"},
     {"width", 'w', "WIDTH", 0, "Max width in px"},
     {"height", 'h', "HEIGHT", 0, "Max height in px"},
+    {"svgz", 'z', 0, 0, "Write a gzip compressed svg (svgz)"},
+    {"level", 'l', "LEVEL", 0,
+     "Compression level of --svgz, 1 (fastest) to 9 (smallest)"},
+    {"threads", 'j', "N", 0, "Compress the --svgz output over N threads"},
+    {"jobs", 'J', "N", 0, "Convert ranges of records over N threads"},
+    {"compact", 'C', 0, 0,
+     "Write compact path data (relative coordinates, fewer decimals)"},
+    {"cull", 'c', 0, 0,
+     "Skip records outside of the image or of the clipping rectangle"},
+    {"merge", 'm', 0, 0,
+     "Merge consecutive shapes of the same style in one path element"},
+    {"trace", 'T', "FILE", 0,
+     "Write a trace event per record to FILE (JSON lines, with the decoded "
+     "fields if --verbose)"},
+    {"progress", 'P', 0, 0,
+     "Print the progress of the conversion (Ctrl-C cancels it cleanly)"},
+    {"stats", 'S', 0, 0,
+     "Print statistics by record type (count, bytes, time, output)"},
+    {"simplify", 's', "TOL", 0,
+     "Simplify polylines and polygons (max deviation TOL in px)"},
+    {"roi", 'r', "X,Y,W,H", 0, "Only convert this region of the image (in px)"},
+    {"tiles", 't', "COLSxROWS", 0,
+     "Split the image in tiles (written to FILE-<row>-<col>.svg)"},
+    {"max-time", OPT_MAX_TIME, "SECONDS", 0,
+     "Abort the conversion after SECONDS"},
+    {"max-output", OPT_MAX_OUTPUT, "BYTES", 0,
+     "Abort the conversion after BYTES of svg"},
+    {"max-records", OPT_MAX_RECORDS, "N", 0,
+     "Abort the conversion after N records"},
+    {"max-pixels", OPT_MAX_PIXELS, "N", 0,
+     "Abort the conversion after N decoded pixels"},
+    {"max-memory", OPT_MAX_MEMORY, "BYTES", 0,
+     "Abort the conversion if it uses about BYTES of memory"},
     {0}};
 
 /* A description of the arguments we accept. */
@@ -51,13 +100,32 @@ static char args_doc[] = "-i FILE -o FILE";
 
 struct arguments {
     char *args[2]; /* arg1 & arg2 */
-    bool verbose, emfplus, version;
+    bool verbose, emfplus, version, cull, merge, compact, svgz, stats, progress,
+        info;
     char *output;
     char *input;
+    char *trace;
     int width;
     int height;
+    double roi[4];
+    double simplify;
+    int level;
+    unsigned int threads;
+    unsigned int jobs;
+    unsigned int columns;
+    unsigned int rows;
+    double maxTime;
+    unsigned long long maxOutput, maxRecords, maxPixels, maxMemory;
 };
 
+static unsigned long long parse_max(char *arg, struct argp_state *state) {
+    char *end;
+    unsigned long long value = strtoull(arg, &end, 10);
+    if (*arg == '\0' || *arg == '-' || *end != '\0')
+        argp_error(state, "invalid budget '%s'", arg);
+    return value;
+}
+
 static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     /* Get the input argument from argp_parse, which we
        know is a pointer to our arguments structure. */
@@ -85,6 +153,72 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     case 'V':
         arguments->version = 1;
         break;
+    case 'c':
+        arguments->cull = 1;
+        break;
+    case 'm':
+        arguments->merge = 1;
+        break;
+    case 'C':
+        arguments->compact = 1;
+        break;
+    case 's':
+        arguments->simplify = atof(arg);
+        break;
+    case 'z':
+        arguments->svgz = 1;
+        break;
+    case 'S':
+        arguments->stats = 1;
+        break;
+    case 'T':
+        arguments->trace = arg;
+        break;
+    case 'P':
+        arguments->progress = 1;
+        break;
+    case 'I':
+        arguments->info = 1;
+        break;
+    case 'l':
+        arguments->level = atoi(arg);
+        if (arguments->level < 1 || arguments->level > 9)
+            argp_error(state, "invalid level '%s'", arg);
+        break;
+    case 'j':
+        arguments->threads = atoi(arg);
+        break;
+    case 'J':
+        arguments->jobs = atoi(arg);
+        break;
+    case 'r':
+        if (sscanf(arg, "%lf,%lf,%lf,%lf", &arguments->roi[0],
+                   &arguments->roi[1], &arguments->roi[2],
+                   &arguments->roi[3]) != 4)
+            argp_error(state, "invalid region '%s'", arg);
+        break;
+    case 't':
+        if (sscanf(arg, "%ux%u", &arguments->columns, &arguments->rows) != 2 ||
+            arguments->columns == 0 || arguments->rows == 0)
+            argp_error(state, "invalid tiles '%s'", arg);
+        break;
+    case OPT_MAX_TIME:
+        arguments->maxTime = atof(arg);
+        if (arguments->maxTime <= 0)
+            argp_error(state, "invalid budget '%s'", arg);
+        break;
+    case OPT_MAX_OUTPUT:
+        arguments->maxOutput = parse_max(arg, state);
+        break;
+    case OPT_MAX_RECORDS:
+        arguments->maxRecords = parse_max(arg, state);
+        break;
+    case OPT_MAX_PIXELS:
+        arguments->maxPixels = parse_max(arg, state);
+        break;
+    case OPT_MAX_MEMORY:
+        arguments->maxMemory = parse_max(arg, state);
+        break;
     default:
         return ARGP_ERR_UNKNOWN;
     }
@@ -94,6 +228,215 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
 /* Our argp parser. */
 static struct argp argp = {options, parse_opt, args_doc, doc};
 
+// length of the UTF-8 sequence at s, 0 if invalid
+static size_t utf8_length(const unsigned char *s) {
+    size_t n = s[0] >= 0xF0 ? 4 : s[0] >= 0xE0 ? 3 : s[0] >= 0xC0 ? 2 : 0;
+    if (s[0] > 0xF4 || s[0] == 0xC0 || s[0] == 0xC1)
+        return 0;
+    for (size_t i = 1; i < n; i++) {
+        if ((s[i] & 0xC0) != 0x80)
+            return 0;
+    }
+    return n;
+}
+
+// the decoded fields can hold any byte from the file, invalid UTF-8 is
+// replaced by U+FFFD
+static void json_string(FILE *f, const char *str) {
+    const unsigned char *s = (const unsigned char *)str;
+    fputc('"', f);
+    while (*s) {
+        if (*s == '"' || *s == '\\') {
+            fprintf(f, "\\%c", *s++);
+        } else if (*s < 0x20) {
+            fprintf(f, "\\u%04x", *s++);
+        } else if (*s < 0x80) {
+            fputc(*s++, f);
+        } else {
+            size_t n = utf8_length(s);
+            if (n) {
+                fwrite(s, 1, n, f);
+                s += n;
+            } else {
+                fputs("\\ufffd", f);
+                s++;
+            }
+        }
+    }
+    fputc('"', f);
+}
+
+static const char *trace_status[] = {"unknown", "supported", "partial",
+                                     "ignored", "unused",    "culled",
+                                     "error"};
+
+// --trace, one JSON object per record
+static void trace_json(const generatorTraceEvent *event, void *ctx) {
+    FILE *f = (FILE *)ctx;
+    fprintf(f, "{\"index\":%zu,\"type\":%u,\"name\":", event->index,
+            (unsigned int)event->type);
+    json_string(f, event->name ? event->name : "");
+    fprintf(f, ",\"offset\":%zu,\"size\":%u,\"status\":\"%s\"",
+            event->offset, (unsigned int)event->size,
+            trace_status[event->status]);
+    if (event->message) {
+        fputs(",\"message\":", f);
+        json_string(f, event->message);
+    }
+    if (event->fieldCount) {
+        // names can repeat, kept as [name, value] pairs
+        fputs(",\"fields\":[", f);
+        for (size_t i = 0; i < event->fieldCount; i++) {
+            fputs(i ? ",[" : "[", f);
+            json_string(f, event->fields[i].name);
+            fputc(',', f);
+            json_string(f, event->fields[i].value);
+            fputc(']', f);
+        }
+        fputc(']', f);
+    }
+    fputs("}\n", f);
+}
+
+static void free_options(generatorOptions *options) {
+    if (options->traceCtx)
+        fclose((FILE *)options->traceCtx);
+    free(options->stats);
+    free(options);
+}
+
+static const char *budget_names[] = {"none",   "time",   "output",
+                                     "records", "pixels", "memory"};
+
+// set on SIGINT with --progress, the conversion is then cancelled
+static volatile sig_atomic_t interrupted = 0;
+
+static void on_interrupt(int sig) {
+    (void)sig;
+    interrupted = 1;
+}
+
+// --progress, percentage of the EMF converted
+static bool print_progress(size_t offset, size_t length, size_t records,
+                           void *ctx) {
+    (void)ctx;
+    std::cerr << "\r" << (length ? offset * 100 / length : 100) << "% ("
+              << records << " records)" << std::flush;
+    return interrupted != 0;
+}
+
+// --info reads the beginning of the file only (header and first comment)
+#define INFO_READ 65536
+
+static int print_info(const char *input) {
+    std::ifstream in(input, ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "[ERROR] "
+                  << "Impossible to open input file '" << input << std::endl;
+        return 1;
+    }
+    in.seekg(0, std::ios::end);
+    size_t size = in.tellg();
+    in.seekg(0, std::ios::beg);
+    std::vector<char> head(std::min<size_t>(size, INFO_READ));
+    in.read(head.data(), head.size());
+    in.close();
+
+    generatorProbe probe;
+    if (!emf2svg_probe(head.data(), head.size(), &probe)) {
+        std::cerr << "[ERROR] "
+                  << "Not an EMF file '" << input << std::endl;
+        return 1;
+    }
+    std::cout << "bounds: " << probe.bounds.left << "," << probe.bounds.top
+              << "," << probe.bounds.right << "," << probe.bounds.bottom
+              << std::endl;
+    std::cout << "frame: " << probe.frame.left << "," << probe.frame.top << ","
+              << probe.frame.right << "," << probe.frame.bottom << std::endl;
+    std::cout << "device: " << probe.device.cx << "x" << probe.device.cy
+              << std::endl;
+    std::cout << "millimeters: " << probe.millimeters.cx << "x"
+              << probe.millimeters.cy << std::endl;
+    std::cout << "records: " << probe.records << std::endl;
+    std::cout << "handles: " << probe.handles << std::endl;
+    std::cout << "bytes: " << probe.bytes << std::endl;
+    std::cout << "file size: " << size << std::endl;
+    std::cout << "application: " << probe.application << std::endl;
+    std::cout << "title: " << probe.title << std::endl;
+    std::cout << "emf+: "
+              << (probe.emfplus ? (probe.emfplusDual ? "dual" : "yes") : "no")
+              << std::endl;
+    return 0;
+}
+
+// exit code: 0 on success, 2 if a budget was exceeded, 130 if cancelled,
+// 1 otherwise
+static int exit_code(int ret, generatorOptions *options) {
+    if (ret)
+        return 0;
+    if (options->cancelled) {
+        std::cerr << "[ERROR] Conversion cancelled" << std::endl;
+        return 130;
+    }
+    if (options->budgetExceeded != EMF2SVG_BUDGET_NONE) {
+        std::cerr << "[ERROR] "
+                  << "Budget exceeded: " << budget_names[options->budgetExceeded]
+                  << std::endl;
+        return 2;
+    }
+    return 1;
+}
+
+// -J ignored by the library (see generatorOptions.drawThreads)
+static void warn_jobs(unsigned int jobs, generatorOptions *options) {
+    if (jobs > 1 && options->drawRanges < 2)
+        std::cerr << "[WARNING] "
+                  << "Converted in a single thread (-J is ignored with -p, "
+                     "-m, -v, -T, -P, -S, -t, --max-memory and with too few "
+                     "records)"
+                  << std::endl;
+}
+
+// table of the record types, slowest first
+static void print_stats(generatorStats *stats) {
+    std::vector<unsigned int> types;
+    generatorRecordStats total = generatorRecordStats();
+    for (unsigned int i = 0; i < EMF2SVG_RECORD_TYPES; i++) {
+        generatorRecordStats *rs = &stats->records[i];
+        if (rs->count == 0)
+            continue;
+        types.push_back(i);
+        total.count += rs->count;
+        total.bytes += rs->bytes;
+        total.time += rs->time;
+        total.output += rs->output;
+    }
+    std::sort(types.begin(), types.end(), [stats](unsigned int a,
+                                                  unsigned int b) {
+        return stats->records[a].time > stats->records[b].time;
+    });
+    std::cerr << std::left << std::setw(30) << "record" << std::right
+              << std::setw(10) << "count" << std::setw(14) << "bytes"
+              << std::setw(12) << "time (ms)" << std::setw(14) << "output"
+              << std::endl;
+    std::cerr << std::fixed << std::setprecision(3);
+    for (unsigned int i : types) {
+        generatorRecordStats *rs = &stats->records[i];
+        std::cerr << std::left << std::setw(30) << emf2svg_record_name(i)
+                  << std::right << std::setw(10) << rs->count
+                  << std::setw(14) << rs->bytes << std::setw(12)
+                  << rs->time * 1000 << std::setw(14) << rs->output
+                  << std::endl;
+    }
+    std::cerr << std::left << std::setw(30) << "total" << std::right
+              << std::setw(10) << total.count << std::setw(14) << total.bytes
+              << std::setw(12) << total.time * 1000 << std::setw(14)
+              << total.output << std::endl;
+    std::cerr << "buffer allocations: " << stats->bufferAllocations
+              << ", font lookups: " << stats->fontLookups
+              << ", image encodes: " << stats->imageEncodes << std::endl;
+}
+
 int main(int argc, char *argv[]) {
     struct arguments arguments;
     arguments.width = 0;
@@ -103,6 +446,27 @@ int main(int argc, char *argv[]) {
     arguments.input = NULL;
     arguments.output = NULL;
     arguments.emfplus = 0;
+    arguments.cull = 0;
+    arguments.merge = 0;
+    arguments.compact = 0;
+    arguments.simplify = 0;
+    arguments.svgz = 0;
+    arguments.stats = 0;
+    arguments.trace = NULL;
+    arguments.progress = 0;
+    arguments.info = 0;
+    arguments.maxTime = 0;
+    arguments.maxOutput = 0;
+    arguments.maxRecords = 0;
+    arguments.maxPixels = 0;
+    arguments.maxMemory = 0;
+    arguments.level = 0;
+    arguments.threads = 0;
+    arguments.jobs = 0;
+    arguments.roi[0] = arguments.roi[1] = 0;
+    arguments.roi[2] = arguments.roi[3] = 0;
+    arguments.columns = 0;
+    arguments.rows = 0;
 
     argp_parse(&argp, argc, argv, 0, 0, &arguments);
 
@@ -120,6 +484,9 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
+    if (arguments.info)
+        return print_info(arguments.input);
+
     if (arguments.output == NULL) {
         std::cerr << "[ERROR] "
                   << "Missing --output=FILE argument"
@@ -160,8 +527,122 @@ int main(int argc, char *argv[]) {
     options->svgDelimiter = true;
     options->imgWidth = arguments.width;
     options->imgHeight = arguments.height;
+    options->culling = arguments.cull;
+    options->mergePaths = arguments.merge;
+    options->simplifyTolerance = arguments.simplify;
+    options->compactPaths = arguments.compact;
+    options->svgz = arguments.svgz;
+    options->svgzLevel = arguments.level;
+    options->svgzThreads = arguments.threads;
+    options->drawThreads = arguments.jobs;
+    if (arguments.stats)
+        options->stats = (generatorStats *)calloc(1, sizeof(generatorStats));
+    if (arguments.trace) {
+        FILE *trace = fopen(arguments.trace, "w");
+        if (trace == NULL) {
+            std::cerr << "[ERROR] "
+                << "Impossible to open trace file '" << arguments.trace
+                << std::endl;
+            delete[] contents;
+            free_options(options);
+            return 1;
+        }
+        options->trace = trace_json;
+        options->traceCtx = trace;
+        options->traceFields = arguments.verbose;
+    }
+    if (arguments.progress) {
+        options->progress = print_progress;
+        signal(SIGINT, on_interrupt);
+    }
+    options->maxTime = arguments.maxTime;
+    options->maxOutput = arguments.maxOutput;
+    options->maxRecords = arguments.maxRecords;
+    options->maxImagePixels = arguments.maxPixels;
+    options->maxMemory = arguments.maxMemory;
+    options->roiX = arguments.roi[0];
+    options->roiY = arguments.roi[1];
+    options->roiWidth = arguments.roi[2];
+    options->roiHeight = arguments.roi[3];
+    if (arguments.columns) {
+        unsigned int count = arguments.columns * arguments.rows;
+        char **tiles = (char **)calloc(count, sizeof(char *));
+        size_t *tiles_len = (size_t *)calloc(count, sizeof(size_t));
+        int ret = emf2svg_tiles(contents, size, arguments.columns,
+                                arguments.rows, tiles, tiles_len, options);
+        if (arguments.progress)
+            std::cerr << std::endl;
+        warn_jobs(arguments.jobs, options);
+        std::string base(arguments.output);
+        if (base.size() > 4 && base.compare(base.size() - 4, 4, ".svg") == 0)
+            base.resize(base.size() - 4);
+        for (unsigned int i = 0; i < count && ret > 0; i++) {
+            std::ostringstream name;
+            name << base << "-" << i / arguments.columns << "-"
+                 << i % arguments.columns << ".svg";
+            std::ofstream out(name.str());
+            if (!out.is_open()) {
+                std::cerr << "[ERROR] "
+                    << "Impossible to open output file '" << name.str()
+                    << std::endl;
+                ret = 0;
+                break;
+            }
+            out << std::string(tiles[i]);
+            out.close();
+        }
+        if (options->stats)
+            print_stats(options->stats);
+        for (unsigned int i = 0; i < count; i++)
+            free(tiles[i]);
+        free(tiles);
+        free(tiles_len);
+        delete[] contents;
+        int code = exit_code(ret, options);
+        free_options(options);
+        return code;
+    }
+    if (arguments.svgz) {
+        // compressed while converting, straight to the file
+        FILE *out = fopen(arguments.output, "wb");
+        if (out == NULL) {
+            std::cerr << "[ERROR] "
+                << "Impossible to open output file '" << arguments.output
+                << std::endl;
+            delete[] contents;
+            free_options(options);
+            return 1;
+        }
+        int ret = emf2svg_file(contents, size, out, options);
+        if (arguments.progress)
+            std::cerr << std::endl;
+        warn_jobs(arguments.jobs, options);
+        if (fclose(out) != 0)
+            ret = 0;
+        if (ret <= 0)
+            remove(arguments.output);
+        if (arguments.cull) {
+            std::cerr << "culled records: " << options->culledRecords
+                      << std::endl;
+        }
+        if (options->stats)
+            print_stats(options->stats);
+        delete[] contents;
+        int code = exit_code(ret, options);
+        free_options(options);
+        return code;
+    }
     int ret = emf2svg(contents, size, &svg_out, &svg_len, options);
-    if (ret != 0) {
+    if (arguments.progress)
+        std::cerr << std::endl;
+    warn_jobs(arguments.jobs, options);
+    if (arguments.cull) {
+        std::cerr << "culled records: " << options->culledRecords
+                  << std::endl;
+    }
+    if (options->stats)
+        print_stats(options->stats);
+    if (ret > 0) {
         std::ofstream out(arguments.output);
         if (!out.is_open()) {
             std::cerr << "[ERROR] "
@@ -169,7 +650,7 @@ int main(int argc, char *argv[]) {
                 << std::endl;
             delete[] contents;
             free(svg_out);
-            free(options);
+            free_options(options);
             return 1;
         }
         out << std::string(svg_out);
@@ -177,8 +658,9 @@ int main(int argc, char *argv[]) {
     }
     delete[] contents;
     free(svg_out);
-    free(options);
+    int code = exit_code(ret, options);
+    free_options(options);
 
-    return (ret==0)?1:0;
+    return code;
 }
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -8,10 +8,11 @@ extern "C" {
 #include "emf2svg.h"
 #include "emf2svg_private.h"
 #include "emf2svg_print.h"
+#include "upmf.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <internal-fmem.h>
+#include <limits.h>
 
 int U_emf_onerec_is_emfp(const char *contents, const char *blimit, int recnum,
                          size_t off, bool *ret) {
@@ -40,241 +41,78 @@ int U_emf_onerec_is_emfp(const char *contents, const char *blimit, int recnum,
     return (size);
 }
 
-int U_emf_onerec_analyse(const char *contents, const char *blimit, int recnum,
-                         size_t off, drawingStates *states) {
-    PU_ENHMETARECORD lpEMFR = (PU_ENHMETARECORD)(contents + off);
-    unsigned int size;
+// records whose drawing function does nothing but the verbose output,
+// skipped without going through the switch when not in verbose mode
+// (unknown record types are skipped as well)
+static const bool emf_noop_records[U_EMR_MAX + 1] = {
+    [U_EMR_SETBRUSHORGEX] = true,        [U_EMR_SETMAPPERFLAGS] = true,
+    [U_EMR_SETROP2] = true,              [U_EMR_SETCOLORADJUSTMENT] = true,
+    [U_EMR_SETMETARGN] = true,           [U_EMR_SCALEVIEWPORTEXTEX] = true,
+    [U_EMR_SCALEWINDOWEXTEX] = true,     [U_EMR_SELECTPALETTE] = true,
+    [U_EMR_CREATEPALETTE] = true,        [U_EMR_SETPALETTEENTRIES] = true,
+    [U_EMR_RESIZEPALETTE] = true,        [U_EMR_REALIZEPALETTE] = true,
+    [U_EMR_EXTFLOODFILL] = true,         [U_EMR_POLYDRAW] = true,
+    [U_EMR_FILLPATH] = true,             [U_EMR_STROKEANDFILLPATH] = true,
+    [U_EMR_STROKEPATH] = true,           [U_EMR_FLATTENPATH] = true,
+    [U_EMR_WIDENPATH] = true,            [U_EMR_UNDEF69] = true,
+    [U_EMR_FILLRGN] = true,              [U_EMR_FRAMERGN] = true,
+    [U_EMR_INVERTRGN] = true,            [U_EMR_PAINTRGN] = true,
+    [U_EMR_MASKBLT] = true,              [U_EMR_PLGBLT] = true,
+    [U_EMR_SETDIBITSTODEVICE] = true,    [U_EMR_POLYDRAW16] = true,
+    [U_EMR_POLYTEXTOUTA] = true,         [U_EMR_POLYTEXTOUTW] = true,
+    [U_EMR_SETICMMODE] = true,           [U_EMR_CREATECOLORSPACE] = true,
+    [U_EMR_SETCOLORSPACE] = true,        [U_EMR_DELETECOLORSPACE] = true,
+    [U_EMR_GLSRECORD] = true,            [U_EMR_GLSBOUNDEDRECORD] = true,
+    [U_EMR_PIXELFORMAT] = true,          [U_EMR_DRAWESCAPE] = true,
+    [U_EMR_EXTESCAPE] = true,            [U_EMR_UNDEF107] = true,
+    [U_EMR_FORCEUFIMAPPING] = true,      [U_EMR_NAMEDESCAPE] = true,
+    [U_EMR_COLORCORRECTPALETTE] = true,  [U_EMR_SETICMPROFILEA] = true,
+    [U_EMR_SETICMPROFILEW] = true,       [U_EMR_TRANSPARENTBLT] = true,
+    [U_EMR_UNDEF117] = true,             [U_EMR_SETLINKEDUFIS] = true,
+    [U_EMR_SETTEXTJUSTIFICATION] = true, [U_EMR_COLORMATCHTOTARGETW] = true,
+    [U_EMR_CREATECOLORSPACEW] = true,
+};
 
-    size = lpEMFR->nSize;
-    contents += off;
+#define emf_noop_record(iType)                                                 \
+    ((iType) > U_EMR_MAX || emf_noop_records[(iType)])
 
-    /* Check that the record size is OK, abort if not.
-       Pointer math might wrap, so check both sides of the range */
-    if (size < sizeof(U_EMR) || contents + size - 1 >= blimit ||
-        contents + size - 1 < contents)
-        return (-1);
+// records added to the pending compound path (mergePaths), or only changing
+// states it does not depend on: the path is not written before them
+static const bool emf_path_run_records[U_EMR_MAX + 1] = {
+    [U_EMR_POLYGON] = true,         [U_EMR_POLYLINE] = true,
+    [U_EMR_POLYPOLYLINE] = true,    [U_EMR_POLYPOLYGON] = true,
+    [U_EMR_POLYGON16] = true,       [U_EMR_POLYLINE16] = true,
+    [U_EMR_POLYPOLYLINE16] = true,  [U_EMR_POLYPOLYGON16] = true,
+    [U_EMR_RECTANGLE] = true,       [U_EMR_LINETO] = true,
+    [U_EMR_SELECTOBJECT] = true,    [U_EMR_CREATEPEN] = true,
+    [U_EMR_EXTCREATEPEN] = true,    [U_EMR_DELETEOBJECT] = true,
+    [U_EMR_MOVETOEX] = true,        [U_EMR_SETBKMODE] = true,
+    [U_EMR_SETBKCOLOR] = true,      [U_EMR_SETTEXTCOLOR] = true,
+    [U_EMR_SETTEXTALIGN] = true,    [U_EMR_SETPOLYFILLMODE] = true,
+    [U_EMR_SETMITERLIMIT] = true,   [U_EMR_SETARCDIRECTION] = true,
+    [U_EMR_CREATEBRUSHINDIRECT] = true,
+    [U_EMR_EXTCREATEFONTINDIRECTW] = true,
+    [U_EMR_SETSTRETCHBLTMODE] = true,
+};
+
+#define emf_path_run_record(iType)                                             \
+    ((iType) <= U_EMR_MAX && emf_path_run_records[(iType)])
 
-    switch (lpEMFR->iType) {
-    case U_EMR_HEADER:
-        break;
-    case U_EMR_POLYBEZIER:
-    case U_EMR_POLYGON:
-    case U_EMR_POLYLINE:
-    case U_EMR_POLYBEZIERTO:
-    case U_EMR_POLYLINETO:
-    case U_EMR_POLYPOLYLINE:
-    case U_EMR_POLYPOLYGON:
-    case U_EMR_SETWINDOWEXTEX:
-    case U_EMR_LINETO:
-    case U_EMR_ARCTO:
-    case U_EMR_POLYDRAW:
-    case U_EMR_POLYBEZIER16:
-    case U_EMR_POLYGON16:
-    case U_EMR_POLYLINE16:
-    case U_EMR_POLYBEZIERTO16:
-    case U_EMR_POLYLINETO16:
-    case U_EMR_POLYPOLYLINE16:
-    case U_EMR_POLYPOLYGON16:
-    case U_EMR_POLYDRAW16:
-        if (states->inPath) {
-            states->pathDrawn = true;
-        }
-        break;
-    case U_EMR_EOF:
-        size = 0;
-        break;
-    case U_EMR_BEGINPATH:
-        newPathStruct(states);
-        states->inPath = true;
-        break;
-    case U_EMR_ENDPATH:
-        states->inPath = false;
-        states->pathDrawn = false;
-        break;
-    case U_EMR_FILLPATH:
-        if (states->emfStructure.pathStackLast != NULL) {
-            states->emfStructure.pathStackLast->pathStruct.fillOffset = off;
-        }
-        break;
-    case U_EMR_STROKEANDFILLPATH:
-        if (states->emfStructure.pathStackLast != NULL) {
-            states->emfStructure.pathStackLast->pathStruct.strokeFillOffset =
-                off;
-        }
-        break;
-    case U_EMR_STROKEPATH:
-        if (states->emfStructure.pathStackLast != NULL) {
-            states->emfStructure.pathStackLast->pathStruct.strokeOffset = off;
-        }
-        break;
-    case U_EMR_FLATTENPATH:
-        if (states->emfStructure.pathStackLast != NULL) {
-            states->emfStructure.pathStackLast->pathStruct.flattenOffset = off;
-        }
-        break;
-    case U_EMR_WIDENPATH:
-        if (states->emfStructure.pathStackLast != NULL) {
-            states->emfStructure.pathStackLast->pathStruct.widdenOffset = off;
-        }
-        break;
-    case U_EMR_SELECTCLIPPATH:
-        if (states->emfStructure.pathStackLast != NULL) {
-            states->emfStructure.pathStackLast->pathStruct.clipOffset = off;
-        }
-        break;
-    case U_EMR_ABORTPATH:
-        if (states->emfStructure.pathStackLast != NULL) {
-            states->emfStructure.pathStackLast->pathStruct.abortOffset = off;
-        }
-        break;
-    case U_EMR_SETWORLDTRANSFORM:
-        if (states->inPath) {
-            PU_EMRSETWORLDTRANSFORM pEmr = (PU_EMRSETWORLDTRANSFORM)(contents);
-            states->currentDeviceContext.worldTransform = pEmr->xform;
-            if (states->pathDrawn) {
-                states->emfStructure.pathStackLast->pathStruct.wtBeforeSet =
-                    true;
-                states->emfStructure.pathStackLast->pathStruct.wtBeforeiMode =
-                    0;
-                states->emfStructure.pathStackLast->pathStruct.wtBeforexForm =
-                    pEmr->xform;
-            } else {
-                states->emfStructure.pathStackLast->pathStruct.wtAfterSet =
-                    true;
-                states->emfStructure.pathStackLast->pathStruct.wtAfteriMode = 0;
-                states->emfStructure.pathStackLast->pathStruct.wtAfterxForm =
-                    pEmr->xform;
-            }
-        }
-        break;
-    case U_EMR_MODIFYWORLDTRANSFORM:
-        if (states->inPath) {
-            PU_EMRMODIFYWORLDTRANSFORM pEmr =
-                (PU_EMRMODIFYWORLDTRANSFORM)(contents);
-            states->currentDeviceContext.worldTransform = pEmr->xform;
-            if (states->pathDrawn) {
-                states->emfStructure.pathStackLast->pathStruct.wtBeforeSet =
-                    true;
-                states->emfStructure.pathStackLast->pathStruct.wtBeforeiMode =
-                    pEmr->iMode;
-                states->emfStructure.pathStackLast->pathStruct.wtBeforexForm =
-                    pEmr->xform;
-            } else {
-                states->emfStructure.pathStackLast->pathStruct.wtAfterSet =
-                    true;
-                states->emfStructure.pathStackLast->pathStruct.wtAfteriMode =
-                    pEmr->iMode;
-                states->emfStructure.pathStackLast->pathStruct.wtAfterxForm =
-                    pEmr->xform;
-            }
-        }
-        break;
-    case U_EMR_SETWINDOWORGEX:
-    case U_EMR_SETVIEWPORTEXTEX:
-    case U_EMR_SETVIEWPORTORGEX:
-    case U_EMR_SETBRUSHORGEX:
-    case U_EMR_SETPIXELV:
-    case U_EMR_SETMAPPERFLAGS:
-    case U_EMR_SETMAPMODE:
-    case U_EMR_SETBKMODE:
-    case U_EMR_SETPOLYFILLMODE:
-    case U_EMR_SETROP2:
-    case U_EMR_SETSTRETCHBLTMODE:
-    case U_EMR_SETTEXTALIGN:
-    case U_EMR_SETCOLORADJUSTMENT:
-    case U_EMR_SETTEXTCOLOR:
-    case U_EMR_SETBKCOLOR:
-    case U_EMR_OFFSETCLIPRGN:
-    case U_EMR_MOVETOEX:
-    case U_EMR_SETMETARGN:
-    case U_EMR_EXCLUDECLIPRECT:
-    case U_EMR_INTERSECTCLIPRECT:
-    case U_EMR_SCALEVIEWPORTEXTEX:
-    case U_EMR_SCALEWINDOWEXTEX:
-    case U_EMR_SAVEDC:
-    case U_EMR_RESTOREDC:
-    case U_EMR_SELECTOBJECT:
-    case U_EMR_CREATEPEN:
-    case U_EMR_CREATEBRUSHINDIRECT:
-    case U_EMR_DELETEOBJECT:
-    case U_EMR_ANGLEARC:
-    case U_EMR_ELLIPSE:
-    case U_EMR_RECTANGLE:
-    case U_EMR_ROUNDRECT:
-    case U_EMR_ARC:
-    case U_EMR_CHORD:
-    case U_EMR_PIE:
-    case U_EMR_SELECTPALETTE:
-    case U_EMR_CREATEPALETTE:
-    case U_EMR_SETPALETTEENTRIES:
-    case U_EMR_RESIZEPALETTE:
-    case U_EMR_REALIZEPALETTE:
-    case U_EMR_EXTFLOODFILL:
-    case U_EMR_SETARCDIRECTION:
-    case U_EMR_SETMITERLIMIT:
-    case U_EMR_CLOSEFIGURE:
-    case U_EMR_COMMENT:
-    case U_EMR_FILLRGN:
-    case U_EMR_FRAMERGN:
-    case U_EMR_INVERTRGN:
-    case U_EMR_PAINTRGN:
-    case U_EMR_EXTSELECTCLIPRGN:
-    case U_EMR_BITBLT:
-    case U_EMR_STRETCHBLT:
-    case U_EMR_MASKBLT:
-    case U_EMR_PLGBLT:
-    case U_EMR_SETDIBITSTODEVICE:
-    case U_EMR_STRETCHDIBITS:
-    case U_EMR_EXTCREATEFONTINDIRECTW:
-    case U_EMR_EXTTEXTOUTA:
-    case U_EMR_EXTTEXTOUTW:
-    case U_EMR_CREATEMONOBRUSH:
-    case U_EMR_CREATEDIBPATTERNBRUSHPT:
-    case U_EMR_EXTCREATEPEN:
-    // case U_EMR_POLYTEXTOUTA:            break;
-    // case U_EMR_POLYTEXTOUTW:            break;
-    case U_EMR_SETICMMODE:
-    case U_EMR_CREATECOLORSPACE:
-    case U_EMR_SETCOLORSPACE:
-    case U_EMR_DELETECOLORSPACE:
-    // case U_EMR_GLSRECORD:               break;
-    // case U_EMR_GLSBOUNDEDRECORD:        break;
-    case U_EMR_PIXELFORMAT:
-    // case U_EMR_DRAWESCAPE:              break;
-    // case U_EMR_EXTESCAPE:               break;
-    // case U_EMR_UNDEF107:                break;
-    case U_EMR_SMALLTEXTOUT:
-    // case U_EMR_FORCEUFIMAPPING:         break;
-    // case U_EMR_NAMEDESCAPE:             break;
-    // case U_EMR_COLORCORRECTPALETTE:     break;
-    // case U_EMR_SETICMPROFILEA:          break;
-    // case U_EMR_SETICMPROFILEW:          break;
-    case U_EMR_ALPHABLEND:
-    case U_EMR_SETLAYOUT:
-    case U_EMR_TRANSPARENTBLT:
-    // case U_EMR_UNDEF117:                break;
-    case U_EMR_GRADIENTFILL:
-    // case U_EMR_SETLINKEDUFIS:           break;
-    // case U_EMR_SETTEXTJUSTIFICATION:    break;
-    // case U_EMR_COLORMATCHTOTARGETW:     break;
-    case U_EMR_CREATECOLORSPACEW:
-    default:
-        // nothing to do for those records
-        break;
-        // case U_EMR_UNDEF69:                 break;
-    } // end of switch
-    return (size);
-}
 int U_emf_onerec_draw(const char *contents, const char *blimit, int recnum,
-                      size_t off, FILE *out, drawingStates *states) {
+                      size_t off, svgWriter *out, drawingStates *states) {
     PU_ENHMETARECORD lpEMFR = (PU_ENHMETARECORD)(contents + off);
     unsigned int size;
-    if (states->verbose) {
+    states->idRecord = (uint32_t)recnum;
+    states->idIndex = 0;
+    // the trace event carries the record header
+    if (isVerbose(states) && states->trace.callback == NULL) {
         U_emf_onerec_print(contents, blimit, recnum, off, states);
     }
 #ifdef RECORD_INDEX
     if (recnum && !states->inPath) {
-        fprintf(out, "<!-- begin record: %d -->\n", recnum);
+        svg_append_literal(out, "<!-- begin record: ");
+        svg_append_int(out, recnum);
+        svg_append_literal(out, " -->\n");
     }
 #endif /* RECORD_INDEX */
     size = lpEMFR->nSize;
@@ -286,6 +124,42 @@ int U_emf_onerec_draw(const char *contents, const char *blimit, int recnum,
         contents + size - 1 < contents)
         return (-1);
 
+#ifndef RECORD_INDEX
+    // nothing to draw, nor any state to update (but a status to trace)
+    if (!isVerbose(states) && states->trace.callback == NULL &&
+        emf_noop_record(lpEMFR->iType))
+        return (size);
+#endif /* RECORD_INDEX */
+
+    // the pending EMR_SETPIXELV pixels are drawn before the next record
+    // changing the output or the states
+    if (states->pixelRun.count && lpEMFR->iType != U_EMR_SETPIXELV &&
+        !emf_noop_record(lpEMFR->iType)) {
+        if (states->tiles)
+            tiles_record_all(states);
+        pixel_run_flush(states, out);
+        if (states->tiles)
+            tiles_record_end(states, out);
+    }
+    if (states->pathRun.count && !emf_path_run_record(lpEMFR->iType) &&
+        !emf_noop_record(lpEMFR->iType))
+        path_run_flush(states, out);
+
+    // record drawn outside of the visible area
+    if (states->culling && cull_record(states, contents)) {
+        states->culledRecords++;
+        states->trace.status = EMF2SVG_TRACE_CULLED;
+        return (size);
+    }
+
+    // snapshot pass of a parallel conversion, only the states are needed
+    if (states->replay && states->replay[recnum] && !states->inPath &&
+        parallel_skip(states, contents, out))
+        return (size);
+
+    if (states->tiles)
+        tiles_record_start(states, contents);
+
     switch (lpEMFR->iType) {
     case U_EMR_HEADER:
         U_EMRHEADER_draw(contents, out, states);
@@ -641,36 +515,76 @@ int U_emf_onerec_draw(const char *contents, const char *blimit, int recnum,
         U_EMRNOTIMPLEMENTED_draw("?", contents, out, states);
         break;
     } // end of switch
+
+    if (states->tiles)
+        tiles_record_end(states, out);
     return (size);
 }
 
-int emf2svg(char *contents, size_t length, char ** fm_out, size_t * fm_out_length,
-            generatorOptions *options) {
-    size_t off = 0;
-    size_t result;
-    int OK = 1;
-    int recnum = 0;
-    PU_ENHMETARECORD pEmr;
-    char *blimit;
-    FILE *stream;
-    fmem fm;
-    fmem_init(&fm);
-    *fm_out = NULL;
-    *fm_out_length = 0;
-
-#if U_BYTE_SWAP
-    // This is a Big Endian machine, EMF data is Little Endian
-    U_emf_endian(contents, length, 0); // LE to BE
-#endif
+// draw a record, accounted in states->stats
+static int emf_onerec_draw_stats(const char *contents, const char *blimit,
+                                 int recnum, size_t off, svgWriter *out,
+                                 drawingStates *states) {
+    PU_ENHMETARECORD pEmr = (PU_ENHMETARECORD)(contents + off);
+    uint32_t iType = pEmr->iType;
+    uint32_t nSize = pEmr->nSize;
+    size_t written = out->written + out->len;
+    double start = e2s_clock();
+    int result = U_emf_onerec_draw(contents, blimit, recnum, off, out, states);
+    generatorRecordStats *rs =
+        &(states->stats->records[iType < EMF2SVG_RECORD_TYPES ? iType : 0]);
+    rs->time += e2s_clock() - start;
+    rs->count++;
+    rs->bytes += nSize;
+    // the tiles empty out after each record
+    if (states->tiles == NULL && out->written + out->len > written)
+        rs->output += out->written + out->len - written;
+    return result;
+}
 
+drawingStates *states_new(char *contents, size_t length, emfTiles *tiles,
+                          generatorOptions *options) {
     drawingStates *states = (drawingStates *)calloc(1, sizeof(drawingStates));
+    if (states == NULL)
+        return NULL;
     states->fixBrokenYTransform = false;
     states->verbose = options->verbose;
+    budget_init(states, options);
+    if (options->trace) {
+        // the verbose output goes to the trace events
+        states->trace.callback = options->trace;
+        states->trace.ctx = options->traceCtx;
+        states->verbose = options->traceFields;
+        if (states->verbose)
+            svg_writer_init(&(states->trace.text), NULL, NULL, NULL);
+    }
     states->viewPortExSet = false;
     states->windowExSet = false;
     states->emfplus = options->emfplus;
     states->imgWidth = options->imgWidth;
     states->imgHeight = options->imgHeight;
+    states->flatteningTolerance = options->flatteningTolerance;
+    states->culling = options->culling;
+    // records are dispatched one by one to the tiles
+    states->mergePaths = options->mergePaths && tiles == NULL;
+    states->simplifyTolerance = options->simplifyTolerance;
+    states->compactPaths = options->compactPaths;
+    states->timing = options->timings != NULL;
+    states->stats = options->stats;
+    if (states->stats)
+        memset(states->stats, 0, sizeof(generatorStats));
+    states->maxObjects =
+        options->maxObjects ? options->maxObjects : OBJECT_TABLE_MAX;
+    if (options->svgDelimiter && options->roiWidth > 0 &&
+        options->roiHeight > 0) {
+        states->roi.left = options->roiX;
+        states->roi.top = options->roiY;
+        states->roi.right = options->roiX + options->roiWidth;
+        states->roi.bottom = options->roiY + options->roiHeight;
+        states->roiSet = true;
+        states->culling = true;
+    }
+    states->tiles = tiles;
     states->endAddress = (intptr_t)contents + (intptr_t)length;
     if ((options->nameSpace != NULL) && (strlen(options->nameSpace) != 0)) {
         states->nameSpace = options->nameSpace;
@@ -682,74 +596,148 @@ int emf2svg(char *contents, size_t length, char ** fm_out, size_t * fm_out_lengt
     }
 
     states->svgDelimiter = options->svgDelimiter;
-    states->currentDeviceContext.font_name = NULL;
+    if (!intern_init(&(states->pens), sizeof(emfPen), false) ||
+        !intern_init(&(states->brushes), sizeof(emfBrush), false) ||
+        !intern_init(&(states->fonts), sizeof(emfFont), false) ||
+        !intern_init(&(states->strings), 0, true) ||
+        !intern_init(&(states->gradients), sizeof(emfGradient), false)) {
+        states->Error = true;
+    }
     /* initialized to -1 because real size of states->objectTable is always
      * states->objectTableSize + 1 (for easier index manipulation since
      * indexes in emf files start at 1 and not 0)*/
     states->objectTableSize = -1;
+    states->objectHandles = -1;
+    // ids differ between conversions (several svg in the same document)
+    states->idBase = (uint32_t)rand();
     setTransformIdentity(states);
+    return states;
+}
 
-    blimit = contents + length;
-    int err = 1;
+void states_free(drawingStates *states) {
+    freeObjectTable(states);
+    free_path(&(states->currentPath));
+    freeDeviceContext(&(states->currentDeviceContext));
+    freeDeviceContextStack(states);
+    freeStyleCache(states);
+    intern_free(&(states->pens));
+    intern_free(&(states->brushes));
+    intern_free(&(states->fonts));
+    intern_free(&(states->strings));
+    intern_free(&(states->gradients));
+    pixel_run_free(states);
+    path_run_free(states);
+    simplify_free(states);
+    trace_free(states);
+    freeEmfImageLibrary(states);
+    freeEmfClipLibrary(states);
+    if (states->nameSpace != NULL)
+        free(states->nameSpaceString);
+    free(states);
+}
 
-    stream = fmem_open(&fm, "w");
-    if (stream == NULL) {
-        if (states->verbose) {
-            printf("Failed to allocate output stream\n");
+drawingStates *states_copy(drawingStates *src) {
+    if (src->pathRun.count || src->trace.callback || src->tiles)
+        return NULL;
+    drawingStates *states = (drawingStates *)malloc(sizeof(drawingStates));
+    if (states == NULL)
+        return NULL;
+    *states = *src;
+    // nothing is shared, the style cache and the scratch buffers start
+    // empty
+    states->objectTable = NULL;
+    states->DeviceContextStack = NULL;
+    states->currentPath = NULL;
+    states->library = NULL;
+    memset(states->clipLibrary, 0, sizeof(states->clipLibrary));
+    states->pens = states->brushes = states->fonts = states->strings =
+        states->gradients = (emfInternTable){0};
+    states->styleCache = (emfStyleCache){0};
+    states->pixelRun = (emfPixelRun){0};
+    states->pathRun = (emfPathRun){0};
+    states->simplify = (emfSimplify){0};
+    states->trace = (emfTrace){0};
+    copyDeviceContext(&(states->currentDeviceContext),
+                      &(src->currentDeviceContext));
+    states->currentDeviceContext.dirty = DC_DIRTY_ALL;
+    copy_path(src->currentPath, &(states->currentPath));
+    bool ok = true;
+    if (src->nameSpace != NULL) {
+        states->nameSpaceString =
+            (char *)malloc(strlen(src->nameSpaceString) + 1);
+        if (states->nameSpaceString == NULL) {
+            states->nameSpace = NULL;
+            states->nameSpaceString = (char *)"";
+            ok = false;
+        } else {
+            strcpy(states->nameSpaceString, src->nameSpaceString);
         }
-        FLAG_RESET;
-        err = 0;
-        OK = 0;
     }
+    ok = ok && copyObjectTable(states, src) &&
+         intern_copy(&(states->pens), &(src->pens)) &&
+         intern_copy(&(states->brushes), &(src->brushes)) &&
+         intern_copy(&(states->fonts), &(src->fonts)) &&
+         intern_copy(&(states->strings), &(src->strings)) &&
+         intern_copy(&(states->gradients), &(src->gradients)) &&
+         copyDeviceContextStack(states, src) &&
+         image_library_copy(states, src) && clip_library_copy(states, src) &&
+         pixel_run_copy(states, src);
+    if (!ok) {
+        states_free(states);
+        return NULL;
+    }
+    return states;
+}
 
-    // analyze emf structure
-    while (OK) {
-        if (off >= length) { // normally should exit from while after EMREOF
-                             // sets OK to false, this is most likely a corrupt
-                             // EMF
-            if (states->verbose) {
-                printf("WARNING(scanning): record claims to extend beyond the "
-                       "end of the EMF file\n");
-            }
-            OK = 0;
-            err = 0;
-        }
+// draw all the records of contents in out (or in the tiles outputs if
+// tiles is not NULL), returns 0 on error
+static int emf2svg_draw(char *contents, size_t length, svgWriter *out,
+                        emfTiles *tiles, generatorOptions *options) {
+    size_t off = 0;
+    size_t result;
+    int OK = 1;
+    int recnum = 0;
+    char *blimit;
 
-        pEmr = (PU_ENHMETARECORD)(contents + off);
+    options->drawRanges = 1;
+    drawingStates *states = states_new(contents, length, tiles, options);
+    if (states == NULL)
+        return 0;
 
-        if (!recnum && (pEmr->iType != U_EMR_HEADER)) {
-            if (states->verbose) {
-                printf("WARNING(scanning): EMF file does not begin with an "
-                       "EMR_HEADER record\n");
-            }
-            OK = 0;
-            err = 0;
-        }
-        if (recnum && (pEmr->iType == U_EMR_HEADER)) {
-            if (states->verbose) {
-                printf("ABORTING(scanning): EMF contains two or more "
-                       "EMR_HEADER records\n");
-            }
-            OK = 0;
-            err = 0;
-        }
+    blimit = contents + length;
+    int err = 1;
+    double start = states->timing ? e2s_clock() : 0;
+    double analysed = 0;
 
-        result = U_emf_onerec_analyse(contents, blimit, recnum, off, states);
-        if (result == (size_t)-1 || states->Error) {
-            if (states->verbose) {
-                printf(
-                    "ABORTING(scanning): invalid record - corrupted file?\n");
-            }
-            OK = 0;
-        } else if (!result) {
-            OK = 0;
-        } else {
-            off += result;
-            recnum++;
-        }
-    } // end of while
+    // analyze emf structure (or take it from options->index)
+    generatorIndex built;
+    generatorIndex *index = options->index;
+    if (index == NULL) {
+        err = index_build(contents, length, &built, states);
+        index = &built;
+    } else if (index->length != length || index->count == 0) {
+        trace_message(states, 0, 0,
+                      "ABORTING(scanning): index of another EMF file");
+        err = 0;
+    } else if (states->budget.maxRecords &&
+               index->count > states->budget.maxRecords) {
+        // more records than the budget, no need to draw them
+        states->budget.exceeded = EMF2SVG_BUDGET_RECORDS;
+        trace_message(states, states->budget.maxRecords,
+                      index->offsets[states->budget.maxRecords],
+                      "ABORTING(scanning): resource budget exceeded");
+        err = 0;
+    }
+    states->emfStructure.paths = (pathStruct *)index->pathData;
+    states->emfStructure.count = index->pathCount;
+    // a path left open at the end of the pass
+    states->inPath = index->pathCount &&
+                     index->paths[index->pathCount - 1].end == UINT32_MAX;
     FLAG_RESET;
     setTransformIdentity(states);
+    states->currentDeviceContext.dirty = DC_DIRTY_ALL;
+    if (states->timing)
+        analysed = e2s_clock();
 
     // continue only if no previous errors
     if (err == 0) {
@@ -760,26 +748,51 @@ int emf2svg(char *contents, size_t length, char ** fm_out, size_t * fm_out_lengt
 
     off = 0;
     recnum = 0;
+    // ranges of records converted over options->drawThreads threads
+    if (OK && parallel_enabled(states, index, options)) {
+        err = parallel_draw(contents, length, index, out, states, options,
+                            &recnum);
+        OK = 0;
+    }
+    unsigned int progressInterval =
+        options->progressInterval ? options->progressInterval : 1024;
     while (OK) {
         if (off >= length) { // normally should exit from while after EMREOF
                              // sets OK to false, this is most likely a corrupt
                              // EMF
-            if (states->verbose) {
-                printf("WARNING(converting): record claims to extend beyond "
-                       "the end of the EMF file\n");
-            }
+            trace_message(states, recnum, off,
+                          "WARNING(converting): record claims to extend "
+                          "beyond the end of the EMF file");
             OK = 0;
             err = 0;
         }
 
-        pEmr = (PU_ENHMETARECORD)(contents + off);
-
-        result = U_emf_onerec_draw(contents, blimit, recnum, off, stream, states);
+        if (states->budget.enabled && budget_check(states, out)) {
+            trace_message(states, recnum, off,
+                          "ABORTING(converting): resource budget exceeded");
+            break;
+        }
+        if (options->progress && recnum % progressInterval == 0 &&
+            options->progress(off, length, recnum, options->progressCtx)) {
+            states->cancelled = true;
+            trace_message(states, recnum, off,
+                          "ABORTING(converting): cancelled");
+            break;
+        }
+        if (states->stats)
+            result = emf_onerec_draw_stats(contents, blimit, recnum, off, out,
+                                           states);
+        else
+            result =
+                U_emf_onerec_draw(contents, blimit, recnum, off, out, states);
+        if (states->trace.callback && result != (size_t)-1)
+            trace_record(states, contents, recnum, off);
         if (result == (size_t)-1 || states->Error) {
-            if (states->verbose) {
-                printf(
-                    "ABORTING(converting): invalid record - corrupted file?\n");
-            }
+            trace_message(
+                states, recnum, off,
+                states->budget.exceeded
+                    ? "ABORTING(converting): resource budget exceeded"
+                    : "ABORTING(converting): invalid record - corrupted file?");
             OK = 0;
             err = 0;
         } else if (!result) {
@@ -790,36 +803,173 @@ int emf2svg(char *contents, size_t length, char ** fm_out, size_t * fm_out_lengt
         }
     } // end of while
     FLAG_RESET;
-    freeObjectTable(states);
-    freePathStack(states->emfStructure.pathStack);
-    free_path(&(states->currentPath));
-    free(states->objectTable);
-    freeDeviceContext(&(states->currentDeviceContext));
-    freeDeviceContextStack(states);
-    freeEmfImageLibrary(states);
-    free(states);
+    options->culledRecords = states->culledRecords;
+    // failures, with their reason
+    if (states->budget.exceeded) {
+        options->budgetExceeded = states->budget.exceeded;
+        err = 0;
+    }
+    if (states->cancelled) {
+        options->cancelled = true;
+        err = 0;
+    }
+    if (states->timing) {
+        generatorTimings *timings = options->timings;
+        timings->analyse = analysed - start;
+        timings->draw = e2s_clock() - analysed;
+        timings->images = states->imagesTime;
+        timings->fonts = states->fontsTime;
+        timings->records = recnum;
+    }
+    if (states->stats) {
+        emfStyleCache *cache = &(states->styleCache);
+        states->stats->bufferAllocations +=
+            out->allocations + states->pathRun.d.allocations +
+            states->pathRun.style.allocations + cache->stroke.allocations +
+            cache->fill.allocations + cache->text.allocations +
+            cache->textLayout.allocations;
+    }
+    if (isVerbose(states) && states->culling && !states->trace.callback) {
+        printf("Culled records: %zu\n", states->culledRecords);
+    }
+    if (index == &built)
+        index_clear(&built);
+    states_free(states);
+    return err;
+}
+
+// convert to a writer (memory, FILE or callback), returns 0 on error
+static int emf2svg_write(char *contents, size_t length, svgWriter *out,
+                         generatorOptions *options) {
+    int err = 0;
+
+#if U_BYTE_SWAP
+    // This is a Big Endian machine, EMF data is Little Endian
+    U_emf_endian(contents, length, 0); // LE to BE
+#endif
 
-    if (stream) {
-        fflush(stream);
-        void* out;
-        fmem_mem(&fm, &out, fm_out_length);
-        if (*fm_out_length) {
-            *fm_out = (char*)malloc(*fm_out_length+1);
+    if (options->svgz)
+        svg_writer_gzip(out, options->svgzLevel, options->svgzThreads);
+    if (out->error) {
+        if (isVerbose(options)) {
+            printf("Failed to allocate output buffer\n");
         }
-        if (*fm_out) {
-            memcpy((void*)(*fm_out), out, *fm_out_length);
-            (*fm_out)[*fm_out_length] = 0;
+    } else {
+        err = emf2svg_draw(contents, length, out, NULL, options);
+    }
+    if (!svg_writer_close(out))
+        err = 0;
+    return err;
+}
+
+int emf2svg(char *contents, size_t length, char ** fm_out, size_t * fm_out_length,
+            generatorOptions *options) {
+    svgWriter out;
+    *fm_out = NULL;
+    *fm_out_length = 0;
+
+    svg_writer_init(&out, NULL, NULL, NULL);
+    int err = emf2svg_write(contents, length, &out, options);
+    // the buffer is handed over to the caller
+    if (out.len && svg_reserve(&out, 1)) {
+        out.buf[out.len] = 0;
+        *fm_out = out.buf;
+        *fm_out_length = out.len;
+    } else {
+        svg_writer_free(&out);
+        err = 0;
+    }
+    return err;
+}
+
+int emf2svg_file(char *contents, size_t length, FILE *file,
+                 generatorOptions *options) {
+    svgWriter out;
+    svg_writer_init(&out, file, NULL, NULL);
+    int err = emf2svg_write(contents, length, &out, options);
+    svg_writer_free(&out);
+    return err;
+}
+
+int emf2svg_stream(char *contents, size_t length,
+                   emf2svg_write_callback callback, void *ctx,
+                   generatorOptions *options) {
+    svgWriter out;
+    svg_writer_init(&out, NULL, callback, ctx);
+    int err = emf2svg_write(contents, length, &out, options);
+    svg_writer_free(&out);
+    return err;
+}
+
+int emf2svg_tiles(char *contents, size_t length, unsigned int columns,
+                  unsigned int rows, char **out, size_t *out_length,
+                  generatorOptions *options) {
+    if (columns == 0 || rows == 0 || rows > UINT_MAX / columns ||
+        !options->svgDelimiter)
+        return 0;
+    unsigned int count = columns * rows;
+    int err = 0;
+    emfTiles tiles;
+    tiles.count = count;
+    tiles.columns = columns;
+    tiles.viewports = (RECT_D *)calloc(count, sizeof(RECT_D));
+    tiles.visible = (bool *)calloc(count, sizeof(bool));
+    tiles.writers = (svgWriter *)calloc(count, sizeof(svgWriter));
+    // records are drawn in fragment before being dispatched to the tiles
+    svgWriter fragment;
+    svg_writer_init(&fragment, NULL, NULL, NULL);
+    for (unsigned int i = 0; i < count; i++) {
+        out[i] = NULL;
+        out_length[i] = 0;
+    }
+
+#if U_BYTE_SWAP
+    // This is a Big Endian machine, EMF data is Little Endian
+    U_emf_endian(contents, length, 0); // LE to BE
+#endif
+
+    err = tiles.viewports != NULL && tiles.visible != NULL &&
+          tiles.writers != NULL && !fragment.error;
+    for (unsigned int i = 0; i < count && err; i++)
+        err = svg_writer_init(&tiles.writers[i], NULL, NULL, NULL);
+    if (!err) {
+        if (isVerbose(options)) {
+            printf("Failed to allocate output buffer\n");
         }
-        else {
+    } else {
+        err = emf2svg_draw(contents, length, &fragment, &tiles, options);
+    }
+
+    for (unsigned int i = 0; i < count && tiles.writers; i++) {
+        svgWriter *w = &tiles.writers[i];
+        // the buffers are handed over to the caller
+        if (err && w->len && !w->error && svg_reserve(w, 1)) {
+            w->buf[w->len] = 0;
+            out[i] = w->buf;
+            out_length[i] = w->len;
+        } else {
+            svg_writer_free(w);
             err = 0;
         }
-        fclose(stream);
-        fmem_term(&fm);
     }
-
+    if (!err) {
+        for (unsigned int i = 0; i < count; i++) {
+            free(out[i]);
+            out[i] = NULL;
+            out_length[i] = 0;
+        }
+    }
+    svg_writer_free(&fragment);
+    free(tiles.viewports);
+    free(tiles.visible);
+    free(tiles.writers);
     return err;
 }
 
+const char *emf2svg_record_name(unsigned int iType) {
+    return U_emr_names(iType);
+}
+
 int emf2svg_is_emfplus(char *contents, size_t length, bool *is_emfp) {
     size_t off = 0;
     size_t result;
@@ -860,7 +1010,8 @@ int emf2svg_is_emfplus(char *contents, size_t length, bool *is_emfp) {
         result = U_emf_onerec_is_emfp(contents, blimit, recnum, off, is_emfp);
         if (result == (size_t)-1) {
             OK = 0;
-        } else if (!result) {
+        } else if (!result || *is_emfp) {
+            // no need to look further than the first EMF+ record
             OK = 0;
         } else {
             off += result;
@@ -870,6 +1021,164 @@ int emf2svg_is_emfplus(char *contents, size_t length, bool *is_emfp) {
     return err;
 }
 
+// the probe reads the little endian fields in place (the contents are not
+// swapped on big endian machines)
+static uint32_t probe_le32(const char *p) {
+    const unsigned char *u = (const unsigned char *)p;
+    return (uint32_t)u[0] | (uint32_t)u[1] << 8 | (uint32_t)u[2] << 16 |
+           (uint32_t)u[3] << 24;
+}
+
+static uint16_t probe_le16(const char *p) {
+    const unsigned char *u = (const unsigned char *)p;
+    return (uint16_t)(u[0] | u[1] << 8);
+}
+
+// fields of a record of size bytes at rec, read only if they are within it
+// (0 otherwise), offset being given by offsetof() on the uemf structures
+static uint32_t probe_u32(const char *rec, size_t size, size_t offset) {
+    return offset + sizeof(uint32_t) <= size ? probe_le32(rec + offset) : 0;
+}
+
+static uint16_t probe_u16(const char *rec, size_t size, size_t offset) {
+    return offset + sizeof(uint16_t) <= size ? probe_le16(rec + offset) : 0;
+}
+
+static void probe_rect(const char *rec, size_t size, size_t offset,
+                       generatorRect *rect) {
+    rect->left = (int32_t)probe_u32(rec, size, offset);
+    rect->top = (int32_t)probe_u32(rec, size, offset + sizeof(int32_t));
+    rect->right = (int32_t)probe_u32(rec, size, offset + 2 * sizeof(int32_t));
+    rect->bottom = (int32_t)probe_u32(rec, size, offset + 3 * sizeof(int32_t));
+}
+
+// converts the UTF-16LE string at src (at most *count characters, ends at a
+// NUL) to UTF-8 in dst (truncated to size), *count is decreased by the
+// characters read
+static const char *probe_utf16(const char *src, uint32_t *count, char *dst,
+                               size_t size) {
+    size_t len = 0;
+    while (*count) {
+        uint32_t c = probe_le16(src);
+        src += 2;
+        (*count)--;
+        if (c == 0)
+            break;
+        if (c >= 0xD800 && c < 0xDC00 && *count) {
+            uint32_t low = probe_le16(src);
+            if (low >= 0xDC00 && low < 0xE000) {
+                c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                src += 2;
+                (*count)--;
+            }
+        }
+        if (c >= 0xD800 && c < 0xE000)
+            c = 0xFFFD;
+        char tmp[4];
+        size_t n;
+        if (c < 0x80) {
+            tmp[0] = (char)c;
+            n = 1;
+        } else if (c < 0x800) {
+            tmp[0] = (char)(0xC0 | c >> 6);
+            tmp[1] = (char)(0x80 | (c & 0x3F));
+            n = 2;
+        } else if (c < 0x10000) {
+            tmp[0] = (char)(0xE0 | c >> 12);
+            tmp[1] = (char)(0x80 | ((c >> 6) & 0x3F));
+            tmp[2] = (char)(0x80 | (c & 0x3F));
+            n = 3;
+        } else {
+            tmp[0] = (char)(0xF0 | c >> 18);
+            tmp[1] = (char)(0x80 | ((c >> 12) & 0x3F));
+            tmp[2] = (char)(0x80 | ((c >> 6) & 0x3F));
+            tmp[3] = (char)(0x80 | (c & 0x3F));
+            n = 4;
+        }
+        // whole characters only
+        if (len + n < size) {
+            memcpy(dst + len, tmp, n);
+            len += n;
+        }
+    }
+    dst[len] = '\0';
+    return src;
+}
+
+int emf2svg_probe(const char *contents, size_t length, generatorProbe *probe) {
+    memset(probe, 0, sizeof(generatorProbe));
+    probe->length = length;
+    if (contents == NULL)
+        return 0;
+    uint32_t iType = probe_u32(contents, length, offsetof(U_EMR, iType));
+    uint32_t nSize = probe_u32(contents, length, offsetof(U_EMR, nSize));
+    // the header up to szlMillimeters is mandatory (U_SIZE_EMRHEADER_MIN),
+    // the fields are then read within nSize
+    if (iType != U_EMR_HEADER || nSize < U_SIZE_EMRHEADER_MIN ||
+        nSize > length ||
+        probe_u32(contents, nSize, offsetof(U_EMRHEADER, dSignature)) !=
+            U_ENHMETA_SIGNATURE)
+        return 0;
+    probe_rect(contents, nSize, offsetof(U_EMRHEADER, rclBounds),
+               &(probe->bounds));
+    probe_rect(contents, nSize, offsetof(U_EMRHEADER, rclFrame),
+               &(probe->frame));
+    probe->bytes = probe_u32(contents, nSize, offsetof(U_EMRHEADER, nBytes));
+    probe->records =
+        probe_u32(contents, nSize, offsetof(U_EMRHEADER, nRecords));
+    probe->handles =
+        probe_u16(contents, nSize, offsetof(U_EMRHEADER, nHandles));
+    probe->device.cx = (int32_t)probe_u32(
+        contents, nSize, offsetof(U_EMRHEADER, szlDevice.cx));
+    probe->device.cy = (int32_t)probe_u32(
+        contents, nSize, offsetof(U_EMRHEADER, szlDevice.cy));
+    probe->millimeters.cx = (int32_t)probe_u32(
+        contents, nSize, offsetof(U_EMRHEADER, szlMillimeters.cx));
+    probe->millimeters.cy = (int32_t)probe_u32(
+        contents, nSize, offsetof(U_EMRHEADER, szlMillimeters.cy));
+
+    // description, "application\0title\0\0", within the header record
+    uint32_t nDescription =
+        probe_u32(contents, nSize, offsetof(U_EMRHEADER, nDescription));
+    uint32_t offDescription =
+        probe_u32(contents, nSize, offsetof(U_EMRHEADER, offDescription));
+    if (nDescription && offDescription >= U_SIZE_EMRHEADER_MIN &&
+        offDescription < nSize &&
+        nDescription <= (nSize - offDescription) / 2) {
+        const char *src = contents + offDescription;
+        src = probe_utf16(src, &nDescription, probe->application,
+                          sizeof(probe->application));
+        probe_utf16(src, &nDescription, probe->title, sizeof(probe->title));
+    }
+
+    // EMF+ files start with a comment holding the EMF+ header record
+    const char *rec = contents + nSize;
+    size_t left = length - nSize;
+    if (probe_u32(rec, left, offsetof(U_EMR, iType)) != U_EMR_COMMENT)
+        return 1;
+    uint32_t recSize = probe_u32(rec, left, offsetof(U_EMR, nSize));
+    if (recSize < offsetof(U_EMRCOMMENT_EMFPLUS, Data) || recSize > left)
+        return 1;
+    uint32_t cbData =
+        probe_u32(rec, recSize, offsetof(U_EMRCOMMENT_EMFPLUS, cbData));
+    // the comment data must hold the identifier, then be within the record
+    if (cbData < sizeof(uint32_t) ||
+        cbData > recSize - offsetof(U_EMRCOMMENT_EMFPLUS, cIdent) ||
+        probe_u32(rec, recSize, offsetof(U_EMRCOMMENT_EMFPLUS, cIdent)) !=
+            U_EMR_COMMENT_EMFPLUSRECORD)
+        return 1;
+    probe->emfplus = true;
+    // EMF+ header record, in the comment data
+    const char *plus = rec + offsetof(U_EMRCOMMENT_EMFPLUS, Data);
+    size_t plusSize = cbData - sizeof(uint32_t);
+    if (probe_u16(plus, plusSize, offsetof(U_PMF_CMN_HDR, Type)) ==
+            (U_PMR_RECFLAG | U_PMR_HEADER))
+        probe->emfplusDual =
+            probe_u16(plus, plusSize, offsetof(U_PMF_CMN_HDR, Flags)) &
+            U_PPF_DM;
+    return 1;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -8,38 +8,829 @@ extern "C" {
 
 #include "emf2svg_img_utils.h"
 #include "emf2svg_private.h"
+#include <math.h>
 #include <stdint.h>
 #include <stdio.h>
 
-void clip_rgn_mix(drawingStates *states, PATH *path, uint32_t mode) {
-    // FIXME need to handle clip region definition properly.
-    // Need to calculate new clipping form.
-    // it's not trivial, use a lib like polyclip (cpp) which in turn
-    // needs to convert Bezier/ARC curves in segment.
-    switch (mode) {
-    case U_RGN_NONE:
-    case U_RGN_AND:
-    case U_RGN_OR:
-    case U_RGN_XOR:
-    case U_RGN_DIFF:
-    case U_RGN_COPY:
+// closed path of a list of rectangles, the empty region if count is 0
+static PATH *rects_path(RECT_D *rects, size_t count) {
+    PATH *path = NULL;
+    for (size_t i = 0; i < count; i++) {
+        POINT_D pts[4] = {{rects[i].left, rects[i].top},
+                          {rects[i].right, rects[i].top},
+                          {rects[i].right, rects[i].bottom},
+                          {rects[i].left, rects[i].bottom}};
+        add_new_seg(&path, SEG_MOVE);
+        path->last->section.points[0] = pts[0];
+        for (int j = 1; j < 4; j++) {
+            add_new_seg(&path, SEG_LINE);
+            path->last->section.points[0] = pts[j];
+        }
+        add_new_seg(&path, SEG_END);
+    }
+    if (path == NULL) {
+        // empty region, everything is clipped
+        add_new_seg(&path, SEG_MOVE);
+        add_new_seg(&path, SEG_END);
+    }
+    return path;
+}
+
+RECT_D rect_d(POINT_D a, POINT_D b) {
+    RECT_D rect;
+    rect.left = a.x < b.x ? a.x : b.x;
+    rect.right = a.x < b.x ? b.x : a.x;
+    rect.top = a.y < b.y ? a.y : b.y;
+    rect.bottom = a.y < b.y ? b.y : a.y;
+    return rect;
+}
+
+void clip_rects_free(EMF_DEVICE_CONTEXT *dc) {
+    free(dc->clipRects);
+    dc->clipRects = NULL;
+    dc->clipRectsCount = 0;
+    dc->clipRectOnly = false;
+}
+
+void clip_rects_copy(EMF_DEVICE_CONTEXT *dest, EMF_DEVICE_CONTEXT *src) {
+    dest->clipRects = NULL;
+    if (src->clipRectsCount == 0)
+        return;
+    dest->clipRects = malloc(src->clipRectsCount * sizeof(RECT_D));
+    if (dest->clipRects == NULL) {
+        // fallback on the (equivalent) path representation
+        dest->clipRectsCount = 0;
+        dest->clipRectOnly = false;
+        return;
+    }
+    memcpy(dest->clipRects, src->clipRects,
+           src->clipRectsCount * sizeof(RECT_D));
+}
+
+// rects minus rect, as a new list of disjoint rectangles (NULL on error)
+static RECT_D *rects_subtract(RECT_D *src, size_t count, RECT_D rect,
+                              size_t *n_out) {
+    // a difference splits a rectangle in at most 4 rectangles
+    RECT_D *rects = malloc((count * 4 + 1) * sizeof(RECT_D));
+    if (rects == NULL)
+        return NULL;
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++) {
+        RECT_D r = src[i];
+        RECT_D inter;
+        inter.left = r.left > rect.left ? r.left : rect.left;
+        inter.top = r.top > rect.top ? r.top : rect.top;
+        inter.right = r.right < rect.right ? r.right : rect.right;
+        inter.bottom = r.bottom < rect.bottom ? r.bottom : rect.bottom;
+        if (inter.left >= inter.right || inter.top >= inter.bottom) {
+            rects[n++] = r;
+            continue;
+        }
+        // bands above and below the intersection, then left and right
+        if (r.top < inter.top)
+            rects[n++] = (RECT_D){r.left, r.top, r.right, inter.top};
+        if (inter.bottom < r.bottom)
+            rects[n++] = (RECT_D){r.left, inter.bottom, r.right, r.bottom};
+        if (r.left < inter.left)
+            rects[n++] = (RECT_D){r.left, inter.top, inter.left, inter.bottom};
+        if (inter.right < r.right)
+            rects[n++] =
+                (RECT_D){inter.right, inter.top, r.right, inter.bottom};
+    }
+    *n_out = n;
+    return rects;
+}
+
+// rect minus all the rectangles of rects (NULL on error)
+static RECT_D *rect_subtract_all(RECT_D rect, RECT_D *rects, size_t count,
+                                 size_t *n_out) {
+    RECT_D *pieces = malloc(sizeof(RECT_D));
+    if (pieces == NULL)
+        return NULL;
+    pieces[0] = rect;
+    size_t n = (rect.left < rect.right && rect.top < rect.bottom) ? 1 : 0;
+    for (size_t i = 0; i < count && n > 0; i++) {
+        size_t m;
+        RECT_D *next = rects_subtract(pieces, n, rects[i], &m);
+        free(pieces);
+        if (next == NULL)
+            return NULL;
+        pieces = next;
+        n = m;
+    }
+    *n_out = n;
+    return pieces;
+}
+
+// rectangle only fast path of clip_rgn_mix, the region is kept as a list of
+// disjoint rectangles (or as the complement of such a list) as long as only
+// AND (INTERSECTCLIPRECT) and DIFF (EXCLUDECLIPRECT) of rectangles are
+// involved
+void clip_rgn_rect_mix(drawingStates *states, RECT_D rect, uint32_t mode) {
+    EMF_DEVICE_CONTEXT *dc = &(states->currentDeviceContext);
+    if ((mode != U_RGN_AND && mode != U_RGN_DIFF) ||
+        (dc->clipRGN != NULL && !dc->clipRectOnly)) {
+        PATH *path = rects_path(&rect, 1);
+        clip_rgn_mix(states, path, mode);
+        free_path(&path);
+        return;
+    }
+
+    RECT_D *rects = NULL;
+    size_t n = 0;
+    bool inverted = false;
+    if (dc->clipRGN == NULL) {
+        // no clipping region: rect itself, or everything but rect
+        rects = malloc(sizeof(RECT_D));
+        if (rects != NULL && rect.left < rect.right && rect.top < rect.bottom) {
+            rects[0] = rect;
+            n = 1;
+        }
+        inverted = (mode == U_RGN_DIFF);
+    } else if (!dc->clipInverted) {
+        if (mode == U_RGN_AND) {
+            rects = malloc((dc->clipRectsCount + 1) * sizeof(RECT_D));
+            for (size_t i = 0; rects != NULL && i < dc->clipRectsCount; i++) {
+                RECT_D r = dc->clipRects[i];
+                RECT_D inter;
+                inter.left = r.left > rect.left ? r.left : rect.left;
+                inter.top = r.top > rect.top ? r.top : rect.top;
+                inter.right = r.right < rect.right ? r.right : rect.right;
+                inter.bottom =
+                    r.bottom < rect.bottom ? r.bottom : rect.bottom;
+                if (inter.left < inter.right && inter.top < inter.bottom)
+                    rects[n++] = inter;
+            }
+        } else {
+            rects = rects_subtract(dc->clipRects, dc->clipRectsCount, rect, &n);
+        }
+    } else if (mode == U_RGN_AND) {
+        // rect minus the excluded rectangles
+        rects = rect_subtract_all(rect, dc->clipRects, dc->clipRectsCount, &n);
+    } else {
+        // one more excluded rectangle, only its part not already excluded
+        size_t m = 0;
+        RECT_D *pieces =
+            rect_subtract_all(rect, dc->clipRects, dc->clipRectsCount, &m);
+        if (pieces != NULL) {
+            n = dc->clipRectsCount + m;
+            rects = malloc((n + 1) * sizeof(RECT_D));
+            if (rects != NULL) {
+                memcpy(rects, dc->clipRects,
+                       dc->clipRectsCount * sizeof(RECT_D));
+                memcpy(rects + dc->clipRectsCount, pieces,
+                       m * sizeof(RECT_D));
+            }
+            free(pieces);
+        }
+        inverted = true;
+    }
+    if (rects == NULL) {
+        states->Error = true;
+        return;
+    }
+
+    clip_rects_free(dc);
+    free_path(&(dc->clipRGN));
+    if (inverted && n == 0) {
+        // nothing excluded, no clipping region
+        free(rects);
+        dc->clipInverted = false;
+        return;
+    }
+    dc->clipRects = rects;
+    dc->clipRectsCount = n;
+    dc->clipRectOnly = true;
+    dc->clipInverted = inverted;
+    dc->clipRGN = rects_path(rects, n);
+}
+
+void clip_rgn_offset(drawingStates *states, POINT_D pt) {
+    EMF_DEVICE_CONTEXT *dc = &(states->currentDeviceContext);
+    offset_path(dc->clipRGN, pt);
+    for (size_t i = 0; i < dc->clipRectsCount; i++) {
+        dc->clipRects[i].left += pt.x;
+        dc->clipRects[i].right += pt.x;
+        dc->clipRects[i].top += pt.y;
+        dc->clipRects[i].bottom += pt.y;
+    }
+}
+
+// position of box relatively to the clipping region, only rectangle
+// regions are tested, CLIP_PARTIAL is returned for other regions
+int clip_rect_test(drawingStates *states, RECT_D box) {
+    EMF_DEVICE_CONTEXT *dc = &(states->currentDeviceContext);
+    if (dc->clipRGN == NULL || dc->clipID == 0)
+        return CLIP_INSIDE;
+    if (!dc->clipRectOnly || !isfinite(box.left) || !isfinite(box.top) ||
+        !isfinite(box.right) || !isfinite(box.bottom))
+        return CLIP_PARTIAL;
+    bool overlap = false;
+    for (size_t i = 0; i < dc->clipRectsCount; i++) {
+        RECT_D r = dc->clipRects[i];
+        if (box.left >= r.left && box.right <= r.right && box.top >= r.top &&
+            box.bottom <= r.bottom)
+            return dc->clipInverted ? CLIP_OUTSIDE : CLIP_INSIDE;
+        if (box.left < r.right && r.left < box.right && box.top < r.bottom &&
+            r.top < box.bottom)
+            overlap = true;
+    }
+    if (overlap)
+        return CLIP_PARTIAL;
+    // the rectangles of an inverted region are the excluded ones
+    return dc->clipInverted ? CLIP_INSIDE : CLIP_OUTSIDE;
+}
+
+static void box_add(RECT_D *box, POINT_D pt) {
+    if (pt.x < box->left)
+        box->left = pt.x;
+    if (pt.x > box->right)
+        box->right = pt.x;
+    if (pt.y < box->top)
+        box->top = pt.y;
+    if (pt.y > box->bottom)
+        box->bottom = pt.y;
+}
+
+// margin around the geometry of a shape covered by its stroke
+double stroke_margin(drawingStates *states) {
+    EMF_DEVICE_CONTEXT *dc = &(states->currentDeviceContext);
+    double width = 1;
+    if ((currentPen(states)->mode & 0x000000FF) != U_PS_NULL &&
+        (currentPen(states)->mode & 0x000F0000) != U_PS_COSMETIC)
+        width = currentPen(states)->width * states->scaling;
+    // miter joins can go as far as miterLimit * width / 2
+    double miter = dc->miterLimit > 2 ? dc->miterLimit : 2;
+    return fabs(width) * miter / 2;
+}
+
+// Clipping group clipset_draw_box() draws the element of box in: -1 if the
+// element is completely clipped, else the clip ID of the group (0: none).
+int clipset_box_group(drawingStates *states, RECT_D box, bool stroked) {
+    if (stroked) {
+        double margin = stroke_margin(states);
+        box.left -= margin;
+        box.top -= margin;
+        box.right += margin;
+        box.bottom += margin;
+    }
+    switch (clip_rect_test(states, box)) {
+    case CLIP_OUTSIDE:
+        return -1;
+    case CLIP_INSIDE:
+        // staying in the current group if it's the same clip is harmless
+        if (states->clipGroupID == states->currentDeviceContext.clipID)
+            return states->clipGroupID;
+        return 0;
     default:
-        free_path(&(states->currentDeviceContext.clipRGN));
-        copy_path(path, &(states->currentDeviceContext.clipRGN));
+        return states->currentDeviceContext.clipID;
+    }
+}
+
+// Same as clipset_draw, but with the bounding box of the element.
+// Returns false if the element is completely clipped (and must be skipped),
+// elements completely inside the clipping region are not clipped.
+bool clipset_draw_box(drawingStates *states, svgWriter *out, RECT_D box,
+                      bool stroked) {
+    if (states->inPath)
+        return true;
+    int group = clipset_box_group(states, box, stroked);
+    if (group < 0)
+        return false;
+    if (group == 0)
+        clip_group_close(states, out);
+    else
+        clipset_draw(states, out);
+    return true;
+}
+
+// bounding box (output coordinates) of the points of POLY* (and POLYPOLY*)
+// records, returns false if there is no point
+bool poly_box(drawingStates *states, const char *contents, bool is16,
+                     bool polypolygon, RECT_D *box) {
+    uint32_t count;
+    const char *pts;
+    if (polypolygon) {
+        PU_EMRPOLYPOLYLINE pEmr = (PU_EMRPOLYPOLYLINE)(contents);
+        count = pEmr->cptl;
+        pts = (const char *)pEmr->aPolyCounts +
+              sizeof(uint32_t) * (uint64_t)pEmr->nPolys;
+    } else {
+        PU_EMRPOLYLINE pEmr = (PU_EMRPOLYLINE)(contents);
+        count = pEmr->cptl;
+        pts = (const char *)pEmr->aptl;
+    }
+    size_t size = is16 ? sizeof(U_POINT16) : sizeof(U_POINT);
+    if (count == 0 ||
+        checkOutOfEMF(states, (uintptr_t)pts + (uint64_t)count * size))
+        return false;
+
+    RECT_D r = {INFINITY, INFINITY, -INFINITY, -INFINITY};
+    for (uint32_t i = 0; i < count; i++) {
+        if (is16)
+            box_add(&r, point_s16(states, ((PU_POINT16)pts)[i]));
+        else
+            box_add(&r, point_s(states, ((PU_POINT)pts)[i]));
+    }
+    *box = r;
+    return true;
+}
+
+// clipset_draw_box for the POLY* (and POLYPOLY*) records
+bool clipset_draw_poly(drawingStates *states, svgWriter *out,
+                       const char *contents, bool is16, bool polypolygon) {
+    EMF_DEVICE_CONTEXT *dc = &(states->currentDeviceContext);
+    // computing the bounding box is only useful for rectangle regions
+    if (states->inPath || dc->clipRGN == NULL || !dc->clipRectOnly) {
+        clipset_draw(states, out);
+        return true;
+    }
+    RECT_D box;
+    if (!poly_box(states, contents, is16, polypolygon, &box))
+        return false;
+    return clipset_draw_box(states, out, box, true);
+}
+
+// Bounding box of drawing records, in px after world transform (same
+// coordinates as states->viewport). clipped is set if the record is outside
+// of the current rectangle clipping region.
+// Returns false if the box is unknown (record without geometry, in a path,
+// or flipped geometry with fixBrokenYTransform).
+// The rclBounds of the records are not used: a lot of generators record
+// them in logical units instead of device units, the box is computed
+// from the geometry of the record instead.
+bool record_view_box(drawingStates *states, const char *contents,
+                     RECT_D *view, bool *clipped) {
+    PU_EMR emr = (PU_EMR)contents;
+    RECT_D box;
+    bool stroked = true;
+    if (states->inPath || states->fixBrokenYTransform)
+        return false;
+    switch (emr->iType) {
+    case U_EMR_POLYBEZIER:
+    case U_EMR_POLYGON:
+    case U_EMR_POLYLINE:
+    case U_EMR_POLYBEZIER16:
+    case U_EMR_POLYGON16:
+    case U_EMR_POLYLINE16:
+        if (emr->nSize < offsetof(U_EMRPOLYLINE, aptl) ||
+            !poly_box(states, contents, emr->iType >= U_EMR_POLYBEZIER16,
+                      false, &box))
+            return false;
+        break;
+    case U_EMR_POLYPOLYLINE:
+    case U_EMR_POLYPOLYGON:
+    case U_EMR_POLYPOLYLINE16:
+    case U_EMR_POLYPOLYGON16:
+        if (emr->nSize < offsetof(U_EMRPOLYPOLYLINE, aPolyCounts) ||
+            !poly_box(states, contents, emr->iType >= U_EMR_POLYPOLYLINE16,
+                      true, &box))
+            return false;
+        break;
+    case U_EMR_ELLIPSE:
+    case U_EMR_RECTANGLE:
+    case U_EMR_ROUNDRECT: {
+        if (emr->nSize < sizeof(U_EMRRECTANGLE))
+            return false;
+        U_RECTL r = ((PU_EMRRECTANGLE)contents)->rclBox;
+        box = rect_d(point_cal(states, (double)r.left, (double)r.top),
+                     point_cal(states, (double)r.right, (double)r.bottom));
+        break;
+    }
+    case U_EMR_BITBLT:
+    case U_EMR_STRETCHBLT:
+    case U_EMR_STRETCHDIBITS:
+    case U_EMR_ALPHABLEND: {
+        U_POINTL dest, cDest;
+        if (emr->iType == U_EMR_STRETCHDIBITS) {
+            if (emr->nSize < sizeof(U_EMRSTRETCHDIBITS))
+                return false;
+            dest = ((PU_EMRSTRETCHDIBITS)contents)->Dest;
+            cDest = ((PU_EMRSTRETCHDIBITS)contents)->cDest;
+        } else if (emr->iType == U_EMR_ALPHABLEND) {
+            if (emr->nSize < sizeof(U_EMRALPHABLEND))
+                return false;
+            dest = ((PU_EMRALPHABLEND)contents)->Dest;
+            cDest = ((PU_EMRALPHABLEND)contents)->cDest;
+        } else {
+            // same layout for BITBLT and STRETCHBLT
+            if (emr->nSize < sizeof(U_EMRBITBLT))
+                return false;
+            dest = ((PU_EMRBITBLT)contents)->Dest;
+            cDest = ((PU_EMRBITBLT)contents)->cDest;
+        }
+        // same computation as the bitmap records
+        POINT_D size = point_cal(states, (double)cDest.x, (double)cDest.y);
+        POINT_D position = point_cal(states, (double)dest.x, (double)dest.y);
+        POINT_D corner = {position.x + size.x, position.y + size.y};
+        box = rect_d(position, corner);
+        stroked = false;
+        break;
+    }
+    case U_EMR_EXTTEXTOUTA:
+    case U_EMR_EXTTEXTOUTW:
+    case U_EMR_SMALLTEXTOUT: {
+        U_POINTL ref;
+        uint32_t chars;
+        if (emr->iType == U_EMR_SMALLTEXTOUT) {
+            if (emr->nSize < sizeof(U_EMRSMALLTEXTOUT))
+                return false;
+            ref = ((PU_EMRSMALLTEXTOUT)contents)->Dest;
+            chars = ((PU_EMRSMALLTEXTOUT)contents)->cChars;
+        } else {
+            // same layout for EXTTEXTOUTA and EXTTEXTOUTW
+            if (emr->nSize < sizeof(U_EMREXTTEXTOUTA))
+                return false;
+            ref = ((PU_EMREXTTEXTOUTA)contents)->emrtext.ptlReference;
+            chars = ((PU_EMREXTTEXTOUTA)contents)->emrtext.nChars;
+        }
+        // the glyphs are not measured: whatever the alignment and the
+        // escapement (a rotation around the reference point, see
+        // text_style_draw()), the text stays within 2 font heights per
+        // character and 3 for the line of the reference point
+        double height = fabs(scaleX(states, currentFont(states)->height));
+        if (height == 0)
+            return false;
+        double radius = height * (2 * (double)chars + 3);
+        POINT_D org = point_cal(states, (double)ref.x, (double)ref.y);
+        box.left = org.x - radius;
+        box.top = org.y - radius;
+        box.right = org.x + radius;
+        box.bottom = org.y + radius;
+        stroked = false;
         break;
     }
+    default:
+        return false;
+    }
+    if (stroked) {
+        double margin = stroke_margin(states);
+        box.left -= margin;
+        box.top -= margin;
+        box.right += margin;
+        box.bottom += margin;
+    }
+    if (!isfinite(box.left) || !isfinite(box.top) || !isfinite(box.right) ||
+        !isfinite(box.bottom))
+        return false;
+    *clipped = clip_rect_test(states, box) == CLIP_OUTSIDE;
+
+    // box after world transform
+    U_XFORM w = states->currentDeviceContext.worldTransform;
+    double dx = scaleX(states, w.eDx);
+    double dy = scaleY(states, w.eDy);
+    POINT_D corners[4] = {{box.left, box.top},
+                          {box.right, box.top},
+                          {box.right, box.bottom},
+                          {box.left, box.bottom}};
+    RECT_D t = {INFINITY, INFINITY, -INFINITY, -INFINITY};
+    for (int i = 0; i < 4; i++) {
+        POINT_D pt;
+        pt.x = w.eM11 * corners[i].x + w.eM21 * corners[i].y + dx;
+        pt.y = w.eM12 * corners[i].x + w.eM22 * corners[i].y + dy;
+        box_add(&t, pt);
+    }
+    *view = t;
+    return true;
+}
+
+// if box (from record_view_box) is outside of viewport
+bool view_outside(RECT_D box, RECT_D viewport) {
+    // one pixel of margin for rounding
+    return box.right + 1 < viewport.left || box.left - 1 > viewport.right ||
+           box.bottom + 1 < viewport.top || box.top - 1 > viewport.bottom;
+}
+
+// Returns true if the record draws nothing visible and can be skipped.
+bool cull_record(drawingStates *states, const char *contents) {
+    RECT_D box;
+    bool clipped;
+    if (!states->viewportSet ||
+        !record_view_box(states, contents, &box, &clipped))
+        return false;
+    return clipped || view_outside(box, states->viewport);
+}
+
+// combine the current clipping region with path
+// (no clipping region means the whole plane, an inverted region is the
+// complement of clipRGN)
+void clip_rgn_mix(drawingStates *states, PATH *path, uint32_t mode) {
+    EMF_DEVICE_CONTEXT *dc = &(states->currentDeviceContext);
+    PATH *current = dc->clipRGN;
+    int fill_a = RGN_FILL_NONZERO;
+    int fill_b = RGN_FILL_NONZERO;
+    if (dc->fill_polymode == U_ALTERNATE)
+        fill_b = RGN_FILL_EVENODD;
+    bool inverted = false;
+
+    if (current == NULL) {
+        switch (mode) {
+        case U_RGN_OR:
+            // already the whole plane
+            return;
+        case U_RGN_XOR:
+        case U_RGN_DIFF:
+            // everything but path
+            inverted = true;
+            break;
+        default:
+            break;
+        }
+        mode = U_RGN_COPY;
+    } else if (dc->clipInverted) {
+        // ~A and B = B - A, the other modes keep the region inverted:
+        // ~A or B = ~(A - B), ~A xor B = ~(A xor B), ~A - B = ~(A or B)
+        switch (mode) {
+        case U_RGN_AND: {
+            PATH *tmp = current;
+            current = path;
+            path = tmp;
+            int fill = fill_a;
+            fill_a = fill_b;
+            fill_b = fill;
+            mode = U_RGN_DIFF;
+            break;
+        }
+        case U_RGN_OR:
+            mode = U_RGN_DIFF;
+            inverted = true;
+            break;
+        case U_RGN_XOR:
+            inverted = true;
+            break;
+        case U_RGN_DIFF:
+            mode = U_RGN_OR;
+            inverted = true;
+            break;
+        default:
+            break;
+        }
+    }
+
+    bool error = false;
+    PATH *result = region_mix(current, fill_a, path, fill_b, mode,
+                              states->flatteningTolerance, &error);
+    if (error) {
+        states->Error = true;
+        return;
+    }
+    clip_rects_free(dc);
+    free_path(&(dc->clipRGN));
+    dc->clipInverted = inverted && result != NULL;
+    if (result == NULL && !inverted)
+        // empty region, everything is clipped
+        result = rects_path(NULL, 0);
+    // (the complement of an empty region is no clipping region)
+    dc->clipRGN = result;
+}
+
+// number of points carried by a path section of the given type
+static int seg_points(uint8_t type) {
+    switch (type) {
+    case SEG_MOVE:
+    case SEG_LINE:
+        return 1;
+    case SEG_ARC:
+        return 2;
+    case SEG_BEZIER:
+        return 3;
+    case SEG_END:
+    default:
+        return 0;
+    }
+}
+
+// FNV-1a hash of the path sections (types and coordinates)
+uint32_t hash_path(PATH *in) {
+    uint32_t hash = 2166136261u;
+    PATH *tmp = in;
+    while (tmp != NULL) {
+        hash ^= tmp->section.type;
+        hash *= 16777619u;
+        const unsigned char *data = (const unsigned char *)tmp->section.points;
+        size_t len = seg_points(tmp->section.type) * sizeof(POINT_D);
+        for (size_t i = 0; i < len; i++) {
+            hash ^= data[i];
+            hash *= 16777619u;
+        }
+        tmp = tmp->next;
+    }
+    return hash;
+}
+
+bool equal_path(PATH *a, PATH *b) {
+    while (a != NULL && b != NULL) {
+        if (a->section.type != b->section.type)
+            return false;
+        int n = seg_points(a->section.type);
+        for (int i = 0; i < n; i++) {
+            if (a->section.points[i].x != b->section.points[i].x ||
+                a->section.points[i].y != b->section.points[i].y)
+                return false;
+        }
+        a = a->next;
+        b = b->next;
+    }
+    return (a == NULL && b == NULL);
+}
+
+// Find a clipping region already emitted (otherwise return NULL)
+emfClipLibrary *clip_library_find(drawingStates *states, PATH *path,
+                                  uint32_t hash, bool evenodd) {
+    emfClipLibrary *clip = states->clipLibrary[hash % CLIP_LIBRARY_BUCKETS];
+    while (clip) {
+        if (clip->hash == hash && clip->evenodd == evenodd &&
+            equal_path(clip->path, path))
+            return clip;
+        clip = clip->next;
+    }
+    return NULL;
+}
+
+// Add a clipping region to the states clip 'library'
+emfClipLibrary *clip_library_add(drawingStates *states, PATH *path,
+                                 uint32_t hash, bool evenodd) {
+    emfClipLibrary *clip = (emfClipLibrary *)calloc(1, sizeof(emfClipLibrary));
+    if (clip == NULL)
+        return NULL;
+    clip->id = get_id(states);
+    clip->hash = hash;
+    clip->evenodd = evenodd;
+    copy_path(path, &(clip->path));
+    clip->next = states->clipLibrary[hash % CLIP_LIBRARY_BUCKETS];
+    states->clipLibrary[hash % CLIP_LIBRARY_BUCKETS] = clip;
+    return clip;
+}
+
+// Release clip library
+void freeEmfClipLibrary(drawingStates *states) {
+    for (int i = 0; i < CLIP_LIBRARY_BUCKETS; i++) {
+        emfClipLibrary *clip = states->clipLibrary[i];
+        while (clip) {
+            emfClipLibrary *next = clip->next;
+            free_path(&(clip->path));
+            free(clip);
+            clip = next;
+        }
+        states->clipLibrary[i] = NULL;
+    }
+}
+
+// move the clip entry of dc from the library of src to its copy in dest
+// (same position in the same bucket)
+static void clip_library_move(drawingStates *dest, drawingStates *src,
+                              EMF_DEVICE_CONTEXT *dc) {
+    if (dc->clipEntry == NULL)
+        return;
+    uint32_t bucket = dc->clipEntry->hash % CLIP_LIBRARY_BUCKETS;
+    emfClipLibrary *copy = dest->clipLibrary[bucket];
+    emfClipLibrary *clip = src->clipLibrary[bucket];
+    for (; clip && copy; clip = clip->next, copy = copy->next) {
+        if (clip == dc->clipEntry) {
+            dc->clipEntry = copy;
+            return;
+        }
+    }
+    dc->clipEntry = NULL;
+}
+
+bool clip_library_copy(drawingStates *dest, drawingStates *src) {
+    for (int i = 0; i < CLIP_LIBRARY_BUCKETS; i++) {
+        emfClipLibrary **last = &(dest->clipLibrary[i]);
+        *last = NULL;
+        for (emfClipLibrary *clip = src->clipLibrary[i]; clip;
+             clip = clip->next) {
+            *last = (emfClipLibrary *)malloc(sizeof(emfClipLibrary));
+            if (*last == NULL)
+                return false;
+            **last = *clip;
+            (*last)->next = NULL;
+            (*last)->path = NULL;
+            copy_path(clip->path, &((*last)->path));
+            last = &((*last)->next);
+        }
+    }
+    clip_library_move(dest, src, &(dest->currentDeviceContext));
+    EMF_DEVICE_CONTEXT_STACK *stack_entry = dest->DeviceContextStack;
+    for (; stack_entry != NULL; stack_entry = stack_entry->previous)
+        clip_library_move(dest, src, &(stack_entry->DeviceContext));
+    return true;
+}
+
+// write the <clipPath> definition of a clip library entry
+void clip_library_draw(drawingStates *states, svgWriter *out,
+                       emfClipLibrary *clip) {
+    svg_printf(out, "<%sdefs><%sclipPath id=\"clip-%d\">",
+               states->nameSpaceString, states->nameSpaceString, clip->id);
+    svg_printf(out, "<%spath d=\"", states->nameSpaceString);
+    draw_path(states, clip->path, out);
+    if (clip->evenodd)
+        svg_append_literal(out, "Z\" clip-rule=\"evenodd\" />");
+    else
+        svg_append_literal(out, "Z\" />");
+    svg_append_literal(out, "</clipPath></defs>\n");
+    clip->drawn = true;
+}
+
+// area of the image which can be visible, in the coordinates of the
+// clipping regions (before the world transform)
+static RECT_D clip_frame(drawingStates *states) {
+    RECT_D view;
+    if (states->viewportSet) {
+        view = states->viewport;
+    } else if (states->fixBrokenYTransform) {
+        view = (RECT_D){0, 0, states->imgWidth + 1, states->imgHeight + 1};
+    } else {
+        double dx = states->RefX * states->scaling;
+        double dy = states->RefY * states->scaling;
+        view = (RECT_D){dx, dy, dx + states->imgWidth, dy + states->imgHeight};
+    }
+    U_XFORM w = states->currentDeviceContext.worldTransform;
+    double det = (double)w.eM11 * w.eM22 - (double)w.eM12 * w.eM21;
+    if (!isfinite(det) || fabs(det) < 1e-12)
+        return view;
+    double dx = scaleX(states, w.eDx);
+    double dy = scaleY(states, w.eDy);
+    POINT_D corners[4] = {{view.left, view.top},
+                          {view.right, view.top},
+                          {view.right, view.bottom},
+                          {view.left, view.bottom}};
+    RECT_D frame = {INFINITY, INFINITY, -INFINITY, -INFINITY};
+    for (int i = 0; i < 4; i++) {
+        double x = corners[i].x - dx;
+        double y = corners[i].y - dy;
+        POINT_D pt = {(w.eM22 * x - w.eM21 * y) / det,
+                      (w.eM11 * y - w.eM12 * x) / det};
+        box_add(&frame, pt);
+    }
+    return frame;
+}
+
+// path of an inverted clipping region: its polygons inside a rectangle
+// covering both them and the visible area, to be drawn with the evenodd
+// rule
+static PATH *clip_inverted_path(drawingStates *states, PATH *region) {
+    RECT_D box = clip_frame(states);
+    for (PATH *tmp = region; tmp != NULL; tmp = tmp->next) {
+        if (tmp->section.type == SEG_MOVE || tmp->section.type == SEG_LINE)
+            box_add(&box, tmp->section.points[0]);
+    }
+    // margin for the strokes and the rounding of the output
+    double margin = (box.right - box.left) + (box.bottom - box.top) + 1;
+    box.left -= margin;
+    box.top -= margin;
+    box.right += margin;
+    box.bottom += margin;
+    PATH *path = rects_path(&box, 1);
+    for (PATH *tmp = region; tmp != NULL; tmp = tmp->next) {
+        add_new_seg(&path, tmp->section.type);
+        if (tmp->section.type == SEG_MOVE || tmp->section.type == SEG_LINE)
+            path->last->section.points[0] = tmp->section.points[0];
+    }
+    return path;
+}
+
+// select the clip library entry of the current clipping region
+// the definition itself is only written by clipset_draw when an element
+// actually needs it
+void clip_rgn_draw(drawingStates *states, svgWriter *out) {
+    UNUSED(out);
+    if (states->inPath)
+        return;
+    EMF_DEVICE_CONTEXT *dc = &(states->currentDeviceContext);
+    if (dc->clipRGN == NULL) {
+        dc->clipID = 0;
+        dc->clipEntry = NULL;
+        return;
+    }
+    PATH *clipRGN = dc->clipRGN;
+    PATH *inverted = NULL;
+    if (dc->clipInverted) {
+        inverted = clip_inverted_path(states, clipRGN);
+        clipRGN = inverted;
+    }
+    uint32_t hash = hash_path(clipRGN);
+    bool evenodd = dc->clipInverted;
+    emfClipLibrary *clip = clip_library_find(states, clipRGN, hash, evenodd);
+    if (clip == NULL)
+        clip = clip_library_add(states, clipRGN, hash, evenodd);
+    free_path(&inverted);
+    if (clip == NULL) {
+        states->Error = true;
+        return;
+    }
+    dc->clipID = clip->id;
+    dc->clipEntry = clip;
 }
 
-void clip_rgn_draw(drawingStates *states, FILE *out) {
-    if (!(states->inPath) && states->currentDeviceContext.clipRGN != NULL) {
-        states->currentDeviceContext.clipID = get_id(states);
-        fprintf(out, "<%sdefs><%sclipPath id=\"clip-%d\">",
-                states->nameSpaceString, states->nameSpaceString,
-                states->currentDeviceContext.clipID);
-        fprintf(out, "<%spath d=\"", states->nameSpaceString);
-        draw_path(states->currentDeviceContext.clipRGN, out);
-        fprintf(out, "Z\" />");
-        fprintf(out, "</clipPath></defs>\n");
+// close the <g clip-path="..."> group opened by clipset_draw (if any)
+void clip_group_close(drawingStates *states, svgWriter *out) {
+    if (states->clipGroupID) {
+        svg_append_literal(out, "</");
+        svg_append_string(out, states->nameSpaceString);
+        svg_append_literal(out, "g>\n");
+        states->clipGroupID = 0;
+        tiles_mark(states, out);
     }
 }
 
@@ -0,0 +1,357 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DARWIN
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "emf2svg_private.h"
+#include <math.h>
+#include <stdio.h>
+
+// EMR_GRADIENTFILL: rectangles and triangles filled with a linear color
+// interpolation between their vertices.
+//
+// The colors of a shape are written as an affine scalar s(x, y) = gx * x +
+// gy * y + k, the color going from "from" (s = 0) to "to" (s = 1), which is
+// exactly a <linearGradient>. It's exact for the rectangles and for the
+// triangles whose vertex colors are on a line of the RGB space (two equal
+// colors is the common case), other triangles are approximated.
+//
+// Consecutive shapes whose vertex colors are given by the same
+// interpolation (or with the same solid color) are drawn as one <path>.
+// The gradients are in bounding box units and interned, a gradient is only
+// defined once for all the paths using it.
+
+// color channels, 0-255 (not rounded)
+typedef struct {
+    double c[3];
+} gradientColor;
+
+// shapes drawn as one <path>
+typedef struct {
+    bool open;
+    bool solid;
+    gradientColor from;
+    gradientColor to;
+    double gx;
+    double gy;
+    double k;
+    // range of s on the vertices of the shapes
+    double smin;
+    double smax;
+    RECT_D box;
+    // subpaths of the shapes
+    svgWriter path;
+} gradientRun;
+
+static gradientColor vertex_color(const U_TRIVERTEX *v) {
+    gradientColor color = {
+        {v->Red / 257.0, v->Green / 257.0, v->Blue / 257.0}};
+    return color;
+}
+
+static U_COLORREF color_round(gradientColor color) {
+    U_COLORREF ret = {0};
+    uint8_t *channels[3] = {&ret.Red, &ret.Green, &ret.Blue};
+    for (int i = 0; i < 3; i++) {
+        double c = round(color.c[i]);
+        *channels[i] = c < 0 ? 0 : (c > 255 ? 255 : (uint8_t)c);
+    }
+    return ret;
+}
+
+static uint32_t color_key(gradientColor color) {
+    U_COLORREF c = color_round(color);
+    return ((uint32_t)c.Red << 16) | ((uint32_t)c.Green << 8) | c.Blue;
+}
+
+// color of the run at s
+static gradientColor color_at(const gradientRun *run, double s) {
+    gradientColor ret;
+    for (int i = 0; i < 3; i++)
+        ret.c[i] = run->from.c[i] + (run->to.c[i] - run->from.c[i]) * s;
+    return ret;
+}
+
+static double color_distance(gradientColor a, gradientColor b) {
+    double d = 0;
+    for (int i = 0; i < 3; i++)
+        d += (a.c[i] - b.c[i]) * (a.c[i] - b.c[i]);
+    return d;
+}
+
+// interpolation of shape with s(a) = 0, s(b) = 1 and s(c) = t, false if
+// a, b and c are aligned (nothing to draw)
+static bool gradient_field(gradientRun *shape, POINT_D a, POINT_D b,
+                           POINT_D c, double t) {
+    double ux = b.x - a.x;
+    double uy = b.y - a.y;
+    double vx = c.x - a.x;
+    double vy = c.y - a.y;
+    double det = ux * vy - uy * vx;
+    if (!(fabs(det) > 1e-9))
+        return false;
+    shape->gx = (vy - t * uy) / det;
+    shape->gy = (t * ux - vx) / det;
+    shape->k = -(shape->gx * a.x + shape->gy * a.y);
+    return true;
+}
+
+// define the gradient if it's new, returns its id (0 on error)
+static uint32_t gradient_def(drawingStates *states, svgWriter *out,
+                             const emfGradient *gradient) {
+    uint32_t count = states->gradients.count;
+    uint32_t id = intern_item(states, &(states->gradients), gradient);
+    if (states->Error || states->gradients.count == count)
+        return id;
+    svg_printf(out, "<%sdefs><%slinearGradient id=\"grad-%u\" x1=\"",
+               states->nameSpaceString, states->nameSpaceString, id);
+    svg_append_number(out, gradient->x1);
+    svg_append_literal(out, "\" y1=\"");
+    svg_append_number(out, gradient->y1);
+    svg_append_literal(out, "\" x2=\"");
+    svg_append_number(out, gradient->x2);
+    svg_append_literal(out, "\" y2=\"");
+    svg_append_number(out, gradient->y2);
+    svg_printf(out, "\"><%sstop offset=\"0\" stop-color=\"",
+               states->nameSpaceString);
+    svg_append_color(out, gradient->from.Red, gradient->from.Green,
+                     gradient->from.Blue);
+    svg_printf(out, "\" /><%sstop offset=\"1\" stop-color=\"",
+               states->nameSpaceString);
+    svg_append_color(out, gradient->to.Red, gradient->to.Green,
+                     gradient->to.Blue);
+    svg_printf(out, "\" /></%slinearGradient></%sdefs>\n",
+               states->nameSpaceString, states->nameSpaceString);
+    return id;
+}
+
+// gradient of the run, false if there is nothing to draw
+static bool gradient_run_gradient(gradientRun *run, emfGradient *gradient) {
+    // colors of the range of s actually used, s -> (s - smin) / range
+    double range = run->smax - run->smin;
+    if (!(range > 0))
+        return false;
+    gradientColor from = color_at(run, run->smin);
+    gradientColor to = color_at(run, run->smax);
+    double gx = run->gx / range;
+    double gy = run->gy / range;
+    double k = (run->k - run->smin) / range;
+    // one orientation for a pair of colors (s -> 1 - s)
+    if (color_key(from) > color_key(to)) {
+        gradientColor tmp = from;
+        from = to;
+        to = tmp;
+        gx = -gx;
+        gy = -gy;
+        k = 1 - k;
+    }
+    // same interpolation in bounding box units
+    double w = run->box.right - run->box.left;
+    double h = run->box.bottom - run->box.top;
+    double bx = gx * w;
+    double by = gy * h;
+    double bk = gx * run->box.left + gy * run->box.top + k;
+    double n = bx * bx + by * by;
+    if (!(n > 0))
+        return false;
+    *gradient = (emfGradient){0};
+    gradient->from = color_round(from);
+    gradient->to = color_round(to);
+    // rounded as in the output (+ 0.0: no negative zero)
+    gradient->x1 = round(-bk * bx / n * 10000) / 10000 + 0.0;
+    gradient->y1 = round(-bk * by / n * 10000) / 10000 + 0.0;
+    gradient->x2 = round((1 - bk) * bx / n * 10000) / 10000 + 0.0;
+    gradient->y2 = round((1 - bk) * by / n * 10000) / 10000 + 0.0;
+    return true;
+}
+
+// write the <path> of the run
+static void gradient_run_flush(drawingStates *states, svgWriter *out,
+                               gradientRun *run) {
+    if (!run->open)
+        return;
+    run->open = false;
+    if (run->path.error) {
+        states->Error = true;
+        return;
+    }
+    emfGradient gradient;
+    uint32_t id = 0;
+    if ((run->solid || gradient_run_gradient(run, &gradient)) &&
+        clipset_draw_box(states, out, run->box, false)) {
+        if (!run->solid)
+            id = gradient_def(states, out, &gradient);
+        svg_printf(out, "<%spath d=\"", states->nameSpaceString);
+        svg_append(out, run->path.buf, run->path.len);
+        if (run->solid) {
+            U_COLORREF color = color_round(run->from);
+            svg_append_literal(out, "\" fill=\"");
+            svg_append_color(out, color.Red, color.Green, color.Blue);
+            svg_append_literal(out, "\" ");
+        } else {
+            svg_printf(out, "\" fill=\"url(#grad-%u)\" ", id);
+        }
+        svg_append_literal(out, "stroke=\"none\" />\n");
+    }
+    run->path.len = 0;
+}
+
+// does the run give the colors of the vertices (up to the rounding)
+static bool gradient_match(const gradientRun *run, const gradientRun *shape,
+                           const POINT_D *pts, const gradientColor *colors,
+                           int count) {
+    if (!run->open || run->solid != shape->solid)
+        return false;
+    if (run->solid)
+        return color_key(run->from) == color_key(shape->from);
+    for (int i = 0; i < count; i++) {
+        double s = run->gx * pts[i].x + run->gy * pts[i].y + run->k;
+        gradientColor c = color_at(run, s);
+        for (int j = 0; j < 3; j++) {
+            if (!(fabs(c.c[j] - colors[i].c[j]) <= 0.5))
+                return false;
+        }
+    }
+    return true;
+}
+
+// add the polygon pts (vertex colors: colors) to the run, or to a new run
+static void gradient_shape(drawingStates *states, svgWriter *out,
+                           gradientRun *run, const POINT_D *pts,
+                           const gradientColor *colors, int count,
+                           const gradientRun *shape) {
+    if (!gradient_match(run, shape, pts, colors, count)) {
+        gradient_run_flush(states, out, run);
+        run->open = true;
+        run->solid = shape->solid;
+        run->from = shape->from;
+        run->to = shape->to;
+        run->gx = shape->gx;
+        run->gy = shape->gy;
+        run->k = shape->k;
+        run->smin = INFINITY;
+        run->smax = -INFINITY;
+        run->box = rect_d(pts[0], pts[0]);
+    }
+    for (int i = 0; i < count; i++) {
+        if (i)
+            svg_append_literal(&(run->path), "L ");
+        else
+            svg_append_literal(&(run->path), "M ");
+        svg_append_point(&(run->path), pts[i].x, pts[i].y);
+        double s = run->gx * pts[i].x + run->gy * pts[i].y + run->k;
+        if (s < run->smin)
+            run->smin = s;
+        if (s > run->smax)
+            run->smax = s;
+        if (pts[i].x < run->box.left)
+            run->box.left = pts[i].x;
+        if (pts[i].x > run->box.right)
+            run->box.right = pts[i].x;
+        if (pts[i].y < run->box.top)
+            run->box.top = pts[i].y;
+        if (pts[i].y > run->box.bottom)
+            run->box.bottom = pts[i].y;
+    }
+    svg_append_literal(&(run->path), "Z ");
+}
+
+static void gradient_rect(drawingStates *states, svgWriter *out,
+                          gradientRun *run, const U_TRIVERTEX *ul,
+                          const U_TRIVERTEX *lr, bool vertical) {
+    POINT_D pts[4] = {
+        point_cal(states, (double)ul->x, (double)ul->y),
+        point_cal(states, (double)lr->x, (double)ul->y),
+        point_cal(states, (double)lr->x, (double)lr->y),
+        point_cal(states, (double)ul->x, (double)lr->y),
+    };
+    gradientColor a = vertex_color(ul);
+    gradientColor b = vertex_color(lr);
+    gradientColor colors[4] = {a, vertical ? a : b, b, vertical ? b : a};
+    gradientRun shape = {0};
+    shape.from = a;
+    shape.to = b;
+    shape.solid = color_key(a) == color_key(b);
+    // flat rectangles are not drawn, even with a solid color
+    if (!(vertical ? gradient_field(&shape, pts[0], pts[3], pts[1], 0)
+                   : gradient_field(&shape, pts[0], pts[1], pts[3], 0)))
+        return;
+    gradient_shape(states, out, run, pts, colors, 4, &shape);
+}
+
+static void gradient_triangle(drawingStates *states, svgWriter *out,
+                              gradientRun *run, const U_TRIVERTEX **v) {
+    POINT_D pts[3];
+    gradientColor c[3];
+    for (int i = 0; i < 3; i++) {
+        pts[i] = point_cal(states, (double)v[i]->x, (double)v[i]->y);
+        c[i] = vertex_color(v[i]);
+    }
+    // the two most different colors are s = 0 and s = 1, the third one is
+    // projected on their segment of the RGB space
+    int a = 0, b = 1, o = 2;
+    double d = color_distance(c[0], c[1]);
+    if (color_distance(c[0], c[2]) > d) {
+        d = color_distance(c[0], c[2]);
+        b = 2;
+        o = 1;
+    }
+    if (color_distance(c[1], c[2]) > d) {
+        d = color_distance(c[1], c[2]);
+        a = 1;
+        b = 2;
+        o = 0;
+    }
+    double t = 0;
+    if (d > 0) {
+        for (int i = 0; i < 3; i++)
+            t += (c[o].c[i] - c[a].c[i]) * (c[b].c[i] - c[a].c[i]);
+        t /= d;
+        t = t < 0 ? 0 : (t > 1 ? 1 : t);
+    }
+    gradientRun shape = {0};
+    shape.from = c[a];
+    shape.to = c[b];
+    shape.solid = color_key(c[0]) == color_key(c[1]) &&
+                  color_key(c[0]) == color_key(c[2]);
+    if (!gradient_field(&shape, pts[a], pts[b], pts[o], t))
+        return;
+    gradient_shape(states, out, run, pts, c, 3, &shape);
+}
+
+void gradient_fill_draw(drawingStates *states, svgWriter *out,
+                        const U_TRIVERTEX *vertices, uint32_t nVertices,
+                        const char *objects, uint32_t nObjects,
+                        uint32_t mode) {
+    gradientRun run = {0};
+    for (uint32_t i = 0; i < nObjects && !states->Error; i++) {
+        if (mode == U_GRADIENT_FILL_TRIANGLE) {
+            const U_GRADIENT3 *g = (const U_GRADIENT3 *)objects + i;
+            if (g->Vertex1 >= nVertices || g->Vertex2 >= nVertices ||
+                g->Vertex3 >= nVertices)
+                continue;
+            const U_TRIVERTEX *v[3] = {&vertices[g->Vertex1],
+                                       &vertices[g->Vertex2],
+                                       &vertices[g->Vertex3]};
+            gradient_triangle(states, out, &run, v);
+        } else {
+            const U_GRADIENT4 *g = (const U_GRADIENT4 *)objects + i;
+            if (g->UpperLeft >= nVertices || g->LowerRight >= nVertices)
+                continue;
+            gradient_rect(states, out, &run, &vertices[g->UpperLeft],
+                          &vertices[g->LowerRight],
+                          mode == U_GRADIENT_FILL_RECT_V);
+        }
+    }
+    if (!states->Error)
+        gradient_run_flush(states, out, &run);
+    svg_writer_free(&(run.path));
+}
+
+#ifdef __cplusplus
+}
+#endif
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,339 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DARWIN
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "emf2svg_writer.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <zlib.h>
+#ifndef _MSC_VER
+#include <pthread.h>
+#define SVG_GZIP_THREADS
+#endif
+
+// input size of the blocks compressed in parallel
+#define SVG_GZIP_BLOCK 131072
+// deflate window size, the preceding input primes the blocks
+#define SVG_GZIP_DICT 32768
+#define SVG_GZIP_MAX_THREADS 256
+
+// The writer passes its chunks to gzip_write() instead of its output, the
+// compressed data goes to the sink writer (FILE, callback or memory).
+//
+// With one thread, the chunks are fed to a single deflate stream.
+//
+// With more threads, the svg is cut in blocks compressed in parallel as raw
+// deflate data, each one primed with the 32 KiB preceding it and ended by
+// a sync flush (byte aligned and not final), so that they can be
+// concatenated. A batch of blocks (one per thread) is compressed while the
+// next one is filled. The blocks are written in order after a gzip header,
+// followed by an empty final block and the trailer, the crc of the svg
+// being combined from the crc of the blocks.
+
+typedef struct {
+    const char *data;
+    size_t len;
+    const char *dict;
+    size_t dictLen;
+    int level;
+    // compressed block
+    char *out;
+    size_t outLen;
+    size_t outSize;
+    uLong crc;
+    bool error;
+    // compressed by its own thread (to join)
+    bool threaded;
+#ifdef SVG_GZIP_THREADS
+    pthread_t thread;
+#endif
+} gzipBlock;
+
+struct svgGzip {
+    svgWriter sink;
+    int level;
+    unsigned int threads;
+    // single stream
+    z_stream strm;
+    bool strmInit;
+    // batch[0] is being filled, batch[1] is being compressed
+    char *batch[2];
+    size_t fill;
+    size_t compressed;
+    gzipBlock *blocks;
+    unsigned int count;
+    // input preceding batch[1]
+    char dict[SVG_GZIP_DICT];
+    size_t dictLen;
+    uLong crc;
+    uint64_t total;
+};
+
+static bool gzip_deflate(svgGzip *gz, const char *data, size_t size,
+                         int flush) {
+    z_stream *strm = &(gz->strm);
+    svgWriter *sink = &(gz->sink);
+    int ret;
+    // size is at most a chunk of the writer
+    strm->next_in = (Bytef *)data;
+    strm->avail_in = (uInt)size;
+    do {
+        if (!svg_reserve(sink, SVG_WRITER_CHUNK / 4))
+            return false;
+        size_t room = sink->size - sink->len;
+        if (room > UINT_MAX)
+            room = UINT_MAX;
+        strm->next_out = (Bytef *)(sink->buf + sink->len);
+        strm->avail_out = (uInt)room;
+        ret = deflate(strm, flush);
+        sink->len = (char *)strm->next_out - sink->buf;
+        if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+            return false;
+    } while (flush == Z_FINISH ? ret != Z_STREAM_END : strm->avail_in > 0);
+    return true;
+}
+
+static void *gzip_block_deflate(void *arg) {
+    gzipBlock *b = (gzipBlock *)arg;
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    b->error = true;
+    b->crc = crc32(crc32(0L, Z_NULL, 0), (const Bytef *)b->data, (uInt)b->len);
+    if (deflateInit2(&strm, b->level, Z_DEFLATED, -15, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK)
+        return NULL;
+    if (b->dictLen)
+        deflateSetDictionary(&strm, (const Bytef *)b->dict, (uInt)b->dictLen);
+    // room for the sync flush marker
+    size_t bound = deflateBound(&strm, (uLong)b->len) + 16;
+    if (b->outSize < bound) {
+        char *out = (char *)realloc(b->out, bound);
+        if (out == NULL) {
+            deflateEnd(&strm);
+            return NULL;
+        }
+        b->out = out;
+        b->outSize = bound;
+    }
+    strm.next_in = (Bytef *)b->data;
+    strm.avail_in = (uInt)b->len;
+    strm.next_out = (Bytef *)b->out;
+    strm.avail_out = (uInt)b->outSize;
+    int ret = deflate(&strm, Z_SYNC_FLUSH);
+    // the flush is complete if some room is left
+    if (ret == Z_OK && strm.avail_in == 0 && strm.avail_out > 0) {
+        b->outLen = b->outSize - strm.avail_out;
+        b->error = false;
+    }
+    deflateEnd(&strm);
+    return NULL;
+}
+
+static void gzip_join(svgGzip *gz) {
+#ifdef SVG_GZIP_THREADS
+    for (unsigned int i = 0; i < gz->count; i++) {
+        if (gz->blocks[i].threaded) {
+            pthread_join(gz->blocks[i].thread, NULL);
+            gz->blocks[i].threaded = false;
+        }
+    }
+#endif
+}
+
+// wait for the batch being compressed and write its blocks
+static bool gzip_wait(svgGzip *gz) {
+    gzip_join(gz);
+    for (unsigned int i = 0; i < gz->count; i++) {
+        gzipBlock *b = &(gz->blocks[i]);
+        if (b->error) {
+            gz->sink.error = true;
+            break;
+        }
+        svg_append(&(gz->sink), b->out, b->outLen);
+        gz->crc = crc32_combine(gz->crc, b->crc, (z_off_t)b->len);
+        gz->total += b->len;
+    }
+    gz->count = 0;
+    return !gz->sink.error;
+}
+
+static void gzip_dict_update(svgGzip *gz, const char *data, size_t len) {
+    if (len >= SVG_GZIP_DICT) {
+        memcpy(gz->dict, data + len - SVG_GZIP_DICT, SVG_GZIP_DICT);
+        gz->dictLen = SVG_GZIP_DICT;
+        return;
+    }
+    size_t keep = gz->dictLen;
+    if (keep + len > SVG_GZIP_DICT)
+        keep = SVG_GZIP_DICT - len;
+    memmove(gz->dict, gz->dict + gz->dictLen - keep, keep);
+    memcpy(gz->dict + keep, data, len);
+    gz->dictLen = keep + len;
+}
+
+// start compressing the filled batch (after the previous one)
+static bool gzip_launch(svgGzip *gz) {
+    if (!gzip_wait(gz))
+        return false;
+    // the previous batch is done, its end primes the new one
+    gzip_dict_update(gz, gz->batch[1], gz->compressed);
+    char *data = gz->batch[0];
+    gz->batch[0] = gz->batch[1];
+    gz->batch[1] = data;
+    gz->compressed = gz->fill;
+    gz->fill = 0;
+
+    for (size_t off = 0; off < gz->compressed; off += SVG_GZIP_BLOCK) {
+        gzipBlock *b = &(gz->blocks[gz->count++]);
+        b->data = data + off;
+        b->len = gz->compressed - off;
+        if (b->len > SVG_GZIP_BLOCK)
+            b->len = SVG_GZIP_BLOCK;
+        b->dict = off ? b->data - SVG_GZIP_DICT : gz->dict;
+        b->dictLen = off ? SVG_GZIP_DICT : gz->dictLen;
+        b->level = gz->level;
+#ifdef SVG_GZIP_THREADS
+        b->threaded = pthread_create(&(b->thread), NULL, gzip_block_deflate,
+                                     b) == 0;
+#endif
+        // compressed here if no thread could be started
+        if (!b->threaded)
+            gzip_block_deflate(b);
+    }
+    return true;
+}
+
+static size_t gzip_write(const char *data, size_t size, void *ctx) {
+    svgGzip *gz = (svgGzip *)ctx;
+    if (gz->threads <= 1)
+        return gzip_deflate(gz, data, size, Z_NO_FLUSH) ? size : 0;
+
+    size_t batch = (size_t)gz->threads * SVG_GZIP_BLOCK;
+    size_t left = size;
+    while (left) {
+        size_t n = batch - gz->fill;
+        if (n > left)
+            n = left;
+        memcpy(gz->batch[0] + gz->fill, data, n);
+        gz->fill += n;
+        data += n;
+        left -= n;
+        if (gz->fill == batch && !gzip_launch(gz))
+            return 0;
+    }
+    return size;
+}
+
+static void gzip_append_le32(svgWriter *w, uint32_t v) {
+    char tmp[4] = {(char)(v & 0xff), (char)((v >> 8) & 0xff),
+                   (char)((v >> 16) & 0xff), (char)((v >> 24) & 0xff)};
+    svg_append(w, tmp, sizeof(tmp));
+}
+
+bool svg_writer_gzip(svgWriter *w, int level, unsigned int threads) {
+    if (w->error || w->gzip)
+        return !w->error;
+    svgGzip *gz = (svgGzip *)calloc(1, sizeof(svgGzip));
+    if (gz == NULL) {
+        w->error = true;
+        return false;
+    }
+    if (level <= 0)
+        gz->level = Z_DEFAULT_COMPRESSION;
+    else
+        gz->level = level > 9 ? 9 : level;
+#ifdef SVG_GZIP_THREADS
+    gz->threads =
+        threads > SVG_GZIP_MAX_THREADS ? SVG_GZIP_MAX_THREADS : threads;
+#else
+    (void)threads;
+    gz->threads = 1;
+#endif
+
+    // the compressed data goes where the svg would have gone
+    bool ok = svg_writer_init(&(gz->sink), w->file, w->callback, w->ctx);
+    if (ok && gz->threads > 1) {
+        size_t batch = (size_t)gz->threads * SVG_GZIP_BLOCK;
+        gz->batch[0] = (char *)malloc(batch);
+        gz->batch[1] = (char *)malloc(batch);
+        gz->blocks = (gzipBlock *)calloc(gz->threads, sizeof(gzipBlock));
+        ok = gz->batch[0] && gz->batch[1] && gz->blocks;
+        gz->crc = crc32(0L, Z_NULL, 0);
+        // gzip header: deflate, no flags, no time, unix
+        svg_append(&(gz->sink), "\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\x03",
+                   10);
+    } else if (ok) {
+        // gzip wrapper around the deflate stream
+        ok = deflateInit2(&(gz->strm), gz->level, Z_DEFLATED, 15 + 16, 8,
+                          Z_DEFAULT_STRATEGY) == Z_OK;
+        gz->strmInit = ok;
+    }
+    if (!ok) {
+        svg_gzip_free(gz);
+        w->error = true;
+        return false;
+    }
+    w->file = NULL;
+    w->callback = gzip_write;
+    w->ctx = gz;
+    w->gzip = gz;
+    return true;
+}
+
+// end the gzip stream (the writer buffer is already flushed) and restore
+// the output of the writer, in memory it gets the compressed data
+bool svg_gzip_finish(svgWriter *w) {
+    svgGzip *gz = w->gzip;
+    svgWriter *sink = &(gz->sink);
+    bool ok;
+    if (gz->threads > 1) {
+        ok = gzip_launch(gz) && gzip_wait(gz);
+        // empty final block (fixed huffman), crc and size of the svg
+        svg_append(sink, "\x03\x00", 2);
+        gzip_append_le32(sink, (uint32_t)gz->crc);
+        gzip_append_le32(sink, (uint32_t)(gz->total & 0xffffffff));
+    } else {
+        ok = gzip_deflate(gz, NULL, 0, Z_FINISH);
+    }
+    ok = svg_writer_flush(sink) && ok;
+
+    w->file = sink->file;
+    w->callback = sink->callback;
+    w->ctx = sink->ctx;
+    if (w->file == NULL && w->callback == NULL) {
+        free(w->buf);
+        w->buf = sink->buf;
+        w->len = sink->len;
+        w->size = sink->size;
+        sink->buf = NULL;
+    }
+    svg_gzip_free(gz);
+    w->gzip = NULL;
+    if (!ok)
+        w->error = true;
+    return ok;
+}
+
+void svg_gzip_free(svgGzip *gz) {
+    gzip_join(gz);
+    if (gz->blocks) {
+        for (unsigned int i = 0; i < gz->threads; i++)
+            free(gz->blocks[i].out);
+    }
+    free(gz->blocks);
+    free(gz->batch[0]);
+    free(gz->batch[1]);
+    if (gz->strmInit)
+        deflateEnd(&(gz->strm));
+    svg_writer_free(&(gz->sink));
+    free(gz);
+}
+
+#ifdef __cplusplus
+}
+#endif
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
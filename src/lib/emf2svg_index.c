@@ -0,0 +1,380 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DARWIN
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "emf2svg_private.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The first pass over the records checks their sizes and associates each
+// path with the records drawing it (FILLPATH, STROKEPATH...) and with the
+// transformations set inside of it, which are applied at BEGINPATH or
+// ENDPATH. Its result is kept in a generatorIndex, with the record offsets,
+// the device context nesting and the object creations, so a caller
+// converting the same EMF several times only does it once.
+
+static void index_message(drawingStates *states, uint32_t recnum, size_t off,
+                          const char *message) {
+    if (states != NULL)
+        trace_message(states, recnum, off, message);
+}
+
+// make room for one more item in array, and in array2 if not NULL (size
+// is the number of items both have room for)
+static bool index_grow(void **array, void **array2, uint32_t *size,
+                       uint32_t count, size_t item, size_t item2) {
+    if (count < *size)
+        return true;
+    if (*size >= UINT32_MAX / 2)
+        return false;
+    uint32_t new_size = *size ? *size * 2 : 16;
+    void *tmp = realloc(*array, (size_t)new_size * item);
+    if (tmp == NULL)
+        return false;
+    *array = tmp;
+    if (array2 != NULL) {
+        tmp = realloc(*array2, (size_t)new_size * item2);
+        if (tmp == NULL)
+            return false;
+        *array2 = tmp;
+    }
+    *size = new_size;
+    return true;
+}
+
+// give back the unused part of array
+static void index_shrink(void **array, uint32_t count, size_t item) {
+    if (count == 0)
+        return;
+    void *tmp = realloc(*array, (size_t)count * item);
+    if (tmp != NULL)
+        *array = tmp;
+}
+
+static bool index_object_record(uint32_t iType) {
+    switch (iType) {
+    case U_EMR_CREATEPEN:
+    case U_EMR_CREATEBRUSHINDIRECT:
+    case U_EMR_CREATEPALETTE:
+    case U_EMR_EXTCREATEFONTINDIRECTW:
+    case U_EMR_CREATEMONOBRUSH:
+    case U_EMR_CREATEDIBPATTERNBRUSHPT:
+    case U_EMR_EXTCREATEPEN:
+    case U_EMR_CREATECOLORSPACE:
+    case U_EMR_CREATECOLORSPACEW:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// transformation set inside a path (same as the former first pass): once
+// a point of the path was drawn, it is recorded as wtBefore, applied at
+// BEGINPATH, before any point is drawn, as wtAfter, applied at ENDPATH
+static void index_path_transform(pathStruct *path, bool pathDrawn,
+                                 uint32_t iMode, U_XFORM xform) {
+    if (pathDrawn) {
+        path->wtBeforeSet = true;
+        path->wtBeforeiMode = iMode;
+        path->wtBeforexForm = xform;
+    } else {
+        path->wtAfterSet = true;
+        path->wtAfteriMode = iMode;
+        path->wtAfterxForm = xform;
+    }
+}
+
+int index_build(const char *contents, size_t length, generatorIndex *index,
+                drawingStates *states) {
+    uint32_t recordSize = 0;
+    uint32_t saveSize = 0;
+    uint32_t pathSize = 0;
+    uint32_t objectSize = 0;
+    bool inPath = false;
+    bool pathDrawn = false;
+    int32_t depth = 0;
+    size_t off = 0;
+    int err = 1;
+
+    memset(index, 0, sizeof(generatorIndex));
+    index->length = length;
+
+    while (true) {
+        uint32_t recnum = index->count;
+        if (off >= length) { // normally should exit from while after EMREOF
+                             // this is most likely a corrupt EMF
+            index_message(states, recnum, off,
+                          "WARNING(scanning): record claims to extend beyond "
+                          "the end of the EMF file");
+            err = 0;
+            break;
+        }
+        if (length - off < sizeof(U_EMR)) {
+            index_message(
+                states, recnum, off,
+                "ABORTING(scanning): invalid record - corrupted file?");
+            break;
+        }
+
+        PU_ENHMETARECORD pEmr = (PU_ENHMETARECORD)(contents + off);
+        uint32_t size = pEmr->nSize;
+        uint32_t iType = pEmr->iType;
+
+        if (!recnum && (iType != U_EMR_HEADER)) {
+            index_message(states, recnum, off,
+                          "WARNING(scanning): EMF file does not begin with an "
+                          "EMR_HEADER record");
+            err = 0;
+            break;
+        }
+        if (recnum && (iType == U_EMR_HEADER)) {
+            index_message(states, recnum, off,
+                          "ABORTING(scanning): EMF contains two or more "
+                          "EMR_HEADER records");
+            err = 0;
+            break;
+        }
+
+        // more records than the budget, no need to draw them
+        if (states != NULL && states->budget.maxRecords &&
+            recnum >= states->budget.maxRecords) {
+            states->budget.exceeded = EMF2SVG_BUDGET_RECORDS;
+            index_message(states, recnum, off,
+                          "ABORTING(scanning): resource budget exceeded");
+            err = 0;
+            break;
+        }
+
+        // check that the record size is OK, abort if not
+        if (size < sizeof(U_EMR) || size > length - off) {
+            index_message(
+                states, recnum, off,
+                "ABORTING(scanning): invalid record - corrupted file?");
+            break;
+        }
+
+        if (!index_grow((void **)&(index->offsets), (void **)&(index->types),
+                        &recordSize, recnum, sizeof(size_t),
+                        sizeof(uint8_t))) {
+            index_message(states, recnum, off,
+                          "ABORTING(scanning): failed to allocate the index");
+            err = 0;
+            break;
+        }
+        index->offsets[recnum] = off;
+        index->types[recnum] = iType <= UINT8_MAX ? (uint8_t)iType : 0;
+        index->count++;
+
+        pathStruct *last = index->pathCount
+                               ? &((pathStruct *)index->pathData)
+                                      [index->pathCount - 1]
+                               : NULL;
+        bool failed = false;
+        switch (iType) {
+        case U_EMR_EOF:
+            index->complete = true;
+            break;
+        case U_EMR_SAVEDC:
+        case U_EMR_RESTOREDC:
+            if (iType == U_EMR_SAVEDC) {
+                depth++;
+            } else if (size >= sizeof(U_EMRRESTOREDC)) {
+                // negative, relative to the current device context
+                int32_t iRelative = ((PU_EMRRESTOREDC)pEmr)->iRelative;
+                if (iRelative < 0)
+                    depth = iRelative < -depth ? 0 : depth + iRelative;
+            }
+            if (!index_grow((void **)&(index->saves), NULL, &saveSize,
+                            index->saveCount, sizeof(generatorIndexSave), 0)) {
+                failed = true;
+                break;
+            }
+            index->saves[index->saveCount].record = recnum;
+            index->saves[index->saveCount].depth = depth;
+            index->saveCount++;
+            break;
+        case U_EMR_BEGINPATH:
+            if (!index_grow((void **)&(index->paths), &(index->pathData),
+                            &pathSize, index->pathCount,
+                            sizeof(generatorIndexPath), sizeof(pathStruct))) {
+                failed = true;
+                break;
+            }
+            index->paths[index->pathCount].begin = recnum;
+            index->paths[index->pathCount].end = UINT32_MAX;
+            memset(&((pathStruct *)index->pathData)[index->pathCount], 0,
+                   sizeof(pathStruct));
+            index->pathCount++;
+            inPath = true;
+            break;
+        case U_EMR_ENDPATH:
+            if (inPath)
+                index->paths[index->pathCount - 1].end = recnum;
+            inPath = false;
+            pathDrawn = false;
+            break;
+        case U_EMR_POLYBEZIER:
+        case U_EMR_POLYGON:
+        case U_EMR_POLYLINE:
+        case U_EMR_POLYBEZIERTO:
+        case U_EMR_POLYLINETO:
+        case U_EMR_POLYPOLYLINE:
+        case U_EMR_POLYPOLYGON:
+        case U_EMR_SETWINDOWEXTEX:
+        case U_EMR_LINETO:
+        case U_EMR_ARCTO:
+        case U_EMR_POLYDRAW:
+        case U_EMR_POLYBEZIER16:
+        case U_EMR_POLYGON16:
+        case U_EMR_POLYLINE16:
+        case U_EMR_POLYBEZIERTO16:
+        case U_EMR_POLYLINETO16:
+        case U_EMR_POLYPOLYLINE16:
+        case U_EMR_POLYPOLYGON16:
+        case U_EMR_POLYDRAW16:
+            if (inPath)
+                pathDrawn = true;
+            break;
+        case U_EMR_FILLPATH:
+            if (last != NULL)
+                last->fillOffset = off;
+            break;
+        case U_EMR_STROKEANDFILLPATH:
+            if (last != NULL)
+                last->strokeFillOffset = off;
+            break;
+        case U_EMR_STROKEPATH:
+            if (last != NULL)
+                last->strokeOffset = off;
+            break;
+        case U_EMR_FLATTENPATH:
+            if (last != NULL)
+                last->flattenOffset = off;
+            break;
+        case U_EMR_WIDENPATH:
+            if (last != NULL)
+                last->widdenOffset = off;
+            break;
+        case U_EMR_SELECTCLIPPATH:
+            if (last != NULL)
+                last->clipOffset = off;
+            break;
+        case U_EMR_ABORTPATH:
+            if (last != NULL)
+                last->abortOffset = off;
+            break;
+        case U_EMR_SETWORLDTRANSFORM:
+            if (inPath && size >= sizeof(U_EMRSETWORLDTRANSFORM))
+                index_path_transform(last, pathDrawn, 0,
+                                     ((PU_EMRSETWORLDTRANSFORM)pEmr)->xform);
+            break;
+        case U_EMR_MODIFYWORLDTRANSFORM:
+            if (inPath && size >= sizeof(U_EMRMODIFYWORLDTRANSFORM)) {
+                PU_EMRMODIFYWORLDTRANSFORM pModify =
+                    (PU_EMRMODIFYWORLDTRANSFORM)pEmr;
+                index_path_transform(last, pathDrawn, pModify->iMode,
+                                     pModify->xform);
+            }
+            break;
+        default:
+            // ihPen, ihBrush, ihFont... follow the record header
+            if (index_object_record(iType) &&
+                size >= sizeof(U_EMR) + sizeof(uint32_t)) {
+                if (!index_grow((void **)&(index->objects), NULL, &objectSize,
+                                index->objectCount,
+                                sizeof(generatorIndexObject), 0)) {
+                    failed = true;
+                    break;
+                }
+                generatorIndexObject *object =
+                    &(index->objects[index->objectCount]);
+                object->record = recnum;
+                object->type = iType;
+                memcpy(&(object->handle), (const char *)pEmr + sizeof(U_EMR),
+                       sizeof(uint32_t));
+                index->objectCount++;
+            }
+            break;
+        }
+        if (failed) {
+            index_message(states, recnum, off,
+                          "ABORTING(scanning): failed to allocate the index");
+            err = 0;
+            break;
+        }
+        if (iType == U_EMR_EOF)
+            break;
+        off += size;
+    }
+
+    index_shrink((void **)&(index->offsets), index->count, sizeof(size_t));
+    index_shrink((void **)&(index->types), index->count, sizeof(uint8_t));
+    index_shrink((void **)&(index->saves), index->saveCount,
+                 sizeof(generatorIndexSave));
+    index_shrink((void **)&(index->paths), index->pathCount,
+                 sizeof(generatorIndexPath));
+    index_shrink(&(index->pathData), index->pathCount, sizeof(pathStruct));
+    index_shrink((void **)&(index->objects), index->objectCount,
+                 sizeof(generatorIndexObject));
+    return err;
+}
+
+void index_clear(generatorIndex *index) {
+    free(index->offsets);
+    free(index->types);
+    free(index->saves);
+    free(index->paths);
+    free(index->pathData);
+    free(index->objects);
+    memset(index, 0, sizeof(generatorIndex));
+}
+
+generatorIndex *emf2svg_index(const char *contents, size_t length,
+                              generatorOptions *options) {
+#if U_BYTE_SWAP
+    // the conversions swap the contents, the offsets would not be checked
+    // against the same data
+    UNUSED(contents);
+    UNUSED(length);
+    UNUSED(options);
+    return NULL;
+#else
+    generatorIndex *index = (generatorIndex *)calloc(1, sizeof(generatorIndex));
+    if (index == NULL)
+        return NULL;
+    drawingStates *states = NULL;
+    if (options != NULL && (options->verbose || options->trace)) {
+        // for the messages only
+        states = (drawingStates *)calloc(1, sizeof(drawingStates));
+        if (states != NULL) {
+            states->verbose = options->verbose;
+            states->trace.callback = options->trace;
+            states->trace.ctx = options->traceCtx;
+        }
+    }
+    int err = index_build(contents, length, index, states);
+    free(states);
+    if (!err) {
+        emf2svg_index_free(index);
+        return NULL;
+    }
+    return index;
+#endif
+}
+
+void emf2svg_index_free(generatorIndex *index) {
+    if (index == NULL)
+        return;
+    index_clear(index);
+    free(index);
+}
+
+#ifdef __cplusplus
+}
+#endif
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,178 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DARWIN
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "emf2svg_private.h"
+#include <stdio.h>
+
+// Interned tables: pens, brushes and fonts are stored once, the object table
+// and the device contexts only hold their ids. Selecting an object or saving
+// a device context is then a copy of a few integers, and two styles are
+// equal if their ids are.
+
+// FNV-1a
+static uint32_t intern_hash(const void *data, size_t len) {
+    const unsigned char *p = (const unsigned char *)data;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static const void *intern_key(const emfInternTable *table, uint32_t id,
+                              size_t *len) {
+    if (table->strings) {
+        const char *string = ((char **)table->items)[id];
+        *len = strlen(string);
+        return string;
+    }
+    *len = table->itemSize;
+    return table->items + (size_t)id * table->itemSize;
+}
+
+// slot of key: the slot holding its id, or the free slot where to add it
+static uint32_t *intern_slot(emfInternTable *table, const void *key,
+                             size_t len, uint32_t hash) {
+    uint32_t mask = table->slotCount - 1;
+    for (uint32_t i = hash & mask;; i = (i + 1) & mask) {
+        uint32_t *slot = &(table->slots[i]);
+        if (*slot == 0)
+            return slot;
+        size_t item_len;
+        const void *item = intern_key(table, *slot - 1, &item_len);
+        if (item_len == len && memcmp(item, key, len) == 0)
+            return slot;
+    }
+}
+
+// double the hash table (kept at most half full)
+static bool intern_rehash(emfInternTable *table) {
+    uint32_t count = table->slotCount ? table->slotCount * 2 : 64;
+    uint32_t *slots = (uint32_t *)calloc(count, sizeof(uint32_t));
+    if (slots == NULL)
+        return false;
+    free(table->slots);
+    table->slots = slots;
+    table->slotCount = count;
+    // the NULL string (id 0) is not hashed
+    for (uint32_t id = table->strings ? 1 : 0; id < table->count; id++) {
+        size_t len;
+        const void *key = intern_key(table, id, &len);
+        *intern_slot(table, key, len, intern_hash(key, len)) = id + 1;
+    }
+    return true;
+}
+
+bool intern_init(emfInternTable *table, size_t itemSize, bool strings) {
+    *table = (emfInternTable){0};
+    table->itemSize = strings ? sizeof(char *) : itemSize;
+    table->strings = strings;
+    table->size = 16;
+    table->items = (char *)calloc(table->size, table->itemSize);
+    if (table->items == NULL)
+        return false;
+    // id 0: zeroed item
+    table->count = 1;
+    return intern_rehash(table);
+}
+
+void intern_free(emfInternTable *table) {
+    if (table->strings && table->items != NULL) {
+        for (uint32_t id = 1; id < table->count; id++)
+            free(((char **)table->items)[id]);
+    }
+    free(table->items);
+    free(table->slots);
+    *table = (emfInternTable){0};
+}
+
+bool intern_copy(emfInternTable *dest, const emfInternTable *src) {
+    *dest = *src;
+    dest->items = (char *)malloc((size_t)src->size * src->itemSize);
+    dest->slots = (uint32_t *)malloc(src->slotCount * sizeof(uint32_t));
+    if (dest->items == NULL || dest->slots == NULL) {
+        dest->count = 0;
+        return false;
+    }
+    memcpy(dest->items, src->items, (size_t)src->count * src->itemSize);
+    memcpy(dest->slots, src->slots, src->slotCount * sizeof(uint32_t));
+    if (!src->strings)
+        return true;
+    for (uint32_t id = 1; id < src->count; id++) {
+        const char *string = ((char **)src->items)[id];
+        char *copy = (char *)malloc(strlen(string) + 1);
+        if (copy == NULL) {
+            // only the strings copied so far are freed
+            dest->count = id;
+            return false;
+        }
+        strcpy(copy, string);
+        ((char **)dest->items)[id] = copy;
+    }
+    return true;
+}
+
+static uint32_t intern_add(drawingStates *states, emfInternTable *table,
+                           const void *key, size_t len, const void *item) {
+    if (table->slots == NULL) {
+        states->Error = true;
+        return 0;
+    }
+    uint32_t hash = intern_hash(key, len);
+    uint32_t *slot = intern_slot(table, key, len, hash);
+    if (*slot != 0)
+        return *slot - 1;
+    if (table->count == UINT32_MAX - 1) {
+        states->Error = true;
+        return 0;
+    }
+    if (table->count == table->size) {
+        char *items = (char *)realloc(
+            table->items, (size_t)table->size * 2 * table->itemSize);
+        if (items == NULL) {
+            states->Error = true;
+            return 0;
+        }
+        table->items = items;
+        table->size *= 2;
+    }
+    uint32_t id = table->count++;
+    memcpy(table->items + (size_t)id * table->itemSize, item, table->itemSize);
+    if (table->count * 2 > table->slotCount) {
+        if (!intern_rehash(table)) {
+            states->Error = true;
+            return 0;
+        }
+    } else {
+        *slot = id + 1;
+    }
+    return id;
+}
+
+uint32_t intern_item(drawingStates *states, emfInternTable *table,
+                     const void *item) {
+    return intern_add(states, table, item, table->itemSize, item);
+}
+
+uint32_t intern_string(drawingStates *states, emfInternTable *table,
+                       char *string) {
+    if (string == NULL)
+        return 0;
+    uint32_t count = table->count;
+    uint32_t id = intern_add(states, table, string, strlen(string), &string);
+    // already known (or error), the table does not keep this copy
+    if (table->count == count)
+        free(string);
+    return id;
+}
+
+#ifdef __cplusplus
+}
+#endif
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
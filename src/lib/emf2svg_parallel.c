@@ -0,0 +1,557 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DARWIN
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "emf2svg_private.h"
+#include <stdlib.h>
+#include <string.h>
+#ifndef _MSC_VER
+#include <pthread.h>
+#define PARALLEL_THREADS
+#endif
+
+// fewest records of a range
+#define PARALLEL_MIN_RECORDS 32
+#define PARALLEL_MAX_THREADS 256
+
+// With options->drawThreads, the records are cut in ranges, each one
+// converted by its own thread in its own drawing states and output buffer.
+//
+// The ranges start after a top-level RESTOREDC when there is one close to an
+// even split, never inside of a path (both found in the record index). The
+// states at their start are snapshots (states_copy()) taken by a single
+// pass over the records, each range being started as soon as its snapshot
+// is taken. The pass draws in a discarded output: the objects, device
+// contexts, transformations, clipping regions and paths are set as usual,
+// but the images are not decoded and the drawing records outside of paths
+// only open the clipping group they would be drawn in (parallel_skip()). A
+// polygon or polyline is only skipped if nothing after it reads the current
+// position or the current path it leaves (parallel_replay()), the snapshots
+// are then the states of the sequential conversion, the clip ids being
+// derived from the record numbers (get_id()).
+//
+// Once converted, the outputs are written in order. As a safety net, the
+// states a range started from are compared to the states the previous
+// range ended with (the ones the drawing records change), on a difference
+// the conversion goes on sequentially from the end of the previous range.
+//
+// The budgets are checked in each range on its own resources, then the ones
+// of the ranges before it are added (parallel_budget()): if that exceeds a
+// budget, the conversion also goes on from the end of the previous range, to
+// stop on the record the sequential conversion stops on.
+
+// states compared at the start of a range
+typedef struct {
+    int clipGroupID;
+    int clipID;
+    bool inPath;
+    bool transformOpen;
+    size_t pixels;
+    uint32_t pathNext;
+} parallelStates;
+
+typedef struct {
+    char *contents;
+    size_t length;
+    generatorIndex *index;
+    drawingStates *states;
+    // records first to last (excluded) are drawn in out, the ones before
+    // first in discard (snapshot pass)
+    uint32_t first;
+    uint32_t last;
+    // next record to draw
+    uint32_t next;
+    svgWriter out;
+    svgWriter discard;
+    // length of out at the last budget check
+    size_t checked;
+    // states at first, with the drawn flags of the clip library entries
+    parallelStates start;
+    bool *drawn;
+    size_t drawnCount;
+    // no snapshot, or failed to save the states at first
+    bool failed;
+    // stopped on an invalid record, or on the EOF record
+    bool error;
+    bool eof;
+    // converted by its own thread (to join)
+    bool threaded;
+#ifdef PARALLEL_THREADS
+    pthread_t thread;
+#endif
+} parallelRange;
+
+// records which can be skipped by the snapshot pass (if outside of paths):
+// the texts and shapes, the polygons and polylines only if the current
+// position and the current path they leave are set again before being read
+static uint8_t *parallel_replay(generatorIndex *index) {
+    uint8_t *replay = (uint8_t *)calloc(index->count, sizeof(uint8_t));
+    if (replay == NULL)
+        return NULL;
+    bool posRead = false;
+    bool pathRead = false;
+    for (uint32_t i = index->count; i-- > 0;) {
+        switch (index->types[i]) {
+        case U_EMR_POLYGON:
+        case U_EMR_POLYLINE:
+        case U_EMR_POLYPOLYLINE:
+        case U_EMR_POLYPOLYGON:
+        case U_EMR_POLYGON16:
+        case U_EMR_POLYLINE16:
+        case U_EMR_POLYPOLYLINE16:
+        case U_EMR_POLYPOLYGON16:
+            replay[i] = !posRead && !pathRead;
+            break;
+        case U_EMR_RECTANGLE:
+        case U_EMR_ROUNDRECT:
+        case U_EMR_ELLIPSE:
+        case U_EMR_EXTTEXTOUTA:
+        case U_EMR_EXTTEXTOUTW:
+        case U_EMR_SMALLTEXTOUT:
+            replay[i] = 1;
+            break;
+        // records drawing from the current position
+        case U_EMR_LINETO:
+        case U_EMR_POLYLINETO:
+        case U_EMR_POLYLINETO16:
+        case U_EMR_POLYBEZIER:
+        case U_EMR_POLYBEZIER16:
+        case U_EMR_POLYBEZIERTO:
+        case U_EMR_POLYBEZIERTO16:
+        case U_EMR_POLYDRAW:
+        case U_EMR_POLYDRAW16:
+        case U_EMR_ARC:
+        case U_EMR_ARCTO:
+        case U_EMR_ANGLEARC:
+        case U_EMR_CHORD:
+        case U_EMR_PIE:
+            posRead = true;
+            break;
+        case U_EMR_MOVETOEX:
+            posRead = false;
+            break;
+        case U_EMR_SELECTCLIPPATH:
+            pathRead = true;
+            break;
+        case U_EMR_BEGINPATH:
+        case U_EMR_ABORTPATH:
+            pathRead = false;
+            break;
+        default:
+            break;
+        }
+    }
+    return replay;
+}
+
+bool parallel_skip(drawingStates *states, const char *contents,
+                   svgWriter *out) {
+    EMF_DEVICE_CONTEXT *dc = &(states->currentDeviceContext);
+    switch (((PU_EMR)contents)->iType) {
+    case U_EMR_POLYGON:
+    case U_EMR_POLYLINE:
+        clipset_draw_poly(states, out, contents, false, false);
+        return true;
+    case U_EMR_POLYGON16:
+    case U_EMR_POLYLINE16:
+        clipset_draw_poly(states, out, contents, true, false);
+        return true;
+    case U_EMR_POLYPOLYLINE:
+    case U_EMR_POLYPOLYGON:
+        clipset_draw_poly(states, out, contents, false, true);
+        return true;
+    case U_EMR_POLYPOLYLINE16:
+    case U_EMR_POLYPOLYGON16:
+        clipset_draw_poly(states, out, contents, true, true);
+        return true;
+    case U_EMR_RECTANGLE:
+    case U_EMR_ROUNDRECT:
+    case U_EMR_ELLIPSE:
+        // the group depends on the box of the shape (clipset_draw_box())
+        if (dc->clipID && (dc->clipRGN == NULL || dc->clipRectOnly))
+            return false;
+        clipset_draw(states, out);
+        return true;
+    default:
+        clipset_draw(states, out);
+        return true;
+    }
+}
+
+static parallelStates parallel_states(drawingStates *states) {
+    parallelStates s;
+    memset(&s, 0, sizeof(s));
+    s.clipGroupID = states->clipGroupID;
+    s.clipID = states->currentDeviceContext.clipID;
+    s.inPath = states->inPath;
+    s.transformOpen = states->transform_open;
+    s.pixels = states->pixelRun.count;
+    s.pathNext = states->emfStructure.next;
+    return s;
+}
+
+// save the states at the first record of the range, its counters start
+static void parallel_start(parallelRange *r) {
+    drawingStates *states = r->states;
+    states->replay = NULL;
+    states->currentDeviceContext.dirty = DC_DIRTY_ALL;
+    r->start = parallel_states(states);
+    size_t count = 0;
+    for (int i = 0; i < CLIP_LIBRARY_BUCKETS; i++) {
+        for (emfClipLibrary *c = states->clipLibrary[i]; c; c = c->next)
+            count++;
+    }
+    r->drawn = (bool *)malloc(count ? count * sizeof(bool) : 1);
+    if (r->drawn == NULL) {
+        r->failed = true;
+    } else {
+        for (int i = 0; i < CLIP_LIBRARY_BUCKETS; i++) {
+            for (emfClipLibrary *c = states->clipLibrary[i]; c; c = c->next)
+                r->drawn[r->drawnCount++] = c->drawn;
+        }
+    }
+    states->culledRecords = 0;
+    states->imagesTime = 0;
+    states->fontsTime = 0;
+    states->budget.records = 0;
+    states->budget.imagePixels = 0;
+    states->budget.outputBase = 0;
+}
+
+// draw the records of the range up to last (excluded)
+static void parallel_records(parallelRange *r, uint32_t last) {
+    drawingStates *states = r->states;
+    const char *blimit = r->contents + r->length;
+    while (r->next < last) {
+        if (r->next == r->first)
+            parallel_start(r);
+        svgWriter *out = r->next < r->first ? &(r->discard) : &(r->out);
+        if (out == &(r->out) && states->budget.enabled) {
+            r->checked = out->len;
+            if (budget_check(states, out)) {
+                r->error = true;
+                return;
+            }
+        }
+        int result = U_emf_onerec_draw(r->contents, blimit, r->next,
+                                       r->index->offsets[r->next], out,
+                                       states);
+        if (result == -1 || states->Error) {
+            r->error = true;
+            return;
+        }
+        if (!result) {
+            r->eof = true;
+            return;
+        }
+        r->next++;
+    }
+}
+
+#ifdef PARALLEL_THREADS
+static void *parallel_range_run(void *arg) {
+    parallelRange *r = (parallelRange *)arg;
+    parallel_records(r, r->last);
+    return NULL;
+}
+#endif
+
+// start converting the range in its own thread (if possible)
+static void parallel_launch(parallelRange *r) {
+#ifdef PARALLEL_THREADS
+    r->threaded =
+        pthread_create(&(r->thread), NULL, parallel_range_run, r) == 0;
+#else
+    UNUSED(r);
+#endif
+}
+
+// convert the range (or wait for its thread)
+static void parallel_wait(parallelRange *r) {
+#ifdef PARALLEL_THREADS
+    if (r->threaded) {
+        pthread_join(r->thread, NULL);
+        r->threaded = false;
+        return;
+    }
+#endif
+    if (r->states != NULL)
+        parallel_records(r, r->last);
+}
+
+// take the snapshots the ranges after the first one start from, in one pass
+// over the records before them, and start them
+static void parallel_snapshots(parallelRange *ranges, uint32_t used,
+                               drawingStates *states) {
+    parallelRange pass;
+    memset(&pass, 0, sizeof(pass));
+    pass.contents = ranges[0].contents;
+    pass.length = ranges[0].length;
+    pass.index = ranges[0].index;
+    pass.first = pass.index->count;
+    pass.discard.error = true;
+    pass.states = states;
+    for (uint32_t k = 1; k < used; k++) {
+        parallelRange *r = &(ranges[k]);
+        if (pass.states != NULL)
+            parallel_records(&pass, r->first);
+        if (pass.states == NULL || pass.error || pass.eof) {
+            r->failed = true;
+            continue;
+        }
+        // the last range takes the states of the pass
+        if (k == used - 1) {
+            r->states = pass.states;
+            pass.states = NULL;
+        } else {
+            r->states = states_copy(pass.states);
+        }
+        if (r->states == NULL) {
+            r->failed = true;
+            continue;
+        }
+        parallel_launch(r);
+    }
+    if (pass.states != NULL)
+        states_free(pass.states);
+}
+
+// true if range r started from the states prev ended with
+static bool parallel_match(parallelRange *prev, parallelRange *r) {
+    if (r->failed || r->next == r->first || prev->next != r->first)
+        return false;
+    parallelStates end = parallel_states(prev->states);
+    if (end.clipGroupID != r->start.clipGroupID ||
+        end.clipID != r->start.clipID || end.inPath != r->start.inPath ||
+        end.transformOpen != r->start.transformOpen ||
+        end.pixels != r->start.pixels || end.pathNext != r->start.pathNext)
+        return false;
+    size_t n = 0;
+    for (int i = 0; i < CLIP_LIBRARY_BUCKETS; i++) {
+        emfClipLibrary *c = prev->states->clipLibrary[i];
+        for (; c; c = c->next) {
+            if (n == r->drawnCount || c->drawn != r->drawn[n])
+                return false;
+            n++;
+        }
+    }
+    return n == r->drawnCount;
+}
+
+// true if a budget is exceeded by range r once added the resources used up
+// to the end of range prev, which are otherwise added to the ones of r
+static bool parallel_budget(parallelRange *prev, parallelRange *r) {
+    emfBudget *before = &(prev->states->budget);
+    emfBudget *budget = &(r->states->budget);
+    if (!budget->enabled)
+        return false;
+    size_t output = before->outputBase + prev->out.len;
+    if (budget->exceeded ||
+        (budget->maxRecords &&
+         before->records + budget->records > budget->maxRecords) ||
+        (budget->maxOutput && output + r->checked > budget->maxOutput) ||
+        (budget->maxImagePixels &&
+         before->imagePixels + budget->imagePixels > budget->maxImagePixels))
+        return true;
+    budget->records += before->records;
+    budget->imagePixels += before->imagePixels;
+    budget->outputBase = output;
+    return false;
+}
+
+// path containing record (between its BEGINPATH and ENDPATH), NULL if none
+static generatorIndexPath *parallel_path(generatorIndex *index,
+                                         uint32_t record) {
+    uint32_t lo = 0;
+    uint32_t hi = index->pathCount;
+    // first path beginning at or after record
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (index->paths[mid].begin < record)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == 0 || index->paths[lo - 1].end < record)
+        return NULL;
+    return &(index->paths[lo - 1]);
+}
+
+// first record of range k of count: the one following the top-level
+// RESTOREDC closest to an even split (within half a range), else the first
+// record out of a path from the split (index->count if none)
+static uint32_t parallel_split(generatorIndex *index, uint32_t k,
+                               uint32_t count) {
+    uint32_t target = (uint32_t)((uint64_t)index->count * k / count);
+    uint32_t window = index->count / count / 2;
+    uint32_t best = UINT32_MAX;
+    uint32_t bestDistance = UINT32_MAX;
+    for (uint32_t i = 0; i < index->saveCount; i++) {
+        generatorIndexSave *save = &(index->saves[i]);
+        if (index->types[save->record] != U_EMR_RESTOREDC || save->depth)
+            continue;
+        uint32_t record = save->record + 1;
+        uint32_t distance =
+            record > target ? record - target : target - record;
+        if (distance <= window && distance < bestDistance &&
+            parallel_path(index, record) == NULL) {
+            best = record;
+            bestDistance = distance;
+        }
+    }
+    if (best != UINT32_MAX)
+        return best;
+    generatorIndexPath *path;
+    while ((path = parallel_path(index, target)) != NULL) {
+        if (path->end >= index->count - 1)
+            return index->count;
+        target = path->end + 1;
+    }
+    return target;
+}
+
+bool parallel_enabled(drawingStates *states, generatorIndex *index,
+                      generatorOptions *options) {
+    // the verbose output, trace, statistics and progress follow the records
+    // in order, the memory estimate does not count the outputs of the other
+    // ranges, the EMF+ records and the merged paths keep states out of
+    // drawingStates
+    return options->drawThreads > 1 && index->complete &&
+           index->count >= 2 * PARALLEL_MIN_RECORDS && states->tiles == NULL &&
+           !isVerbose(states) && states->trace.callback == NULL &&
+           states->stats == NULL && !states->budget.maxMemory &&
+           options->progress == NULL && !states->emfplus &&
+           !states->mergePaths;
+}
+
+int parallel_draw(char *contents, size_t length, generatorIndex *index,
+                  svgWriter *out, drawingStates *states,
+                  generatorOptions *options, int *recnum) {
+    uint32_t count = options->drawThreads;
+    if (count > PARALLEL_MAX_THREADS)
+        count = PARALLEL_MAX_THREADS;
+    if (count > index->count / PARALLEL_MIN_RECORDS)
+        count = index->count / PARALLEL_MIN_RECORDS;
+    uint8_t *replay = parallel_replay(index);
+    parallelRange *ranges =
+        (parallelRange *)calloc(count, sizeof(parallelRange));
+    if (replay == NULL || ranges == NULL)
+        count = 1;
+    parallelRange single;
+    if (ranges == NULL) {
+        memset(&single, 0, sizeof(single));
+        ranges = &single;
+    }
+
+    // the first range is converted in states, the other ones in snapshots
+    uint32_t used = 0;
+    for (uint32_t k = 0; k < count; k++) {
+        parallelRange *r = &(ranges[used]);
+        r->first = k ? parallel_split(index, k, count) : 0;
+        if (used && r->first <= ranges[used - 1].first)
+            continue;
+        if (r->first >= index->count - 1)
+            break;
+        r->contents = contents;
+        r->length = length;
+        r->index = index;
+        r->next = r->first;
+        if (!svg_writer_init(&(r->out), NULL, NULL, NULL)) {
+            svg_writer_free(&(r->out));
+            break;
+        }
+        if (used)
+            ranges[used - 1].last = r->first;
+        used++;
+    }
+    if (used)
+        ranges[used - 1].last = index->count;
+
+    // states of the snapshot pass, set before the first range changes
+    // states
+    drawingStates *pass = NULL;
+    if (used > 1) {
+        pass = states_new(contents, length, NULL, options);
+        if (pass != NULL) {
+            pass->emfStructure = states->emfStructure;
+            pass->inPath = states->inPath;
+            pass->currentDeviceContext.dirty = DC_DIRTY_ALL;
+            pass->replay = replay;
+            pass->idBase = states->idBase;
+            pass->budget = states->budget;
+        }
+    }
+    if (used) {
+        ranges[0].states = states;
+        parallel_launch(&(ranges[0]));
+        parallel_snapshots(ranges, used, pass);
+    }
+
+    int err = 0;
+    uint32_t drawn = 0;
+    if (used) {
+        parallel_wait(&(ranges[0]));
+        drawn = 1;
+    }
+    for (uint32_t k = 1; k < used; k++) {
+        parallelRange *prev = &(ranges[k - 1]);
+        if (prev->error || prev->eof)
+            break;
+        parallel_wait(&(ranges[k]));
+        if (!parallel_match(prev, &(ranges[k])) ||
+            parallel_budget(prev, &(ranges[k]))) {
+            // go on from the end of the previous range
+            parallel_records(prev, index->count);
+            break;
+        }
+        drawn++;
+    }
+#ifdef PARALLEL_THREADS
+    for (uint32_t k = 1; k < used; k++) {
+        if (ranges[k].threaded)
+            pthread_join(ranges[k].thread, NULL);
+    }
+#endif
+
+    if (drawn) {
+        parallelRange *last = &(ranges[drawn - 1]);
+        // the records must end with the EOF record
+        err = last->eof && !last->error;
+        *recnum = (int)last->next;
+        if (last->states->budget.exceeded)
+            states->budget.exceeded = last->states->budget.exceeded;
+        options->drawRanges = drawn;
+    }
+    for (uint32_t k = 0; k < drawn; k++) {
+        if (ranges[k].out.error)
+            out->error = true;
+        svg_append(out, ranges[k].out.buf, ranges[k].out.len);
+        if (k) {
+            states->culledRecords += ranges[k].states->culledRecords;
+            states->imagesTime += ranges[k].states->imagesTime;
+            states->fontsTime += ranges[k].states->fontsTime;
+        }
+    }
+    if (out->error)
+        err = 0;
+
+    for (uint32_t k = 0; k < used; k++) {
+        if (k && ranges[k].states != NULL)
+            states_free(ranges[k].states);
+        svg_writer_free(&(ranges[k].out));
+        free(ranges[k].drawn);
+    }
+    if (ranges != &single)
+        free(ranges);
+    free(replay);
+    return err;
+}
+
+#ifdef __cplusplus
+}
+#endif
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,658 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DARWIN
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "emf2svg_private.h"
+#include <math.h>
+#include <stdio.h>
+
+// Compound paths (mergePaths option): consecutive POLY*, LINETO and RECTANGLE
+// records drawn with the same pen and brush, in the same clipping group, are
+// written as the subpaths of a single <path>. The path is written when a
+// record which is not one of them, or which only changes states not used
+// by them (see U_emf_onerec_draw), arrives.
+//
+// Filling all the subpaths then stroking them gives the same result as
+// drawing the shapes one after the other as long as the painted shapes do
+// not overlap (with their stroke, unless it has the fill color). Lines are
+// always merged.
+
+// maximum number of painted shapes in a path (overlap tests)
+#define PATH_RUN_MAX_BOXES 1024
+
+static bool box_overlap(RECT_D a, RECT_D b) {
+    return a.left < b.right && b.left < a.right && a.top < b.bottom &&
+           b.top < a.bottom;
+}
+
+// if the shape of box can be added to the path
+static bool path_run_accepts(drawingStates *states, int group, bool filled,
+                             bool painted, RECT_D box) {
+    emfPathRun *run = &(states->pathRun);
+    EMF_DEVICE_CONTEXT *dc = &(states->currentDeviceContext);
+    if (run->filled != filled || run->pen != dc->pen ||
+        run->brush != dc->brush || run->miterLimit != dc->miterLimit ||
+        run->clipGroupID != group)
+        return false;
+    if (!painted || !box_overlap(run->box, box))
+        return true;
+    if (run->boxCount >= PATH_RUN_MAX_BOXES)
+        return false;
+    for (size_t i = 0; i < run->boxCount; i++) {
+        if (box_overlap(run->boxes[i], box))
+            return false;
+    }
+    return true;
+}
+
+// start the drawing of a shape (geometry bounding box), the previous
+// shapes are written if it cannot be merged with them
+// returns false if the shape is not drawn (completely clipped)
+static bool path_run_start(drawingStates *states, svgWriter *out, RECT_D box,
+                           bool filled) {
+    emfPathRun *run = &(states->pathRun);
+    EMF_DEVICE_CONTEXT *dc = &(states->currentDeviceContext);
+    int group = clipset_box_group(states, box, true);
+    if (group < 0)
+        return false;
+
+    bool painted = filled && currentBrush(states)->mode != U_BS_NULL;
+    RECT_D painted_box = box;
+    // the stroke is drawn over the fill of the other shapes, unless it is
+    // the 1px stroke of the fill color of null pens
+    if ((currentPen(states)->mode & 0x000000FF) != U_PS_NULL ||
+        currentBrush(states)->mode != U_BS_SOLID) {
+        double margin = stroke_margin(states);
+        painted_box.left -= margin;
+        painted_box.top -= margin;
+        painted_box.right += margin;
+        painted_box.bottom += margin;
+    }
+    if (run->count &&
+        !path_run_accepts(states, group, filled, painted, painted_box))
+        path_run_flush(states, out);
+
+    // only switches the group for the first shape
+    clipset_draw_box(states, out, box, true);
+    if (run->count == 0) {
+        path_data_start(states, &(states->pathData));
+        run->filled = filled;
+        run->pen = dc->pen;
+        run->brush = dc->brush;
+        run->miterLimit = dc->miterLimit;
+        run->clipGroupID = states->clipGroupID;
+        run->style.len = 0;
+        bool filled_style = false;
+        bool stroked = false;
+        if (filled)
+            fill_draw(states, &(run->style), &filled_style, &stroked);
+        stroke_draw(states, &(run->style), &filled_style, &stroked);
+        if (!filled_style)
+            svg_append_literal(&(run->style), "fill=\"none\" ");
+        if (!stroked)
+            svg_append_literal(&(run->style), "stroke=\"none\" ");
+        run->box = painted_box;
+    } else {
+        run->box.left = fmin(run->box.left, painted_box.left);
+        run->box.top = fmin(run->box.top, painted_box.top);
+        run->box.right = fmax(run->box.right, painted_box.right);
+        run->box.bottom = fmax(run->box.bottom, painted_box.bottom);
+    }
+    if (painted) {
+        if (run->boxCount == run->boxSize) {
+            size_t size = run->boxSize ? run->boxSize * 2 : 64;
+            RECT_D *boxes =
+                (RECT_D *)realloc(run->boxes, size * sizeof(RECT_D));
+            if (boxes == NULL) {
+                states->Error = true;
+                return false;
+            }
+            run->boxes = boxes;
+            run->boxSize = size;
+        }
+        run->boxes[run->boxCount++] = painted_box;
+    }
+    run->count++;
+    return true;
+}
+
+// POLYGON, POLYLINE, POLYPOLYGON and POLYPOLYLINE records (and their 16 bits
+// versions), outside of paths
+void path_run_poly(drawingStates *states, svgWriter *out,
+                   const char *contents) {
+    bool is16 = false;
+    bool polypolygon = false;
+    bool filled = false;
+    switch (((PU_EMR)contents)->iType) {
+    case U_EMR_POLYGON16:
+        is16 = true;
+        filled = true;
+        break;
+    case U_EMR_POLYGON:
+        filled = true;
+        break;
+    case U_EMR_POLYLINE16:
+        is16 = true;
+        break;
+    case U_EMR_POLYLINE:
+        break;
+    case U_EMR_POLYPOLYGON16:
+        is16 = true;
+        filled = true;
+        polypolygon = true;
+        break;
+    case U_EMR_POLYPOLYGON:
+        filled = true;
+        polypolygon = true;
+        break;
+    case U_EMR_POLYPOLYLINE16:
+        is16 = true;
+        polypolygon = true;
+        break;
+    case U_EMR_POLYPOLYLINE:
+        polypolygon = true;
+        break;
+    default:
+        return;
+    }
+    // also checks that the points are in the emf file
+    RECT_D box;
+    if (!poly_box(states, contents, is16, polypolygon, &box) ||
+        !path_run_start(states, out, box, filled))
+        return;
+
+    svgWriter *d = &(states->pathRun.d);
+    if (!polypolygon) {
+        PU_EMRPOLYLINE pEmr = (PU_EMRPOLYLINE)(contents);
+        poly_points_draw(states, d, (const char *)pEmr->aptl, is16,
+                         pEmr->cptl, true);
+        if (filled)
+            path_data_cmd(&(states->pathData), d, 'Z');
+        return;
+    }
+    PU_EMRPOLYPOLYLINE pEmr = (PU_EMRPOLYPOLYLINE)(contents);
+    const char *pts = (const char *)pEmr->aPolyCounts +
+                      sizeof(uint32_t) * (uint64_t)pEmr->nPolys;
+    size_t pointSize = is16 ? sizeof(U_POINT16) : sizeof(U_POINT);
+    uint32_t index = 0;
+    for (uint32_t i = 0; i < pEmr->nPolys && index < pEmr->cptl; i++) {
+        uint32_t count = pEmr->aPolyCounts[i];
+        if (count == 0)
+            continue;
+        if (count > pEmr->cptl - index)
+            count = pEmr->cptl - index;
+        poly_points_draw(states, d, pts + pointSize * index, is16, count,
+                         true);
+        index += count;
+        if (filled)
+            path_data_cmd(&(states->pathData), d, 'Z');
+    }
+}
+
+// LINETO record, outside of paths
+void path_run_line(drawingStates *states, svgWriter *out,
+                   const char *contents) {
+    PU_EMRLINETO pEmr = (PU_EMRLINETO)(contents);
+    returnOutOfEmf(contents + sizeof(U_EMRLINETO));
+    U_POINT pt;
+    pt.x = states->cur_x;
+    pt.y = states->cur_y;
+    if (!path_run_start(states, out,
+                        rect_d(point_s(states, pt), point_s(states, pEmr->ptl)),
+                        false))
+        return;
+    svgWriter *d = &(states->pathRun.d);
+    path_data_cmd(&(states->pathData), d, 'M');
+    point_draw(states, pt, d);
+    path_data_cmd(&(states->pathData), d, 'L');
+    point_draw(states, pEmr->ptl, d);
+}
+
+// RECTANGLE record (corners in output coordinates)
+void path_run_rect(drawingStates *states, svgWriter *out, POINT_D LT,
+                   POINT_D RB) {
+    if (!path_run_start(states, out, rect_d(LT, RB), true))
+        return;
+    svgWriter *d = &(states->pathRun.d);
+    emfPathData *pd = &(states->pathData);
+    POINT_D RT = {RB.x, LT.y};
+    POINT_D LB = {LT.x, RB.y};
+    path_data_cmd(pd, d, 'M');
+    path_data_point(pd, d, LT);
+    path_data_cmd(pd, d, 'L');
+    path_data_point(pd, d, RT);
+    path_data_cmd(pd, d, 'L');
+    path_data_point(pd, d, RB);
+    path_data_cmd(pd, d, 'L');
+    path_data_point(pd, d, LB);
+    path_data_cmd(pd, d, 'Z');
+}
+
+// write the path
+void path_run_flush(drawingStates *states, svgWriter *out) {
+    emfPathRun *run = &(states->pathRun);
+    if (run->count == 0)
+        return;
+    if (run->d.error || run->style.error) {
+        out->error = true;
+    } else {
+        svg_append_literal(out, "<");
+        svg_append_string(out, states->nameSpaceString);
+        svg_append_literal(out, "path d=\"");
+        svg_append(out, run->d.buf, run->d.len);
+        path_data_end(&(states->pathData), out, false);
+        svg_append(out, run->style.buf, run->style.len);
+        svg_append_literal(out, "/>\n");
+    }
+    run->count = 0;
+    run->d.len = 0;
+    run->boxCount = 0;
+}
+
+void path_run_free(drawingStates *states) {
+    emfPathRun *run = &(states->pathRun);
+    svg_writer_free(&(run->d));
+    svg_writer_free(&(run->style));
+    free(run->boxes);
+    *run = (emfPathRun){0};
+}
+
+// Polyline simplification (simplifyTolerance option): the points are
+// transformed, the points closer than half the tolerance to the previous
+// point kept are dropped (linear, removes most points of dense plots), then
+// the remaining ones are simplified with Douglas-Peucker at half the
+// tolerance. Only points of the original polyline are kept, so the result
+// does not deviate more than the tolerance and stays in the bounding box.
+
+static bool simplify_reserve(drawingStates *states, uint32_t count) {
+    emfSimplify *s = &(states->simplify);
+    if (count <= s->size)
+        return true;
+    size_t size = s->size ? s->size : 256;
+    while (size < count)
+        size *= 2;
+    POINT_D *points = (POINT_D *)realloc(s->points, size * sizeof(POINT_D));
+    if (points != NULL)
+        s->points = points;
+    bool *keep = (bool *)realloc(s->keep, size * sizeof(bool));
+    if (keep != NULL)
+        s->keep = keep;
+    uint32_t *stack =
+        (uint32_t *)realloc(s->stack, 2 * size * sizeof(uint32_t));
+    if (stack != NULL)
+        s->stack = stack;
+    if (points == NULL || keep == NULL || stack == NULL)
+        return false;
+    s->size = size;
+    return true;
+}
+
+static double distance2(POINT_D a, POINT_D b) {
+    return (a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y);
+}
+
+// square of the distance between p and the segment from a to a + (dx, dy),
+// len2 being its squared length
+static double segment_distance2(POINT_D p, POINT_D a, double dx, double dy,
+                                double len2) {
+    double px = p.x - a.x;
+    double py = p.y - a.y;
+    double dot = px * dx + py * dy;
+    if (dot <= 0 || len2 == 0)
+        return px * px + py * py;
+    if (dot >= len2) {
+        px -= dx;
+        py -= dy;
+        return px * px + py * py;
+    }
+    double cross = px * dy - py * dx;
+    return cross * cross / len2;
+}
+
+// simplify the count transformed points, returns the number of points left
+// (marked in keep)
+static uint32_t simplify_points(emfSimplify *s, uint32_t count,
+                                double tolerance) {
+    POINT_D *p = s->points;
+    double max2 = tolerance * tolerance / 4;
+
+    uint32_t n = 1;
+    for (uint32_t i = 1; i < count - 1; i++) {
+        if (distance2(p[i], p[n - 1]) >= max2)
+            p[n++] = p[i];
+    }
+    p[n++] = p[count - 1];
+
+    for (uint32_t i = 0; i < n; i++)
+        s->keep[i] = false;
+    s->keep[0] = true;
+    s->keep[n - 1] = true;
+    uint32_t kept = 2;
+    // each range pushed has at least one point less than its parent, and
+    // the ranges on the stack do not share inner points: at most n ranges
+    size_t top = 0;
+    s->stack[top++] = 0;
+    s->stack[top++] = n - 1;
+    while (top) {
+        uint32_t last = s->stack[--top];
+        uint32_t first = s->stack[--top];
+        double dx = p[last].x - p[first].x;
+        double dy = p[last].y - p[first].y;
+        double len2 = dx * dx + dy * dy;
+        double dmax = max2;
+        uint32_t index = 0;
+        for (uint32_t i = first + 1; i < last; i++) {
+            double d = segment_distance2(p[i], p[first], dx, dy, len2);
+            if (d > dmax) {
+                dmax = d;
+                index = i;
+            }
+        }
+        if (index == 0)
+            continue;
+        s->keep[index] = true;
+        kept++;
+        if (index - first > 1) {
+            s->stack[top++] = first;
+            s->stack[top++] = index;
+        }
+        if (last - index > 1) {
+            s->stack[top++] = index;
+            s->stack[top++] = last;
+        }
+    }
+    uint32_t j = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        if (s->keep[i])
+            p[j++] = p[i];
+    }
+    return kept;
+}
+
+void poly_points_draw(drawingStates *states, svgWriter *out, const char *pts,
+                      bool is16, uint32_t count, bool move) {
+    if (count == 0)
+        return;
+    PU_POINT16 pts16 = (PU_POINT16)pts;
+    PU_POINT pts32 = (PU_POINT)pts;
+    if (states->simplifyTolerance <= 0 || count < 3) {
+        for (uint32_t i = 0; i < count; i++) {
+            if (move && i == 0)
+                path_data_cmd(&(states->pathData), out, 'M');
+            else
+                path_data_cmd(&(states->pathData), out, 'L');
+            if (is16)
+                point16_draw(states, pts16[i], out);
+            else
+                point_draw(states, pts32[i], out);
+        }
+        return;
+    }
+    if (!simplify_reserve(states, count)) {
+        states->Error = true;
+        return;
+    }
+    emfSimplify *s = &(states->simplify);
+    for (uint32_t i = 0; i < count; i++) {
+        if (is16)
+            s->points[i] = point_s16(states, pts16[i]);
+        else
+            s->points[i] = point_s(states, pts32[i]);
+    }
+    if (is16) {
+        states->cur_x = pts16[count - 1].x;
+        states->cur_y = pts16[count - 1].y;
+    } else {
+        states->cur_x = pts32[count - 1].x;
+        states->cur_y = pts32[count - 1].y;
+    }
+    uint32_t kept = simplify_points(s, count, states->simplifyTolerance);
+    for (uint32_t i = 0; i < kept; i++) {
+        if (move && i == 0)
+            path_data_cmd(&(states->pathData), out, 'M');
+        else
+            path_data_cmd(&(states->pathData), out, 'L');
+        path_data_point(&(states->pathData), out, s->points[i]);
+    }
+}
+
+void simplify_free(drawingStates *states) {
+    emfSimplify *s = &(states->simplify);
+    free(s->points);
+    free(s->keep);
+    free(s->stack);
+    *s = (emfSimplify){0};
+}
+
+// Path data (compactPaths option): coordinates are rounded to 1 decimal
+// when logical units are at least one pixel (MM_TEXT at scale 1 say),
+// to 2 decimals otherwise, trailing zeros are not written (integers stay
+// integers). The path is drawn inside the world transform group, which
+// magnifies the rounding: one more decimal is kept per power of 10 of its
+// scale. Coordinates are written relative to the rounded previous point,
+// so the rounding errors do not add up. Command letters are only written
+// when they change, separators only when needed.
+
+// max number of decimals of the path data
+#define PATH_DATA_MAX_PRECISION 6
+
+// largest scale factor of the world transform (its largest singular value)
+static double world_scale(drawingStates *states) {
+    U_XFORM w = states->currentDeviceContext.worldTransform;
+    double a = w.eM11, b = w.eM12, c = w.eM21, d = w.eM22;
+    double sum = a * a + b * b + c * c + d * d;
+    double det = a * d - b * c;
+    double disc = sum * sum - 4 * det * det;
+    return sqrt((sum + sqrt(disc > 0 ? disc : 0)) / 2);
+}
+
+void path_data_start(drawingStates *states, emfPathData *pd) {
+    *pd = (emfPathData){0};
+    pd->compact = states->compactPaths;
+    double unit = fmin(fabs(scaleX(states, 1.0)), fabs(scaleY(states, 1.0)));
+    if (unit >= 1.0) {
+        pd->precision = 1;
+        pd->scale = 10;
+    } else {
+        pd->precision = 2;
+        pd->scale = 100;
+    }
+    // (with some slack for the float rounding of the rotations)
+    double world = world_scale(states);
+    while (world > 1.001 && pd->precision < PATH_DATA_MAX_PRECISION) {
+        pd->precision++;
+        pd->scale *= 10;
+        world /= 10.0;
+    }
+}
+
+static int64_t path_data_fixed(emfPathData *pd, double v) {
+    double f = round(v * (double)pd->scale);
+    // also for NaN and infinity
+    if (!(f > -1e15))
+        return (int64_t)-1e15;
+    if (!(f < 1e15))
+        return (int64_t)1e15;
+    return (int64_t)f;
+}
+
+// write v / scale, without trailing zeros nor leading zero
+static void path_data_number(emfPathData *pd, svgWriter *out, int64_t v) {
+    char tmp[32];
+    int i = sizeof(tmp);
+    uint64_t n = v < 0 ? -(uint64_t)v : (uint64_t)v;
+    bool dot = false;
+    if (pd->precision) {
+        uint64_t frac = n % (uint64_t)pd->scale;
+        n /= (uint64_t)pd->scale;
+        int digits = pd->precision;
+        while (digits && frac % 10 == 0) {
+            frac /= 10;
+            digits--;
+        }
+        for (int d = 0; d < digits; d++) {
+            tmp[--i] = '0' + frac % 10;
+            frac /= 10;
+        }
+        if (digits) {
+            tmp[--i] = '.';
+            dot = true;
+        }
+    }
+    if (n || !dot) {
+        do {
+            tmp[--i] = '0' + n % 10;
+            n /= 10;
+        } while (n);
+    }
+    if (v < 0)
+        tmp[--i] = '-';
+    if (pd->sep && tmp[i] != '-' && !(tmp[i] == '.' && pd->dot))
+        svg_append_literal(out, " ");
+    svg_append(out, tmp + i, sizeof(tmp) - i);
+    pd->sep = true;
+    pd->dot = dot;
+}
+
+static void path_data_letter(emfPathData *pd, svgWriter *out, char letter) {
+    svg_append(out, &letter, 1);
+    pd->last = letter;
+    pd->sep = false;
+    pd->dot = false;
+}
+
+void path_data_cmd(emfPathData *pd, svgWriter *out, char cmd) {
+    if (!pd->compact) {
+        switch (cmd) {
+        case 'M':
+            svg_append_literal(out, "M ");
+            break;
+        case 'L':
+            svg_append_literal(out, "L ");
+            break;
+        case 'C':
+            svg_append_literal(out, "C ");
+            break;
+        case 'A':
+            svg_append_literal(out, "A ");
+            break;
+        case 'Z':
+            svg_append_literal(out, "Z ");
+            break;
+        }
+        return;
+    }
+    if (cmd == 'Z') {
+        path_data_letter(pd, out, 'z');
+        pd->x = pd->startX;
+        pd->y = pd->startY;
+        return;
+    }
+    pd->cmd = cmd;
+    pd->arg = 0;
+}
+
+void path_data_point(emfPathData *pd, svgWriter *out, POINT_D pt) {
+    if (!pd->compact) {
+        svg_append_point(out, pt.x, pt.y);
+        return;
+    }
+    int64_t x = path_data_fixed(pd, pt.x);
+    int64_t y = path_data_fixed(pd, pt.y);
+    switch (pd->cmd) {
+    case 'C':
+        // the 3 points of a segment are relative to its start
+        if (pd->arg % 3 == 0) {
+            if (pd->last != 'c')
+                path_data_letter(pd, out, 'c');
+            pd->baseX = pd->x;
+            pd->baseY = pd->y;
+        }
+        path_data_number(pd, out, x - pd->baseX);
+        path_data_number(pd, out, y - pd->baseY);
+        if (pd->arg % 3 == 2) {
+            pd->x = x;
+            pd->y = y;
+        }
+        break;
+    case 'A':
+        // radii, then end point
+        if (pd->arg == 0) {
+            path_data_letter(pd, out, 'a');
+            path_data_number(pd, out, x);
+            path_data_number(pd, out, y);
+        } else {
+            path_data_number(pd, out, x - pd->x);
+            path_data_number(pd, out, y - pd->y);
+            pd->x = x;
+            pd->y = y;
+        }
+        break;
+    case 'M':
+        // points after the first one of a moveto are linetos
+        if (pd->arg == 0)
+            path_data_letter(pd, out, 'm');
+        path_data_number(pd, out, x - pd->x);
+        path_data_number(pd, out, y - pd->y);
+        pd->x = x;
+        pd->y = y;
+        if (pd->arg == 0) {
+            pd->startX = x;
+            pd->startY = y;
+        }
+        break;
+    default:
+        if (pd->last != 'l' && pd->last != 'm')
+            path_data_letter(pd, out, 'l');
+        path_data_number(pd, out, x - pd->x);
+        path_data_number(pd, out, y - pd->y);
+        pd->x = x;
+        pd->y = y;
+        break;
+    }
+    pd->arg++;
+}
+
+void path_data_arc(emfPathData *pd, svgWriter *out, POINT_D radii,
+                   int largeArc, int sweep, POINT_D end) {
+    path_data_cmd(pd, out, 'A');
+    path_data_point(pd, out, radii);
+    if (pd->compact) {
+        int64_t scale = pd->scale;
+        int precision = pd->precision;
+        // integers
+        pd->scale = 1;
+        pd->precision = 0;
+        path_data_number(pd, out, 0);
+        path_data_number(pd, out, largeArc);
+        path_data_number(pd, out, sweep);
+        pd->scale = scale;
+        pd->precision = precision;
+    } else {
+        svg_append_literal(out, "0 ");
+        svg_append_int(out, largeArc);
+        svg_append_literal(out, " ");
+        svg_append_int(out, sweep);
+        svg_append_literal(out, " ");
+    }
+    path_data_point(pd, out, end);
+}
+
+void path_data_end(emfPathData *pd, svgWriter *out, bool close) {
+    if (close) {
+        if (pd->compact)
+            path_data_letter(pd, out, 'z');
+        else
+            svg_append_literal(out, "Z");
+    }
+    svg_append_literal(out, "\" ");
+}
+
+#ifdef __cplusplus
+}
+#endif
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
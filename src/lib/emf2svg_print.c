@@ -56,15 +56,15 @@ void fill_print(drawingStates *states) {
         verbose_printf("   Fill Rule:      UNKNOWN\n");
         break;
     }
-    switch (states->currentDeviceContext.fill_mode) {
+    switch (currentBrush(states)->mode) {
     case U_BS_SOLID:
         verbose_printf(
             "   Fill Mode:      BS_SOLID          Status: %sSUPPORTED%s\n",
             KGRN, KNRM);
         verbose_printf("   Fill Color:     #%02X%02X%02X\n",
-                       states->currentDeviceContext.fill_red,
-                       states->currentDeviceContext.fill_green,
-                       states->currentDeviceContext.fill_blue);
+                       currentBrush(states)->color.Red,
+                       currentBrush(states)->color.Green,
+                       currentBrush(states)->color.Blue);
         break;
     case U_BS_NULL:
         verbose_printf(
@@ -113,7 +113,7 @@ void fill_print(drawingStates *states) {
         break;
     default:
         verbose_printf("   Fill Mode:      %x     %sUNKNOWN%s\n",
-                       states->currentDeviceContext.stroke_mode, KRED, KNRM);
+                       currentPen(states)->mode, KRED, KNRM);
         break;
     }
     return;
@@ -121,16 +121,16 @@ void fill_print(drawingStates *states) {
 
 void stroke_print(drawingStates *states) {
     verbose_printf("   Stroke Mode:    0x%8.8X\n",
-                   states->currentDeviceContext.stroke_mode);
+                   currentPen(states)->mode);
 
     verbose_printf("   Stroke Color:   #%02X%02X%02X\n",
-                   states->currentDeviceContext.stroke_red,
-                   states->currentDeviceContext.stroke_green,
-                   states->currentDeviceContext.stroke_blue);
+                   currentPen(states)->color.Red,
+                   currentPen(states)->color.Green,
+                   currentPen(states)->color.Blue);
     verbose_printf("   Stroke Width:   %f\n",
-                   states->currentDeviceContext.stroke_width);
+                   currentPen(states)->width);
     // pen type
-    switch (states->currentDeviceContext.stroke_mode & 0x000F0000) {
+    switch (currentPen(states)->mode & 0x000F0000) {
     case U_PS_COSMETIC:
         verbose_printf(
             "   Pen Type:       PS_COSMETIC       Status: %sSUPPORTED%s\n",
@@ -143,12 +143,12 @@ void stroke_print(drawingStates *states) {
         break;
     default:
         verbose_printf("   Pen Type:       0x%X     %sUNKNOWN%s\n",
-                       states->currentDeviceContext.stroke_mode & 0x000F0000,
+                       currentPen(states)->mode & 0x000F0000,
                        KRED, KNRM);
         break;
     }
     // line style.
-    switch (states->currentDeviceContext.stroke_mode & 0x000000FF) {
+    switch (currentPen(states)->mode & 0x000000FF) {
     case U_PS_SOLID:
         verbose_printf(
             "   Line Mode:      PS_SOLID          Status: %sSUPPORTED%s\n",
@@ -196,13 +196,13 @@ void stroke_print(drawingStates *states) {
         break;
     default:
         verbose_printf("   Line Mode:      0x%X     %sUNKNOWN%s\n",
-                       states->currentDeviceContext.stroke_mode & 0x000000FF,
+                       currentPen(states)->mode & 0x000000FF,
                        KRED, KNRM);
 
         break;
     }
     // line cap.
-    switch (states->currentDeviceContext.stroke_mode & 0x00000F00) {
+    switch (currentPen(states)->mode & 0x00000F00) {
     case U_PS_ENDCAP_ROUND:
         verbose_printf(
             "   Line Cap:       PS_ENDCAP_ROUND   Status: %sSUPPORTED%s\n",
@@ -220,13 +220,13 @@ void stroke_print(drawingStates *states) {
         break;
     default:
         verbose_printf("   Line Cap:       0x%X     %sUNKNOWN%s\n",
-                       states->currentDeviceContext.stroke_mode & 0x00000F00,
+                       currentPen(states)->mode & 0x00000F00,
                        KRED, KNRM);
 
         break;
     }
     // line join.
-    switch (states->currentDeviceContext.stroke_mode & 0x0000F000) {
+    switch (currentPen(states)->mode & 0x0000F000) {
     case U_PS_JOIN_ROUND:
         verbose_printf(
             "   Line Join:      U_PS_JOIN_ROUND   Status: %sSUPPORTED%s\n",
@@ -244,7 +244,7 @@ void stroke_print(drawingStates *states) {
         break;
     default:
         verbose_printf("   Line Join:      0x%X     %sUNKNOWN%s\n",
-                       states->currentDeviceContext.stroke_mode & 0x0000F000,
+                       currentPen(states)->mode & 0x0000F000,
                        KRED, KNRM);
         break;
     }
@@ -567,7 +567,7 @@ void logfont_print(drawingStates *states, U_LOGFONT lf) {
         break;
     default:
         verbose_printf("lfCharSet:<Unknown charset [0x%X] >",
-                       states->currentDeviceContext.font_charset);
+                       currentFont(states)->charset);
         break;
     }
     verbose_printf("lfOutPrecision:0x%2.2X ", lf.lfOutPrecision);
@@ -12,10 +12,10 @@ extern "C" {
 #include <stdio.h>
 #include <stdlib.h>
 
-void U_EMRALPHABLEND_draw(const char *contents, FILE *out,
+void U_EMRALPHABLEND_draw(const char *contents, svgWriter *out,
                           drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRALPHABLEND_print(contents, states);
     }
 
@@ -40,20 +40,26 @@ void U_EMRALPHABLEND_draw(const char *contents, FILE *out,
         point_cal(states, (double)pEmr->cDest.x, (double)pEmr->cDest.y);
     POINT_D position =
         point_cal(states, (double)pEmr->Dest.x, (double)pEmr->Dest.y);
-    fprintf(out, "<image width=\"%.4f\" height=\"%.4f\" x=\"%.4f\" y=\"%.4f\" ",
-            size.x, size.y, position.x, position.y);
+    POINT_D corner = {position.x + size.x, position.y + size.y};
+    if (!clipset_draw_box(states, out, rect_d(position, corner), false))
+        return;
+    svg_printf(out,
+               "<image width=\"%.4f\" height=\"%.4f\" x=\"%.4f\" y=\"%.4f\" ",
+               size.x, size.y, position.x, position.y);
 
     float alpha = (float)pEmr->Blend.Global / 255.0;
-    fprintf(out, " fill-opacity=\"%.4f\" ", alpha);
-    clipset_draw(states, out);
+    svg_append_literal(out, " fill-opacity=\"");
+    svg_append_number(out, alpha);
+    svg_append_literal(out, "\" ");
 
     dib_img_writer(contents, out, states, BmiSrc, BmpSrc,
                    (size_t)pEmr->cbBitsSrc, false);
-    fprintf(out, "/>\n");
+    svg_append_literal(out, "/>\n");
 }
-void U_EMRBITBLT_draw(const char *contents, FILE *out, drawingStates *states) {
+void U_EMRBITBLT_draw(const char *contents, svgWriter *out,
+                      drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRBITBLT_print(contents, states);
     }
     PU_EMRBITBLT pEmr = (PU_EMRBITBLT)(contents);
@@ -64,14 +70,14 @@ void U_EMRBITBLT_draw(const char *contents, FILE *out, drawingStates *states) {
         char style[256];
         if (pEmr->dwRop == U_NOOP)
             return;
-        if (states->currentDeviceContext.fill_mode == U_BS_MONOPATTERN) {
+        if (currentBrush(states)->mode == U_BS_MONOPATTERN) {
             sprintf(style, "fill:url(#img-%d-ref);",
-                    states->currentDeviceContext.fill_idx);
-        } else if (states->currentDeviceContext.fill_mode == U_BS_SOLID) {
+                    currentBrush(states)->idx);
+        } else if (currentBrush(states)->mode == U_BS_SOLID) {
             sprintf(style, "fill:#%02x%02x%02x",
-                    states->currentDeviceContext.fill_red,
-                    states->currentDeviceContext.fill_green,
-                    states->currentDeviceContext.fill_blue);
+                    currentBrush(states)->color.Red,
+                    currentBrush(states)->color.Green,
+                    currentBrush(states)->color.Blue);
         } else {
             style[0] = '\0';
         }
@@ -80,8 +86,15 @@ void U_EMRBITBLT_draw(const char *contents, FILE *out, drawingStates *states) {
                 point_cal(states, (double)pEmr->cDest.x, (double)pEmr->cDest.y);
             POINT_D position =
                 point_cal(states, (double)pEmr->Dest.x, (double)pEmr->Dest.y);
-            fprintf(out, "<%spath style=\"%s", states->nameSpaceString, style);
-            fprintf(
+            POINT_D corner = {position.x + size.x, position.y + size.y};
+            if (!clipset_draw_box(states, out, rect_d(position, corner),
+                                  false))
+                return;
+            svg_append_literal(out, "<");
+            svg_append_string(out, states->nameSpaceString);
+            svg_append_literal(out, "path style=\"");
+            svg_append_string(out, style);
+            svg_printf(
                 out,
                 "\" d=\"M %.4f,%.4f L %.4f,%.4f L %.4f,%.4f L %.4f,%.4f Z\" />",
                 position.x, position.y, position.x + size.x, position.y,
@@ -114,43 +127,48 @@ void U_EMRBITBLT_draw(const char *contents, FILE *out, drawingStates *states) {
         point_cal(states, (double)pEmr->cDest.x, (double)pEmr->cDest.y);
     POINT_D position =
         point_cal(states, (double)pEmr->Dest.x, (double)pEmr->Dest.y);
-    fprintf(out, "<image width=\"%.4f\" height=\"%.4f\" x=\"%.4f\" y=\"%.4f\" ",
-            size.x, size.y, position.x, position.y);
-    clipset_draw(states, out);
+    POINT_D corner = {position.x + size.x, position.y + size.y};
+    if (!clipset_draw_box(states, out, rect_d(position, corner), false))
+        return;
+    svg_printf(out,
+               "<image width=\"%.4f\" height=\"%.4f\" x=\"%.4f\" y=\"%.4f\" ",
+               size.x, size.y, position.x, position.y);
 
     // float alpha = (float)pEmr->Blend.Global / 255.0;
-    // fprintf(out, " fill-opacity=\"%.4f\" ", alpha);
+    // svg_printf(out, " fill-opacity=\"%.4f\" ", alpha);
 
     dib_img_writer(contents, out, states, BmiSrc, BmpSrc,
                    (size_t)pEmr->cbBitsSrc, false);
-    fprintf(out, "/>\n");
+    svg_append_literal(out, "/>\n");
 }
-void U_EMRMASKBLT_draw(const char *contents, FILE *out, drawingStates *states) {
+void U_EMRMASKBLT_draw(const char *contents, svgWriter *out,
+                       drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRMASKBLT_print(contents, states);
     }
     // PU_EMRMASKBLT pEmr = (PU_EMRMASKBLT) (contents);
 }
-void U_EMRPLGBLT_draw(const char *contents, FILE *out, drawingStates *states) {
+void U_EMRPLGBLT_draw(const char *contents, svgWriter *out,
+                      drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRPLGBLT_print(contents, states);
     }
     // PU_EMRPLGBLT pEmr = (PU_EMRPLGBLT) (contents);
 }
-void U_EMRSETDIBITSTODEVICE_draw(const char *contents, FILE *out,
+void U_EMRSETDIBITSTODEVICE_draw(const char *contents, svgWriter *out,
                                  drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETDIBITSTODEVICE_print(contents, states);
     }
     // PU_EMRSETDIBITSTODEVICE pEmr = (PU_EMRSETDIBITSTODEVICE) (contents);
 }
-void U_EMRSTRETCHBLT_draw(const char *contents, FILE *out,
+void U_EMRSTRETCHBLT_draw(const char *contents, svgWriter *out,
                           drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSTRETCHBLT_print(contents, states);
     }
     PU_EMRSTRETCHBLT pEmr = (PU_EMRSTRETCHBLT)(contents);
@@ -173,18 +191,21 @@ void U_EMRSTRETCHBLT_draw(const char *contents, FILE *out,
         point_cal(states, (double)pEmr->cDest.x, (double)pEmr->cDest.y);
     POINT_D position =
         point_cal(states, (double)pEmr->Dest.x, (double)pEmr->Dest.y);
-    fprintf(out, "<image width=\"%.4f\" height=\"%.4f\" x=\"%.4f\" y=\"%.4f\" ",
-            size.x, size.y, position.x, position.y);
-    clipset_draw(states, out);
+    POINT_D corner = {position.x + size.x, position.y + size.y};
+    if (!clipset_draw_box(states, out, rect_d(position, corner), false))
+        return;
+    svg_printf(out,
+               "<image width=\"%.4f\" height=\"%.4f\" x=\"%.4f\" y=\"%.4f\" ",
+               size.x, size.y, position.x, position.y);
 
     dib_img_writer(contents, out, states, BmiSrc, BmpSrc,
                    (size_t)pEmr->cbBitsSrc, false);
-    fprintf(out, "/>\n");
+    svg_append_literal(out, "/>\n");
 }
-void U_EMRSTRETCHDIBITS_draw(const char *contents, FILE *out,
+void U_EMRSTRETCHDIBITS_draw(const char *contents, svgWriter *out,
                              drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSTRETCHDIBITS_print(contents, states);
     }
     PU_EMRSTRETCHDIBITS pEmr = (PU_EMRSTRETCHDIBITS)(contents);
@@ -208,25 +229,29 @@ void U_EMRSTRETCHDIBITS_draw(const char *contents, FILE *out,
         point_cal(states, (double)pEmr->cDest.x, (double)pEmr->cDest.y);
     POINT_D position =
         point_cal(states, (double)pEmr->Dest.x, (double)pEmr->Dest.y);
-    fprintf(out, "<image width=\"%.4f\" height=\"%.4f\" x=\"%.4f\" y=\"%.4f\" ",
-            size.x, size.y, position.x, position.y);
-    clipset_draw(states, out);
+    POINT_D corner = {position.x + size.x, position.y + size.y};
+    if (!clipset_draw_box(states, out, rect_d(position, corner), false))
+        return;
+    svg_printf(out,
+               "<image width=\"%.4f\" height=\"%.4f\" x=\"%.4f\" y=\"%.4f\" ",
+               size.x, size.y, position.x, position.y);
 
     dib_img_writer(contents, out, states, BmiSrc, BmpSrc,
                    (size_t)pEmr->cbBitsSrc, false);
-    fprintf(out, "/>\n");
+    svg_append_literal(out, "/>\n");
 }
-void U_EMRTRANSPARENTBLT_draw(const char *contents, FILE *out,
+void U_EMRTRANSPARENTBLT_draw(const char *contents, svgWriter *out,
                               drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRTRANSPARENTBLT_print(contents, states);
     }
 }
 
-void dib_img_writer(const char *contents, FILE *out, drawingStates *states,
-                    PU_BITMAPINFOHEADER BmiSrc, const unsigned char *BmpSrc,
-                    size_t size, bool assign_mono_colors_from_dc) {
+static void dib_img_write(const char *contents, svgWriter *out,
+                          drawingStates *states, PU_BITMAPINFOHEADER BmiSrc,
+                          const unsigned char *BmpSrc, size_t size,
+                          bool assign_mono_colors_from_dc) {
     char *b64Bmp = NULL;
     size_t b64s;
     char *tmp = NULL;
@@ -235,15 +260,16 @@ void dib_img_writer(const char *contents, FILE *out, drawingStates *states,
     switch (BmiSrc->biCompression) {
     case U_BI_JPEG:
         b64Bmp = base64_encode(BmpSrc, size, &b64s);
-        fprintf(out, "xlink:href=\"data:image/jpg;base64,");
+        svg_append_literal(out, "xlink:href=\"data:image/jpg;base64,");
         break;
     case U_BI_PNG:
         b64Bmp = base64_encode(BmpSrc, size, &b64s);
-        fprintf(out, "xlink:href=\"data:image/png;base64,");
+        svg_append_literal(out, "xlink:href=\"data:image/png;base64,");
         break;
     }
     if (b64Bmp != NULL) {
-        fprintf(out, "%s\" ", b64Bmp);
+        svg_append_string(out, b64Bmp);
+        svg_append_literal(out, "\" ");
         free(b64Bmp);
         return;
     }
@@ -270,7 +296,7 @@ void dib_img_writer(const char *contents, FILE *out, drawingStates *states,
     RGBABitmap convert_inpng;
 
     // In any cases after that, we get a png blob
-    fprintf(out, "xlink:href=\"data:image/png;base64,");
+    svg_append_literal(out, "xlink:href=\"data:image/png;base64,");
 
     switch (BmiSrc->biCompression) {
     case U_BI_RLE8:
@@ -293,7 +319,8 @@ void dib_img_writer(const char *contents, FILE *out, drawingStates *states,
         e2s_get_DIB_params((PU_BITMAPINFO)BmiSrc, (const U_RGBQUAD **)&ct,
                            &numCt, &width, &height, &colortype, &invert);
     // if enable to read header, then exit
-    if (dibparams || width > MAX_BMP_WIDTH || height > MAX_BMP_HEIGHT) {
+    if (dibparams || width > MAX_BMP_WIDTH || height > MAX_BMP_HEIGHT ||
+        !budget_image(states, out, width, height)) {
         free(convert_out.pixels);
         states->Error = true;
         return;
@@ -309,13 +336,13 @@ void dib_img_writer(const char *contents, FILE *out, drawingStates *states,
     }
     if (colortype == U_BCBM_MONOCHROME) {
         if (assign_mono_colors_from_dc) {
-            monoCt[0].Red = states->currentDeviceContext.text_red;
-            monoCt[0].Green = states->currentDeviceContext.text_green;
-            monoCt[0].Blue = states->currentDeviceContext.text_blue;
+            monoCt[0].Red = states->currentDeviceContext.text_color.Red;
+            monoCt[0].Green = states->currentDeviceContext.text_color.Green;
+            monoCt[0].Blue = states->currentDeviceContext.text_color.Blue;
             monoCt[0].Reserved = 0xff;
-            monoCt[1].Red = states->currentDeviceContext.bk_red;
-            monoCt[1].Green = states->currentDeviceContext.bk_green;
-            monoCt[1].Blue = states->currentDeviceContext.bk_blue;
+            monoCt[1].Red = states->currentDeviceContext.bk_color.Red;
+            monoCt[1].Green = states->currentDeviceContext.bk_color.Green;
+            monoCt[1].Blue = states->currentDeviceContext.bk_color.Blue;
             monoCt[1].Reserved =
                 0xff; // states->currentDeviceContext.bk_mode ? 0xff : 0;
             ct = monoCt;
@@ -341,18 +368,32 @@ void dib_img_writer(const char *contents, FILE *out, drawingStates *states,
     }
 
     if (b64Bmp != NULL) {
-        fprintf(out, "%s\" ", b64Bmp);
+        svg_append_string(out, b64Bmp);
+        svg_append_literal(out, "\" ");
         free(b64Bmp);
     } else {
         // transparent 5x5 px png
-        fprintf(out, "iVBORw0KGgoAAAANSUhEUgAAAAUAAAAFCAYAAACNbyblAAAABGdBTUEAA"
-                     "LGPC/xhBQAAAAZiS0dEAP8A/wD/"
-                     "oL2nkwAAAAlwSFlzAAALEwAACxMBAJqcGAAAAAd0SU1FB+"
-                     "ABFREtOJX7FAkAAAAIdEVYdENvbW1lbnQA9syWvwAAAAxJREFUCNdjYKA"
-                     "TAAAAaQABwB3y+AAAAABJRU5ErkJggg==\" ");
+        svg_append_literal(
+            out,
+            "iVBORw0KGgoAAAANSUhEUgAAAAUAAAAFCAYAAACNbyblAAAABGdBTUEAALGPC/xhBQAAAAZiS0dEAP8A/wD/oL2nkwAAAAlwSFlzAAALEwAACxMBAJqcGAAAAAd0SU1FB+ABFREtOJX7FAkAAAAIdEVYdENvbW1lbnQA9syWvwAAAAxJREFUCNdjYKATAAAAaQABwB3y+AAAAABJRU5ErkJggg==\" ");
     }
 }
 
+void dib_img_writer(const char *contents, svgWriter *out, drawingStates *states,
+                    PU_BITMAPINFOHEADER BmiSrc, const unsigned char *BmpSrc,
+                    size_t size, bool assign_mono_colors_from_dc) {
+    // snapshot pass of a parallel conversion, the output is discarded
+    if (states->replay)
+        return;
+    double start = states->timing ? e2s_clock() : 0;
+    dib_img_write(contents, out, states, BmiSrc, BmpSrc, size,
+                  assign_mono_colors_from_dc);
+    if (states->timing)
+        states->imagesTime += e2s_clock() - start;
+    if (states->stats)
+        states->stats->imageEncodes++;
+}
+
 // Find an image that matches (otherwise return NULL)
 emfImageLibrary *image_library_find(emfImageLibrary *lib,
                                     PU_BITMAPINFOHEADER BmiSrc, size_t size) {
@@ -369,8 +410,11 @@ emfImageLibrary *image_library_create(int id, PU_BITMAPINFOHEADER BmiSrc,
                                       size_t size) {
     emfImageLibrary *image =
         (emfImageLibrary *)calloc(1, sizeof(emfImageLibrary) + size);
+    if (image == NULL)
+        return NULL;
     image->id = id;
     image->content = (PU_BITMAPINFOHEADER)(image + 1);
+    image->size = size;
     memcpy(image->content, BmiSrc, size);
     return image;
 }
@@ -403,9 +447,22 @@ void freeEmfImageLibrary(drawingStates *states) {
     }
 }
 
+// Copy the image library of src in dest
+bool image_library_copy(drawingStates *dest, drawingStates *src) {
+    emfImageLibrary **last = &(dest->library);
+    *last = NULL;
+    for (emfImageLibrary *lib = src->library; lib; lib = lib->next) {
+        *last = image_library_create(lib->id, lib->content, lib->size);
+        if (*last == NULL)
+            return false;
+        last = &((*last)->next);
+    }
+    return true;
+}
+
 // Lookup existing - or create and emit new image reference for use with image
 // brush
-emfImageLibrary *image_library_writer(const char *contents, FILE *out,
+emfImageLibrary *image_library_writer(const char *contents, svgWriter *out,
                                       drawingStates *states,
                                       PU_BITMAPINFOHEADER BmiSrc, size_t size,
                                       const unsigned char *BmpSrc) {
@@ -418,27 +475,186 @@ emfImageLibrary *image_library_writer(const char *contents, FILE *out,
             e2s_get_DIB_params((PU_BITMAPINFO)BmiSrc, (const U_RGBQUAD **)&ct,
                                &numCt, &width, &height, &colortype, &invert);
             if (width > 0 && height > 0) {
-                fprintf(out, "<%sdefs><%simage id=\"img-%d\" x=\"0\" y=\"0\" "
-                             "width=\"%d\" height=\"%d\" ",
-                        states->nameSpaceString, states->nameSpaceString,
-                        image->id, width, height);
+                svg_printf(
+                    out,
+                    "<%sdefs><%simage id=\"img-%d\" x=\"0\" y=\"0\" "
+                    "width=\"%d\" height=\"%d\" ",
+                    states->nameSpaceString, states->nameSpaceString, image->id,
+                    width, height);
                 dib_img_writer(contents, out, states, BmiSrc, BmpSrc, size,
                                true);
-                fprintf(out, " preserveAspectRatio=\"none\" />");
-                fprintf(out, "<%spattern id=\"img-%d-ref\" x=\"0\" y=\"0\" "
-                             "width=\"%d\" height=\"%d\" "
-                             "patternUnits=\"userSpaceOnUse\" >\n",
-                        states->nameSpaceString, image->id, width, height);
-                fprintf(out,
-                        "<%suse id=\"img-%d-ign\" xlink:href=\"#img-%d\" />",
-                        states->nameSpaceString, image->id, image->id);
-                fprintf(out, "</%spattern></%sdefs>\n", states->nameSpaceString,
-                        states->nameSpaceString);
+                svg_append_literal(out, " preserveAspectRatio=\"none\" />");
+                svg_printf(
+                    out,
+                    "<%spattern id=\"img-%d-ref\" x=\"0\" y=\"0\" "
+                    "width=\"%d\" height=\"%d\" "
+                    "patternUnits=\"userSpaceOnUse\" >\n",
+                    states->nameSpaceString, image->id, width, height);
+                svg_printf(out,
+                           "<%suse id=\"img-%d-ign\" xlink:href=\"#img-%d\" />",
+                           states->nameSpaceString, image->id, image->id);
+                svg_append_literal(out, "</");
+                svg_append_string(out, states->nameSpaceString);
+                svg_append_literal(out, "pattern></");
+                svg_append_string(out, states->nameSpaceString);
+                svg_append_literal(out, "defs>\n");
             };
         }
     }
     return image;
 }
+// EMR_SETPIXELV runs: the pixels of consecutive records are collected, then
+// drawn as a single png image when another record arrives. A run is cut
+// when its bounding box gets too large for its number of pixels, the image
+// size stays proportional to the number of pixels.
+#define PIXEL_RUN_MIN_AREA 1024
+#define PIXEL_RUN_MAX_SPARSITY 16
+
+void pixel_run_add(drawingStates *states, svgWriter *out, U_POINTL pt,
+                   U_COLORREF color) {
+    emfPixelRun *run = &(states->pixelRun);
+    if (run->count) {
+        U_RECTL box = run->box;
+        if (pt.x < box.left)
+            box.left = pt.x;
+        if (pt.x > box.right)
+            box.right = pt.x;
+        if (pt.y < box.top)
+            box.top = pt.y;
+        if (pt.y > box.bottom)
+            box.bottom = pt.y;
+        uint64_t width = (uint64_t)((int64_t)box.right - box.left + 1);
+        uint64_t height = (uint64_t)((int64_t)box.bottom - box.top + 1);
+        if (width > MAX_BMP_WIDTH || height > MAX_BMP_HEIGHT ||
+            width * height > PIXEL_RUN_MIN_AREA +
+                                 PIXEL_RUN_MAX_SPARSITY * (run->count + 1)) {
+            pixel_run_flush(states, out);
+        } else {
+            run->box = box;
+        }
+    }
+    if (run->count == 0) {
+        run->box.left = run->box.right = pt.x;
+        run->box.top = run->box.bottom = pt.y;
+    }
+    if (run->count == run->size) {
+        size_t size = run->size ? run->size * 2 : 256;
+        emfPixel *pixels =
+            (emfPixel *)realloc(run->pixels, size * sizeof(emfPixel));
+        if (pixels == NULL) {
+            states->Error = true;
+            return;
+        }
+        run->pixels = pixels;
+        run->size = size;
+    }
+    run->pixels[run->count].x = pt.x;
+    run->pixels[run->count].y = pt.y;
+    run->pixels[run->count].color = color;
+    run->count++;
+}
+
+void pixel_run_flush(drawingStates *states, svgWriter *out) {
+    emfPixelRun *run = &(states->pixelRun);
+    if (run->count == 0)
+        return;
+    size_t count = run->count;
+    run->count = 0;
+
+    // a pixel covers one logical unit
+    POINT_D p1 =
+        point_cal(states, (double)run->box.left, (double)run->box.top);
+    POINT_D p2 = point_cal(states, (double)run->box.right + 1,
+                           (double)run->box.bottom + 1);
+    RECT_D rect = rect_d(p1, p2);
+    if (!clipset_draw_box(states, out, rect, false))
+        return;
+
+    size_t width = (size_t)((int64_t)run->box.right - run->box.left + 1);
+    size_t height = (size_t)((int64_t)run->box.bottom - run->box.top + 1);
+    if (!budget_image(states, out, width, height))
+        return;
+    RGBAPixel *rgba_px = (RGBAPixel *)calloc(width * height, sizeof(RGBAPixel));
+    if (rgba_px == NULL) {
+        states->Error = true;
+        return;
+    }
+    // mapping modes can flip the axes, the image must not
+    bool flipX = p2.x < p1.x;
+    bool flipY = p2.y < p1.y;
+    for (size_t i = 0; i < count; i++) {
+        emfPixel *pixel = &(run->pixels[i]);
+        size_t col = (size_t)((int64_t)pixel->x - run->box.left);
+        size_t row = (size_t)((int64_t)pixel->y - run->box.top);
+        if (flipX)
+            col = width - 1 - col;
+        if (flipY)
+            row = height - 1 - row;
+        // rgb2png() takes the rows bottom-up, like the DIBs
+        RGBAPixel *px = &(rgba_px[(height - 1 - row) * width + col]);
+        px->red = pixel->color.Red;
+        px->green = pixel->color.Green;
+        px->blue = pixel->color.Blue;
+        px->alpha = 0xff;
+    }
+
+    RGBABitmap bitmap;
+    bitmap.pixels = rgba_px;
+    bitmap.width = width;
+    bitmap.height = height;
+    bitmap.bytewidth = width * 4;
+    bitmap.bytes_per_pixel = 4;
+    bitmap.size = width * height * 4;
+    char *png = NULL;
+    size_t png_size = 0;
+    char *b64Bmp = NULL;
+    size_t b64s;
+    double start = states->timing ? e2s_clock() : 0;
+    rgb2png(&bitmap, &png, &png_size);
+    free(rgba_px);
+    if (png != NULL)
+        b64Bmp = base64_encode((unsigned char *)png, png_size, &b64s);
+    free(png);
+    if (states->timing)
+        states->imagesTime += e2s_clock() - start;
+    if (states->stats)
+        states->stats->imageEncodes++;
+    if (b64Bmp == NULL)
+        return;
+
+    svg_printf(out,
+               "<%simage x=\"%.4f\" y=\"%.4f\" width=\"%.4f\" "
+               "height=\"%.4f\" preserveAspectRatio=\"none\" "
+               "image-rendering=\"optimizeSpeed\" ",
+               states->nameSpaceString, rect.left, rect.top,
+               rect.right - rect.left, rect.bottom - rect.top);
+    svg_append_literal(out, "xlink:href=\"data:image/png;base64,");
+    svg_append_string(out, b64Bmp);
+    svg_append_literal(out, "\" />\n");
+    free(b64Bmp);
+}
+
+void pixel_run_free(drawingStates *states) {
+    free(states->pixelRun.pixels);
+    states->pixelRun = (emfPixelRun){0};
+}
+
+bool pixel_run_copy(drawingStates *dest, drawingStates *src) {
+    emfPixelRun *run = &(dest->pixelRun);
+    *run = src->pixelRun;
+    run->pixels = NULL;
+    run->size = 0;
+    if (run->count == 0)
+        return true;
+    run->pixels = (emfPixel *)malloc(run->count * sizeof(emfPixel));
+    if (run->pixels == NULL) {
+        run->count = 0;
+        return false;
+    }
+    memcpy(run->pixels, src->pixelRun.pixels, run->count * sizeof(emfPixel));
+    run->size = run->count;
+    return true;
+}
 #ifdef __cplusplus
 }
 #endif
@@ -27,10 +27,10 @@ bool U_EMRCOMMENT_is_emfplus(const char *contents, const char *blimit) {
     return ret;
 }
 
-void U_EMRCOMMENT_draw(const char *contents, FILE *out, drawingStates *states,
-                       const char *blimit, size_t off) {
+void U_EMRCOMMENT_draw(const char *contents, svgWriter *out,
+                       drawingStates *states, const char *blimit, size_t off) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRCOMMENT_print(contents, states, blimit, off);
     }
     char *src;
@@ -77,19 +77,21 @@ void U_EMRCOMMENT_draw(const char *contents, FILE *out, drawingStates *states,
             if (states->emfplus) {
                 loff = 16; /* Header size of the header part of an EMF+ comment
                               record */
-                if (states->verbose) {
-                    printf("\n   =====================%s START EMF+ RECORD "
-                           "ANALYSING %s=====================\n\n",
-                           KCYN, KNRM);
-                }
+                // the EMF+ records are part of the comment record status
+                generatorTraceStatus status = states->trace.status;
+                verbose_printf("\n   =====================%s START EMF+ RECORD "
+                               "ANALYSING %s=====================\n\n",
+                               KCYN, KNRM);
                 while (loff < cbData + 12) { // EMF+ records may not fill the
                                              // entire comment, cbData value
                                              // includes cIdent, but not U_EMR
                                              // or cbData
                     returnOutOfEmf(src);
+                    if (states->budget.enabled && budget_check(states, out))
+                        return;
                     recsize = U_pmf_onerec_draw(src, blimit, recnum, loff + off,
                                                 out, states);
-                    if (states->verbose) {
+                    if (isVerbose(states)) {
                         U_pmf_onerec_print(src, blimit, recnum, loff + off, out,
                                            states);
                     }
@@ -99,11 +101,10 @@ void U_EMRCOMMENT_draw(const char *contents, FILE *out, drawingStates *states,
                     src += recsize;
                     recnum++;
                 }
-                if (states->verbose) {
-                    printf("\n   ======================%s END EMF+ RECORD "
-                           "ANALYSING %s======================\n",
-                           KBLU, KNRM);
-                }
+                verbose_printf("\n   ======================%s END EMF+ RECORD "
+                               "ANALYSING %s======================\n",
+                               KBLU, KNRM);
+                states->trace.status = status;
             }
             return;
         }
@@ -11,35 +11,39 @@ extern "C" {
 #include <stdlib.h>
 #include <string.h>
 
-void U_EMREOF_draw(const char *contents, FILE *out, drawingStates *states) {
+void U_EMREOF_draw(const char *contents, svgWriter *out,
+                   drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMREOF_print(contents, states);
     }
+    clip_group_close(states, out);
     if (states->transform_open) {
-        fprintf(out, "</%sg>\n", states->nameSpaceString);
+        svg_append_literal(out, "</");
+        svg_append_string(out, states->nameSpaceString);
+        svg_append_literal(out, "g>\n");
     }
-    fprintf(out, "</%sg>\n", states->nameSpaceString);
+    svg_append_literal(out, "</");
+    svg_append_string(out, states->nameSpaceString);
+    svg_append_literal(out, "g>\n");
     if (states->svgDelimiter)
-        fprintf(out, "</%ssvg>\n", states->nameSpaceString);
+        svg_printf(out, "</%ssvg>\n", states->nameSpaceString);
 }
-void U_EMRHEADER_draw(const char *contents, FILE *out, drawingStates *states) {
+void U_EMRHEADER_draw(const char *contents, svgWriter *out,
+                      drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRHEADER_print(contents, states);
     }
-    char *string;
     int p1len;
 
     PU_EMRHEADER pEmr = (PU_EMRHEADER)(contents);
+    // the description is not used in the output (only printed in verbose
+    // mode), it is only checked to reject corrupted headers
     if (pEmr->offDescription) {
         returnOutOfEmf((uint16_t *)((char *)(intptr_t)pEmr +
                                     (intptr_t)pEmr->offDescription) +
                        2 * (intptr_t)pEmr->nDescription);
-        string =
-            U_Utf16leToUtf8((uint16_t *)((char *)pEmr + pEmr->offDescription),
-                            pEmr->nDescription, NULL);
-        free(string);
         p1len =
             2 +
             2 * wchar16len((uint16_t *)((char *)pEmr + pEmr->offDescription));
@@ -47,15 +51,13 @@ void U_EMRHEADER_draw(const char *contents, FILE *out, drawingStates *states) {
                                     (intptr_t)pEmr->offDescription +
                                     (intptr_t)p1len) +
                        2 * (intptr_t)pEmr->nDescription);
-        string = U_Utf16leToUtf8(
-            (uint16_t *)((char *)pEmr + pEmr->offDescription + p1len),
-            pEmr->nDescription, NULL);
-        free(string);
     }
-    // object table allocation
-    // allocate one more to directly use object indexes (starts at 1 and not 0)
-    states->objectTable = calloc(pEmr->nHandles + 1, sizeof(emfGraphObject));
+    // object table size, the pages are allocated when objects are created
+    // one more to directly use object indexes (starts at 1 and not 0)
+    states->objectHandles = pEmr->nHandles;
     states->objectTableSize = pEmr->nHandles;
+    if (states->objectTableSize > states->maxObjects)
+        states->objectTableSize = states->maxObjects;
 
     double ratioXY = (double)(pEmr->rclBounds.right - pEmr->rclBounds.left) /
                      (double)(pEmr->rclBounds.bottom - pEmr->rclBounds.top);
@@ -130,32 +132,69 @@ void U_EMRHEADER_draw(const char *contents, FILE *out, drawingStates *states) {
 
     states->pxPerMm =
         (double)pEmr->szlDevice.cx / (double)pEmr->szlMillimeters.cx;
+    // serialized widths depend on the scaling
+    states->currentDeviceContext.dirty |= DC_DIRTY_ALL;
+
+    // visible area, unknown without svg delimiter
+    if (states->svgDelimiter && !states->fixBrokenYTransform) {
+        RECT_D image = {0, 0, states->imgWidth, states->imgHeight};
+        if (states->roiSet)
+            image = states->roi;
+        states->viewport.left = image.left + states->RefX * states->scaling;
+        states->viewport.top = image.top + states->RefY * states->scaling;
+        states->viewport.right = image.right + states->RefX * states->scaling;
+        states->viewport.bottom = image.bottom + states->RefY * states->scaling;
+        states->viewportSet = true;
+    }
 
     if (states->svgDelimiter) {
-        fprintf(
+        if (states->tiles)
+            tiles_start_draw(states);
+        else
+            svg_start_draw(states, out, states->roiSet ? &states->roi : NULL);
+    }
+}
+
+// svg start tag and top group, view is the displayed part of the image
+// (NULL for the whole image)
+void svg_start_draw(drawingStates *states, svgWriter *out, const RECT_D *view) {
+    svg_append_literal(
+        out, "<?xml version=\"1.0\"  encoding=\"UTF-8\" standalone=\"no\"?>\n");
+    svg_append_literal(out, "<");
+    svg_append_string(out, states->nameSpaceString);
+    svg_append_literal(out, "svg version=\"1.1\" ");
+    svg_append_literal(out, "xmlns=\"http://www.w3.org/2000/svg\" ");
+    svg_append_literal(out, "xmlns:xlink=\"http://www.w3.org/1999/xlink\"");
+    if ((states->nameSpace != NULL) && (strlen(states->nameSpace) != 0)) {
+        svg_append_literal(out, "xmlns:");
+        svg_append_string(out, states->nameSpace);
+        svg_append_literal(out, "=\"http://www.w3.org/2000/svg\"");
+    }
+    if (view) {
+        svg_printf(
             out,
-            "<?xml version=\"1.0\"  encoding=\"UTF-8\" standalone=\"no\"?>\n");
-        fprintf(out, "<%ssvg version=\"1.1\" ", states->nameSpaceString);
-        fprintf(out, "xmlns=\"http://www.w3.org/2000/svg\" ");
-        fprintf(out, "xmlns:xlink=\"http://www.w3.org/1999/xlink\"");
-        if ((states->nameSpace != NULL) && (strlen(states->nameSpace) != 0)) {
-            fprintf(out, "xmlns:%s=\"http://www.w3.org/2000/svg\"",
-                    states->nameSpace);
-        }
+            " width=\"%.4f\" height=\"%.4f\" "
+            "viewBox=\"%.4f %.4f %.4f %.4f\">\n",
+            view->right - view->left, view->bottom - view->top, view->left,
+            view->top, view->right - view->left, view->bottom - view->top);
+    }
     // https://www.w3.org/TR/SVG2/coords.html
-        if (states->fixBrokenYTransform) {
-            fprintf(out, " width=\"%.4f\" height=\"%.4f\">\n",
-                states->imgWidth + 1,
-                states->imgHeight + 1);
-            fprintf(out, "<%sg transform=\"translate(0.0000, 0.00 00)\">\n",
-                    states->nameSpaceString);
-        } else {
-            fprintf(out, " width=\"%.4f\" height=\"%.4f\">\n", states->imgWidth,
-                states->imgHeight);
-            fprintf(out, "<%sg transform=\"translate(%.4f, %.4f)\">\n",
-                states->nameSpaceString, -1.0 * states->RefX * states->scaling,
-                -1.0 * states->RefY * states->scaling);
-        }
+    if (states->fixBrokenYTransform) {
+        if (!view)
+            svg_printf(out, " width=\"%.4f\" height=\"%.4f\">\n",
+                       states->imgWidth + 1, states->imgHeight + 1);
+        svg_append_literal(out, "<");
+        svg_append_string(out, states->nameSpaceString);
+        svg_append_literal(out,
+                           "g transform=\"translate(0.0000, 0.00 00)\">\n");
+    } else {
+        if (!view)
+            svg_printf(out, " width=\"%.4f\" height=\"%.4f\">\n",
+                       states->imgWidth, states->imgHeight);
+        svg_printf(out, "<%sg transform=\"translate(%.4f, %.4f)\">\n",
+                   states->nameSpaceString,
+                   -1.0 * states->RefX * states->scaling,
+                   -1.0 * states->RefY * states->scaling);
     }
 }
 
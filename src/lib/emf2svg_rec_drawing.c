@@ -10,47 +10,51 @@ extern "C" {
 #include <stdio.h>
 #include <stdlib.h>
 
-void U_EMRANGLEARC_draw(const char *contents, FILE *out,
+void U_EMRANGLEARC_draw(const char *contents, svgWriter *out,
                         drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRANGLEARC_print(contents, states);
     }
     arc_circle_draw(contents, out, states);
 }
-void U_EMRARC_draw(const char *contents, FILE *out, drawingStates *states) {
+void U_EMRARC_draw(const char *contents, svgWriter *out,
+                   drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRARC_print(contents, states);
     }
     arc_draw(contents, out, states, ARC_SIMPLE);
 }
-void U_EMRARCTO_draw(const char *contents, FILE *out, drawingStates *states) {
+void U_EMRARCTO_draw(const char *contents, svgWriter *out,
+                     drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRARCTO_print(contents, states);
     }
     arc_draw(contents, out, states, ARC_SIMPLE);
 }
-void U_EMRCHORD_draw(const char *contents, FILE *out, drawingStates *states) {
+void U_EMRCHORD_draw(const char *contents, svgWriter *out,
+                     drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRCHORD_print(contents, states);
     }
     arc_draw(contents, out, states, ARC_CHORD);
 }
-void U_EMRCLOSEFIGURE_draw(const char *contents, FILE *out,
+void U_EMRCLOSEFIGURE_draw(const char *contents, svgWriter *out,
                            drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRCLOSEFIGURE_print(contents, states);
     }
-    fprintf(out, "Z ");
+    path_data_cmd(&(states->pathData), out, 'Z');
     UNUSED(contents);
 }
-void U_EMRELLIPSE_draw(const char *contents, FILE *out, drawingStates *states) {
+void U_EMRELLIPSE_draw(const char *contents, svgWriter *out,
+                       drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRELLIPSE_print(contents, states);
     }
     PU_EMRELLIPSE pEmr = (PU_EMRELLIPSE)(contents);
@@ -64,412 +68,510 @@ void U_EMRELLIPSE_draw(const char *contents, FILE *out, drawingStates *states) {
     center.y = (LT.y + RB.y) / 2;
     radius.x = (RB.x - LT.x) / 2;
     radius.y = (RB.y - LT.y) / 2;
-    fprintf(out, "<%sellipse cx=\"%.4f\" cy=\"%.4f\" rx=\"%.4f\" ry=\"%.4f\" ",
-            states->nameSpaceString, center.x, center.y, radius.x, radius.y);
+    if (!clipset_draw_box(states, out, rect_d(LT, RB), true))
+        return;
+    svg_printf(out,
+               "<%sellipse cx=\"%.4f\" cy=\"%.4f\" rx=\"%.4f\" ry=\"%.4f\" ",
+               states->nameSpaceString, center.x, center.y, radius.x, radius.y);
     bool filled = false;
     bool stroked = false;
     fill_draw(states, out, &filled, &stroked);
     stroke_draw(states, out, &filled, &stroked);
-    clipset_draw(states, out);
     if (!filled)
-        fprintf(out, "fill=\"none\" ");
+        svg_append_literal(out, "fill=\"none\" ");
     if (!stroked)
-        fprintf(out, "stroke=\"none\" ");
-    fprintf(out, "/>\n");
+        svg_append_literal(out, "stroke=\"none\" ");
+    svg_append_literal(out, "/>\n");
 }
-void U_EMREXTFLOODFILL_draw(const char *contents, FILE *out,
+void U_EMREXTFLOODFILL_draw(const char *contents, svgWriter *out,
                             drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMREXTFLOODFILL_print(contents, states);
     }
     // PU_EMREXTFLOODFILL pEmr = (PU_EMREXTFLOODFILL)(contents);
 }
-void U_EMREXTTEXTOUTA_draw(const char *contents, FILE *out,
+void U_EMREXTTEXTOUTA_draw(const char *contents, svgWriter *out,
                            drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMREXTTEXTOUTA_print(contents, states);
     }
     text_draw(contents, out, states, ASCII);
 }
-void U_EMREXTTEXTOUTW_draw(const char *contents, FILE *out,
+void U_EMREXTTEXTOUTW_draw(const char *contents, svgWriter *out,
                            drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMREXTTEXTOUTW_print(contents, states);
     }
     text_draw(contents, out, states, UTF_16);
 }
-void U_EMRFILLPATH_draw(const char *contents, FILE *out,
+void U_EMRFILLPATH_draw(const char *contents, svgWriter *out,
                         drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRFILLPATH_print(contents, states);
     }
     // real work done in U_EMRENDPATH
 }
-void U_EMRFILLRGN_draw(const char *contents, FILE *out, drawingStates *states) {
+void U_EMRFILLRGN_draw(const char *contents, svgWriter *out,
+                       drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRFILLRGN_print(contents, states);
     }
     // PU_EMRFILLRGN pEmr = (PU_EMRFILLRGN)(contents);
 }
-void U_EMRFRAMERGN_draw(const char *contents, FILE *out,
+void U_EMRFRAMERGN_draw(const char *contents, svgWriter *out,
                         drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRFRAMERGN_print(contents, states);
     }
     // PU_EMRFRAMERGN pEmr = (PU_EMRFRAMERGN)(contents);
 }
-void U_EMRGRADIENTFILL_draw(const char *contents, FILE *out,
+void U_EMRGRADIENTFILL_draw(const char *contents, svgWriter *out,
                             drawingStates *states) {
-    FLAG_IGNORED;
-    if (states->verbose) {
+    FLAG_PARTIAL;
+    if (isVerbose(states)) {
         U_EMRGRADIENTFILL_print(contents, states);
     }
-    // PU_EMRGRADIENTFILL pEmr = (PU_EMRGRADIENTFILL)(contents);
-}
-void U_EMRLINETO_draw(const char *contents, FILE *out, drawingStates *states) {
+    // not part of paths
+    if (states->inPath)
+        return;
+    PU_EMRGRADIENTFILL pEmr = (PU_EMRGRADIENTFILL)(contents);
+    returnOutOfEmf(contents + sizeof(U_EMRGRADIENTFILL));
+    size_t objectSize;
+    switch (pEmr->ulMode) {
+    case U_GRADIENT_FILL_RECT_H:
+    case U_GRADIENT_FILL_RECT_V:
+        objectSize = sizeof(U_GRADIENT4);
+        break;
+    case U_GRADIENT_FILL_TRIANGLE:
+        objectSize = sizeof(U_GRADIENT3);
+        break;
+    default:
+        return;
+    }
+    const char *vertices = contents + sizeof(U_EMRGRADIENTFILL);
+    const char *objects =
+        vertices + (size_t)pEmr->nTriVert * sizeof(U_TRIVERTEX);
+    returnOutOfEmf((intptr_t)vertices +
+                   (intptr_t)pEmr->nTriVert * sizeof(U_TRIVERTEX));
+    returnOutOfEmf((intptr_t)objects +
+                   (intptr_t)pEmr->nGradObj * objectSize);
+    gradient_fill_draw(states, out, (const U_TRIVERTEX *)vertices,
+                       pEmr->nTriVert, objects, pEmr->nGradObj, pEmr->ulMode);
+}
+void U_EMRLINETO_draw(const char *contents, svgWriter *out,
+                      drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRLINETO_print(contents, states);
     }
+    if (states->mergePaths && !states->inPath) {
+        path_run_line(states, out, contents);
+        return;
+    }
     lineto_draw("U_EMRLINETO", "ptl:", "", contents, out, states);
 }
-void U_EMRPAINTRGN_draw(const char *contents, FILE *out,
+void U_EMRPAINTRGN_draw(const char *contents, svgWriter *out,
                         drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRPAINTRGN_print(contents, states);
     }
 }
-void U_EMRPIE_draw(const char *contents, FILE *out, drawingStates *states) {
+void U_EMRPIE_draw(const char *contents, svgWriter *out,
+                   drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRPIE_print(contents, states);
     }
     arc_draw(contents, out, states, ARC_PIE);
 }
-void U_EMRPOLYBEZIER_draw(const char *contents, FILE *out,
+void U_EMRPOLYBEZIER_draw(const char *contents, svgWriter *out,
                           drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRPOLYBEZIER_print(contents, states);
     }
     cubic_bezier_draw("U_EMRPOLYBEZIER", contents, out, states, 1);
 }
-void U_EMRPOLYBEZIER16_draw(const char *contents, FILE *out,
+void U_EMRPOLYBEZIER16_draw(const char *contents, svgWriter *out,
                             drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRPOLYBEZIER16_print(contents, states);
     }
     cubic_bezier16_draw("U_EMRPOLYBEZIER16", contents, out, states, 1);
 }
-void U_EMRPOLYBEZIERTO_draw(const char *contents, FILE *out,
+void U_EMRPOLYBEZIERTO_draw(const char *contents, svgWriter *out,
                             drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRPOLYBEZIERTO_print(contents, states);
     }
     cubic_bezier_draw("U_EMRPOLYBEZIER", contents, out, states, 0);
 }
-void U_EMRPOLYBEZIERTO16_draw(const char *contents, FILE *out,
+void U_EMRPOLYBEZIERTO16_draw(const char *contents, svgWriter *out,
                               drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRPOLYBEZIERTO16_print(contents, states);
     }
     cubic_bezier16_draw("U_EMRPOLYBEZIERTO16", contents, out, states, 0);
 }
-void U_EMRPOLYDRAW_draw(const char *contents, FILE *out,
+void U_EMRPOLYDRAW_draw(const char *contents, svgWriter *out,
                         drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRPOLYDRAW_print(contents, states);
     }
     // PU_EMRPOLYDRAW pEmr = (PU_EMRPOLYDRAW)(contents);
 }
-void U_EMRPOLYDRAW16_draw(const char *contents, FILE *out,
+void U_EMRPOLYDRAW16_draw(const char *contents, svgWriter *out,
                           drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRPOLYDRAW16_print(contents, states);
     }
     // PU_EMRPOLYDRAW16 pEmr = (PU_EMRPOLYDRAW16)(contents);
 }
-void U_EMRPOLYGON_draw(const char *contents, FILE *out, drawingStates *states) {
+void U_EMRPOLYGON_draw(const char *contents, svgWriter *out,
+                       drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRPOLYGON_print(contents, states);
     }
+    if (states->mergePaths && !states->inPath) {
+        path_run_poly(states, out, contents);
+        return;
+    }
     bool localPath = false;
     if (!states->inPath) {
+        if (!clipset_draw_poly(states, out, contents, false, false))
+            return;
         localPath = true;
         states->inPath = true;
-        fprintf(out, "<%spath ", states->nameSpaceString);
-        clipset_draw(states, out);
-        fprintf(out, "d=\"");
+        svg_append_literal(out, "<");
+        svg_append_string(out, states->nameSpaceString);
+        svg_append_literal(out, "path ");
+        svg_append_literal(out, "d=\"");
+        path_data_start(states, &(states->pathData));
     }
     bool ispolygon = true;
     polyline_draw("U_EMRPOLYGON16", contents, out, states, ispolygon);
 
     if (localPath) {
         states->inPath = false;
-        fprintf(out, "Z\" ");
+        path_data_end(&(states->pathData), out, true);
         bool filled = false;
         bool stroked = false;
         stroke_draw(states, out, &filled, &stroked);
         fill_draw(states, out, &filled, &stroked);
         if (!filled)
-            fprintf(out, "fill=\"none\" ");
+            svg_append_literal(out, "fill=\"none\" ");
         if (!stroked)
-            fprintf(out, "stroke=\"none\" ");
+            svg_append_literal(out, "stroke=\"none\" ");
 
-        fprintf(out, "/>\n");
+        svg_append_literal(out, "/>\n");
     }
 }
-void U_EMRPOLYGON16_draw(const char *contents, FILE *out,
+void U_EMRPOLYGON16_draw(const char *contents, svgWriter *out,
                          drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRPOLYGON16_print(contents, states);
     }
+    if (states->mergePaths && !states->inPath) {
+        path_run_poly(states, out, contents);
+        return;
+    }
     bool localPath = false;
     if (!states->inPath) {
+        if (!clipset_draw_poly(states, out, contents, true, false))
+            return;
         localPath = true;
         states->inPath = true;
-        fprintf(out, "<%spath ", states->nameSpaceString);
-        clipset_draw(states, out);
-        fprintf(out, "d=\"");
+        svg_append_literal(out, "<");
+        svg_append_string(out, states->nameSpaceString);
+        svg_append_literal(out, "path ");
+        svg_append_literal(out, "d=\"");
+        path_data_start(states, &(states->pathData));
     }
     bool ispolygon = true;
     polyline16_draw("U_EMRPOLYGON16", contents, out, states, ispolygon);
 
     if (localPath) {
         states->inPath = false;
-        fprintf(out, "Z\" ");
+        path_data_end(&(states->pathData), out, true);
         bool filled = false;
         bool stroked = false;
         stroke_draw(states, out, &filled, &stroked);
         fill_draw(states, out, &filled, &stroked);
         if (!filled)
-            fprintf(out, "fill=\"none\" ");
+            svg_append_literal(out, "fill=\"none\" ");
         if (!stroked)
-            fprintf(out, "stroke=\"none\" ");
+            svg_append_literal(out, "stroke=\"none\" ");
 
-        fprintf(out, "/>\n");
+        svg_append_literal(out, "/>\n");
     }
 }
-void U_EMRPOLYLINE_draw(const char *contents, FILE *out,
+void U_EMRPOLYLINE_draw(const char *contents, svgWriter *out,
                         drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRPOLYLINE_print(contents, states);
     }
+    if (states->mergePaths && !states->inPath) {
+        path_run_poly(states, out, contents);
+        return;
+    }
     bool localPath = false;
     if (!states->inPath) {
+        if (!clipset_draw_poly(states, out, contents, false, false))
+            return;
         localPath = true;
         states->inPath = true;
-        fprintf(out, "<%spath ", states->nameSpaceString);
-        clipset_draw(states, out);
-        fprintf(out, "d=\"");
+        svg_append_literal(out, "<");
+        svg_append_string(out, states->nameSpaceString);
+        svg_append_literal(out, "path ");
+        svg_append_literal(out, "d=\"");
+        path_data_start(states, &(states->pathData));
     }
     bool ispolygon = true;
     polyline_draw("U_EMRPOLYLINE", contents, out, states, ispolygon);
     if (localPath) {
         states->inPath = false;
-        // fprintf(out, "Z\" ");
-        fprintf(out, "\" ");
+        // svg_printf(out, "Z\" ");
+        path_data_end(&(states->pathData), out, false);
         bool filled = false;
         bool stroked = false;
         stroke_draw(states, out, &filled, &stroked);
         if (!filled)
-            fprintf(out, "fill=\"none\" ");
+            svg_append_literal(out, "fill=\"none\" ");
         if (!stroked)
-            fprintf(out, "stroke=\"none\" ");
-        fprintf(out, "/>\n");
+            svg_append_literal(out, "stroke=\"none\" ");
+        svg_append_literal(out, "/>\n");
     }
 }
-void U_EMRPOLYLINE16_draw(const char *contents, FILE *out,
+void U_EMRPOLYLINE16_draw(const char *contents, svgWriter *out,
                           drawingStates *states) {
     FLAG_SUPPORTED;
+    if (isVerbose(states)) {
+        U_EMRPOLYLINE16_print(contents, states);
+    }
+    if (states->mergePaths && !states->inPath) {
+        path_run_poly(states, out, contents);
+        return;
+    }
     bool localPath = false;
     if (!states->inPath) {
+        if (!clipset_draw_poly(states, out, contents, true, false))
+            return;
         localPath = true;
         states->inPath = true;
-        fprintf(out, "<%spath ", states->nameSpaceString);
-        clipset_draw(states, out);
-        fprintf(out, "d=\"");
+        svg_append_literal(out, "<");
+        svg_append_string(out, states->nameSpaceString);
+        svg_append_literal(out, "path ");
+        svg_append_literal(out, "d=\"");
+        path_data_start(states, &(states->pathData));
     }
     bool ispolygon = true;
     polyline16_draw("U_EMRPOLYGON16", contents, out, states, ispolygon);
 
     if (localPath) {
         states->inPath = false;
-        // fprintf(out, "Z\" ");
-        fprintf(out, "\" ");
+        // svg_printf(out, "Z\" ");
+        path_data_end(&(states->pathData), out, false);
         bool filled = false;
         bool stroked = false;
         stroke_draw(states, out, &filled, &stroked);
         if (!filled)
-            fprintf(out, "fill=\"none\" ");
+            svg_append_literal(out, "fill=\"none\" ");
         if (!stroked)
-            fprintf(out, "stroke=\"none\" ");
-        fprintf(out, "/>\n");
-    }
-
-    if (states->verbose) {
-        U_EMRPOLYLINE16_print(contents, states);
+            svg_append_literal(out, "stroke=\"none\" ");
+        svg_append_literal(out, "/>\n");
     }
 }
-void U_EMRPOLYLINETO_draw(const char *contents, FILE *out,
+void U_EMRPOLYLINETO_draw(const char *contents, svgWriter *out,
                           drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRPOLYLINETO_print(contents, states);
     }
     polyline_draw("U_EMRPOLYLINETO", contents, out, states, false);
 }
-void U_EMRPOLYLINETO16_draw(const char *contents, FILE *out,
+void U_EMRPOLYLINETO16_draw(const char *contents, svgWriter *out,
                             drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRPOLYLINETO16_print(contents, states);
     }
     polyline16_draw("U_EMRPOLYLINETO16", contents, out, states, false);
 }
-void U_EMRPOLYPOLYGON_draw(const char *contents, FILE *out,
+void U_EMRPOLYPOLYGON_draw(const char *contents, svgWriter *out,
                            drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRPOLYPOLYLINE_print(contents, states);
     }
+    if (states->mergePaths && !states->inPath) {
+        path_run_poly(states, out, contents);
+        return;
+    }
     bool localPath = false;
     if (!states->inPath) {
+        if (!clipset_draw_poly(states, out, contents, false, true))
+            return;
         localPath = true;
         states->inPath = true;
-        fprintf(out, "<%spath ", states->nameSpaceString);
-        clipset_draw(states, out);
-        fprintf(out, "d=\"");
+        svg_append_literal(out, "<");
+        svg_append_string(out, states->nameSpaceString);
+        svg_append_literal(out, "path ");
+        svg_append_literal(out, "d=\"");
+        path_data_start(states, &(states->pathData));
     }
     bool ispolygon = true;
     polypolygon_draw("U_EMRPOLYPOLYGON", contents, out, states, ispolygon);
 
     if (localPath) {
         states->inPath = false;
-        fprintf(out, "\" ");
+        path_data_end(&(states->pathData), out, false);
         bool filled = false;
         bool stroked = false;
         fill_draw(states, out, &filled, &stroked);
         stroke_draw(states, out, &filled, &stroked);
         if (!filled)
-            fprintf(out, "fill=\"none\" ");
+            svg_append_literal(out, "fill=\"none\" ");
         if (!stroked)
-            fprintf(out, "stroke=\"none\" ");
+            svg_append_literal(out, "stroke=\"none\" ");
 
-        fprintf(out, "/>\n");
+        svg_append_literal(out, "/>\n");
     }
 }
-void U_EMRPOLYPOLYGON16_draw(const char *contents, FILE *out,
+void U_EMRPOLYPOLYGON16_draw(const char *contents, svgWriter *out,
                              drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRPOLYPOLYGON16_print(contents, states);
     }
+    if (states->mergePaths && !states->inPath) {
+        path_run_poly(states, out, contents);
+        return;
+    }
     bool localPath = false;
     if (!states->inPath) {
+        if (!clipset_draw_poly(states, out, contents, true, true))
+            return;
         localPath = true;
         states->inPath = true;
-        fprintf(out, "<%spath ", states->nameSpaceString);
-        clipset_draw(states, out);
-        fprintf(out, "d=\"");
+        svg_append_literal(out, "<");
+        svg_append_string(out, states->nameSpaceString);
+        svg_append_literal(out, "path ");
+        svg_append_literal(out, "d=\"");
+        path_data_start(states, &(states->pathData));
     }
     bool ispolygon = true;
     polypolygon16_draw("U_EMRPOLYPOLYGON16", contents, out, states, ispolygon);
 
     if (localPath) {
         states->inPath = false;
-        fprintf(out, "\" ");
+        path_data_end(&(states->pathData), out, false);
         bool filled = false;
         bool stroked = false;
         fill_draw(states, out, &filled, &stroked);
         stroke_draw(states, out, &filled, &stroked);
         if (!filled)
-            fprintf(out, "fill=\"none\" ");
+            svg_append_literal(out, "fill=\"none\" ");
         if (!stroked)
-            fprintf(out, "stroke=\"none\" ");
+            svg_append_literal(out, "stroke=\"none\" ");
 
-        fprintf(out, "/>\n");
+        svg_append_literal(out, "/>\n");
     }
 }
-void U_EMRPOLYPOLYLINE_draw(const char *contents, FILE *out,
+void U_EMRPOLYPOLYLINE_draw(const char *contents, svgWriter *out,
                             drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRPOLYPOLYLINE_print(contents, states);
     }
+    if (states->mergePaths && !states->inPath) {
+        path_run_poly(states, out, contents);
+        return;
+    }
     bool localPath = false;
     if (!states->inPath) {
+        if (!clipset_draw_poly(states, out, contents, false, true))
+            return;
         localPath = true;
         states->inPath = true;
-        fprintf(out, "<%spath ", states->nameSpaceString);
-        clipset_draw(states, out);
-        fprintf(out, "d=\"");
+        svg_append_literal(out, "<");
+        svg_append_string(out, states->nameSpaceString);
+        svg_append_literal(out, "path ");
+        svg_append_literal(out, "d=\"");
+        path_data_start(states, &(states->pathData));
     }
     polypolygon_draw("U_EMRPOLYPOLYGON16", contents, out, states, false);
 
     if (localPath) {
         states->inPath = false;
-        fprintf(out, "\" ");
+        path_data_end(&(states->pathData), out, false);
         bool filled = false;
         bool stroked = false;
         stroke_draw(states, out, &filled, &stroked);
         if (!filled)
-            fprintf(out, "fill=\"none\" ");
+            svg_append_literal(out, "fill=\"none\" ");
         if (!stroked)
-            fprintf(out, "stroke=\"none\" ");
+            svg_append_literal(out, "stroke=\"none\" ");
 
-        fprintf(out, "/>\n");
+        svg_append_literal(out, "/>\n");
     }
 }
-void U_EMRPOLYPOLYLINE16_draw(const char *contents, FILE *out,
+void U_EMRPOLYPOLYLINE16_draw(const char *contents, svgWriter *out,
                               drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRPOLYPOLYLINE16_print(contents, states);
     }
+    if (states->mergePaths && !states->inPath) {
+        path_run_poly(states, out, contents);
+        return;
+    }
     bool localPath = false;
     if (!states->inPath) {
+        if (!clipset_draw_poly(states, out, contents, true, true))
+            return;
         localPath = true;
         states->inPath = true;
-        fprintf(out, "<%spath ", states->nameSpaceString);
-        clipset_draw(states, out);
-        fprintf(out, "d=\"");
+        svg_append_literal(out, "<");
+        svg_append_string(out, states->nameSpaceString);
+        svg_append_literal(out, "path ");
+        svg_append_literal(out, "d=\"");
+        path_data_start(states, &(states->pathData));
     }
     polypolygon16_draw("U_EMRPOLYPOLYGON16", contents, out, states, false);
 
     if (localPath) {
         states->inPath = false;
-        fprintf(out, "\" ");
+        path_data_end(&(states->pathData), out, false);
         bool filled = false;
         bool stroked = false;
         stroke_draw(states, out, &filled, &stroked);
         if (!filled)
-            fprintf(out, "fill=\"none\" ");
+            svg_append_literal(out, "fill=\"none\" ");
         if (!stroked)
-            fprintf(out, "stroke=\"none\" ");
+            svg_append_literal(out, "stroke=\"none\" ");
 
-        fprintf(out, "/>\n");
+        svg_append_literal(out, "/>\n");
     }
 }
-void U_EMRRECTANGLE_draw(const char *contents, FILE *out,
+void U_EMRRECTANGLE_draw(const char *contents, svgWriter *out,
                          drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRRECTANGLE_print(contents, states);
     }
     PU_EMRRECTANGLE pEmr = (PU_EMRRECTANGLE)(contents);
@@ -487,24 +589,30 @@ void U_EMRRECTANGLE_draw(const char *contents, FILE *out,
         LT.y -= dim.y;
     }
 
-    fprintf(out,
-            "<%srect x=\"%.4f\" y=\"%.4f\" width=\"%.4f\" height=\"%.4f\" ",
-            states->nameSpaceString, LT.x, LT.y, dim.x, dim.y);
+    POINT_D corner = {LT.x + dim.x, LT.y + dim.y};
+    if (states->mergePaths && !states->inPath) {
+        path_run_rect(states, out, LT, corner);
+        return;
+    }
+    if (!clipset_draw_box(states, out, rect_d(LT, corner), true))
+        return;
+    svg_printf(out,
+               "<%srect x=\"%.4f\" y=\"%.4f\" width=\"%.4f\" height=\"%.4f\" ",
+               states->nameSpaceString, LT.x, LT.y, dim.x, dim.y);
     bool filled = false;
     bool stroked = false;
     fill_draw(states, out, &filled, &stroked);
     stroke_draw(states, out, &filled, &stroked);
-    clipset_draw(states, out);
     if (!filled)
-        fprintf(out, "fill=\"none\" ");
+        svg_append_literal(out, "fill=\"none\" ");
     if (!stroked)
-        fprintf(out, "stroke=\"none\" ");
-    fprintf(out, "/>\n");
+        svg_append_literal(out, "stroke=\"none\" ");
+    svg_append_literal(out, "/>\n");
 }
-void U_EMRROUNDRECT_draw(const char *contents, FILE *out,
+void U_EMRROUNDRECT_draw(const char *contents, svgWriter *out,
                          drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRROUNDRECT_print(contents, states);
     }
     PU_EMRROUNDRECT pEmr = (PU_EMRROUNDRECT)(contents);
@@ -522,39 +630,53 @@ void U_EMRROUNDRECT_draw(const char *contents, FILE *out,
         LT.y -= dim.y;
     }
 
-    fprintf(out,
-            "<%srect x=\"%.4f\" y=\"%.4f\" width=\"%.4f\" height=\"%.4f\" ",
-            states->nameSpaceString, LT.x, LT.y, dim.x, dim.y);
-    fprintf(out, "rx=\"%.4f\" ry=\"%.4f\" ", scaleX(states, (double)pEmr->szlCorner.cx), scaleX(states, (double)pEmr->szlCorner.cy));
+    POINT_D corner = {LT.x + dim.x, LT.y + dim.y};
+    if (!clipset_draw_box(states, out, rect_d(LT, corner), true))
+        return;
+    svg_printf(out,
+               "<%srect x=\"%.4f\" y=\"%.4f\" width=\"%.4f\" height=\"%.4f\" ",
+               states->nameSpaceString, LT.x, LT.y, dim.x, dim.y);
+    svg_append_literal(out, "rx=\"");
+    svg_append_number(out, scaleX(states, (double)pEmr->szlCorner.cx));
+    svg_append_literal(out, "\" ry=\"");
+    svg_append_number(out, scaleX(states, (double)pEmr->szlCorner.cy));
+    svg_append_literal(out, "\" ");
     bool filled = false;
     bool stroked = false;
     fill_draw(states, out, &filled, &stroked);
     stroke_draw(states, out, &filled, &stroked);
-    clipset_draw(states, out);
     if (!filled)
-        fprintf(out, "fill=\"none\" ");
+        svg_append_literal(out, "fill=\"none\" ");
     if (!stroked)
-        fprintf(out, "stroke=\"none\" ");
-    fprintf(out, "/>\n");
+        svg_append_literal(out, "stroke=\"none\" ");
+    svg_append_literal(out, "/>\n");
 }
-void U_EMRSETPIXELV_draw(const char *contents, FILE *out,
+void U_EMRSETPIXELV_draw(const char *contents, svgWriter *out,
                          drawingStates *states) {
-    FLAG_IGNORED;
-    if (states->verbose) {
+    FLAG_PARTIAL;
+    if (isVerbose(states)) {
         U_EMRSETPIXELV_print(contents, states);
     }
-    // PU_EMRSETPIXELV pEmr = (PU_EMRSETPIXELV)(contents);
+    // not part of paths
+    if (states->inPath)
+        return;
+    PU_EMRSETPIXELV pEmr = (PU_EMRSETPIXELV)(contents);
+    returnOutOfEmf(contents + sizeof(U_EMRSETPIXELV));
+    // drawn with the following pixels (see pixel_run_flush())
+    pixel_run_add(states, out, pEmr->ptlPixel, pEmr->crColor);
 }
-void U_EMRSMALLTEXTOUT_draw(const char *contents, FILE *out,
+void U_EMRSMALLTEXTOUT_draw(const char *contents, svgWriter *out,
                             drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSMALLTEXTOUT_print(contents, states);
     }
 
     PU_EMRSMALLTEXTOUT pEmr = (PU_EMRSMALLTEXTOUT)(contents);
-    fprintf(out, "<%stext ", states->nameSpaceString);
     clipset_draw(states, out);
+    svg_append_literal(out, "<");
+    svg_append_string(out, states->nameSpaceString);
+    svg_append_literal(out, "text ");
     POINT_D Org = point_cal(states, (double)pEmr->Dest.x, (double)pEmr->Dest.y);
 
     size_t roff = sizeof(U_EMRSMALLTEXTOUT);
@@ -577,23 +699,27 @@ void U_EMRSMALLTEXTOUT_draw(const char *contents, FILE *out,
 
     free(dup_wt);
     text_style_draw(out, states, Org);
-    fprintf(out, ">");
-    fprintf(out, "<![CDATA[%s]]>", ansi_text);
-    fprintf(out, "</%stext>\n", states->nameSpaceString);
+    svg_append_literal(out, ">");
+    svg_append_literal(out, "<![CDATA[");
+    svg_append_string(out, ansi_text);
+    svg_append_literal(out, "]]>");
+    svg_append_literal(out, "</");
+    svg_append_string(out, states->nameSpaceString);
+    svg_append_literal(out, "text>\n");
     free(ansi_text);
 }
-void U_EMRSTROKEANDFILLPATH_draw(const char *contents, FILE *out,
+void U_EMRSTROKEANDFILLPATH_draw(const char *contents, svgWriter *out,
                                  drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSTROKEANDFILLPATH_print(contents, states);
     }
     // real work done in U_EMRENDPATH
 }
-void U_EMRSTROKEPATH_draw(const char *contents, FILE *out,
+void U_EMRSTROKEPATH_draw(const char *contents, svgWriter *out,
                           drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSTROKEPATH_print(contents, states);
     }
     // real work done in U_EMRENDPATH
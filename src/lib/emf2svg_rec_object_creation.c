@@ -10,56 +10,41 @@ extern "C" {
 #include <stdio.h>
 #include <stdlib.h>
 
-void U_EMRCREATEBRUSHINDIRECT_draw(const char *contents, FILE *out,
+void U_EMRCREATEBRUSHINDIRECT_draw(const char *contents, svgWriter *out,
                                    drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRCREATEBRUSHINDIRECT_print(contents, states);
     }
     PU_EMRCREATEBRUSHINDIRECT pEmr = (PU_EMRCREATEBRUSHINDIRECT)(contents);
 
     uint16_t index = pEmr->ihBrush;
-    returnOutOfOTIndex(index);
-    if (pEmr->lb.lbStyle == U_BS_SOLID) {
-        states->objectTable[index].fill_red = pEmr->lb.lbColor.Red;
-        states->objectTable[index].fill_green = pEmr->lb.lbColor.Green;
-        states->objectTable[index].fill_blue = pEmr->lb.lbColor.Blue;
-        states->objectTable[index].fill_mode = U_BS_SOLID;
-        states->objectTable[index].fill_set = true;
-    } else if (pEmr->lb.lbStyle == U_BS_HATCHED) {
-        states->objectTable[index].fill_recidx =
-            pEmr->ihBrush; // used if the hatch needs to be redone due to
-                           // bkMode, textmode, etc. changes
-        states->objectTable[index].fill_red = pEmr->lb.lbColor.Red;
-        states->objectTable[index].fill_green = pEmr->lb.lbColor.Green;
-        states->objectTable[index].fill_blue = pEmr->lb.lbColor.Blue;
-        states->objectTable[index].fill_mode = U_BS_HATCHED;
-        states->objectTable[index].fill_set = true;
-    } else {
-        states->objectTable[index].fill_red = pEmr->lb.lbColor.Red;
-        states->objectTable[index].fill_green = pEmr->lb.lbColor.Green;
-        states->objectTable[index].fill_blue = pEmr->lb.lbColor.Blue;
-        states->objectTable[index].fill_mode = pEmr->lb.lbStyle;
-        states->objectTable[index].fill_set = true;
-    }
+    emfGraphObject *object = newObject(states, index);
+    if (object == NULL)
+        return;
+    emfBrush brush = {0};
+    brush.color = pEmr->lb.lbColor;
+    brush.mode = pEmr->lb.lbStyle;
+    object->type = OBJECT_BRUSH;
+    object->id = intern_item(states, &(states->brushes), &brush);
 }
-void U_EMRCREATECOLORSPACE_draw(const char *contents, FILE *out,
+void U_EMRCREATECOLORSPACE_draw(const char *contents, svgWriter *out,
                                 drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRCREATECOLORSPACE_print(contents, states);
     }
     // PU_EMRCREATECOLORSPACE pEmr = (PU_EMRCREATECOLORSPACE)(contents);
 }
-void U_EMRCREATECOLORSPACEW_draw(const char *contents, FILE *out,
+void U_EMRCREATECOLORSPACEW_draw(const char *contents, svgWriter *out,
                                  drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRCREATECOLORSPACEW_print(contents, states);
     }
     // PU_EMRCREATECOLORSPACEW pEmr = (PU_EMRCREATECOLORSPACEW)(contents);
 }
-void U_EMRCREATEDIBPATTERNBRUSHPT_draw(const char *contents, FILE *out,
+void U_EMRCREATEDIBPATTERNBRUSHPT_draw(const char *contents, svgWriter *out,
                                        drawingStates *states) {
     PU_EMRCREATEMONOBRUSH pEmr = (PU_EMRCREATEMONOBRUSH)(contents);
 
@@ -81,23 +66,22 @@ void U_EMRCREATEDIBPATTERNBRUSHPT_draw(const char *contents, FILE *out,
     if (image) {
         // draw image;
         uint16_t index = pEmr->ihBrush;
-        returnOutOfOTIndex(index);
-        states->objectTable[index].fill_idx = image->id;
-        states->objectTable[index].fill_red =
-            states->currentDeviceContext.fill_red;
-        states->objectTable[index].fill_green =
-            states->currentDeviceContext.fill_green;
-        states->objectTable[index].fill_blue =
-            states->currentDeviceContext.fill_blue;
-        states->objectTable[index].fill_mode = U_BS_MONOPATTERN;
-        states->objectTable[index].fill_set = true;
+        emfGraphObject *object = newObject(states, index);
+        if (object == NULL)
+            return;
+        emfBrush brush = {0};
+        brush.color = currentBrush(states)->color;
+        brush.mode = U_BS_MONOPATTERN;
+        brush.idx = image->id;
+        object->type = OBJECT_BRUSH;
+        object->id = intern_item(states, &(states->brushes), &brush);
     }
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRCREATEDIBPATTERNBRUSHPT_print(contents, states);
     }
 }
-void U_EMRCREATEMONOBRUSH_draw(const char *contents, FILE *out,
+void U_EMRCREATEMONOBRUSH_draw(const char *contents, svgWriter *out,
                                drawingStates *states) {
     PU_EMRCREATEMONOBRUSH pEmr = (PU_EMRCREATEMONOBRUSH)(contents);
 
@@ -119,69 +103,63 @@ void U_EMRCREATEMONOBRUSH_draw(const char *contents, FILE *out,
     if (image) {
         // draw image;
         uint16_t index = pEmr->ihBrush;
-        returnOutOfOTIndex(index);
-        states->objectTable[index].fill_idx = image->id;
-        states->objectTable[index].fill_red =
-            states->currentDeviceContext.fill_red;
-        states->objectTable[index].fill_green =
-            states->currentDeviceContext.fill_green;
-        states->objectTable[index].fill_blue =
-            states->currentDeviceContext.fill_blue;
-        states->objectTable[index].fill_mode = U_BS_MONOPATTERN;
-        states->objectTable[index].fill_set = true;
+        emfGraphObject *object = newObject(states, index);
+        if (object == NULL)
+            return;
+        emfBrush brush = {0};
+        brush.color = currentBrush(states)->color;
+        brush.mode = U_BS_MONOPATTERN;
+        brush.idx = image->id;
+        object->type = OBJECT_BRUSH;
+        object->id = intern_item(states, &(states->brushes), &brush);
     }
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRCREATEMONOBRUSH_print(contents, states);
     }
 }
-void U_EMRCREATEPALETTE_draw(const char *contents, FILE *out,
+void U_EMRCREATEPALETTE_draw(const char *contents, svgWriter *out,
                              drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRCREATEPALETTE_print(contents, states);
     }
     // PU_EMRCREATEPALETTE pEmr = (PU_EMRCREATEPALETTE)(contents);
 }
-void U_EMRCREATEPEN_draw(const char *contents, FILE *out,
+void U_EMRCREATEPEN_draw(const char *contents, svgWriter *out,
                          drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRCREATEPEN_print(contents, states);
     }
 
     PU_EMRCREATEPEN pEmr = (PU_EMRCREATEPEN)(contents);
 
     uint32_t index = pEmr->ihPen;
-    returnOutOfOTIndex(index);
-    states->objectTable[index].stroke_set = true;
-    states->objectTable[index].stroke_red = pEmr->lopn.lopnColor.Red;
-    states->objectTable[index].stroke_blue = pEmr->lopn.lopnColor.Blue;
-    states->objectTable[index].stroke_green = pEmr->lopn.lopnColor.Green;
-    states->objectTable[index].stroke_mode = pEmr->lopn.lopnStyle;
-    states->objectTable[index].stroke_width = pEmr->lopn.lopnWidth.x;
+    emfGraphObject *object = newObject(states, index);
+    if (object == NULL)
+        return;
+    emfPen pen = {0};
+    pen.color = pEmr->lopn.lopnColor;
+    pen.mode = pEmr->lopn.lopnStyle;
+    pen.width = pEmr->lopn.lopnWidth.x;
+    object->type = OBJECT_PEN;
+    object->id = intern_item(states, &(states->pens), &pen);
 }
-void U_EMREXTCREATEFONTINDIRECTW_draw(const char *contents, FILE *out,
+void U_EMREXTCREATEFONTINDIRECTW_draw(const char *contents, svgWriter *out,
                                       drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMREXTCREATEFONTINDIRECTW_print(contents, states);
     }
     PU_EMREXTCREATEFONTINDIRECTW pEmr =
         (PU_EMREXTCREATEFONTINDIRECTW)(contents);
     uint16_t index = pEmr->ihFont;
-    returnOutOfOTIndex(index);
-    if (states->objectTable[index].font_name != NULL) {
-        free(states->objectTable[index].font_name);
-        states->objectTable[index].font_name = NULL;
-    }
-
-    if (states->objectTable[index].font_family != NULL) {
-        free(states->objectTable[index].font_family);
-        states->objectTable[index].font_family = NULL;
-    }
-
+    emfGraphObject *object = newObject(states, index);
+    if (object == NULL)
+        return;
     U_LOGFONT logfont;
+    emfFont font = {0};
 
     if (pEmr->emr.nSize ==
         sizeof(U_EMREXTCREATEFONTINDIRECTW)) { // holds logfont_panose
@@ -189,41 +167,43 @@ void U_EMREXTCREATEFONTINDIRECTW_draw(const char *contents, FILE *out,
         logfont = pEmr->elfw.elfLogFont;
         char *fullname =
             U_Utf16leToUtf8(lfp.elfFullName, U_LF_FULLFACESIZE, NULL);
-        states->objectTable[index].font_name = fullname;
+        font.name = intern_string(states, &(states->strings), fullname);
     } else { // holds logfont
         logfont = *(PU_LOGFONT) & (pEmr->elfw);
     }
     char *family = U_Utf16leToUtf8(logfont.lfFaceName, U_LF_FACESIZE, NULL);
-    states->objectTable[index].font_width = abs(logfont.lfWidth);
-    states->objectTable[index].font_height = abs(logfont.lfHeight);
-    states->objectTable[index].font_weight = logfont.lfWeight;
-    states->objectTable[index].font_italic = logfont.lfItalic;
-    states->objectTable[index].font_underline = logfont.lfUnderline;
-    states->objectTable[index].font_strikeout = logfont.lfStrikeOut;
-    states->objectTable[index].font_escapement = (logfont.lfEscapement % 3600);
-    states->objectTable[index].font_orientation =
-        (logfont.lfOrientation % 3600);
-    states->objectTable[index].font_family = family;
-    states->objectTable[index].font_set = true;
-    states->objectTable[index].font_charset = logfont.lfCharSet;
+    font.width = abs(logfont.lfWidth);
+    font.height = abs(logfont.lfHeight);
+    font.weight = logfont.lfWeight;
+    font.italic = logfont.lfItalic;
+    font.underline = logfont.lfUnderline;
+    font.strikeout = logfont.lfStrikeOut;
+    font.escapement = (logfont.lfEscapement % 3600);
+    font.orientation = (logfont.lfOrientation % 3600);
+    font.family = intern_string(states, &(states->strings), family);
+    font.charset = logfont.lfCharSet;
+    object->type = OBJECT_FONT;
+    object->id = intern_item(states, &(states->fonts), &font);
 }
-void U_EMREXTCREATEPEN_draw(const char *contents, FILE *out,
+void U_EMREXTCREATEPEN_draw(const char *contents, svgWriter *out,
                             drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMREXTCREATEPEN_print(contents, states);
     }
     PU_EMREXTCREATEPEN pEmr = (PU_EMREXTCREATEPEN)(contents);
     uint32_t index = pEmr->ihPen;
-    returnOutOfOTIndex(index);
-
-    PU_EXTLOGPEN pen = (PU_EXTLOGPEN) & (pEmr->elp);
-    states->objectTable[index].stroke_set = true;
-    states->objectTable[index].stroke_red = pen->elpColor.Red;
-    states->objectTable[index].stroke_blue = pen->elpColor.Blue;
-    states->objectTable[index].stroke_green = pen->elpColor.Green;
-    states->objectTable[index].stroke_mode = pen->elpPenStyle;
-    states->objectTable[index].stroke_width = pen->elpWidth;
+    emfGraphObject *object = newObject(states, index);
+    if (object == NULL)
+        return;
+
+    PU_EXTLOGPEN elp = (PU_EXTLOGPEN) & (pEmr->elp);
+    emfPen pen = {0};
+    pen.color = elp->elpColor;
+    pen.mode = elp->elpPenStyle;
+    pen.width = elp->elpWidth;
+    object->type = OBJECT_PEN;
+    object->id = intern_item(states, &(states->pens), &pen);
 }
 
 #ifdef __cplusplus
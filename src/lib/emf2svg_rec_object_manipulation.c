@@ -11,17 +11,17 @@ extern "C" {
 #include <stdlib.h>
 #include <string.h>
 
-void U_EMRDELETECOLORSPACE_draw(const char *contents, FILE *out,
+void U_EMRDELETECOLORSPACE_draw(const char *contents, svgWriter *out,
                                 drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRDELETECOLORSPACE_print(contents, states);
     }
 }
-void U_EMRDELETEOBJECT_draw(const char *contents, FILE *out,
+void U_EMRDELETEOBJECT_draw(const char *contents, svgWriter *out,
                             drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRDELETEOBJECT_print(contents, states);
     }
     PU_EMRDELETEOBJECT pEmr = (PU_EMRDELETEOBJECT)(contents);
@@ -29,25 +29,59 @@ void U_EMRDELETEOBJECT_draw(const char *contents, FILE *out,
     returnOutOfOTIndex(index);
     freeObject(states, index);
 }
-void U_EMRREALIZEPALETTE_draw(const char *contents, FILE *out,
+void U_EMRREALIZEPALETTE_draw(const char *contents, svgWriter *out,
                               drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRREALIZEPALETTE_print(contents, states);
     }
     UNUSED(contents);
 }
-void U_EMRRESIZEPALETTE_draw(const char *contents, FILE *out,
+void U_EMRRESIZEPALETTE_draw(const char *contents, svgWriter *out,
                              drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRRESIZEPALETTE_print(contents, states);
     }
 }
-void U_EMRSELECTOBJECT_draw(const char *contents, FILE *out,
+static void select_brush(drawingStates *states, uint32_t id) {
+    if (states->currentDeviceContext.brush == id)
+        return;
+    states->currentDeviceContext.brush = id;
+    // the null pen is drawn with the fill color
+    states->currentDeviceContext.dirty |= DC_DIRTY_FILL | DC_DIRTY_STROKE;
+}
+static void select_pen(drawingStates *states, uint32_t id) {
+    if (states->currentDeviceContext.pen == id)
+        return;
+    states->currentDeviceContext.pen = id;
+    states->currentDeviceContext.dirty |= DC_DIRTY_STROKE;
+}
+static void select_font(drawingStates *states, uint32_t id) {
+    if (states->currentDeviceContext.font == id)
+        return;
+    states->currentDeviceContext.font = id;
+    states->currentDeviceContext.dirty |= DC_DIRTY_TEXT;
+}
+// stock brushes and pens: gray level, the null ones keep the current color
+static void select_stock_brush(drawingStates *states, int mode, uint8_t gray) {
+    emfBrush brush = *currentBrush(states);
+    if (mode != U_BS_NULL)
+        brush.color = (U_COLORREF){gray, gray, gray, 0};
+    brush.mode = mode;
+    select_brush(states, intern_item(states, &(states->brushes), &brush));
+}
+static void select_stock_pen(drawingStates *states, int mode, uint8_t gray) {
+    emfPen pen = *currentPen(states);
+    if (mode != U_PS_NULL)
+        pen.color = (U_COLORREF){gray, gray, gray, 0};
+    pen.mode = mode;
+    select_pen(states, intern_item(states, &(states->pens), &pen));
+}
+void U_EMRSELECTOBJECT_draw(const char *contents, svgWriter *out,
                             drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSELECTOBJECT_print(contents, states);
     }
     PU_EMRSELECTOBJECT pEmr = (PU_EMRSELECTOBJECT)(contents);
@@ -55,52 +89,31 @@ void U_EMRSELECTOBJECT_draw(const char *contents, FILE *out,
     if (index & U_STOCK_OBJECT) {
         switch (index) {
         case (U_WHITE_BRUSH):
-            states->currentDeviceContext.fill_red = 0xFF;
-            states->currentDeviceContext.fill_blue = 0xFF;
-            states->currentDeviceContext.fill_green = 0xFF;
-            states->currentDeviceContext.fill_mode = U_BS_SOLID;
+            select_stock_brush(states, U_BS_SOLID, 0xFF);
             break;
         case (U_LTGRAY_BRUSH):
-            states->currentDeviceContext.fill_red = 0xC0;
-            states->currentDeviceContext.fill_blue = 0xC0;
-            states->currentDeviceContext.fill_green = 0xC0;
-            states->currentDeviceContext.fill_mode = U_BS_SOLID;
+            select_stock_brush(states, U_BS_SOLID, 0xC0);
             break;
         case (U_GRAY_BRUSH):
-            states->currentDeviceContext.fill_red = 0x80;
-            states->currentDeviceContext.fill_blue = 0x80;
-            states->currentDeviceContext.fill_green = 0x80;
-            states->currentDeviceContext.fill_mode = U_BS_SOLID;
+            select_stock_brush(states, U_BS_SOLID, 0x80);
             break;
         case (U_DKGRAY_BRUSH):
-            states->currentDeviceContext.fill_red = 0x40;
-            states->currentDeviceContext.fill_blue = 0x40;
-            states->currentDeviceContext.fill_green = 0x40;
-            states->currentDeviceContext.fill_mode = U_BS_SOLID;
+            select_stock_brush(states, U_BS_SOLID, 0x40);
             break;
         case (U_BLACK_BRUSH):
-            states->currentDeviceContext.fill_red = 0x00;
-            states->currentDeviceContext.fill_blue = 0x00;
-            states->currentDeviceContext.fill_green = 0x00;
-            states->currentDeviceContext.fill_mode = U_BS_SOLID;
+            select_stock_brush(states, U_BS_SOLID, 0x00);
             break;
         case (U_NULL_BRUSH):
-            states->currentDeviceContext.fill_mode = U_BS_NULL;
+            select_stock_brush(states, U_BS_NULL, 0);
             break;
         case (U_WHITE_PEN):
-            states->currentDeviceContext.stroke_red = 0xFF;
-            states->currentDeviceContext.stroke_blue = 0xFF;
-            states->currentDeviceContext.stroke_green = 0xFF;
-            states->currentDeviceContext.stroke_mode = U_PS_SOLID;
+            select_stock_pen(states, U_PS_SOLID, 0xFF);
             break;
         case (U_BLACK_PEN):
-            states->currentDeviceContext.stroke_red = 0x00;
-            states->currentDeviceContext.stroke_blue = 0x00;
-            states->currentDeviceContext.stroke_green = 0x00;
-            states->currentDeviceContext.stroke_mode = U_PS_SOLID;
+            select_stock_pen(states, U_PS_SOLID, 0x00);
             break;
         case (U_NULL_PEN):
-            states->currentDeviceContext.stroke_mode = U_PS_NULL;
+            select_stock_pen(states, U_PS_NULL, 0);
             break;
         case (U_OEM_FIXED_FONT):
             break;
@@ -123,91 +136,42 @@ void U_EMRSELECTOBJECT_draw(const char *contents, FILE *out,
         }
     } else {
         returnOutOfOTIndex(index);
-        if (states->objectTable[index].fill_set) {
-            states->currentDeviceContext.fill_red =
-                states->objectTable[index].fill_red;
-            states->currentDeviceContext.fill_blue =
-                states->objectTable[index].fill_blue;
-            states->currentDeviceContext.fill_green =
-                states->objectTable[index].fill_green;
-            states->currentDeviceContext.fill_mode =
-                states->objectTable[index].fill_mode;
-            states->currentDeviceContext.fill_idx =
-                states->objectTable[index].fill_idx;
-        } else if (states->objectTable[index].stroke_set) {
-            states->currentDeviceContext.stroke_red =
-                states->objectTable[index].stroke_red;
-            states->currentDeviceContext.stroke_blue =
-                states->objectTable[index].stroke_blue;
-            states->currentDeviceContext.stroke_green =
-                states->objectTable[index].stroke_green;
-            states->currentDeviceContext.stroke_mode =
-                states->objectTable[index].stroke_mode;
-            states->currentDeviceContext.stroke_width =
-                states->objectTable[index].stroke_width;
-        } else if (states->objectTable[index].font_set) {
-            states->currentDeviceContext.font_width =
-                states->objectTable[index].font_width;
-            states->currentDeviceContext.font_height =
-                states->objectTable[index].font_height;
-            states->currentDeviceContext.font_weight =
-                states->objectTable[index].font_weight;
-            states->currentDeviceContext.font_italic =
-                states->objectTable[index].font_italic;
-            states->currentDeviceContext.font_underline =
-                states->objectTable[index].font_underline;
-            states->currentDeviceContext.font_strikeout =
-                states->objectTable[index].font_strikeout;
-            states->currentDeviceContext.font_escapement =
-                states->objectTable[index].font_escapement;
-            states->currentDeviceContext.font_orientation =
-                states->objectTable[index].font_orientation;
-            states->currentDeviceContext.font_charset =
-                states->objectTable[index].font_charset;
-
-            if (states->currentDeviceContext.font_name != NULL) {
-                free(states->currentDeviceContext.font_name);
-                states->currentDeviceContext.font_name = NULL;
-            }
-            if (states->objectTable[index].font_name != NULL) {
-                size_t len = strlen(states->objectTable[index].font_name);
-                states->currentDeviceContext.font_name =
-                    calloc((len + 1), sizeof(char));
-                strcpy(states->currentDeviceContext.font_name,
-                       states->objectTable[index].font_name);
-            }
-            if (states->currentDeviceContext.font_family != NULL) {
-                free(states->currentDeviceContext.font_family);
-                states->currentDeviceContext.font_family = NULL;
-            }
-            if (states->objectTable[index].font_family != NULL) {
-                size_t len = strlen(states->objectTable[index].font_family);
-                states->currentDeviceContext.font_family =
-                    calloc((len + 1), sizeof(char));
-                strcpy(states->currentDeviceContext.font_family,
-                       states->objectTable[index].font_family);
-            }
+        const emfGraphObject *object = getObject(states, index);
+        if (object == NULL)
+            return;
+        switch (object->type) {
+        case OBJECT_BRUSH:
+            select_brush(states, object->id);
+            break;
+        case OBJECT_PEN:
+            select_pen(states, object->id);
+            break;
+        case OBJECT_FONT:
+            select_font(states, object->id);
+            break;
+        default:
+            break;
         }
     }
 }
-void U_EMRSELECTPALETTE_draw(const char *contents, FILE *out,
+void U_EMRSELECTPALETTE_draw(const char *contents, svgWriter *out,
                              drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSELECTPALETTE_print(contents, states);
     }
 }
-void U_EMRSETCOLORSPACE_draw(const char *contents, FILE *out,
+void U_EMRSETCOLORSPACE_draw(const char *contents, svgWriter *out,
                              drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETCOLORSPACE_print(contents, states);
     }
 }
-void U_EMRSETPALETTEENTRIES_draw(const char *contents, FILE *out,
+void U_EMRSETPALETTEENTRIES_draw(const char *contents, svgWriter *out,
                                  drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETPALETTEENTRIES_print(contents, states);
     }
     // PU_EMRSETPALETTEENTRIES pEmr = (PU_EMRSETPALETTEENTRIES)(contents);
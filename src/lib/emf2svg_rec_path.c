@@ -10,52 +10,58 @@ extern "C" {
 #include <stdio.h>
 #include <stdlib.h>
 
-void U_EMRBEGINPATH_draw(const char *contents, FILE *out,
+void U_EMRBEGINPATH_draw(const char *contents, svgWriter *out,
                          drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRBEGINPATH_print(contents, states);
     }
-    pathStack *stack = states->emfStructure.pathStack;
-    if (stack == NULL) {
+    emfStruct *structure = &(states->emfStructure);
+    if (structure->next >= structure->count) {
         states->Error = true;
         return;
     }
-    if (stack->pathStruct.wtBeforeSet) {
-        if (stack->pathStruct.wtBeforeiMode) {
-            bool draw = transform_set(states, stack->pathStruct.wtBeforexForm,
-                                      stack->pathStruct.wtBeforeiMode);
+    pathStruct *path = &(structure->paths[structure->next]);
+    if (path->wtBeforeSet) {
+        if (path->wtBeforeiMode) {
+            bool draw = transform_set(states, path->wtBeforexForm,
+                                      path->wtBeforeiMode);
             if (draw)
                 transform_draw(states, out);
         } else {
-            states->currentDeviceContext.worldTransform =
-                stack->pathStruct.wtBeforexForm;
+            states->currentDeviceContext.worldTransform = path->wtBeforexForm;
             transform_draw(states, out);
         }
     }
-    fprintf(out, "<%spath d=\"", states->nameSpaceString);
+    clipset_draw(states, out);
+    svg_append_literal(out, "<");
+    svg_append_string(out, states->nameSpaceString);
+    svg_append_literal(out, "path d=\"");
+    path_data_start(states, &(states->pathData));
     // free previously recorded path
     free_path(&(states->currentPath));
     states->inPath = true;
     UNUSED(contents);
 }
-void U_EMRENDPATH_draw(const char *contents, FILE *out, drawingStates *states) {
+void U_EMRENDPATH_draw(const char *contents, svgWriter *out,
+                       drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRENDPATH_print(contents, states);
     }
-    fprintf(out, "\" ");
+    path_data_end(&(states->pathData), out, false);
     states->inPath = false;
     bool filled = false;
     bool stroked = false;
-    pathStack *stack = states->emfStructure.pathStack;
-    if (stack == NULL) {
+    emfStruct *structure = &(states->emfStructure);
+    if (structure->next >= structure->count) {
         states->Error = true;
         return;
     }
-    uint32_t fillOffset = stack->pathStruct.fillOffset;
-    uint32_t strokeOffset = stack->pathStruct.strokeOffset;
-    uint32_t strokeFillOffset = stack->pathStruct.strokeFillOffset;
+    pathStruct *path = &(structure->paths[structure->next]);
+    uint32_t fillOffset = path->fillOffset;
+    uint32_t strokeOffset = path->strokeOffset;
+    uint32_t strokeFillOffset = path->strokeFillOffset;
     if (fillOffset != 0)
         fill_draw(states, out, &filled, &stroked);
     if (strokeOffset != 0)
@@ -65,49 +71,47 @@ void U_EMRENDPATH_draw(const char *contents, FILE *out, drawingStates *states) {
         stroke_draw(states, out, &filled, &stroked);
     }
     if (!filled)
-        fprintf(out, "fill=\"none\" ");
+        svg_append_literal(out, "fill=\"none\" ");
     if (!stroked)
-        fprintf(out, "stroke=\"none\" ");
+        svg_append_literal(out, "stroke=\"none\" ");
 
-    fprintf(out, "/>\n");
-    if (stack->pathStruct.wtAfterSet) {
-        if (stack->pathStruct.wtBeforeiMode) {
-            bool draw = transform_set(states, stack->pathStruct.wtAfterxForm,
-                                      stack->pathStruct.wtAfteriMode);
+    svg_append_literal(out, "/>\n");
+    if (path->wtAfterSet) {
+        if (path->wtBeforeiMode) {
+            bool draw = transform_set(states, path->wtAfterxForm,
+                                      path->wtAfteriMode);
             if (draw)
                 transform_draw(states, out);
         } else {
-            states->currentDeviceContext.worldTransform =
-                stack->pathStruct.wtAfterxForm;
+            states->currentDeviceContext.worldTransform = path->wtAfterxForm;
             transform_draw(states, out);
         }
     }
-    states->emfStructure.pathStack = stack->next;
-    free(stack);
+    structure->next++;
     UNUSED(contents);
 }
-void U_EMRFLATTENPATH_draw(const char *contents, FILE *out,
+void U_EMRFLATTENPATH_draw(const char *contents, svgWriter *out,
                            drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRFLATTENPATH_print(contents, states);
     }
     UNUSED(contents);
 }
-void U_EMRABORTPATH_draw(const char *contents, FILE *out,
+void U_EMRABORTPATH_draw(const char *contents, svgWriter *out,
                          drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRABORTPATH_print(contents, states);
     }
     // free previously recorded path
     free_path(&(states->currentPath));
     UNUSED(contents);
 }
-void U_EMRWIDENPATH_draw(const char *contents, FILE *out,
+void U_EMRWIDENPATH_draw(const char *contents, svgWriter *out,
                          drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRWIDENPATH_print(contents, states);
     }
     UNUSED(contents);
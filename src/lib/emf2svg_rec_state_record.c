@@ -9,22 +9,22 @@ extern "C" {
 #include "emf2svg_print.h"
 #include <stdio.h>
 
-void U_EMRINVERTRGN_draw(const char *contents, FILE *out,
+void U_EMRINVERTRGN_draw(const char *contents, svgWriter *out,
                          drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRINVERTRGN_print(contents, states);
     }
 }
-void U_EMRMOVETOEX_draw(const char *contents, FILE *out,
+void U_EMRMOVETOEX_draw(const char *contents, svgWriter *out,
                         drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRMOVETOEX_print(contents, states);
     }
 
     if (states->inPath) {
-        fprintf(out, "M ");
+        path_data_cmd(&(states->pathData), out, 'M');
         moveto_draw("U_EMRMOVETOEX", "ptl:", "", contents, out, states);
     } else {
         PU_EMRGENERICPAIR pEmr = (PU_EMRGENERICPAIR)(contents);
@@ -34,49 +34,50 @@ void U_EMRMOVETOEX_draw(const char *contents, FILE *out,
         states->cur_y = pt.y;
     }
 }
-void U_EMRPIXELFORMAT_draw(const char *contents, FILE *out,
+void U_EMRPIXELFORMAT_draw(const char *contents, svgWriter *out,
                            drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRPIXELFORMAT_print(contents, states);
     }
     // PU_EMRPIXELFORMAT pEmr = (PU_EMRPIXELFORMAT)(contents);
 }
-void U_EMRRESTOREDC_draw(const char *contents, FILE *out,
+void U_EMRRESTOREDC_draw(const char *contents, svgWriter *out,
                          drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRRESTOREDC_print(contents, states);
     }
     PU_EMRSETMAPMODE pEmr = (PU_EMRSETMAPMODE)(contents);
     restoreDeviceContext(states, pEmr->iMode);
 }
-void U_EMRSAVEDC_draw(const char *contents, FILE *out, drawingStates *states) {
+void U_EMRSAVEDC_draw(const char *contents, svgWriter *out,
+                      drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSAVEDC_print(contents, states);
     }
     saveDeviceContext(states);
     UNUSED(contents);
 }
-void U_EMRSCALEVIEWPORTEXTEX_draw(const char *contents, FILE *out,
+void U_EMRSCALEVIEWPORTEXTEX_draw(const char *contents, svgWriter *out,
                                   drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSCALEVIEWPORTEXTEX_print(contents, states);
     }
 }
-void U_EMRSCALEWINDOWEXTEX_draw(const char *contents, FILE *out,
+void U_EMRSCALEWINDOWEXTEX_draw(const char *contents, svgWriter *out,
                                 drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSCALEWINDOWEXTEX_print(contents, states);
     }
 }
-void U_EMRSETARCDIRECTION_draw(const char *contents, FILE *out,
+void U_EMRSETARCDIRECTION_draw(const char *contents, svgWriter *out,
                                drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETARCDIRECTION_print(contents, states);
     }
     PU_EMRSETARCDIRECTION pEmr = (PU_EMRSETARCDIRECTION)contents;
@@ -89,139 +90,143 @@ void U_EMRSETARCDIRECTION_draw(const char *contents, FILE *out,
         break;
     }
 }
-void U_EMRSETBKCOLOR_draw(const char *contents, FILE *out,
+void U_EMRSETBKCOLOR_draw(const char *contents, svgWriter *out,
                           drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETBKCOLOR_print(contents, states);
     }
     PU_EMRSETBKCOLOR pEmr = (PU_EMRSETBKCOLOR)(contents);
-    states->currentDeviceContext.bk_red = pEmr->crColor.Red;
-    states->currentDeviceContext.bk_blue = pEmr->crColor.Blue;
-    states->currentDeviceContext.bk_green = pEmr->crColor.Green;
+    states->currentDeviceContext.bk_color = pEmr->crColor;
 }
-void U_EMRSETBKMODE_draw(const char *contents, FILE *out,
+void U_EMRSETBKMODE_draw(const char *contents, svgWriter *out,
                          drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETBKMODE_print(contents, states);
     }
     PU_EMRSETMAPMODE pEmr = (PU_EMRSETMAPMODE)(contents);
     states->currentDeviceContext.bk_mode = pEmr->iMode;
 }
-void U_EMRSETBRUSHORGEX_draw(const char *contents, FILE *out,
+void U_EMRSETBRUSHORGEX_draw(const char *contents, svgWriter *out,
                              drawingStates *states) {
     FLAG_UNUSED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETBRUSHORGEX_print(contents, states);
     }
 }
-void U_EMRSETCOLORADJUSTMENT_draw(const char *contents, FILE *out,
+void U_EMRSETCOLORADJUSTMENT_draw(const char *contents, svgWriter *out,
                                   drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETCOLORADJUSTMENT_print(contents, states);
     }
     // PU_EMRSETCOLORADJUSTMENT pEmr = (PU_EMRSETCOLORADJUSTMENT)(contents);
 }
-void U_EMRSETICMMODE_draw(const char *contents, FILE *out,
+void U_EMRSETICMMODE_draw(const char *contents, svgWriter *out,
                           drawingStates *states) {
     FLAG_UNUSED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETICMMODE_print(contents, states);
     }
 }
-void U_EMRSETLAYOUT_draw(const char *contents, FILE *out,
+void U_EMRSETLAYOUT_draw(const char *contents, svgWriter *out,
                          drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETLAYOUT_print(contents, states);
     }
     PU_EMRSETMAPMODE pEmr = (PU_EMRSETLAYOUT)(contents);
     states->text_layout = pEmr->iMode;
+    states->currentDeviceContext.dirty |= DC_DIRTY_TEXT;
 }
-void U_EMRSETMAPMODE_draw(const char *contents, FILE *out,
+void U_EMRSETMAPMODE_draw(const char *contents, svgWriter *out,
                           drawingStates *states) {
     FLAG_PARTIAL;
     PU_EMRSETMAPMODE pEmr = (PU_EMRSETMAPMODE)(contents);
     states->MapMode = pEmr->iMode;
-    if (states->verbose) {
+    // stroke width depends on the mapping mode
+    states->currentDeviceContext.dirty |= DC_DIRTY_STROKE;
+    if (isVerbose(states)) {
         U_EMRSETMAPMODE_print(contents, states);
     }
 }
-void U_EMRSETMAPPERFLAGS_draw(const char *contents, FILE *out,
+void U_EMRSETMAPPERFLAGS_draw(const char *contents, svgWriter *out,
                               drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETMAPPERFLAGS_print(contents, states);
     }
     // PU_EMRSETMAPPERFLAGS pEmr = (PU_EMRSETMAPPERFLAGS)(contents);
 }
-void U_EMRSETMETARGN_draw(const char *contents, FILE *out,
+void U_EMRSETMETARGN_draw(const char *contents, svgWriter *out,
                           drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETMETARGN_print(contents, states);
     }
     UNUSED(contents);
 }
-void U_EMRSETMITERLIMIT_draw(const char *contents, FILE *out,
+void U_EMRSETMITERLIMIT_draw(const char *contents, svgWriter *out,
                              drawingStates *states) {
     FLAG_SUPPORTED;
     PU_EMRSETMITERLIMIT pEmr = (PU_EMRSETMITERLIMIT)(contents);
     states->currentDeviceContext.miterLimit = pEmr->eMiterLimit;
-    if (states->verbose) {
+    states->currentDeviceContext.dirty |= DC_DIRTY_STROKE;
+    if (isVerbose(states)) {
         U_EMRSETMITERLIMIT_print(contents, states);
     }
 }
-void U_EMRSETPOLYFILLMODE_draw(const char *contents, FILE *out,
+void U_EMRSETPOLYFILLMODE_draw(const char *contents, svgWriter *out,
                                drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETPOLYFILLMODE_print(contents, states);
     }
     PU_EMRSETMAPMODE pEmr = (PU_EMRSETMAPMODE)(contents);
     states->currentDeviceContext.fill_polymode = pEmr->iMode;
+    states->currentDeviceContext.dirty |= DC_DIRTY_FILL;
 }
-void U_EMRSETROP2_draw(const char *contents, FILE *out, drawingStates *states) {
+void U_EMRSETROP2_draw(const char *contents, svgWriter *out,
+                       drawingStates *states) {
     FLAG_IGNORED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETROP2_print(contents, states);
     }
 }
-void U_EMRSETSTRETCHBLTMODE_draw(const char *contents, FILE *out,
+void U_EMRSETSTRETCHBLTMODE_draw(const char *contents, svgWriter *out,
                                  drawingStates *states) {
     FLAG_PARTIAL;
     PU_EMRSETMAPMODE pEmr = (PU_EMRSETMAPMODE)(contents);
     states->currentDeviceContext.stretchMode = pEmr->iMode;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETSTRETCHBLTMODE_print(contents, states);
     }
 }
-void U_EMRSETTEXTALIGN_draw(const char *contents, FILE *out,
+void U_EMRSETTEXTALIGN_draw(const char *contents, svgWriter *out,
                             drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETTEXTALIGN_print(contents, states);
     }
     PU_EMRSETMAPMODE pEmr = (PU_EMRSETMAPMODE)(contents);
     states->currentDeviceContext.text_align = pEmr->iMode;
+    states->currentDeviceContext.dirty |= DC_DIRTY_TEXT;
 }
-void U_EMRSETTEXTCOLOR_draw(const char *contents, FILE *out,
+void U_EMRSETTEXTCOLOR_draw(const char *contents, svgWriter *out,
                             drawingStates *states) {
     FLAG_PARTIAL;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETTEXTCOLOR_print(contents, states);
     }
     PU_EMRSETTEXTCOLOR pEmr = (PU_EMRSETTEXTCOLOR)(contents);
-    states->currentDeviceContext.text_red = pEmr->crColor.Red;
-    states->currentDeviceContext.text_blue = pEmr->crColor.Blue;
-    states->currentDeviceContext.text_green = pEmr->crColor.Green;
+    states->currentDeviceContext.text_color = pEmr->crColor;
+    states->currentDeviceContext.dirty |= DC_DIRTY_TEXT;
 }
-void U_EMRSETVIEWPORTEXTEX_draw(const char *contents, FILE *out,
+void U_EMRSETVIEWPORTEXTEX_draw(const char *contents, svgWriter *out,
                                 drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETVIEWPORTEXTEX_print(contents, states);
     }
     PU_EMRSETVIEWPORTEXTEX pEmr = (PU_EMRSETVIEWPORTEXTEX)(contents);
@@ -229,21 +234,22 @@ void U_EMRSETVIEWPORTEXTEX_draw(const char *contents, FILE *out,
     states->viewPortExX = (double)pEmr->szlExtent.cx;
     states->viewPortExY = (double)pEmr->szlExtent.cy;
     states->viewPortExSet = true;
+    states->currentDeviceContext.dirty |= DC_DIRTY_STROKE;
 }
-void U_EMRSETVIEWPORTORGEX_draw(const char *contents, FILE *out,
+void U_EMRSETVIEWPORTORGEX_draw(const char *contents, svgWriter *out,
                                 drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETVIEWPORTORGEX_print(contents, states);
     }
     PU_EMRSETVIEWPORTORGEX pEmr = (PU_EMRSETVIEWPORTORGEX)(contents);
     states->viewPortOrgX = (double)pEmr->ptlOrigin.x;
     states->viewPortOrgY = (double)pEmr->ptlOrigin.y;
 }
-void U_EMRSETWINDOWEXTEX_draw(const char *contents, FILE *out,
+void U_EMRSETWINDOWEXTEX_draw(const char *contents, svgWriter *out,
                               drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETWINDOWEXTEX_print(contents, states);
     }
 
@@ -251,11 +257,12 @@ void U_EMRSETWINDOWEXTEX_draw(const char *contents, FILE *out,
     states->windowExX = (double)pEmr->szlExtent.cx;
     states->windowExY = (double)pEmr->szlExtent.cy;
     states->windowExSet = true;
+    states->currentDeviceContext.dirty |= DC_DIRTY_STROKE;
 }
-void U_EMRSETWINDOWORGEX_draw(const char *contents, FILE *out,
+void U_EMRSETWINDOWORGEX_draw(const char *contents, svgWriter *out,
                               drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETWINDOWORGEX_print(contents, states);
     }
 
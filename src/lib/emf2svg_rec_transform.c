@@ -10,10 +10,10 @@ extern "C" {
 #include "emf2svg_print.h"
 #include <stdio.h>
 
-void U_EMRMODIFYWORLDTRANSFORM_draw(const char *contents, FILE *out,
+void U_EMRMODIFYWORLDTRANSFORM_draw(const char *contents, svgWriter *out,
                                     drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRMODIFYWORLDTRANSFORM_print(contents, states);
     }
     PU_EMRMODIFYWORLDTRANSFORM pEmr = (PU_EMRMODIFYWORLDTRANSFORM)(contents);
@@ -21,10 +21,10 @@ void U_EMRMODIFYWORLDTRANSFORM_draw(const char *contents, FILE *out,
     if (draw)
         transform_draw(states, out);
 }
-void U_EMRSETWORLDTRANSFORM_draw(const char *contents, FILE *out,
+void U_EMRSETWORLDTRANSFORM_draw(const char *contents, svgWriter *out,
                                  drawingStates *states) {
     FLAG_SUPPORTED;
-    if (states->verbose) {
+    if (isVerbose(states)) {
         U_EMRSETWORLDTRANSFORM_print(contents, states);
     }
     PU_EMRSETWORLDTRANSFORM pEmr = (PU_EMRSETWORLDTRANSFORM)(contents);
@@ -0,0 +1,1124 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DARWIN
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "emf2svg_private.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Polygon boolean engine used to compute clipping regions.
+ *
+ * Both operands are flattened into edge lists (Bezier and arc sections are
+ * approximated by line segments, with a maximum deviation of 'tolerance').
+ * A sweep is then done from top to bottom, stopping at the edge end points
+ * and at the edge crossings. The active edges are kept sorted by abscissa
+ * in a linked list, indexed by a treap for the insertions: at each stop,
+ * ended edges are removed, crossed edges are swapped and starting edges
+ * are inserted. Crossings are only computed for edges becoming neighbours,
+ * and queued in a heap giving the next stops.
+ *
+ * Each active edge keeps the winding numbers of the two operands on its
+ * right, and if the result is inside there. At a stop, they are updated
+ * from the modified edges to the right, only as long as they change. Edges
+ * where the result starts (left bounds) or ends (right bounds) delimit the
+ * spans of the result, each span building one polygon from top to bottom.
+ * Only the spans around the updated edges are looked at: a span having the
+ * same corners as before the stop continues its polygon, otherwise the
+ * polygon is finished and a new one is started.
+ *
+ * A stop costs O(log n) per modified edge, O((n + k) log n) overall for n
+ * edges and k crossings (or winding changes under horizontal edges).
+ *
+ * The result is a list of disjoint closed polygons, which renders the same
+ * with nonzero and evenodd fill rules.
+ */
+
+// max distance between two points considered equal (in output pixels)
+#define RGN_EPSILON 1e-6
+// upper bound of the number of segments used to flatten one curve
+#define RGN_MAX_CURVE_STEPS 1024
+
+// the result starts on the right of the edge (left bound of a span)
+#define RGN_BOUND_LEFT 1
+// the result ends on the right of the edge (right bound of a span)
+#define RGN_BOUND_RIGHT 2
+
+typedef struct rgnPoly rgnPoly;
+typedef struct rgnNode rgnNode;
+
+typedef struct rgnEdge {
+    double ytop;
+    double ybot;
+    double xtop;
+    double dxdy;
+    // +1 if the edge is going downward, -1 otherwise
+    int winding;
+    // 0 for the first operand, 1 for the second one
+    int operand;
+    // neighbours in the active edges, sorted by abscissa
+    struct rgnEdge *prev;
+    struct rgnEdge *next;
+    // right neighbour when their crossing was last computed
+    struct rgnEdge *right;
+    rgnNode *node;
+    // winding numbers of the operands on the right of the edge, and if the
+    // result is inside there
+    int wa;
+    int wb;
+    bool in;
+    // RGN_BOUND_LEFT, RGN_BOUND_RIGHT or 0
+    int bound;
+    // polygon of the span bounded by the edge on the left/on the right
+    rgnPoly *poly;
+    rgnPoly *rpoly;
+    // last stop where the edge was modified, updated, or started a span
+    uint32_t anchor_stamp;
+    uint32_t dirty_stamp;
+    uint32_t span_stamp;
+} rgnEdge;
+
+// treap node, the in order traversal gives the active edges
+struct rgnNode {
+    rgnEdge *edge;
+    rgnNode *parent;
+    rgnNode *child[2];
+    uint32_t priority;
+    // number of span bounds in the subtree
+    size_t bounds;
+};
+
+typedef struct {
+    rgnEdge *edges;
+    size_t count;
+    size_t size;
+    bool error;
+} rgnEdgeList;
+
+// crossing of two neighbour edges, left and right above y
+typedef struct {
+    double y;
+    rgnEdge *left;
+    rgnEdge *right;
+} rgnCross;
+
+// min heap of the crossings, ordered by y
+typedef struct {
+    rgnCross *items;
+    size_t count;
+    size_t size;
+} rgnHeap;
+
+typedef struct {
+    POINT_D *pts;
+    size_t count;
+    size_t size;
+} rgnChain;
+
+// polygon being built, left and right chains from top to bottom
+struct rgnPoly {
+    rgnChain left;
+    rgnChain right;
+    // bounds of its span
+    rgnEdge *lbound;
+    rgnEdge *rbound;
+    // corners at the current stop
+    double xl;
+    double xr;
+    // open polygons
+    rgnPoly *prev;
+    rgnPoly *next;
+    uint32_t stamp;
+};
+
+// edge sorted by abscissa at the current stop
+typedef struct {
+    double x;
+    double dxdy;
+    rgnEdge *edge;
+} rgnKey;
+
+// span of the result at the current stop
+typedef struct {
+    rgnEdge *left;
+    rgnEdge *right;
+    double xl;
+    double xr;
+} rgnSpan;
+
+typedef struct {
+    uint32_t mode;
+    int fill_a;
+    int fill_b;
+    // current stop
+    double y0;
+    uint32_t stamp;
+    // treap priorities
+    uint32_t seed;
+    rgnNode *root;
+    rgnHeap heap;
+    // neighbour pairs to check for crossings at the current stop
+    rgnEdge **pairs;
+    size_t n_pairs;
+    size_t s_pairs;
+    // edges modified, then updated, and edges removed at the current stop
+    // (at most all the edges)
+    rgnKey *anchors;
+    size_t n_anchors;
+    rgnEdge **dirty;
+    size_t n_dirty;
+    rgnEdge **removed;
+    size_t n_removed;
+    // polygons and spans around the updated edges
+    rgnPoly **polys;
+    size_t n_polys;
+    size_t s_polys;
+    rgnSpan *spans;
+    size_t n_spans;
+    size_t s_spans;
+    rgnPoly *open;
+    PATH *out;
+    bool error;
+} rgnSweep;
+
+static void rgn_add_edge(rgnEdgeList *list, POINT_D a, POINT_D b,
+                         int operand) {
+    if (a.y == b.y || !isfinite(a.x) || !isfinite(a.y) || !isfinite(b.x) ||
+        !isfinite(b.y))
+        return;
+    if (list->count == list->size) {
+        size_t size = list->size ? list->size * 2 : 64;
+        rgnEdge *edges = realloc(list->edges, size * sizeof(rgnEdge));
+        if (edges == NULL) {
+            list->error = true;
+            return;
+        }
+        list->edges = edges;
+        list->size = size;
+    }
+    rgnEdge *e = &(list->edges[list->count++]);
+    if (a.y < b.y) {
+        e->winding = 1;
+    } else {
+        POINT_D tmp = a;
+        a = b;
+        b = tmp;
+        e->winding = -1;
+    }
+    e->ytop = a.y;
+    e->ybot = b.y;
+    e->xtop = a.x;
+    e->dxdy = (b.x - a.x) / (b.y - a.y);
+    e->operand = operand;
+}
+
+static void rgn_flatten_bezier(rgnEdgeList *list, POINT_D p0, POINT_D *pt,
+                               double tolerance, int operand) {
+    POINT_D p1 = pt[0];
+    POINT_D p2 = pt[1];
+    POINT_D p3 = pt[2];
+    // the deviation of an uniform subdivision in n segments is bounded
+    // by 3/4 * max(second differences) / n^2
+    double ddx1 = p0.x - 2 * p1.x + p2.x;
+    double ddy1 = p0.y - 2 * p1.y + p2.y;
+    double ddx2 = p1.x - 2 * p2.x + p3.x;
+    double ddy2 = p1.y - 2 * p2.y + p3.y;
+    double dd = fmax(ddx1 * ddx1 + ddy1 * ddy1, ddx2 * ddx2 + ddy2 * ddy2);
+    double steps = ceil(sqrt(0.75 * sqrt(dd) / tolerance));
+    int n = 1;
+    if (steps > RGN_MAX_CURVE_STEPS)
+        n = RGN_MAX_CURVE_STEPS;
+    else if (steps > 1)
+        n = (int)steps;
+
+    POINT_D prev = p0;
+    for (int i = 1; i <= n; i++) {
+        double t = (double)i / n;
+        double mt = 1 - t;
+        POINT_D cur;
+        cur.x = mt * mt * mt * p0.x + 3 * mt * mt * t * p1.x +
+                3 * mt * t * t * p2.x + t * t * t * p3.x;
+        cur.y = mt * mt * mt * p0.y + 3 * mt * mt * t * p1.y +
+                3 * mt * t * t * p2.y + t * t * t * p3.y;
+        rgn_add_edge(list, prev, cur, operand);
+        prev = cur;
+    }
+}
+
+// arc sections only record the radii and the end point, flags are
+// not kept in PATH, so small arc and positive angle direction are assumed
+// (same as the conversion to SVG endpoint parameterization, see SVG F.6.5)
+static void rgn_flatten_arc(rgnEdgeList *list, POINT_D p0, POINT_D *pt,
+                            double tolerance, int operand) {
+    double rx = fabs(pt[0].x);
+    double ry = fabs(pt[0].y);
+    POINT_D p1 = pt[1];
+    double hx = (p0.x - p1.x) / 2;
+    double hy = (p0.y - p1.y) / 2;
+
+    if (hx == 0 && hy == 0)
+        return;
+    if (rx == 0 || ry == 0) {
+        rgn_add_edge(list, p0, p1, operand);
+        return;
+    }
+    double lambda = (hx * hx) / (rx * rx) + (hy * hy) / (ry * ry);
+    if (lambda > 1) {
+        rx *= sqrt(lambda);
+        ry *= sqrt(lambda);
+    }
+    double num = rx * rx * ry * ry - rx * rx * hy * hy - ry * ry * hx * hx;
+    double den = rx * rx * hy * hy + ry * ry * hx * hx;
+    double coef = sqrt(fmax(0, num / den));
+    double cxp = coef * rx * hy / ry;
+    double cyp = -coef * ry * hx / rx;
+    double cx = cxp + (p0.x + p1.x) / 2;
+    double cy = cyp + (p0.y + p1.y) / 2;
+    double theta1 = atan2((hy - cyp) / ry, (hx - cxp) / rx);
+    double theta2 = atan2((-hy - cyp) / ry, (-hx - cxp) / rx);
+    double dtheta = theta2 - theta1;
+    if (dtheta < 0)
+        dtheta += 2 * U_PI;
+
+    double r = fmax(rx, ry);
+    double step = U_PI / 2;
+    if (tolerance < r)
+        step = fmin(step, 2 * acos(1 - tolerance / r));
+    double steps = ceil(dtheta / step);
+    int n = 1;
+    if (steps > RGN_MAX_CURVE_STEPS)
+        n = RGN_MAX_CURVE_STEPS;
+    else if (steps > 1)
+        n = (int)steps;
+
+    POINT_D prev = p0;
+    for (int i = 1; i < n; i++) {
+        double theta = theta1 + dtheta * i / n;
+        POINT_D cur;
+        cur.x = cx + rx * cos(theta);
+        cur.y = cy + ry * sin(theta);
+        rgn_add_edge(list, prev, cur, operand);
+        prev = cur;
+    }
+    rgn_add_edge(list, prev, p1, operand);
+}
+
+// convert a path into edges, every sub path is implicitly closed
+static void rgn_flatten(rgnEdgeList *list, PATH *path, double tolerance,
+                        int operand) {
+    POINT_D start = {0, 0};
+    POINT_D cur = {0, 0};
+    bool has_cur = false;
+    PATH *tmp = path;
+    while (tmp != NULL) {
+        POINT_D *pt = tmp->section.points;
+        switch (tmp->section.type) {
+        case SEG_MOVE:
+            if (has_cur)
+                rgn_add_edge(list, cur, start, operand);
+            start = cur = pt[0];
+            has_cur = true;
+            break;
+        case SEG_LINE:
+            if (has_cur)
+                rgn_add_edge(list, cur, pt[0], operand);
+            else
+                start = pt[0];
+            cur = pt[0];
+            has_cur = true;
+            break;
+        case SEG_ARC:
+            if (has_cur)
+                rgn_flatten_arc(list, cur, pt, tolerance, operand);
+            else
+                start = pt[1];
+            cur = pt[1];
+            has_cur = true;
+            break;
+        case SEG_BEZIER:
+            if (has_cur)
+                rgn_flatten_bezier(list, cur, pt, tolerance, operand);
+            else
+                start = pt[2];
+            cur = pt[2];
+            has_cur = true;
+            break;
+        case SEG_END:
+            if (has_cur)
+                rgn_add_edge(list, cur, start, operand);
+            cur = start;
+            break;
+        }
+        tmp = tmp->next;
+    }
+    if (has_cur)
+        rgn_add_edge(list, cur, start, operand);
+}
+
+static int rgn_cmp_double(const void *a, const void *b) {
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+static int rgn_cmp_edge_top(const void *a, const void *b) {
+    const rgnEdge *ea = (const rgnEdge *)a;
+    const rgnEdge *eb = (const rgnEdge *)b;
+    return (ea->ytop > eb->ytop) - (ea->ytop < eb->ytop);
+}
+
+static int rgn_cmp_edge_bottom(const void *a, const void *b) {
+    const rgnEdge *ea = *(rgnEdge *const *)a;
+    const rgnEdge *eb = *(rgnEdge *const *)b;
+    return (ea->ybot > eb->ybot) - (ea->ybot < eb->ybot);
+}
+
+static double rgn_x(const rgnEdge *e, double y) {
+    return e->xtop + e->dxdy * (y - e->ytop);
+}
+
+// order of two edges at y, edges meeting there are ordered by their slope,
+// which is their order just below
+static int rgn_cmp_active(const rgnEdge *ea, const rgnEdge *eb, double y) {
+    double xa = rgn_x(ea, y);
+    double xb = rgn_x(eb, y);
+    if (fabs(xa - xb) > RGN_EPSILON)
+        return (xa > xb) - (xa < xb);
+    return (ea->dxdy > eb->dxdy) - (ea->dxdy < eb->dxdy);
+}
+
+static int rgn_cmp_key(const void *a, const void *b) {
+    const rgnKey *ka = (const rgnKey *)a;
+    const rgnKey *kb = (const rgnKey *)b;
+    if (fabs(ka->x - kb->x) > RGN_EPSILON)
+        return (ka->x > kb->x) - (ka->x < kb->x);
+    return (ka->dxdy > kb->dxdy) - (ka->dxdy < kb->dxdy);
+}
+
+static int rgn_cmp_poly(const void *a, const void *b) {
+    const rgnPoly *pa = *(rgnPoly *const *)a;
+    const rgnPoly *pb = *(rgnPoly *const *)b;
+    return (pa->xl > pb->xl) - (pa->xl < pb->xl);
+}
+
+static int rgn_cmp_span(const void *a, const void *b) {
+    const rgnSpan *sa = (const rgnSpan *)a;
+    const rgnSpan *sb = (const rgnSpan *)b;
+    return (sa->xl > sb->xl) - (sa->xl < sb->xl);
+}
+
+static bool rgn_inside(int winding, int fill) {
+    if (fill == RGN_FILL_EVENODD)
+        return (winding & 1) != 0;
+    return winding != 0;
+}
+
+static bool rgn_op(uint32_t mode, bool a, bool b) {
+    switch (mode) {
+    case U_RGN_AND:
+        return a && b;
+    case U_RGN_OR:
+        return a || b;
+    case U_RGN_XOR:
+        return a != b;
+    case U_RGN_DIFF:
+        return a && !b;
+    case U_RGN_COPY:
+    default:
+        return b;
+    }
+}
+
+// make room for one more item in an array of count items
+static bool rgn_grow(void **items, size_t count, size_t *size,
+                     size_t item_size) {
+    if (count < *size)
+        return true;
+    size_t new_size = *size ? *size * 2 : 64;
+    void *new_items = realloc(*items, new_size * item_size);
+    if (new_items == NULL)
+        return false;
+    *items = new_items;
+    *size = new_size;
+    return true;
+}
+
+static bool rgn_chain_add(rgnChain *chain, double x, double y) {
+    size_t n = chain->count;
+    if (n >= 1 && fabs(chain->pts[n - 1].x - x) < RGN_EPSILON &&
+        fabs(chain->pts[n - 1].y - y) < RGN_EPSILON)
+        return true;
+    // drop the previous point if it is aligned with the new one
+    if (n >= 2) {
+        POINT_D a = chain->pts[n - 2];
+        POINT_D b = chain->pts[n - 1];
+        double cross = (b.x - a.x) * (y - b.y) - (b.y - a.y) * (x - b.x);
+        if (fabs(cross) < RGN_EPSILON) {
+            chain->pts[n - 1].x = x;
+            chain->pts[n - 1].y = y;
+            return true;
+        }
+    }
+    if (n == chain->size) {
+        size_t size = chain->size ? chain->size * 2 : 4;
+        POINT_D *pts = realloc(chain->pts, size * sizeof(POINT_D));
+        if (pts == NULL)
+            return false;
+        chain->pts = pts;
+        chain->size = size;
+    }
+    chain->pts[n].x = x;
+    chain->pts[n].y = y;
+    chain->count++;
+    return true;
+}
+
+static void rgn_poly_free(rgnPoly *poly) {
+    if (poly == NULL)
+        return;
+    free(poly->left.pts);
+    free(poly->right.pts);
+    free(poly);
+}
+
+// add a finished polygon to the result path and free it
+static void rgn_poly_close(rgnPoly *poly, PATH **out) {
+    bool first = true;
+    POINT_D last = {0, 0};
+    for (size_t i = 0; i < poly->left.count; i++) {
+        last = poly->left.pts[i];
+        add_new_seg(out, first ? SEG_MOVE : SEG_LINE);
+        (*out)->last->section.points[0] = last;
+        first = false;
+    }
+    for (size_t i = poly->right.count; i > 0; i--) {
+        POINT_D pt = poly->right.pts[i - 1];
+        if (fabs(pt.x - last.x) < RGN_EPSILON &&
+            fabs(pt.y - last.y) < RGN_EPSILON)
+            continue;
+        last = pt;
+        add_new_seg(out, SEG_LINE);
+        (*out)->last->section.points[0] = last;
+    }
+    add_new_seg(out, SEG_END);
+    rgn_poly_free(poly);
+}
+
+
+static bool rgn_heap_push(rgnHeap *heap, double y, rgnEdge *left,
+                          rgnEdge *right) {
+    if (!rgn_grow((void **)&(heap->items), heap->count, &(heap->size),
+                  sizeof(rgnCross)))
+        return false;
+    size_t i = heap->count++;
+    while (i > 0 && heap->items[(i - 1) / 2].y > y) {
+        heap->items[i] = heap->items[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap->items[i].y = y;
+    heap->items[i].left = left;
+    heap->items[i].right = right;
+    return true;
+}
+
+static void rgn_heap_pop(rgnHeap *heap) {
+    rgnCross last = heap->items[--heap->count];
+    size_t i = 0;
+    for (;;) {
+        size_t c = 2 * i + 1;
+        if (c >= heap->count)
+            break;
+        if (c + 1 < heap->count && heap->items[c + 1].y < heap->items[c].y)
+            c++;
+        if (heap->items[c].y >= last.y)
+            break;
+        heap->items[i] = heap->items[c];
+        i = c;
+    }
+    if (heap->count)
+        heap->items[i] = last;
+}
+
+static void rgn_node_update(rgnNode *node) {
+    node->bounds = (node->edge->bound != 0);
+    for (int i = 0; i < 2; i++) {
+        if (node->child[i])
+            node->bounds += node->child[i]->bounds;
+    }
+}
+
+static void rgn_node_update_up(rgnNode *node) {
+    for (; node != NULL; node = node->parent)
+        rgn_node_update(node);
+}
+
+// move the child c of node above it
+static void rgn_node_rotate(rgnSweep *sweep, rgnNode *node, int c) {
+    rgnNode *child = node->child[c];
+    rgnNode *parent = node->parent;
+    node->child[c] = child->child[!c];
+    if (node->child[c])
+        node->child[c]->parent = node;
+    child->child[!c] = node;
+    node->parent = child;
+    child->parent = parent;
+    if (parent == NULL)
+        sweep->root = child;
+    else
+        parent->child[parent->child[1] == node] = child;
+    rgn_node_update(node);
+    rgn_node_update(child);
+}
+
+// insert an edge in the active edges, at its place at y0
+static void rgn_insert(rgnSweep *sweep, rgnEdge *e) {
+    rgnNode *node = e->node;
+    rgnNode *parent = NULL;
+    rgnNode *cur = sweep->root;
+    rgnEdge *prev = NULL;
+    rgnEdge *next = NULL;
+    int c = 0;
+    while (cur != NULL) {
+        parent = cur;
+        c = rgn_cmp_active(e, cur->edge, sweep->y0) >= 0;
+        if (c)
+            prev = cur->edge;
+        else
+            next = cur->edge;
+        cur = cur->child[c];
+    }
+    // xorshift, rand() is kept for the ids
+    sweep->seed ^= sweep->seed << 13;
+    sweep->seed ^= sweep->seed >> 17;
+    sweep->seed ^= sweep->seed << 5;
+    node->priority = sweep->seed;
+    node->parent = parent;
+    node->child[0] = node->child[1] = NULL;
+    rgn_node_update(node);
+    if (parent == NULL)
+        sweep->root = node;
+    else
+        parent->child[c] = node;
+    while (node->parent && node->parent->priority > node->priority)
+        rgn_node_rotate(sweep, node->parent, node->parent->child[1] == node);
+    rgn_node_update_up(node->parent);
+
+    e->prev = prev;
+    e->next = next;
+    if (prev)
+        prev->next = e;
+    if (next)
+        next->prev = e;
+}
+
+static void rgn_remove(rgnSweep *sweep, rgnEdge *e) {
+    rgnNode *node = e->node;
+    while (node->child[0] || node->child[1]) {
+        int c = node->child[0] == NULL ||
+                (node->child[1] &&
+                 node->child[1]->priority < node->child[0]->priority);
+        rgn_node_rotate(sweep, node, c);
+    }
+    if (node->parent == NULL)
+        sweep->root = NULL;
+    else
+        node->parent->child[node->parent->child[1] == node] = NULL;
+    rgn_node_update_up(node->parent);
+
+    if (e->prev)
+        e->prev->next = e->next;
+    if (e->next)
+        e->next->prev = e->prev;
+    e->prev = e->next = e->right = NULL;
+}
+
+// swap two neighbour edges (left, right), the tree nodes are exchanged
+static void rgn_swap(rgnEdge *left, rgnEdge *right) {
+    rgnNode *nl = left->node;
+    rgnNode *nr = right->node;
+    nl->edge = right;
+    nr->edge = left;
+    left->node = nr;
+    right->node = nl;
+    if (left->bound != right->bound) {
+        rgn_node_update_up(nl);
+        rgn_node_update_up(nr);
+    }
+
+    rgnEdge *prev = left->prev;
+    rgnEdge *next = right->next;
+    right->prev = prev;
+    right->next = left;
+    left->prev = right;
+    left->next = next;
+    if (prev)
+        prev->next = right;
+    if (next)
+        next->prev = left;
+}
+
+// last span bound of the subtree of node, from the right if c = 0
+static rgnEdge *rgn_node_bound(rgnNode *node, int c) {
+    for (;;) {
+        if (node->child[!c] && node->child[!c]->bounds)
+            node = node->child[!c];
+        else if (node->edge->bound)
+            return node->edge;
+        else
+            node = node->child[c];
+    }
+}
+
+// closest span bound on the left (c = 0) or on the right (c = 1) of e
+static rgnEdge *rgn_bound_near(rgnEdge *e, int c) {
+    rgnNode *node = e->node;
+    if (node->child[c] && node->child[c]->bounds)
+        return rgn_node_bound(node->child[c], c);
+    for (; node->parent != NULL; node = node->parent) {
+        rgnNode *parent = node->parent;
+        if (parent->child[!c] != node)
+            continue;
+        if (parent->edge->bound)
+            return parent->edge;
+        if (parent->child[c] && parent->child[c]->bounds)
+            return rgn_node_bound(parent->child[c], c);
+    }
+    return NULL;
+}
+
+static void rgn_push_pair(rgnSweep *sweep, rgnEdge *left, rgnEdge *right) {
+    if (left == NULL || right == NULL)
+        return;
+    if (!rgn_grow((void **)&(sweep->pairs), sweep->n_pairs,
+                  &(sweep->s_pairs), 2 * sizeof(rgnEdge *))) {
+        sweep->error = true;
+        return;
+    }
+    sweep->pairs[2 * sweep->n_pairs] = left;
+    sweep->pairs[2 * sweep->n_pairs + 1] = right;
+    sweep->n_pairs++;
+}
+
+// queue the crossing of two neighbour edges, if they cross below y0
+static void rgn_cross(rgnSweep *sweep, rgnEdge *left, rgnEdge *right) {
+    left->right = right;
+    if (left->dxdy <= right->dxdy)
+        return;
+    double y0 = sweep->y0;
+    double yc = y0 + (rgn_x(right, y0) - rgn_x(left, y0)) /
+                         (left->dxdy - right->dxdy);
+    // crossings too close to be a stop on their own are done just after
+    if (yc < y0 + 2 * RGN_EPSILON)
+        yc = y0 + 2 * RGN_EPSILON;
+    if (yc < left->ybot && yc < right->ybot &&
+        !rgn_heap_push(&(sweep->heap), yc, left, right))
+        sweep->error = true;
+}
+
+static void rgn_anchor(rgnSweep *sweep, rgnEdge *e) {
+    if (e == NULL || e->anchor_stamp == sweep->stamp)
+        return;
+    e->anchor_stamp = sweep->stamp;
+    sweep->anchors[sweep->n_anchors++].edge = e;
+}
+
+static void rgn_dirty(rgnSweep *sweep, rgnEdge *e) {
+    if (e == NULL || e->dirty_stamp == sweep->stamp)
+        return;
+    e->dirty_stamp = sweep->stamp;
+    sweep->dirty[sweep->n_dirty++] = e;
+}
+
+// update the winding numbers from e, to the right as long as they change
+static void rgn_update(rgnSweep *sweep, rgnEdge *e) {
+    for (rgnEdge *anchor = e; e != NULL; e = e->next) {
+        int wa = e->prev ? e->prev->wa : 0;
+        int wb = e->prev ? e->prev->wb : 0;
+        if (e->operand)
+            wb += e->winding;
+        else
+            wa += e->winding;
+        if (e != anchor && wa == e->wa && wb == e->wb)
+            break;
+        e->wa = wa;
+        e->wb = wb;
+        e->in = rgn_op(sweep->mode, rgn_inside(wa, sweep->fill_a),
+                       rgn_inside(wb, sweep->fill_b));
+        // the bound of the next edge depends on this one
+        rgn_dirty(sweep, e);
+        rgn_dirty(sweep, e->next);
+    }
+}
+
+static void rgn_add_poly(rgnSweep *sweep, rgnPoly *poly) {
+    if (poly == NULL || poly->stamp == sweep->stamp)
+        return;
+    if (!rgn_grow((void **)&(sweep->polys), sweep->n_polys,
+                  &(sweep->s_polys), sizeof(rgnPoly *))) {
+        sweep->error = true;
+        return;
+    }
+    poly->stamp = sweep->stamp;
+    poly->xl = rgn_x(poly->lbound, sweep->y0);
+    poly->xr = rgn_x(poly->rbound, sweep->y0);
+    sweep->polys[sweep->n_polys++] = poly;
+}
+
+static void rgn_add_span(rgnSweep *sweep, rgnEdge *left) {
+    if (left == NULL || left->bound != RGN_BOUND_LEFT ||
+        left->span_stamp == sweep->stamp)
+        return;
+    rgnEdge *right = rgn_bound_near(left, 1);
+    if (right == NULL)
+        return;
+    if (!rgn_grow((void **)&(sweep->spans), sweep->n_spans,
+                  &(sweep->s_spans), sizeof(rgnSpan))) {
+        sweep->error = true;
+        return;
+    }
+    left->span_stamp = sweep->stamp;
+    rgnSpan *span = &(sweep->spans[sweep->n_spans++]);
+    span->left = left;
+    span->right = right;
+    span->xl = rgn_x(left, sweep->y0);
+    span->xr = rgn_x(right, sweep->y0);
+}
+
+static void rgn_poly_unlink(rgnSweep *sweep, rgnPoly *poly) {
+    if (poly->prev)
+        poly->prev->next = poly->next;
+    else
+        sweep->open = poly->next;
+    if (poly->next)
+        poly->next->prev = poly->prev;
+}
+
+// finish a polygon at its current corners
+static void rgn_poly_end(rgnSweep *sweep, rgnPoly *poly) {
+    rgn_poly_unlink(sweep, poly);
+    if (!rgn_chain_add(&(poly->left), poly->xl, sweep->y0) ||
+        !rgn_chain_add(&(poly->right), poly->xr, sweep->y0)) {
+        rgn_poly_free(poly);
+        sweep->error = true;
+        return;
+    }
+    rgn_poly_close(poly, &(sweep->out));
+}
+
+// give the bounds of span to poly, adding a corner where a bound changes
+static void rgn_poly_bind(rgnSweep *sweep, rgnPoly *poly, rgnSpan *span) {
+    if (poly->lbound != span->left &&
+        !rgn_chain_add(&(poly->left), poly->xl, sweep->y0))
+        sweep->error = true;
+    if (poly->rbound != span->right &&
+        !rgn_chain_add(&(poly->right), poly->xr, sweep->y0))
+        sweep->error = true;
+    poly->lbound = span->left;
+    poly->rbound = span->right;
+    span->left->poly = poly;
+    span->right->rpoly = poly;
+}
+
+// continue the polygons whose span has the same corners at y0, finish the
+// others and start the new spans (from left to right)
+static void rgn_spans(rgnSweep *sweep) {
+    if (sweep->n_polys > 1)
+        qsort(sweep->polys, sweep->n_polys, sizeof(rgnPoly *), rgn_cmp_poly);
+    if (sweep->n_spans > 1)
+        qsort(sweep->spans, sweep->n_spans, sizeof(rgnSpan), rgn_cmp_span);
+    for (size_t i = 0; i < sweep->n_polys; i++) {
+        rgnPoly *poly = sweep->polys[i];
+        if (poly->lbound->poly == poly)
+            poly->lbound->poly = NULL;
+        if (poly->rbound->rpoly == poly)
+            poly->rbound->rpoly = NULL;
+    }
+    size_t j = 0;
+    for (size_t i = 0; i < sweep->n_spans && !sweep->error; i++) {
+        rgnSpan *span = &(sweep->spans[i]);
+        // null width spans are skipped
+        if (span->xr - span->xl < RGN_EPSILON &&
+            span->right->dxdy - span->left->dxdy < RGN_EPSILON)
+            continue;
+        while (j < sweep->n_polys &&
+               sweep->polys[j]->xl < span->xl - RGN_EPSILON)
+            rgn_poly_end(sweep, sweep->polys[j++]);
+        if (j < sweep->n_polys &&
+            fabs(sweep->polys[j]->xl - span->xl) < RGN_EPSILON &&
+            fabs(sweep->polys[j]->xr - span->xr) < RGN_EPSILON) {
+            rgn_poly_bind(sweep, sweep->polys[j++], span);
+            continue;
+        }
+        rgnPoly *poly = calloc(1, sizeof(rgnPoly));
+        if (poly == NULL ||
+            !rgn_chain_add(&(poly->left), span->xl, sweep->y0) ||
+            !rgn_chain_add(&(poly->right), span->xr, sweep->y0)) {
+            rgn_poly_free(poly);
+            sweep->error = true;
+            break;
+        }
+        poly->lbound = span->left;
+        poly->rbound = span->right;
+        span->left->poly = poly;
+        span->right->rpoly = poly;
+        poly->next = sweep->open;
+        if (sweep->open)
+            sweep->open->prev = poly;
+        sweep->open = poly;
+    }
+    for (; j < sweep->n_polys && !sweep->error; j++)
+        rgn_poly_end(sweep, sweep->polys[j]);
+}
+
+// apply the changes of the active edges at y0: removal of the ending
+// edges, swap of the crossing ones, insertion of the starting ones
+static void rgn_stop(rgnSweep *sweep, rgnEdge **ending, size_t n_ending,
+                     rgnEdge *starting, size_t n_starting) {
+    double y0 = sweep->y0;
+    sweep->stamp++;
+    sweep->n_anchors = 0;
+    sweep->n_dirty = 0;
+    sweep->n_removed = 0;
+    sweep->n_polys = 0;
+    sweep->n_spans = 0;
+
+    for (size_t i = 0; i < n_ending; i++) {
+        rgnEdge *e = ending[i];
+        rgnEdge *prev = e->prev;
+        rgnEdge *next = e->next;
+        rgn_remove(sweep, e);
+        sweep->removed[sweep->n_removed++] = e;
+        rgn_anchor(sweep, next);
+        rgn_push_pair(sweep, prev, next);
+    }
+
+    // neighbours in the wrong order at y0 have crossed
+    while (sweep->n_pairs && !sweep->error) {
+        sweep->n_pairs--;
+        rgnEdge *left = sweep->pairs[2 * sweep->n_pairs];
+        rgnEdge *right = sweep->pairs[2 * sweep->n_pairs + 1];
+        if (left->next != right)
+            continue;
+        if (rgn_cmp_active(left, right, y0) <= 0) {
+            // not crossed yet (rounding)
+            rgn_cross(sweep, left, right);
+            continue;
+        }
+        rgn_swap(left, right);
+        rgn_anchor(sweep, right);
+        rgn_anchor(sweep, left);
+        rgn_push_pair(sweep, right->prev, right);
+        rgn_push_pair(sweep, left, left->next);
+    }
+
+    for (size_t i = 0; i < n_starting; i++) {
+        rgnEdge *e = &(starting[i]);
+        rgn_insert(sweep, e);
+        rgn_anchor(sweep, e);
+        rgn_anchor(sweep, e->next);
+    }
+    if (sweep->error)
+        return;
+
+    // crossings of the new neighbours, and winding numbers (the anchors
+    // are sorted not to update the same edges several times)
+    size_t k = 0;
+    for (size_t i = 0; i < sweep->n_anchors && !sweep->error; i++) {
+        rgnEdge *e = sweep->anchors[i].edge;
+        if (e->ybot <= y0)
+            continue;
+        if (e->prev && e->prev->right != e)
+            rgn_cross(sweep, e->prev, e);
+        if (e->next && e->right != e->next)
+            rgn_cross(sweep, e, e->next);
+        sweep->anchors[k].x = rgn_x(e, y0);
+        sweep->anchors[k].dxdy = e->dxdy;
+        sweep->anchors[k++].edge = e;
+    }
+    sweep->n_anchors = k;
+    qsort(sweep->anchors, sweep->n_anchors, sizeof(rgnKey), rgn_cmp_key);
+    for (size_t i = 0; i < sweep->n_anchors; i++)
+        rgn_update(sweep, sweep->anchors[i].edge);
+
+    // polygons around the updated edges, with the bounds before the stop
+    for (size_t i = 0; i < sweep->n_removed; i++) {
+        rgn_add_poly(sweep, sweep->removed[i]->poly);
+        rgn_add_poly(sweep, sweep->removed[i]->rpoly);
+    }
+    for (size_t i = 0; i < sweep->n_dirty; i++) {
+        rgnEdge *e = sweep->dirty[i];
+        rgn_add_poly(sweep, e->poly);
+        rgn_add_poly(sweep, e->rpoly);
+        rgnEdge *left = rgn_bound_near(e, 0);
+        if (left && left->bound == RGN_BOUND_LEFT)
+            rgn_add_poly(sweep, left->poly);
+    }
+
+    for (size_t i = 0; i < sweep->n_dirty; i++) {
+        rgnEdge *e = sweep->dirty[i];
+        bool prev_in = e->prev ? e->prev->in : false;
+        int bound = 0;
+        if (e->in != prev_in)
+            bound = e->in ? RGN_BOUND_LEFT : RGN_BOUND_RIGHT;
+        if (e->bound != bound) {
+            e->bound = bound;
+            rgn_node_update_up(e->node);
+        }
+    }
+
+    // spans around the updated edges, with the new bounds
+    for (size_t i = 0; i < sweep->n_dirty && !sweep->error; i++) {
+        rgnEdge *e = sweep->dirty[i];
+        if (e->bound == RGN_BOUND_LEFT)
+            rgn_add_span(sweep, e);
+        else
+            rgn_add_span(sweep, rgn_bound_near(e, 0));
+    }
+    if (!sweep->error)
+        rgn_spans(sweep);
+}
+
+static void rgn_sweep_free(rgnSweep *sweep) {
+    free(sweep->heap.items);
+    free(sweep->pairs);
+    free(sweep->anchors);
+    free(sweep->dirty);
+    free(sweep->removed);
+    free(sweep->polys);
+    free(sweep->spans);
+}
+
+PATH *region_mix(PATH *a, int fill_a, PATH *b, int fill_b, uint32_t mode,
+                 double tolerance, bool *error) {
+    rgnEdgeList list = {NULL, 0, 0, false};
+    rgnSweep sweep;
+    rgnNode *nodes = NULL;
+    rgnEdge **ending = NULL;
+    double *ys = NULL;
+
+    memset(&sweep, 0, sizeof(sweep));
+    sweep.mode = mode;
+    sweep.fill_a = fill_a;
+    sweep.fill_b = fill_b;
+    sweep.seed = 2463534242u;
+    *error = false;
+    if (!(tolerance > 0))
+        tolerance = RGN_DEFAULT_TOLERANCE;
+
+    rgn_flatten(&list, a, tolerance, 0);
+    rgn_flatten(&list, b, tolerance, 1);
+    if (list.error)
+        goto err;
+    if (list.count == 0)
+        return NULL;
+
+    qsort(list.edges, list.count, sizeof(rgnEdge), rgn_cmp_edge_top);
+
+    size_t n = list.count;
+    nodes = malloc(n * sizeof(rgnNode));
+    ending = malloc(n * sizeof(rgnEdge *));
+    ys = malloc(n * 2 * sizeof(double));
+    sweep.anchors = malloc(n * sizeof(rgnKey));
+    sweep.dirty = malloc(n * sizeof(rgnEdge *));
+    sweep.removed = malloc(n * sizeof(rgnEdge *));
+    if (nodes == NULL || ending == NULL || ys == NULL ||
+        sweep.anchors == NULL || sweep.dirty == NULL || sweep.removed == NULL)
+        goto err;
+    size_t n_ys = 0;
+    for (size_t i = 0; i < n; i++) {
+        rgnEdge *e = &(list.edges[i]);
+        e->prev = e->next = e->right = NULL;
+        e->node = &(nodes[i]);
+        e->wa = e->wb = 0;
+        e->in = false;
+        e->bound = 0;
+        e->poly = e->rpoly = NULL;
+        e->anchor_stamp = e->dirty_stamp = e->span_stamp = 0;
+        nodes[i].edge = e;
+        ending[i] = e;
+        ys[n_ys++] = e->ytop;
+        ys[n_ys++] = e->ybot;
+    }
+    qsort(ending, n, sizeof(rgnEdge *), rgn_cmp_edge_bottom);
+    qsort(ys, n_ys, sizeof(double), rgn_cmp_double);
+    size_t k = 0;
+    for (size_t i = 0; i < n_ys; i++) {
+        if (k == 0 || ys[i] != ys[k - 1])
+            ys[k++] = ys[i];
+    }
+    n_ys = k;
+
+    // stops at the edge end points and at the crossings
+    size_t next_start = 0;
+    size_t next_end = 0;
+    size_t next_y = 0;
+    sweep.y0 = ys[0];
+    for (;;) {
+        double y0 = sweep.y0;
+        while (sweep.heap.count && sweep.heap.items[0].y <= y0 + RGN_EPSILON) {
+            rgnCross cross = sweep.heap.items[0];
+            rgn_heap_pop(&(sweep.heap));
+            rgn_push_pair(&sweep, cross.left, cross.right);
+        }
+        size_t first_end = next_end;
+        while (next_end < n && ending[next_end]->ybot <= y0)
+            next_end++;
+        size_t first_start = next_start;
+        while (next_start < n && list.edges[next_start].ytop <= y0)
+            next_start++;
+        rgn_stop(&sweep, ending + first_end, next_end - first_end,
+                 list.edges + first_start, next_start - first_start);
+        if (sweep.error)
+            goto err;
+
+        // crossings of edges which are not neighbours anymore are dropped
+        while (sweep.heap.count &&
+               sweep.heap.items[0].left->next != sweep.heap.items[0].right)
+            rgn_heap_pop(&(sweep.heap));
+        while (next_y < n_ys && ys[next_y] <= y0)
+            next_y++;
+        if (next_y == n_ys)
+            break;
+        sweep.y0 = ys[next_y];
+        if (sweep.heap.count && sweep.heap.items[0].y < sweep.y0)
+            sweep.y0 = sweep.heap.items[0].y;
+    }
+
+    // all the edges ended at the last stop, finishing all the polygons
+    while (sweep.open && !sweep.error)
+        rgn_poly_end(&sweep, sweep.open);
+    if (sweep.error)
+        goto err;
+
+    free(list.edges);
+    free(nodes);
+    free(ending);
+    free(ys);
+    rgn_sweep_free(&sweep);
+    return sweep.out;
+
+err:
+    while (sweep.open) {
+        rgnPoly *poly = sweep.open;
+        rgn_poly_unlink(&sweep, poly);
+        rgn_poly_free(poly);
+    }
+    free_path(&(sweep.out));
+    free(list.edges);
+    free(nodes);
+    free(ending);
+    free(ys);
+    rgn_sweep_free(&sweep);
+    *error = true;
+    return NULL;
+}
+
+#ifdef __cplusplus
+}
+#endif
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
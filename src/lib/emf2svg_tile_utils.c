@@ -0,0 +1,82 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DARWIN
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "emf2svg_private.h"
+#include <stdio.h>
+
+// Tiled output (emf2svg_tiles()): records are drawn in a fragment buffer,
+// then copied to the outputs of the tiles they are visible in. The clipping
+// groups are opened/closed in the records drawing elements, so this part of
+// the fragment (before states->fragmentMark) is copied to every tile.
+
+// write the svg start of each tile, and compute the tile viewports
+void tiles_start_draw(drawingStates *states) {
+    emfTiles *tiles = states->tiles;
+    RECT_D area = {0, 0, states->imgWidth, states->imgHeight};
+    if (states->roiSet)
+        area = states->roi;
+    unsigned int rows = tiles->count / tiles->columns;
+    double width = (area.right - area.left) / tiles->columns;
+    double height = (area.bottom - area.top) / rows;
+    double dx = states->fixBrokenYTransform ? 0 : states->RefX * states->scaling;
+    double dy = states->fixBrokenYTransform ? 0 : states->RefY * states->scaling;
+    for (unsigned int i = 0; i < tiles->count; i++) {
+        RECT_D view;
+        view.left = area.left + (i % tiles->columns) * width;
+        view.top = area.top + (i / tiles->columns) * height;
+        view.right = view.left + width;
+        view.bottom = view.top + height;
+        tiles->viewports[i].left = view.left + dx;
+        tiles->viewports[i].top = view.top + dy;
+        tiles->viewports[i].right = view.right + dx;
+        tiles->viewports[i].bottom = view.bottom + dy;
+        svg_start_draw(states, &tiles->writers[i], &view);
+    }
+}
+
+// compute in which tiles the record is visible
+void tiles_record_start(drawingStates *states, const char *contents) {
+    emfTiles *tiles = states->tiles;
+    RECT_D box;
+    bool clipped;
+    bool known = record_view_box(states, contents, &box, &clipped);
+    for (unsigned int i = 0; i < tiles->count; i++) {
+        tiles->visible[i] =
+            !known || (!clipped && !view_outside(box, tiles->viewports[i]));
+    }
+}
+
+// the record is visible in every tile (output not tied to a record)
+void tiles_record_all(drawingStates *states) {
+    emfTiles *tiles = states->tiles;
+    for (unsigned int i = 0; i < tiles->count; i++)
+        tiles->visible[i] = true;
+}
+
+// copy the record drawn in out (the fragment buffer) to the tiles
+void tiles_record_end(drawingStates *states, svgWriter *out) {
+    emfTiles *tiles = states->tiles;
+    for (unsigned int i = 0; i < tiles->count; i++) {
+        size_t len = tiles->visible[i] ? out->len : states->fragmentMark;
+        svg_append(&tiles->writers[i], out->buf, len);
+    }
+    // the buffer is reused for the next record
+    out->len = 0;
+    states->fragmentMark = 0;
+}
+
+// mark the end of the clipping output of the current record
+void tiles_mark(drawingStates *states, svgWriter *out) {
+    if (states->tiles)
+        states->fragmentMark = out->len;
+}
+
+#ifdef __cplusplus
+}
+#endif
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
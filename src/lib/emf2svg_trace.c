@@ -0,0 +1,154 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DARWIN
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "emf2svg_private.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// With options->trace, an event is sent to the callback after each record
+// instead of the verbose output. The FLAG_* macros set its status (a store,
+// the only cost left in the record functions). With options->traceFields,
+// the verbose output of the record is kept in trace.text and split in
+// "name: value" fields for the event.
+
+void verbose_print(drawingStates *states, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    if (states->trace.callback)
+        svg_vprintf(&(states->trace.text), fmt, ap);
+    else
+        vprintf(fmt, ap);
+    va_end(ap);
+}
+
+// remove the color escape sequences and the surrounding blanks of a line
+static char *trace_strip(char *line) {
+    char *src = line;
+    char *dst = line;
+    while (*src) {
+        if (*src == '\x1B' && src[1] == '[') {
+            src += 2;
+            while (*src && *src != 'm')
+                src++;
+            if (*src)
+                src++;
+            continue;
+        }
+        *dst++ = *src++;
+    }
+    *dst = '\0';
+    while (dst > line && (dst[-1] == ' ' || dst[-1] == '\t'))
+        *--dst = '\0';
+    while (*line == ' ' || *line == '\t')
+        line++;
+    return line;
+}
+
+static bool trace_field_add(emfTrace *trace, const char *name,
+                            const char *value) {
+    if (trace->count == trace->size) {
+        size_t size = trace->size ? trace->size * 2 : 32;
+        generatorTraceField *fields = (generatorTraceField *)realloc(
+            trace->fields, size * sizeof(generatorTraceField));
+        if (fields == NULL)
+            return false;
+        trace->fields = fields;
+        trace->size = size;
+    }
+    trace->fields[trace->count].name = name;
+    trace->fields[trace->count].value = value;
+    trace->count++;
+    return true;
+}
+
+// split the verbose output of the record in fields (in place)
+static void trace_fields(emfTrace *trace) {
+    svgWriter *text = &(trace->text);
+    svg_append(text, "", 1);
+    if (text->error)
+        return;
+    char *line = text->buf;
+    char *end = text->buf + text->len - 1;
+    while (line < end) {
+        char *eol = (char *)memchr(line, '\n', end - line);
+        if (eol == NULL)
+            eol = end;
+        *eol = '\0';
+        char *field = trace_strip(line);
+        line = eol + 1;
+        if (*field == '\0')
+            continue;
+        char *value = strchr(field, ':');
+        if (value == NULL) {
+            if (!trace_field_add(trace, "", field))
+                return;
+            continue;
+        }
+        *value = '\0';
+        value = trace_strip(value + 1);
+        if (!trace_field_add(trace, trace_strip(field), value))
+            return;
+    }
+}
+
+void trace_record(drawingStates *states, const char *contents, int recnum,
+                  size_t off) {
+    emfTrace *trace = &(states->trace);
+    PU_ENHMETARECORD pEmr = (PU_ENHMETARECORD)(contents + off);
+    generatorTraceEvent event;
+    memset(&event, 0, sizeof(event));
+    event.index = recnum;
+    event.type = pEmr->iType;
+    event.name = U_emr_names(pEmr->iType);
+    event.offset = off;
+    event.size = pEmr->nSize;
+    event.status = trace->status;
+    if (trace->text.len) {
+        trace_fields(trace);
+        event.fields = trace->fields;
+        event.fieldCount = trace->count;
+    }
+    trace->callback(&event, trace->ctx);
+    trace->status = EMF2SVG_TRACE_UNKNOWN;
+    trace->text.len = 0;
+    trace->text.error = false;
+    trace->count = 0;
+}
+
+// warning or error of the conversion, printed in verbose mode without trace
+void trace_message(drawingStates *states, int recnum, size_t off,
+                   const char *message) {
+    emfTrace *trace = &(states->trace);
+    if (trace->callback == NULL) {
+        if (isVerbose(states))
+            printf("%s\n", message);
+        return;
+    }
+    generatorTraceEvent event;
+    memset(&event, 0, sizeof(event));
+    event.index = recnum;
+    event.offset = off;
+    event.status = EMF2SVG_TRACE_ERROR;
+    event.message = message;
+    trace->callback(&event, trace->ctx);
+}
+
+void trace_free(drawingStates *states) {
+    svg_writer_free(&(states->trace.text));
+    free(states->trace.fields);
+    states->trace.fields = NULL;
+    states->trace.count = 0;
+    states->trace.size = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
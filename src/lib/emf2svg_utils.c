@@ -7,18 +7,26 @@ extern "C" {
 #endif
 #include "emf2svg_private.h"
 #include "emf2svg_print.h"
+#include <assert.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <iconv.h>
 #include <errno.h>
 #include <ft2build.h>
 #include <fontconfig/fontconfig.h>
 #include FT_FREETYPE_H
+#ifndef _MSC_VER
+#include <pthread.h>
+// each font lookup initializes and finalizes fontconfig (FcFini()), the
+// lookups of the threads of a parallel conversion are serialized
+static pthread_mutex_t fontconfig_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
-void U_EMRNOTIMPLEMENTED_draw(const char *name, const char *contents, FILE *out,
-                              drawingStates *states) {
+void U_EMRNOTIMPLEMENTED_draw(const char *name, const char *contents,
+                              svgWriter *out, drawingStates *states) {
     UNUSED(name);
     // if (states->verbose){U_EMRNOTIMPLEMENTED_print(contents, states);}
     UNUSED(contents);
@@ -40,7 +48,8 @@ double _dsign(double v) {
 }
 #endif
 
-void arc_circle_draw(const char *contents, FILE *out, drawingStates *states) {
+void arc_circle_draw(const char *contents, svgWriter *out,
+                     drawingStates *states) {
     PU_EMRANGLEARC pEmr = (PU_EMRANGLEARC)(contents);
     startPathDraw(states, out);
     U_POINTL radii;
@@ -57,7 +66,7 @@ void arc_circle_draw(const char *contents, FILE *out, drawingStates *states) {
     radii.x = pEmr->nRadius;
     radii.y = pEmr->nRadius;
 
-    fprintf(out, "M ");
+    path_data_cmd(&(states->pathData), out, 'M');
     POINT_D start;
     double angle = pEmr->eStartAngle * U_PI / 180;
 
@@ -68,23 +77,21 @@ void arc_circle_draw(const char *contents, FILE *out, drawingStates *states) {
     pointCurrPathAddD(states, start, 0);
 
     addNewSegPath(states, SEG_ARC);
-    fprintf(out, "A ");
-    point_draw(states, radii, out);
     pointCurrPathAdd(states, radii, 0);
 
-    fprintf(out, "0 ");
-    fprintf(out, "%d %d ", large_arc_flag, sweep_flag);
-
     angle = (pEmr->eStartAngle + pEmr->eSweepAngle) * U_PI / 180;
     POINT_D end;
     end.x = pEmr->nRadius * cos(angle) + pEmr->ptlCenter.x;
     end.y = pEmr->nRadius * sin(angle) + pEmr->ptlCenter.y;
-    point_draw_d(states, end, out);
+    path_data_arc(&(states->pathData), out, point_s(states, radii),
+                  large_arc_flag, sweep_flag, point_cal(states, end.x, end.y));
+    states->cur_x = end.x;
+    states->cur_y = end.y;
     pointCurrPathAddD(states, end, 1);
 
     endPathDraw(states, out);
 }
-void arc_draw(const char *contents, FILE *out, drawingStates *states,
+void arc_draw(const char *contents, svgWriter *out, drawingStates *states,
               int type) {
     PU_EMRARC pEmr = (PU_EMRARC)(contents);
     startPathDraw(states, out);
@@ -103,39 +110,36 @@ void arc_draw(const char *contents, FILE *out, drawingStates *states,
     radii.y = (pEmr->rclBox.bottom - pEmr->rclBox.top) / 2;
 
     addNewSegPath(states, SEG_LINE);
-    fprintf(out, "M ");
+    path_data_cmd(&(states->pathData), out, 'M');
     POINT_D start = int_el_rad(pEmr->ptlStart, pEmr->rclBox);
     point_draw_d(states, start, out);
     pointCurrPathAddD(states, start, 0);
 
     addNewSegPath(states, SEG_ARC);
-
-    fprintf(out, "A ");
-    point_draw(states, radii, out);
     pointCurrPathAdd(states, radii, 0);
 
-    fprintf(out, "0 ");
-    fprintf(out, "%d %d ", large_arc_flag, sweep_flag);
-
     POINT_D end = int_el_rad(pEmr->ptlEnd, pEmr->rclBox);
-    point_draw_d(states, end, out);
+    path_data_arc(&(states->pathData), out, point_s(states, radii),
+                  large_arc_flag, sweep_flag, point_cal(states, end.x, end.y));
+    states->cur_x = end.x;
+    states->cur_y = end.y;
     pointCurrPathAddD(states, end, 1);
 
     switch (type) {
     case ARC_PIE:
-        fprintf(out, "L ");
+        path_data_cmd(&(states->pathData), out, 'L');
         U_POINTL center;
         center.x = (pEmr->rclBox.right + pEmr->rclBox.left) / 2;
         center.y = (pEmr->rclBox.bottom + pEmr->rclBox.top) / 2;
         point_draw(states, center, out);
         addNewSegPath(states, SEG_LINE);
         pointCurrPathAdd(states, center, 0);
-        fprintf(out, "Z ");
+        path_data_cmd(&(states->pathData), out, 'Z');
         addNewSegPath(states, SEG_END);
         endFormDraw(states, out);
         break;
     case ARC_CHORD:
-        fprintf(out, "Z ");
+        path_data_cmd(&(states->pathData), out, 'Z');
         addNewSegPath(states, SEG_END);
         endFormDraw(states, out);
         break;
@@ -144,9 +148,9 @@ void arc_draw(const char *contents, FILE *out, drawingStates *states,
         break;
     }
 }
-void basic_stroke(drawingStates *states, FILE *out) {
+void basic_stroke(drawingStates *states, svgWriter *out) {
     color_stroke(states, out);
-    width_stroke(states, out, states->currentDeviceContext.stroke_width);
+    width_stroke(states, out, currentPen(states)->width);
 }
 bool checkOutOfEMF(drawingStates *states, uintptr_t address) {
     if (address > states->endAddress) {
@@ -157,37 +161,29 @@ bool checkOutOfEMF(drawingStates *states, uintptr_t address) {
     }
 }
 bool checkOutOfOTIndex(drawingStates *states, int64_t index) {
-    if (index > states->objectTableSize) {
-        states->Error = true;
-        return true;
-    } else {
+    if (index <= states->objectTableSize)
         return false;
-    }
+    // above the maxObjects cap, the object is ignored
+    if (index > states->objectHandles)
+        states->Error = true;
+    return true;
 }
-void color_stroke(drawingStates *states, FILE *out) {
-    fprintf(out, "stroke=\"#%02X%02X%02X\" ",
-            states->currentDeviceContext.stroke_red,
-            states->currentDeviceContext.stroke_green,
-            states->currentDeviceContext.stroke_blue);
+void color_stroke(drawingStates *states, svgWriter *out) {
+    svg_append_literal(out, "stroke=\"");
+    svg_append_color(out, currentPen(states)->color.Red,
+                     currentPen(states)->color.Green,
+                     currentPen(states)->color.Blue);
+    svg_append_literal(out, "\" ");
 }
 void copyDeviceContext(EMF_DEVICE_CONTEXT *dest, EMF_DEVICE_CONTEXT *src) {
     // copy simple data (int, double...)
     *dest = *src;
 
     // copy more complex data (pointers...)
-    if (src->font_name != NULL) {
-        dest->font_name =
-            (char *)calloc(strlen(src->font_name) + 1, sizeof(char));
-        strcpy(dest->font_name, src->font_name);
-    }
-    if (src->font_family != NULL) {
-        dest->font_family =
-            (char *)calloc(strlen(src->font_family) + 1, sizeof(char));
-        strcpy(dest->font_family, src->font_family);
-    }
     copy_path(src->clipRGN, &(dest->clipRGN));
+    clip_rects_copy(dest, src);
 }
-void cubic_bezier16_draw(const char *name, const char *contents, FILE *out,
+void cubic_bezier16_draw(const char *name, const char *contents, svgWriter *out,
                          drawingStates *states, int startingPoint) {
     UNUSED(name);
     unsigned int i;
@@ -197,7 +193,7 @@ void cubic_bezier16_draw(const char *name, const char *contents, FILE *out,
     returnOutOfEmf((intptr_t)papts +
                    (intptr_t)(pEmr->cpts) * sizeof(U_POINT16));
     if (startingPoint == 1) {
-        fprintf(out, "M ");
+        path_data_cmd(&(states->pathData), out, 'M');
         point16_draw(states, papts[0], out);
         addNewSegPath(states, SEG_MOVE);
         pointCurrPathAdd16(states, papts[0], 0);
@@ -212,7 +208,7 @@ void cubic_bezier16_draw(const char *name, const char *contents, FILE *out,
             addNewSegPath(states, SEG_BEZIER);
             pointCurrPathAdd16(states, papts[i], index);
             index++;
-            fprintf(out, "C ");
+            path_data_cmd(&(states->pathData), out, 'C');
             point16_draw(states, papts[i], out);
         } else if ((i % 3) == ctrl2) {
             point16_draw(states, papts[i], out);
@@ -226,7 +222,7 @@ void cubic_bezier16_draw(const char *name, const char *contents, FILE *out,
     }
     endPathDraw(states, out);
 }
-void cubic_bezier_draw(const char *name, const char *contents, FILE *out,
+void cubic_bezier_draw(const char *name, const char *contents, svgWriter *out,
                        drawingStates *states, int startingPoint) {
     UNUSED(name);
     unsigned int i;
@@ -235,7 +231,7 @@ void cubic_bezier_draw(const char *name, const char *contents, FILE *out,
     PU_POINT papts = (PU_POINT)(&(pEmr->aptl));
     returnOutOfEmf((intptr_t)papts + (intptr_t)pEmr->cptl * sizeof(U_POINT));
     if (startingPoint == 1) {
-        fprintf(out, "M ");
+        path_data_cmd(&(states->pathData), out, 'M');
         point_draw(states, papts[0], out);
         addNewSegPath(states, SEG_BEZIER);
         pointCurrPathAdd(states, papts[0], 0);
@@ -250,7 +246,7 @@ void cubic_bezier_draw(const char *name, const char *contents, FILE *out,
             addNewSegPath(states, SEG_BEZIER);
             pointCurrPathAdd(states, papts[i], index);
             index++;
-            fprintf(out, "C ");
+            path_data_cmd(&(states->pathData), out, 'C');
             point_draw(states, papts[i], out);
         } else if ((i % 3) == ctrl2) {
             point_draw(states, papts[i], out);
@@ -264,63 +260,66 @@ void cubic_bezier_draw(const char *name, const char *contents, FILE *out,
     }
     endPathDraw(states, out);
 }
-void endFormDraw(drawingStates *states, FILE *out) {
+void endFormDraw(drawingStates *states, svgWriter *out) {
     if (!(states->inPath)) {
-        fprintf(out, "\" ");
+        path_data_end(&(states->pathData), out, false);
         bool filled = false;
         bool stroked = false;
         stroke_draw(states, out, &filled, &stroked);
         fill_draw(states, out, &filled, &stroked);
-        clipset_draw(states, out);
         if (!filled)
-            fprintf(out, "fill=\"none\" ");
+            svg_append_literal(out, "fill=\"none\" ");
         if (!stroked)
-            fprintf(out, "stroke=\"none\" ");
-        fprintf(out, " />\n");
+            svg_append_literal(out, "stroke=\"none\" ");
+        svg_append_literal(out, " />\n");
     }
 }
-void endPathDraw(drawingStates *states, FILE *out) {
+void endPathDraw(drawingStates *states, svgWriter *out) {
     if (!(states->inPath)) {
-        fprintf(out, "\" ");
+        path_data_end(&(states->pathData), out, false);
         bool filled;
         bool stroked;
         stroke_draw(states, out, &filled, &stroked);
-        fprintf(out, " fill=\"none\" />\n");
+        svg_append_literal(out, " fill=\"none\" />\n");
     }
 }
-void fill_draw(drawingStates *states, FILE *out, bool *filled, bool *stroked) {
-    if (states->verbose) {
-        fill_print(states);
+// copy a serialized style fragment in out
+static void style_append(svgWriter *out, const svgWriter *fragment) {
+    if (fragment->error) {
+        out->error = true;
+        return;
     }
-    char *fill_rule = calloc(40, sizeof(char));
-    switch (states->currentDeviceContext.fill_mode) {
+    if (fragment->len)
+        svg_append(out, fragment->buf, fragment->len);
+}
+static const char *fill_rule(int mode) {
+    switch (mode) {
     case (U_ALTERNATE):
-        sprintf(fill_rule, "fill-rule:\"evenodd\" ");
-        break;
+        return "fill-rule:\"evenodd\" ";
     case (U_WINDING):
-        sprintf(fill_rule, "fill-rule:\"nonzero\" ");
-        break;
+        return "fill-rule:\"nonzero\" ";
     default:
-        sprintf(fill_rule, " ");
-        break;
+        return " ";
     }
-    switch (states->currentDeviceContext.fill_mode) {
+}
+static void fill_style(drawingStates *states, svgWriter *out) {
+    switch (currentBrush(states)->mode) {
     case U_BS_SOLID:
-        *filled = true;
-        fprintf(out, "%s", fill_rule);
-        fprintf(out, "fill=\"#%02X%02X%02X\" ",
-                states->currentDeviceContext.fill_red,
-                states->currentDeviceContext.fill_green,
-                states->currentDeviceContext.fill_blue);
+        svg_append_string(out,
+                          fill_rule(currentBrush(states)->mode));
+        svg_append_literal(out, "fill=\"");
+        svg_append_color(out, currentBrush(states)->color.Red,
+                         currentBrush(states)->color.Green,
+                         currentBrush(states)->color.Blue);
+        svg_append_literal(out, "\" ");
         break;
     case U_BS_NULL:
-        fprintf(out, "fill=\"none\" ");
-        *filled = true;
+        svg_append_literal(out, "fill=\"none\" ");
         break;
     case U_BS_MONOPATTERN:
-        fprintf(out, "fill=\"#img-%d-ref\" ",
-                states->currentDeviceContext.fill_idx);
-        *filled = true;
+        svg_append_literal(out, "fill=\"#img-");
+        svg_append_int(out, currentBrush(states)->idx);
+        svg_append_literal(out, "-ref\" ");
         break;
     case U_BS_HATCHED:
     case U_BS_PATTERN:
@@ -331,25 +330,41 @@ void fill_draw(drawingStates *states, FILE *out, bool *filled, bool *stroked) {
     case U_BS_DIBPATTERN8X8:
     default:
         // partial
-        fprintf(out, "fill=\"#%02X%02X%02X\" ",
-                states->currentDeviceContext.fill_red,
-                states->currentDeviceContext.fill_green,
-                states->currentDeviceContext.fill_blue);
-        *filled = true;
+        svg_append_literal(out, "fill=\"");
+        svg_append_color(out, currentBrush(states)->color.Red,
+                         currentBrush(states)->color.Green,
+                         currentBrush(states)->color.Blue);
+        svg_append_literal(out, "\" ");
         break;
     }
-    free(fill_rule);
-    return;
+}
+void fill_draw(drawingStates *states, svgWriter *out, bool *filled,
+               bool *stroked) {
+    UNUSED(stroked);
+    if (isVerbose(states)) {
+        fill_print(states);
+    }
+    emfStyleCache *cache = &(states->styleCache);
+    if (states->currentDeviceContext.dirty & DC_DIRTY_FILL) {
+        cache->fill.len = 0;
+        fill_style(states, &(cache->fill));
+        states->currentDeviceContext.dirty &= ~DC_DIRTY_FILL;
+    }
+    style_append(out, &(cache->fill));
+    *filled = true;
 }
 void freeDeviceContext(EMF_DEVICE_CONTEXT *dc) {
     if (dc != NULL) {
-        if (dc->font_name != NULL)
-            free(dc->font_name);
-        if (dc->font_family != NULL)
-            free(dc->font_family);
         free_path(&(dc->clipRGN));
+        clip_rects_free(dc);
     }
 }
+void freeStyleCache(drawingStates *states) {
+    svg_writer_free(&(states->styleCache.stroke));
+    svg_writer_free(&(states->styleCache.fill));
+    svg_writer_free(&(states->styleCache.text));
+    svg_writer_free(&(states->styleCache.textLayout));
+}
 void freeDeviceContextStack(drawingStates *states) {
     EMF_DEVICE_CONTEXT_STACK *stack_entry = states->DeviceContextStack;
     while (stack_entry != NULL) {
@@ -359,31 +374,102 @@ void freeDeviceContextStack(drawingStates *states) {
         stack_entry = next_entry;
     }
 }
-void freeObject(drawingStates *states, uint16_t index) {
-    if (states->objectTable[index].font_name != NULL)
-        free(states->objectTable[index].font_name);
-    if (states->objectTable[index].font_family != NULL)
-        free(states->objectTable[index].font_family);
-    states->objectTable[index] = (const emfGraphObject){0};
+bool copyDeviceContextStack(drawingStates *dest, drawingStates *src) {
+    EMF_DEVICE_CONTEXT_STACK **tail = &(dest->DeviceContextStack);
+    *tail = NULL;
+    EMF_DEVICE_CONTEXT_STACK *stack_entry = src->DeviceContextStack;
+    for (; stack_entry != NULL; stack_entry = stack_entry->previous) {
+        EMF_DEVICE_CONTEXT_STACK *new_entry =
+            (EMF_DEVICE_CONTEXT_STACK *)calloc(
+                1, sizeof(EMF_DEVICE_CONTEXT_STACK));
+        if (new_entry == NULL)
+            return false;
+        copyDeviceContext(&(new_entry->DeviceContext),
+                          &(stack_entry->DeviceContext));
+        *tail = new_entry;
+        tail = &(new_entry->previous);
+    }
+    return true;
+}
+void freeObject(drawingStates *states, uint32_t index) {
+    emfGraphObject *object = getObject(states, index);
+    if (object == NULL)
+        return;
+    *object = (const emfGraphObject){0};
 }
 void freeObjectTable(drawingStates *states) {
-    for (int32_t i = 0; i < (states->objectTableSize + 1); i++) {
-        freeObject(states, i);
+    if (states->objectTable == NULL)
+        return;
+    int64_t pages = states->objectTableSize / OBJECT_TABLE_PAGE + 1;
+    // the objects only hold ids in the interned tables
+    for (int64_t i = 0; i < pages; i++) {
+        free(states->objectTable[i]);
     }
+    free(states->objectTable);
+    states->objectTable = NULL;
 }
-void freePathStack(pathStack *stack) {
-    while (stack != NULL) {
-        // free(stack->pathStruct);
-        pathStack *tmp = stack;
-        stack = stack->next;
-        free(tmp);
-    }
-    return;
+bool copyObjectTable(drawingStates *dest, drawingStates *src) {
+    dest->objectTable = NULL;
+    if (src->objectTable == NULL)
+        return true;
+    int64_t pages = src->objectTableSize / OBJECT_TABLE_PAGE + 1;
+    dest->objectTable =
+        (emfGraphObject **)calloc(pages, sizeof(emfGraphObject *));
+    if (dest->objectTable == NULL)
+        return false;
+    for (int64_t i = 0; i < pages; i++) {
+        if (src->objectTable[i] == NULL)
+            continue;
+        dest->objectTable[i] = (emfGraphObject *)malloc(
+            OBJECT_TABLE_PAGE * sizeof(emfGraphObject));
+        if (dest->objectTable[i] == NULL)
+            return false;
+        memcpy(dest->objectTable[i], src->objectTable[i],
+               OBJECT_TABLE_PAGE * sizeof(emfGraphObject));
+    }
+    return true;
 }
 int get_id(drawingStates *states) {
-    states->uniqId = rand();
+    // from the record number (up to IDS_PER_RECORD ids by record), so the
+    // ranges of a parallel conversion take the ids of the sequential one,
+    // a record taking more would take the ids of the next one
+    assert(states->idIndex < IDS_PER_RECORD);
+    uint64_t n =
+        (uint64_t)states->idRecord * IDS_PER_RECORD + states->idIndex++;
+    states->uniqId = 1 + (int)((states->idBase + n) % INT32_MAX);
     return states->uniqId;
 }
+emfGraphObject *getObject(drawingStates *states, uint32_t index) {
+    if (states->objectTable == NULL || index > states->objectTableSize)
+        return NULL;
+    emfGraphObject *page = states->objectTable[index / OBJECT_TABLE_PAGE];
+    if (page == NULL)
+        return NULL;
+    return &(page[index % OBJECT_TABLE_PAGE]);
+}
+emfGraphObject *newObject(drawingStates *states, uint32_t index) {
+    if (checkOutOfOTIndex(states, index))
+        return NULL;
+    if (states->objectTable == NULL) {
+        states->objectTable = (emfGraphObject **)calloc(
+            states->objectTableSize / OBJECT_TABLE_PAGE + 1,
+            sizeof(emfGraphObject *));
+        if (states->objectTable == NULL) {
+            states->Error = true;
+            return NULL;
+        }
+    }
+    emfGraphObject **page = &(states->objectTable[index / OBJECT_TABLE_PAGE]);
+    if (*page == NULL) {
+        *page = (emfGraphObject *)calloc(OBJECT_TABLE_PAGE,
+                                         sizeof(emfGraphObject));
+        if (*page == NULL) {
+            states->Error = true;
+            return NULL;
+        }
+    }
+    return &((*page)[index % OBJECT_TABLE_PAGE]);
+}
 POINT_D int_el_rad(U_POINTL pt, U_RECTL rect) {
     POINT_D center, intersect, radii, pt_no;
     center.x = (rect.right + rect.left) / 2;
@@ -434,51 +520,42 @@ POINT_D int_el_rad(U_POINTL pt, U_RECTL rect) {
     return intersect;
 }
 void lineto_draw(const char *name, const char *field1, const char *field2,
-                 const char *contents, FILE *out, drawingStates *states) {
+                 const char *contents, svgWriter *out, drawingStates *states) {
     UNUSED(name);
     PU_EMRGENERICPAIR pEmr = (PU_EMRGENERICPAIR)(contents);
     startPathDraw(states, out);
-    fprintf(out, "L ");
+    path_data_cmd(&(states->pathData), out, 'L');
     point_draw(states, pEmr->pair, out);
     addNewSegPath(states, SEG_LINE);
     pointCurrPathAdd(states, pEmr->pair, 0);
     endPathDraw(states, out);
 }
 void moveto_draw(const char *name, const char *field1, const char *field2,
-                 const char *contents, FILE *out, drawingStates *states) {
+                 const char *contents, svgWriter *out, drawingStates *states) {
     UNUSED(name);
     PU_EMRGENERICPAIR pEmr = (PU_EMRGENERICPAIR)(contents);
     point_draw(states, pEmr->pair, out);
     addNewSegPath(states, SEG_MOVE);
     pointCurrPathAdd(states, pEmr->pair, 0);
 }
-void newPathStruct(drawingStates *states) {
-    pathStack *new_entry = calloc(1, sizeof(pathStack));
-    if (states->emfStructure.pathStack == NULL) {
-        states->emfStructure.pathStack = new_entry;
-        states->emfStructure.pathStackLast = new_entry;
-    } else {
-        states->emfStructure.pathStackLast->next = new_entry;
-        states->emfStructure.pathStackLast = new_entry;
-    }
-}
-void no_stroke(drawingStates *states, FILE *out) {
-    if (states->currentDeviceContext.fill_mode != U_BS_NULL) {
-        fprintf(out, "stroke-width=\"1px\" ");
-        fprintf(out, "stroke=\"#%02X%02X%02X\" ",
-                states->currentDeviceContext.fill_red,
-                states->currentDeviceContext.fill_green,
-                states->currentDeviceContext.fill_blue);
+void no_stroke(drawingStates *states, svgWriter *out) {
+    if (currentBrush(states)->mode != U_BS_NULL) {
+        svg_append_literal(out, "stroke-width=\"1px\" ");
+        svg_append_literal(out, "stroke=\"");
+        svg_append_color(out, currentBrush(states)->color.Red,
+                         currentBrush(states)->color.Green,
+                         currentBrush(states)->color.Blue);
+        svg_append_literal(out, "\" ");
     } else {
-        fprintf(out, "stroke=\"none\" ");
-        fprintf(out, "stroke-width=\"0.0\" ");
+        svg_append_literal(out, "stroke=\"none\" ");
+        svg_append_literal(out, "stroke-width=\"0.0\" ");
     }
 }
-void point16_draw(drawingStates *states, U_POINT16 pt, FILE *out) {
+void point16_draw(drawingStates *states, U_POINT16 pt, svgWriter *out) {
     POINT_D ptd = point_cal(states, (double)pt.x, (double)pt.y);
     states->cur_x = pt.x;
     states->cur_y = pt.y;
-    fprintf(out, "%.4f,%.4f ", ptd.x, ptd.y);
+    path_data_point(&(states->pathData), out, ptd);
 }
 
 double scaleX(drawingStates *states, double x) {
@@ -661,23 +738,20 @@ POINT_D point_s16(drawingStates *states, U_POINT16 pt) {
     return point_cal(states, (double)pt.x, (double)pt.y);
 }
 
-void point_draw(drawingStates *states, U_POINT pt, FILE *out) {
+void point_draw(drawingStates *states, U_POINT pt, svgWriter *out) {
     POINT_D ptd = point_cal(states, (double)pt.x, (double)pt.y);
     states->cur_x = pt.x;
     states->cur_y = pt.y;
-    fprintf(out, "%.4f,%.4f ", ptd.x, ptd.y);
+    path_data_point(&(states->pathData), out, ptd);
 }
-void point_draw_d(drawingStates *states, POINT_D pt, FILE *out) {
+void point_draw_d(drawingStates *states, POINT_D pt, svgWriter *out) {
     POINT_D ptd = point_cal(states, pt.x, pt.y);
     states->cur_x = pt.x;
     states->cur_y = pt.y;
-    fprintf(out, "%.4f,%.4f ", ptd.x, ptd.y);
+    path_data_point(&(states->pathData), out, ptd);
 }
 
-void point_draw_raw_d(POINT_D pt, FILE *out) {
-    fprintf(out, "%.4f,%.4f ", pt.x, pt.y);
-}
-void polyline16_draw(const char *name, const char *contents, FILE *out,
+void polyline16_draw(const char *name, const char *contents, svgWriter *out,
                      drawingStates *states, bool polygon) {
     UNUSED(name);
     unsigned int i;
@@ -688,18 +762,17 @@ void polyline16_draw(const char *name, const char *contents, FILE *out,
     startPathDraw(states, out);
     for (i = 0; i < pEmr->cpts; i++) {
         if (polygon && i == 0) {
-            fprintf(out, "M ");
             addNewSegPath(states, SEG_MOVE);
         } else {
-            fprintf(out, "L ");
             addNewSegPath(states, SEG_LINE);
         }
         pointCurrPathAdd16(states, papts[i], 0);
-        point16_draw(states, papts[i], out);
     }
+    poly_points_draw(states, out, (const char *)papts, true, pEmr->cpts,
+                     polygon);
     endPathDraw(states, out);
 }
-void polyline_draw(const char *name, const char *contents, FILE *out,
+void polyline_draw(const char *name, const char *contents, svgWriter *out,
                    drawingStates *states, bool polygon) {
     UNUSED(name);
     unsigned int i;
@@ -709,119 +782,103 @@ void polyline_draw(const char *name, const char *contents, FILE *out,
     returnOutOfEmf((intptr_t)papts + (intptr_t)(pEmr->cptl) * sizeof(U_POINT));
     for (i = 0; i < pEmr->cptl; i++) {
         if (polygon && i == 0) {
-            fprintf(out, "M ");
             addNewSegPath(states, SEG_MOVE);
         } else {
-            fprintf(out, "L ");
             addNewSegPath(states, SEG_LINE);
         }
-        point_draw(states, pEmr->aptl[i], out);
         pointCurrPathAdd(states, pEmr->aptl[i], 0);
     }
+    poly_points_draw(states, out, (const char *)papts, false, pEmr->cptl,
+                     polygon);
     endPathDraw(states, out);
 }
-void polypolygon16_draw(const char *name, const char *contents, FILE *out,
+// polygons of POLYPOLYGON* and POLYPOLYLINE* records (U_POINT16 if is16)
+static void polypolygon_points_draw(drawingStates *states, svgWriter *out,
+                                    PU_EMRPOLYPOLYLINE16 pEmr,
+                                    const char *papts, bool is16,
+                                    bool polygon) {
+    size_t pointSize = is16 ? sizeof(U_POINT16) : sizeof(U_POINT);
+    uint32_t index = 0;
+    for (uint32_t i = 0; i < pEmr->nPolys && index < pEmr->cpts; i++) {
+        uint32_t count = pEmr->aPolyCounts[i];
+        if (count == 0)
+            continue;
+        bool closed = count <= pEmr->cpts - index;
+        if (!closed)
+            count = pEmr->cpts - index;
+        for (uint32_t j = 0; j < count; j++) {
+            if (j == 0)
+                addNewSegPath(states, SEG_MOVE);
+            else
+                addNewSegPath(states, SEG_LINE);
+            if (is16)
+                pointCurrPathAdd16(states, ((PU_POINT16)papts)[index + j], 0);
+            else
+                pointCurrPathAdd(states, ((PU_POINT)papts)[index + j], 0);
+        }
+        poly_points_draw(states, out, papts + pointSize * index, is16, count,
+                         true);
+        index += count;
+        if (polygon && closed) {
+            path_data_cmd(&(states->pathData), out, 'Z');
+            addNewSegPath(states, SEG_END);
+        }
+    }
+}
+void polypolygon16_draw(const char *name, const char *contents, svgWriter *out,
                         drawingStates *states, bool polygon) {
     UNUSED(name);
-    unsigned int i;
     PU_EMRPOLYPOLYLINE16 pEmr = (PU_EMRPOLYPOLYLINE16)(contents);
     PU_POINT16 papts = (PU_POINT16)((char *)pEmr->aPolyCounts +
                                     sizeof(uint32_t) * pEmr->nPolys);
     returnOutOfEmf((intptr_t)papts +
                    (intptr_t)(pEmr->cpts) * sizeof(U_POINT16));
-
-    int counter = 0;
-    int polygon_index = 0;
-    for (i = 0; i < pEmr->cpts; i++) {
-        if (counter == 0) {
-            fprintf(out, "M ");
-            point16_draw(states, papts[i], out);
-            addNewSegPath(states, SEG_MOVE);
-            pointCurrPathAdd16(states, papts[i], 0);
-        } else {
-            fprintf(out, "L ");
-            point16_draw(states, papts[i], out);
-            addNewSegPath(states, SEG_LINE);
-            pointCurrPathAdd16(states, papts[i], 0);
-        }
-        counter++;
-        if (pEmr->aPolyCounts[polygon_index] == counter) {
-            if (polygon) {
-                fprintf(out, "Z ");
-                addNewSegPath(states, SEG_END);
-            }
-            counter = 0;
-            polygon_index++;
-        }
-    }
+    polypolygon_points_draw(states, out, pEmr, (const char *)papts, true,
+                            polygon);
 }
-void polypolygon_draw(const char *name, const char *contents, FILE *out,
+void polypolygon_draw(const char *name, const char *contents, svgWriter *out,
                       drawingStates *states, bool polygon) {
     UNUSED(name);
-    unsigned int i;
     PU_EMRPOLYPOLYLINE16 pEmr = (PU_EMRPOLYPOLYLINE16)(contents);
     PU_POINT papts =
         (PU_POINT)((char *)pEmr->aPolyCounts + sizeof(uint32_t) * pEmr->nPolys);
-
-    int counter = 0;
-    int polygon_index = 0;
     returnOutOfEmf((intptr_t)papts + (intptr_t)(pEmr->cpts) * sizeof(U_POINT));
-    for (i = 0; i < pEmr->cpts; i++) {
-        if (counter == 0) {
-            fprintf(out, "M ");
-            point_draw(states, papts[i], out);
-            addNewSegPath(states, SEG_MOVE);
-            pointCurrPathAdd(states, papts[i], 0);
-        } else {
-            fprintf(out, "L ");
-            point_draw(states, papts[i], out);
-            addNewSegPath(states, SEG_LINE);
-            pointCurrPathAdd(states, papts[i], 0);
-        }
-        counter++;
-        if (pEmr->aPolyCounts[polygon_index] == counter) {
-            if (polygon) {
-                fprintf(out, "Z ");
-                addNewSegPath(states, SEG_END);
-            }
-            counter = 0;
-            polygon_index++;
-        }
-    }
+    polypolygon_points_draw(states, out, pEmr, (const char *)papts, false,
+                            polygon);
 }
-void rectl_draw(drawingStates *states, FILE *out, U_RECTL rect) {
+void rectl_draw(drawingStates *states, svgWriter *out, U_RECTL rect) {
     U_POINT pt;
-    fprintf(out, "M ");
+    path_data_cmd(&(states->pathData), out, 'M');
     pt.x = rect.left;
     pt.y = rect.top;
     addNewSegPath(states, SEG_MOVE);
     pointCurrPathAdd(states, pt, 0);
     point_draw(states, pt, out);
-    fprintf(out, "L ");
+    path_data_cmd(&(states->pathData), out, 'L');
     pt.x = rect.right;
     pt.y = rect.top;
     addNewSegPath(states, SEG_LINE);
     pointCurrPathAdd(states, pt, 0);
     point_draw(states, pt, out);
-    fprintf(out, "L ");
+    path_data_cmd(&(states->pathData), out, 'L');
     pt.x = rect.right;
     pt.y = rect.bottom;
     addNewSegPath(states, SEG_LINE);
     pointCurrPathAdd(states, pt, 0);
     point_draw(states, pt, out);
-    fprintf(out, "L ");
+    path_data_cmd(&(states->pathData), out, 'L');
     pt.x = rect.left;
     pt.y = rect.bottom;
     addNewSegPath(states, SEG_LINE);
     pointCurrPathAdd(states, pt, 0);
     point_draw(states, pt, out);
-    fprintf(out, "L ");
+    path_data_cmd(&(states->pathData), out, 'L');
     pt.x = rect.left;
     pt.y = rect.top;
     addNewSegPath(states, SEG_LINE);
     pointCurrPathAdd(states, pt, 0);
     point_draw(states, pt, out);
-    fprintf(out, "Z ");
+    path_data_cmd(&(states->pathData), out, 'Z');
     addNewSegPath(states, SEG_END);
 }
 void restoreDeviceContext(drawingStates *states, int32_t index) {
@@ -845,6 +902,10 @@ void restoreDeviceContext(drawingStates *states, int32_t index) {
     states->currentDeviceContext = (EMF_DEVICE_CONTEXT){0};
     copyDeviceContext(&(states->currentDeviceContext),
                       &(stack_entry->DeviceContext));
+    if (states->stats)
+        states->stats->bufferAllocations++;
+    // the style cache holds the style of the replaced device context
+    states->currentDeviceContext.dirty = DC_DIRTY_ALL;
 }
 void saveDeviceContext(drawingStates *states) {
     // create the new device context in the stack
@@ -852,6 +913,10 @@ void saveDeviceContext(drawingStates *states) {
         (EMF_DEVICE_CONTEXT_STACK *)calloc(1, sizeof(EMF_DEVICE_CONTEXT_STACK));
     copyDeviceContext(&(new_entry->DeviceContext),
                       &(states->currentDeviceContext));
+    if (states->stats)
+        states->stats->bufferAllocations++;
+    // the entries stay on the stack until the end of the conversion
+    states->budget.memory += sizeof(EMF_DEVICE_CONTEXT_STACK);
     // put the new entry on the stack
     new_entry->previous = states->DeviceContextStack;
     states->DeviceContextStack = new_entry;
@@ -864,11 +929,15 @@ void setTransformIdentity(drawingStates *states) {
     states->currentDeviceContext.worldTransform.eDx = 0.0;
     states->currentDeviceContext.worldTransform.eDy = 0.0;
 }
-void startPathDraw(drawingStates *states, FILE *out) {
+void startPathDraw(drawingStates *states, svgWriter *out) {
     if (!(states->inPath)) {
-        fprintf(out, "<%spath ", states->nameSpaceString);
         clipset_draw(states, out);
-        fprintf(out, "d=\"M ");
+        svg_append_literal(out, "<");
+        svg_append_string(out, states->nameSpaceString);
+        svg_append_literal(out, "path ");
+        svg_append_literal(out, "d=\"");
+        path_data_start(states, &(states->pathData));
+        path_data_cmd(&(states->pathData), out, 'M');
         U_POINT pt;
         pt.x = states->cur_x;
         pt.y = states->cur_y;
@@ -877,24 +946,21 @@ void startPathDraw(drawingStates *states, FILE *out) {
         pointCurrPathAdd(states, pt, 0);
     }
 }
-void stroke_draw(drawingStates *states, FILE *out, bool *filled,
-                 bool *stroked) {
+static void stroke_style(drawingStates *states, svgWriter *out,
+                         bool *stroked) {
     float unit_stroke =
-        states->currentDeviceContext.stroke_width * states->scaling;
+        currentPen(states)->width * states->scaling;
     float dash_len = unit_stroke * 5;
     float dot_len = unit_stroke;
-    if (states->verbose) {
-        stroke_print(states);
-    }
 
-    if ((states->currentDeviceContext.stroke_mode & 0x000000FF) == U_PS_NULL) {
+    if ((currentPen(states)->mode & 0x000000FF) == U_PS_NULL) {
         // no stroke with the fill color with a with of 1px
         no_stroke(states, out);
         *stroked = true;
         return;
     }
     // pen type
-    switch (states->currentDeviceContext.stroke_mode & 0x000F0000) {
+    switch (currentPen(states)->mode & 0x000F0000) {
     case U_PS_COSMETIC:
         color_stroke(states, out);
         // width_stroke(states, out, 1 / states->scaling);
@@ -907,22 +973,30 @@ void stroke_draw(drawingStates *states, FILE *out, bool *filled,
         break;
     }
     // line style.
-    switch (states->currentDeviceContext.stroke_mode & 0x000000FF) {
+    switch (currentPen(states)->mode & 0x000000FF) {
     case U_PS_SOLID:
         break;
     case U_PS_DASH:
-        fprintf(out, "stroke-dasharray=\"%.4f,%.4f\" ", dash_len, dash_len);
+        svg_append_literal(out, "stroke-dasharray=\"");
+        svg_append_number(out, dash_len);
+        svg_append_literal(out, ",");
+        svg_append_number(out, dash_len);
+        svg_append_literal(out, "\" ");
         break;
     case U_PS_DOT:
-        fprintf(out, "stroke-dasharray=\"%.4f,%.4f\" ", dot_len, dot_len);
+        svg_append_literal(out, "stroke-dasharray=\"");
+        svg_append_number(out, dot_len);
+        svg_append_literal(out, ",");
+        svg_append_number(out, dot_len);
+        svg_append_literal(out, "\" ");
         break;
     case U_PS_DASHDOT:
-        fprintf(out, "stroke-dasharray=\"%.4f,%.4f,%.4f,%.4f\" ", dash_len,
-                dash_len, dot_len, dash_len);
+        svg_printf(out, "stroke-dasharray=\"%.4f,%.4f,%.4f,%.4f\" ", dash_len,
+                   dash_len, dot_len, dash_len);
         break;
     case U_PS_DASHDOTDOT:
-        fprintf(out, "stroke-dasharray=\"%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\" ",
-                dash_len, dash_len, dot_len, dot_len, dot_len, dash_len);
+        svg_printf(out, "stroke-dasharray=\"%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\" ",
+                   dash_len, dash_len, dot_len, dot_len, dot_len, dash_len);
         break;
     case U_PS_INSIDEFRAME:
     case U_PS_USERSTYLE:
@@ -932,112 +1006,159 @@ void stroke_draw(drawingStates *states, FILE *out, bool *filled,
         break;
     }
     // line cap.
-    switch (states->currentDeviceContext.stroke_mode & 0x00000F00) {
+    switch (currentPen(states)->mode & 0x00000F00) {
     case U_PS_ENDCAP_ROUND:
-        fprintf(out, " stroke-linecap=\"round\" ");
+        svg_append_literal(out, " stroke-linecap=\"round\" ");
         break;
     case U_PS_ENDCAP_SQUARE:
-        fprintf(out, " stroke-linecap=\"square\" ");
+        svg_append_literal(out, " stroke-linecap=\"square\" ");
         break;
     case U_PS_ENDCAP_FLAT:
-        fprintf(out, " stroke-linecap=\"butt\" ");
+        svg_append_literal(out, " stroke-linecap=\"butt\" ");
         break;
     default:
         break;
     }
     // line join.
-    switch (states->currentDeviceContext.stroke_mode & 0x0000F000) {
+    switch (currentPen(states)->mode & 0x0000F000) {
     case U_PS_JOIN_ROUND:
-        fprintf(out, " stroke-linejoin=\"round\" ");
+        svg_append_literal(out, " stroke-linejoin=\"round\" ");
         break;
     case U_PS_JOIN_BEVEL:
-        fprintf(out, " stroke-linejoin=\"bevel\" ");
+        svg_append_literal(out, " stroke-linejoin=\"bevel\" ");
         break;
     case U_PS_JOIN_MITER:
-        fprintf(out, " stroke-linejoin=\"miter\" ");
+        svg_append_literal(out, " stroke-linejoin=\"miter\" ");
         if (states->currentDeviceContext.miterLimit)
-            fprintf(out, " stroke-miterlimit=\"%.4f\" ",
-                    states->scaling *
-                        (double)states->currentDeviceContext.miterLimit);
+            svg_printf(out, " stroke-miterlimit=\"%.4f\" ",
+                       states->scaling *
+                           (double)states->currentDeviceContext.miterLimit);
         break;
     default:
         break;
     }
 }
-
-void text_style_draw(FILE *out, drawingStates *states, POINT_D Org) {
-    double font_height =
-        fabs(scaleX(states, states->currentDeviceContext.font_height));
-    if (states->currentDeviceContext.font_family != NULL)
-        fprintf(out, "font-family=\"%s\" ",
-                states->currentDeviceContext.font_family);
-    fprintf(out, "fill=\"#%02X%02X%02X\" ",
-            states->currentDeviceContext.text_red,
-            states->currentDeviceContext.text_green,
-            states->currentDeviceContext.text_blue);
-    int orientation = 1;
-    if (scaleY(states, 1.0) > 0) {
-        orientation = -1;
-    } else {
-        orientation = 1;
+void stroke_draw(drawingStates *states, svgWriter *out, bool *filled,
+                 bool *stroked) {
+    UNUSED(filled);
+    if (isVerbose(states)) {
+        stroke_print(states);
     }
-
-    if (states->currentDeviceContext.font_escapement != 0) {
-        fprintf(out, "transform=\"rotate(%d, %.4f, %.4f) translate(0, %.4f)\" ",
-                (orientation *
-                 (int)states->currentDeviceContext.font_escapement / 10),
-                Org.x, (Org.y + font_height * 0.9), font_height * 0.9);
+    emfStyleCache *cache = &(states->styleCache);
+    if (states->currentDeviceContext.dirty & DC_DIRTY_STROKE) {
+        cache->stroke.len = 0;
+        cache->stroked = false;
+        stroke_style(states, &(cache->stroke), &(cache->stroked));
+        states->currentDeviceContext.dirty &= ~DC_DIRTY_STROKE;
     }
+    style_append(out, &(cache->stroke));
+    if (cache->stroked)
+        *stroked = true;
+}
 
+static void text_color_style(drawingStates *states, svgWriter *out) {
+    const char *family = internedString(states, currentFont(states)->family);
+    if (family != NULL)
+        svg_printf(out, "font-family=\"%s\" ", family);
+    svg_append_literal(out, "fill=\"");
+    svg_append_color(out, states->currentDeviceContext.text_color.Red,
+                     states->currentDeviceContext.text_color.Green,
+                     states->currentDeviceContext.text_color.Blue);
+    svg_append_literal(out, "\" ");
+}
+static void text_layout_style(drawingStates *states, svgWriter *out) {
     if (states->text_layout == U_LAYOUT_RTL) {
-        fprintf(out, "writing-mode=\"rl-tb\" ");
+        svg_append_literal(out, "writing-mode=\"rl-tb\" ");
     }
 
-    if (states->currentDeviceContext.font_italic) {
-        fprintf(out, "font-style=\"italic\" ");
+    if (currentFont(states)->italic) {
+        svg_append_literal(out, "font-style=\"italic\" ");
     }
 
-    fprintf(out, "style =\"white-space:pre;\" ");
+    svg_append_literal(out, "style =\"white-space:pre;\" ");
 
-    if (states->currentDeviceContext.font_underline &&
-        states->currentDeviceContext.font_strikeout) {
-        fprintf(out, "text-decoration=\"line-through,underline\" ");
-    } else if (states->currentDeviceContext.font_underline) {
-        fprintf(out, "text-decoration=\"underline\" ");
-    } else if (states->currentDeviceContext.font_strikeout) {
-        fprintf(out, "text-decoration=\"line-through\" ");
+    if (currentFont(states)->underline &&
+        currentFont(states)->strikeout) {
+        svg_append_literal(out, "text-decoration=\"line-through,underline\" ");
+    } else if (currentFont(states)->underline) {
+        svg_append_literal(out, "text-decoration=\"underline\" ");
+    } else if (currentFont(states)->strikeout) {
+        svg_append_literal(out, "text-decoration=\"line-through\" ");
     }
 
-    if (states->currentDeviceContext.font_weight != 0)
-        fprintf(out, "font-weight=\"%d\" ",
-                states->currentDeviceContext.font_weight);
+    if (currentFont(states)->weight != 0)
+        svg_printf(out, "font-weight=\"%d\" ",
+                   currentFont(states)->weight);
 
     // horizontal position
     uint16_t align = states->currentDeviceContext.text_align;
     if ((align & U_TA_CENTER) == U_TA_CENTER) {
-        fprintf(out, "text-anchor=\"middle\" ");
+        svg_append_literal(out, "text-anchor=\"middle\" ");
     } else if ((align & U_TA_CENTER2) == U_TA_CENTER2) {
-        fprintf(out, "text-anchor=\"middle\" ");
+        svg_append_literal(out, "text-anchor=\"middle\" ");
     } else if ((align & U_TA_RIGHT) == U_TA_RIGHT) {
-        fprintf(out, "text-anchor=\"end\" ");
+        svg_append_literal(out, "text-anchor=\"end\" ");
+    } else {
+        svg_append_literal(out, "text-anchor=\"start\" ");
+    }
+}
+void text_style_draw(svgWriter *out, drawingStates *states, POINT_D Org) {
+    double font_height =
+        fabs(scaleX(states, currentFont(states)->height));
+    emfStyleCache *cache = &(states->styleCache);
+    if (states->currentDeviceContext.dirty & DC_DIRTY_TEXT) {
+        cache->text.len = 0;
+        cache->textLayout.len = 0;
+        text_color_style(states, &(cache->text));
+        text_layout_style(states, &(cache->textLayout));
+        states->currentDeviceContext.dirty &= ~DC_DIRTY_TEXT;
+    }
+    style_append(out, &(cache->text));
+    int orientation = 1;
+    if (scaleY(states, 1.0) > 0) {
+        orientation = -1;
     } else {
-        fprintf(out, "text-anchor=\"start\" ");
+        orientation = 1;
     }
+
+    if (currentFont(states)->escapement != 0) {
+        svg_printf(
+            out, "transform=\"rotate(%d, %.4f, %.4f) translate(0, %.4f)\" ",
+            (orientation * (int)currentFont(states)->escapement /
+             10),
+            Org.x, (Org.y + font_height * 0.9), font_height * 0.9);
+    }
+    style_append(out, &(cache->textLayout));
+
     // vertical position
+    uint16_t align = states->currentDeviceContext.text_align;
     if ((align & U_TA_BOTTOM) == U_TA_BOTTOM) {
-        fprintf(out, "x=\"%.4f\" y=\"%.4f\" ", Org.x, Org.y);
+        svg_append_literal(out, "x=\"");
+        svg_append_number(out, Org.x);
+        svg_append_literal(out, "\" y=\"");
+        svg_append_number(out, Org.y);
+        svg_append_literal(out, "\" ");
     } else if ((align & U_TA_BASELINE) == U_TA_BASELINE) {
-        fprintf(out, "x=\"%.4f\" y=\"%.4f\" ", Org.x, Org.y);
+        svg_append_literal(out, "x=\"");
+        svg_append_number(out, Org.x);
+        svg_append_literal(out, "\" y=\"");
+        svg_append_number(out, Org.y);
+        svg_append_literal(out, "\" ");
     } else {
-        fprintf(out, "x=\"%.4f\" y=\"%.4f\" ", Org.x,
-                Org.y + font_height * 0.9);
+        svg_append_literal(out, "x=\"");
+        svg_append_number(out, Org.x);
+        svg_append_literal(out, "\" y=\"");
+        svg_append_number(out, Org.y + font_height * 0.9);
+        svg_append_literal(out, "\" ");
     }
-    fprintf(out, "font-size=\"%.4f\" ", font_height);
+    svg_append_literal(out, "font-size=\"");
+    svg_append_number(out, font_height);
+    svg_append_literal(out, "\" ");
 }
 
 // get the closest ttf file matching font_family, weight, italic
-static int get_fontpath(char *font_family, int weight, int italic,
-                        char **path) {
+static int get_fontpath_unlocked(char *font_family, int weight, int italic,
+                                 char **path) {
     FcPattern *pat;
     FcObjectSet *os = 0;
     FcResult result;
@@ -1125,6 +1246,18 @@ static int get_fontpath(char *font_family, int weight, int italic,
     return 0;
 }
 
+static int get_fontpath(char *font_family, int weight, int italic,
+                        char **path) {
+#ifndef _MSC_VER
+    pthread_mutex_lock(&fontconfig_lock);
+#endif
+    int ret = get_fontpath_unlocked(font_family, weight, italic, path);
+#ifndef _MSC_VER
+    pthread_mutex_unlock(&fontconfig_lock);
+#endif
+    return ret;
+}
+
 // generate the reverse cmap from the ttf file
 static int cmap_rev(const char *fpath, cmap_collection *rcmap) {
     FT_Library library;
@@ -1423,13 +1556,17 @@ void text_convert(char *in, size_t size_in, char **out, size_t *size_out,
         break;
     case FONTINDEX:
         returnOutOfEmf((intptr_t)in + 2 * (intptr_t)size_in);
-        ret = fontindex_to_utf8((uint16_t *)in, size_in, (char **)&string,
-                                size_out,
-                                states->currentDeviceContext.font_family,
-                                states->currentDeviceContext.font_weight,
-                                states->currentDeviceContext.font_italic);
+        double start = states->timing ? e2s_clock() : 0;
+        ret = fontindex_to_utf8(
+            (uint16_t *)in, size_in, (char **)&string, size_out,
+            internedString(states, currentFont(states)->family),
+            currentFont(states)->weight, currentFont(states)->italic);
+        if (states->timing)
+            states->fontsTime += e2s_clock() - start;
+        if (states->stats)
+            states->stats->fontLookups++;
         if (ret==0 && string!=NULL) {
-            switch (states->currentDeviceContext.font_charset) {
+            switch (currentFont(states)->charset) {
             case U_HEBREW_CHARSET:
             case U_ARABIC_CHARSET:
                 /* with Utf-8 strings, the strings must always be
@@ -1510,20 +1647,22 @@ void text_convert(char *in, size_t size_in, char **out, size_t *size_out,
     *out = (char *)string;
 }
 
-void text_draw(const char *contents, FILE *out, drawingStates *states,
+void text_draw(const char *contents, svgWriter *out, drawingStates *states,
                uint8_t type) {
     PU_EMRTEXT pemt =
         (PU_EMRTEXT)(contents + sizeof(U_EMREXTTEXTOUTA) - sizeof(U_EMRTEXT));
 
     returnOutOfEmf(pemt);
 
-    fprintf(out, "<%stext ", states->nameSpaceString);
     clipset_draw(states, out);
+    svg_append_literal(out, "<");
+    svg_append_string(out, states->nameSpaceString);
+    svg_append_literal(out, "text ");
     POINT_D Org = point_cal(states, (double)pemt->ptlReference.x,
                             (double)pemt->ptlReference.y);
 
     text_style_draw(out, states, Org);
-    fprintf(out, ">");
+    svg_append_literal(out, ">");
 
     char *string = NULL;
     size_t string_size;
@@ -1534,37 +1673,49 @@ void text_draw(const char *contents, FILE *out, drawingStates *states,
                  &string_size, type, states);
 
     if (string != NULL) {
-        fprintf(out, "<![CDATA[%s]]>", string);
+        svg_append_literal(out, "<![CDATA[");
+        svg_append_string(out, string);
+        svg_append_literal(out, "]]>");
         free(string);
     } else {
-        fprintf(out, "<![CDATA[]]>");
+        svg_append_literal(out, "<![CDATA[]]>");
     }
-    fprintf(out, "</%stext>\n", states->nameSpaceString);
+    svg_append_literal(out, "</");
+    svg_append_string(out, states->nameSpaceString);
+    svg_append_literal(out, "text>\n");
 }
-void transform_draw(drawingStates *states, FILE *out) {
+void transform_draw(drawingStates *states, svgWriter *out) {
     // transformation could be set inside path.
     // If we are in a path, we do nothing here.
     // However the transformation is set in BEGINPATH or ENDPATH.
     // The "pre" parsing is used to determine if such cases can occure
     // and records transformations that doesn't occure where the record is
     // declared.
-    // (function U_emf_onerec_analyse)
+    // (function index_build)
     if (states->inPath)
         return;
+    // clipping group is always the innermost one
+    clip_group_close(states, out);
     if (states->transform_open) {
-        fprintf(out, "</%sg>\n", states->nameSpaceString);
+        svg_append_literal(out, "</");
+        svg_append_string(out, states->nameSpaceString);
+        svg_append_literal(out, "g>\n");
     }
-    fprintf(
+    svg_printf(
         out, "<%sg transform=\"matrix(%.4f %.4f %.4f %.4f %.4f %.4f)\">\n",
         states->nameSpaceString,
         (double)states->currentDeviceContext.worldTransform.eM11,
         (double)states->currentDeviceContext.worldTransform.eM12,
         (double)states->currentDeviceContext.worldTransform.eM21,
         (double)states->currentDeviceContext.worldTransform.eM22,
-        (double)scaleX(states, states->currentDeviceContext.worldTransform.eDx),
+        (double)scaleX(states,
+                       states->currentDeviceContext.worldTransform.eDx),
         (double)scaleY(states,
                        states->currentDeviceContext.worldTransform.eDy));
     states->transform_open = true;
+    // the path of an inverted clipping region depends on the transform
+    if (states->currentDeviceContext.clipInverted)
+        clip_rgn_draw(states, out);
 }
 bool transform_set(drawingStates *states, U_XFORM xform, uint32_t iMode) {
     switch (iMode) {
@@ -1661,14 +1812,16 @@ bool transform_set(drawingStates *states, U_XFORM xform, uint32_t iMode) {
         return false;
     }
 }
-void width_stroke(drawingStates *states, FILE *out, double width) {
+void width_stroke(drawingStates *states, svgWriter *out, double width) {
     double tmp_w = scaleX(states, width);
     // minimum size of a line seems to be 1px, even if smaller after resize
     // keeping this behavior
     if ((tmp_w / states->scaling) < 1.0) {
-        fprintf(out, "stroke-width=\"1px\" ");
+        svg_append_literal(out, "stroke-width=\"1px\" ");
     } else {
-        fprintf(out, "stroke-width=\"%.4f\" ", tmp_w);
+        svg_append_literal(out, "stroke-width=\"");
+        svg_append_number(out, tmp_w);
+        svg_append_literal(out, "\" ");
     }
 }
 
@@ -1708,6 +1861,102 @@ char *base64_encode(const unsigned char *data, size_t input_length,
     return encoded_data;
 }
 
+double e2s_clock(void) {
+    struct timespec ts;
+#ifdef _MSC_VER
+    timespec_get(&ts, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+void budget_init(drawingStates *states, generatorOptions *options) {
+    emfBudget *budget = &(states->budget);
+    options->budgetExceeded = EMF2SVG_BUDGET_NONE;
+    options->cancelled = false;
+    if (options->maxTime > 0)
+        budget->deadline = e2s_clock() + options->maxTime;
+    budget->maxOutput = options->maxOutput;
+    budget->maxRecords = options->maxRecords;
+    budget->maxImagePixels = options->maxImagePixels;
+    budget->maxMemory = options->maxMemory;
+    budget->enabled = budget->deadline > 0 || budget->maxOutput ||
+                      budget->maxRecords || budget->maxImagePixels ||
+                      budget->maxMemory;
+}
+
+static bool budget_exceed(drawingStates *states, generatorBudget budget) {
+    states->budget.exceeded = budget;
+    states->Error = true;
+    return true;
+}
+
+// svg bytes written, in the tiles if any (out is then a record fragment)
+static size_t budget_output(drawingStates *states, svgWriter *out) {
+    size_t output = out->written + out->len;
+    if (states->tiles) {
+        for (unsigned int i = 0; i < states->tiles->count; i++)
+            output += states->tiles->writers[i].len;
+    }
+    return output;
+}
+
+static size_t budget_memory(drawingStates *states, svgWriter *out) {
+    size_t memory = states->budget.memory + out->size +
+                    states->pathRun.d.size + states->pathRun.style.size +
+                    states->trace.text.size;
+    if (states->tiles) {
+        for (unsigned int i = 0; i < states->tiles->count; i++)
+            memory += states->tiles->writers[i].size;
+    }
+    return memory;
+}
+
+// called before drawing each record (EMF and EMF+), returns true (and sets
+// states->Error) if a budget is exceeded
+bool budget_check(drawingStates *states, svgWriter *out) {
+    emfBudget *budget = &(states->budget);
+    if (budget->exceeded)
+        return true;
+    budget->records++;
+    if (budget->maxRecords && budget->records > budget->maxRecords)
+        return budget_exceed(states, EMF2SVG_BUDGET_RECORDS);
+    if (budget->maxOutput && !states->tiles &&
+        budget->outputBase + out->written + out->len > budget->maxOutput)
+        return budget_exceed(states, EMF2SVG_BUDGET_OUTPUT);
+    if (budget->records % BUDGET_INTERVAL)
+        return false;
+    if (budget->deadline > 0 && e2s_clock() > budget->deadline)
+        return budget_exceed(states, EMF2SVG_BUDGET_TIME);
+    if (budget->maxOutput && states->tiles &&
+        budget_output(states, out) > budget->maxOutput)
+        return budget_exceed(states, EMF2SVG_BUDGET_OUTPUT);
+    if (budget->maxMemory && budget_memory(states, out) > budget->maxMemory)
+        return budget_exceed(states, EMF2SVG_BUDGET_MEMORY);
+    return false;
+}
+
+// called before decoding a width x height bitmap, returns false (and sets
+// states->Error) if a budget is exceeded
+bool budget_image(drawingStates *states, svgWriter *out, uint64_t width,
+                  uint64_t height) {
+    emfBudget *budget = &(states->budget);
+    if (!budget->enabled)
+        return true;
+    uint64_t pixels = width * height;
+    budget->imagePixels += pixels;
+    if (budget->maxImagePixels && budget->imagePixels > budget->maxImagePixels)
+        return !budget_exceed(states, EMF2SVG_BUDGET_IMAGE_PIXELS);
+    if (budget->deadline > 0 && e2s_clock() > budget->deadline)
+        return !budget_exceed(states, EMF2SVG_BUDGET_TIME);
+    // RGBA pixels, and about as much for the png and its base64
+    if (budget->maxMemory &&
+        budget_memory(states, out) + pixels * 4 * 2 > budget->maxMemory)
+        return !budget_exceed(states, EMF2SVG_BUDGET_MEMORY);
+    return true;
+}
+
 void pointCurrPathAdd16(drawingStates *states, U_POINT16 pt, int index) {
     if (states->inPath) {
         states->currentPath->last->section.points[index] =
@@ -1749,33 +1998,35 @@ void free_path(PATH **path) {
     (*path) = NULL;
 }
 
-void draw_path(PATH *in, FILE *out) {
+void draw_path(drawingStates *states, PATH *in, svgWriter *out) {
     PATH *tmp = in;
+    emfPathData pd;
+    path_data_start(states, &pd);
     while (tmp != NULL) {
         uint8_t type = tmp->section.type;
         POINT_D *pt = tmp->section.points;
         switch (type) {
         case SEG_END:
-            fprintf(out, "Z ");
+            path_data_cmd(&pd, out, 'Z');
             break;
         case SEG_MOVE:
-            fprintf(out, "M ");
-            point_draw_raw_d(pt[0], out);
+            path_data_cmd(&pd, out, 'M');
+            path_data_point(&pd, out, pt[0]);
             break;
         case SEG_LINE:
-            fprintf(out, "L ");
-            point_draw_raw_d(pt[0], out);
+            path_data_cmd(&pd, out, 'L');
+            path_data_point(&pd, out, pt[0]);
             break;
         case SEG_ARC:
-            fprintf(out, "A ");
-            point_draw_raw_d(pt[0], out);
-            point_draw_raw_d(pt[1], out);
+            path_data_cmd(&pd, out, 'A');
+            path_data_point(&pd, out, pt[0]);
+            path_data_point(&pd, out, pt[1]);
             break;
         case SEG_BEZIER:
-            fprintf(out, "C ");
-            point_draw_raw_d(pt[0], out);
-            point_draw_raw_d(pt[1], out);
-            point_draw_raw_d(pt[2], out);
+            path_data_cmd(&pd, out, 'C');
+            path_data_point(&pd, out, pt[0]);
+            path_data_point(&pd, out, pt[1]);
+            path_data_point(&pd, out, pt[2]);
             break;
         }
         tmp = tmp->next;
@@ -1875,10 +2126,29 @@ void add_new_seg(PATH **path, uint8_t type) {
     }
 }
 
-void clipset_draw(drawingStates *states, FILE *out) {
+// Must be called before an element start tag.
+// Consecutive elements sharing the same clipping region are put inside
+// a single <g clip-path="..."> group, the group is only switched when
+// the clipping region changes.
+void clipset_draw(drawingStates *states, svgWriter *out) {
+    if (states->inPath)
+        return;
     int clipID = states->currentDeviceContext.clipID;
-    if (clipID)
-        fprintf(out, " clip-path=\"url(#clip-%d)\" ", clipID);
+    if (clipID == states->clipGroupID)
+        return;
+    clip_group_close(states, out);
+    if (clipID) {
+        emfClipLibrary *clip = states->currentDeviceContext.clipEntry;
+        if (clip != NULL && !clip->drawn)
+            clip_library_draw(states, out, clip);
+        svg_append_literal(out, "<");
+        svg_append_string(out, states->nameSpaceString);
+        svg_append_literal(out, "g clip-path=\"url(#clip-");
+        svg_append_int(out, clipID);
+        svg_append_literal(out, ")\">\n");
+        states->clipGroupID = clipID;
+        tiles_mark(states, out);
+    }
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,130 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DARWIN
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "emf2svg_writer.h"
+#include <stdarg.h>
+#include <stdlib.h>
+
+bool svg_writer_init(svgWriter *w, FILE *file, svgWriterCallback callback,
+                     void *ctx) {
+    w->len = 0;
+    w->size = SVG_WRITER_CHUNK;
+    w->file = file;
+    w->callback = callback;
+    w->ctx = ctx;
+    w->gzip = NULL;
+    w->written = 0;
+    w->allocations = 1;
+    w->buf = (char *)malloc(w->size);
+    w->error = w->buf == NULL;
+    if (w->error)
+        w->size = 0;
+    return !w->error;
+}
+
+// write the buffer to the FILE or the callback (nothing to do in memory)
+bool svg_writer_flush(svgWriter *w) {
+    if (w->len == 0 || (w->file == NULL && w->callback == NULL))
+        return !w->error;
+    size_t written;
+    if (w->file)
+        written = fwrite(w->buf, 1, w->len, w->file);
+    else
+        written = w->callback(w->buf, w->len, w->ctx);
+    if (written != w->len)
+        w->error = true;
+    w->written += w->len;
+    w->len = 0;
+    return !w->error;
+}
+
+// flush the buffer and end the output (the gzip stream if any)
+bool svg_writer_close(svgWriter *w) {
+    if (!svg_writer_flush(w))
+        return false;
+    if (w->gzip)
+        return svg_gzip_finish(w);
+    return true;
+}
+
+// make room for n more bytes, flushing the buffer first if possible
+bool svg_writer_grow(svgWriter *w, size_t n) {
+    if (w->error)
+        return false;
+    if (w->file || w->callback) {
+        if (!svg_writer_flush(w))
+            return false;
+        if (w->size >= n)
+            return true;
+    }
+    // a zeroed svgWriter is an empty memory writer, start small
+    size_t size = w->size ? w->size : 256;
+    while (size - w->len < n) {
+        if (size > SIZE_MAX / 2) {
+            w->error = true;
+            return false;
+        }
+        size *= 2;
+    }
+    char *buf = (char *)realloc(w->buf, size);
+    if (buf == NULL) {
+        w->error = true;
+        return false;
+    }
+    w->buf = buf;
+    w->size = size;
+    w->allocations++;
+    return true;
+}
+
+void svg_writer_free(svgWriter *w) {
+    if (w->gzip) {
+        svg_gzip_free(w->gzip);
+        w->gzip = NULL;
+    }
+    free(w->buf);
+    w->buf = NULL;
+    w->len = 0;
+    w->size = 0;
+}
+
+void svg_vprintf(svgWriter *w, const char *fmt, va_list ap) {
+    va_list aq;
+    if (w->error)
+        return;
+    size_t room = w->size - w->len;
+    va_copy(aq, ap);
+    int n = vsnprintf(room ? w->buf + w->len : NULL, room, fmt, aq);
+    va_end(aq);
+    if (n < 0) {
+        w->error = true;
+        return;
+    }
+    if ((size_t)n >= room) {
+        if (!svg_writer_grow(w, (size_t)n + 1))
+            return;
+        vsnprintf(w->buf + w->len, w->size - w->len, fmt, ap);
+    }
+    w->len += n;
+}
+
+void svg_printf(svgWriter *w, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    svg_vprintf(w, fmt, ap);
+    va_end(ap);
+}
+
+void svg_append_number_slow(svgWriter *w, double v) {
+    svg_printf(w, "%.4f", v);
+}
+
+#ifdef __cplusplus
+}
+#endif
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
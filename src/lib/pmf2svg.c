@@ -40,7 +40,7 @@ extern "C" {
    this function is not visible in the API.  Print "data" for one of the many
    records that has none.
    */
-int U_PMR_NODATAREC_draw(const char *contents, FILE *out,
+int U_PMR_NODATAREC_draw(const char *contents, svgWriter *out,
                          drawingStates *states) {
     return (1);
 }
@@ -50,7 +50,7 @@ int U_PMR_NODATAREC_draw(const char *contents, FILE *out,
    functions that draw points.
    */
 void U_PMF_VARPOINTS_draw(const char **contents, int Flags, uint32_t Elements,
-                          FILE *out, drawingStates *states) {
+                          svgWriter *out, drawingStates *states) {
     return;
 }
 
@@ -58,8 +58,8 @@ void U_PMF_VARPOINTS_draw(const char **contents, int Flags, uint32_t Elements,
    this function is not visible in the API.  Common routine used by many
    functions that draw points.
    */
-void U_PMF_VARPOINTF_S_draw(U_PMF_POINTF *Points, uint32_t Elements, FILE *out,
-                            drawingStates *states) {
+void U_PMF_VARPOINTF_S_draw(U_PMF_POINTF *Points, uint32_t Elements,
+                            svgWriter *out, drawingStates *states) {
     return;
 }
 
@@ -67,7 +67,7 @@ void U_PMF_VARPOINTF_S_draw(U_PMF_POINTF *Points, uint32_t Elements, FILE *out,
    this function is not visible in the API.  Common routine used by many
    functions that draw rectangles.
    */
-int U_PMF_VARRECTF_S_draw(U_PMF_RECTF *Rects, uint32_t Elements, FILE *out,
+int U_PMF_VARRECTF_S_draw(U_PMF_RECTF *Rects, uint32_t Elements, svgWriter *out,
                           drawingStates *states) {
     return (1);
 }
@@ -76,7 +76,7 @@ int U_PMF_VARRECTF_S_draw(U_PMF_RECTF *Rects, uint32_t Elements, FILE *out,
    this function is not visible in the API.  Common routine used by many
    functions.
    */
-int U_PMF_VARBRUSHID_draw(int btype, uint32_t BrushID, FILE *out,
+int U_PMF_VARBRUSHID_draw(int btype, uint32_t BrushID, svgWriter *out,
                           drawingStates *states) {
     return (1);
 }
@@ -92,7 +92,7 @@ int U_PMF_VARBRUSHID_draw(int btype, uint32_t BrushID, FILE *out,
   \param off        Offset from the beginning of the EMF+ file.
   */
 int U_pmf_onerec_draw(const char *contents, const char *blimit, int recnum,
-                      int off, FILE *out, drawingStates *states) {
+                      int off, svgWriter *out, drawingStates *states) {
     int status;
     static U_OBJ_ACCUM ObjCont = {
         NULL, 0, 0, 0,
@@ -309,8 +309,8 @@ int U_pmf_onerec_draw(const char *contents, const char *blimit, int recnum,
   \param  off        Offset in file to the start of this EMF+ record.
   common structure present at the beginning of all(*) EMF+ records
   */
-int U_PMF_CMN_HDR_draw(U_PMF_CMN_HDR Header, int precnum, int off, FILE *out,
-                       drawingStates *states) {
+int U_PMF_CMN_HDR_draw(U_PMF_CMN_HDR Header, int precnum, int off,
+                       svgWriter *out, drawingStates *states) {
     return ((int)Header.Size);
 }
 
@@ -323,7 +323,7 @@ int U_PMF_CMN_HDR_draw(U_PMF_CMN_HDR Header, int precnum, int off, FILE *out,
   \param  End        Text to follow array data
   */
 int U_PMF_UINT8_ARRAY_draw(const char *Start, const uint8_t *Array,
-                           int Elements, char *End, FILE *out,
+                           int Elements, char *End, svgWriter *out,
                            drawingStates *states) {
     return (1);
 }
@@ -334,7 +334,7 @@ int U_PMF_UINT8_ARRAY_draw(const char *Start, const uint8_t *Array,
   \param otype    Value to print.
   EMF+ manual 2.1.1.3, Microsoft name: BrushType Enumeration
   */
-int U_PMF_BRUSHTYPEENUMERATION_draw(int otype, FILE *out,
+int U_PMF_BRUSHTYPEENUMERATION_draw(int otype, svgWriter *out,
                                     drawingStates *states) {
     int status = 1;
     return (status);
@@ -346,7 +346,7 @@ int U_PMF_BRUSHTYPEENUMERATION_draw(int otype, FILE *out,
   \param otype    Value to print.
   EMF+ manual 2.1.1.4, Microsoft name: BrushType Enumeration
   */
-int U_PMF_COMBINEMODEENUMERATION_draw(int otype, FILE *out,
+int U_PMF_COMBINEMODEENUMERATION_draw(int otype, svgWriter *out,
                                       drawingStates *states) {
     int status = 1;
     return (status);
@@ -358,7 +358,7 @@ int U_PMF_COMBINEMODEENUMERATION_draw(int otype, FILE *out,
   \param hstype    Value to print.
   EMF+ manual 2.1.1.13, Microsoft name: HatchStyle Enumeration
   */
-int U_PMF_HATCHSTYLEENUMERATION_draw(int hstype, FILE *out,
+int U_PMF_HATCHSTYLEENUMERATION_draw(int hstype, svgWriter *out,
                                      drawingStates *states) {
     int status = 1;
     return (status);
@@ -370,7 +370,7 @@ int U_PMF_HATCHSTYLEENUMERATION_draw(int hstype, FILE *out,
   \param otype    Value to print.
   EMF+ manual 2.1.1.22, Microsoft name: ObjectType Enumeration
   */
-int U_PMF_OBJECTTYPEENUMERATION_draw(int otype, FILE *out,
+int U_PMF_OBJECTTYPEENUMERATION_draw(int otype, svgWriter *out,
                                      drawingStates *states) {
     int status = 1;
     return (status);
@@ -382,7 +382,8 @@ int U_PMF_OBJECTTYPEENUMERATION_draw(int otype, FILE *out,
   \param  Type   Value to print
   EMF+ manual 2.1.1.23, Microsoft name: PathPointType Enumeration
   */
-int U_PMF_PATHPOINTTYPE_ENUM_draw(int Type, FILE *out, drawingStates *states) {
+int U_PMF_PATHPOINTTYPE_ENUM_draw(int Type, svgWriter *out,
+                                  drawingStates *states) {
     return (1);
 }
 
@@ -392,7 +393,7 @@ int U_PMF_PATHPOINTTYPE_ENUM_draw(int Type, FILE *out, drawingStates *states) {
   \param  pfe   A PixelFormat Enumeration value
   EMF+ manual 2.1.1.25, Microsoft name: PixelFormat Enumeration (U_PF_*)
   */
-int U_PMF_PX_FMT_ENUM_draw(int pfe, FILE *out, drawingStates *states) {
+int U_PMF_PX_FMT_ENUM_draw(int pfe, svgWriter *out, drawingStates *states) {
     return (1);
 }
 
@@ -403,7 +404,7 @@ int U_PMF_PX_FMT_ENUM_draw(int pfe, FILE *out, drawingStates *states) {
   EMF+ manual 2.1.1.27, Microsoft name: RegionNodeDataType Enumeration
   (U_RNDT_*)
   */
-int U_PMF_NODETYPE_draw(int Type, FILE *out, drawingStates *states) {
+int U_PMF_NODETYPE_draw(int Type, svgWriter *out, drawingStates *states) {
     return (1);
 }
 
@@ -413,7 +414,8 @@ int U_PMF_NODETYPE_draw(int Type, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.2.1.1, Microsoft name: EmfPlusBrush Object
   */
-int U_PMF_BRUSH_draw(const char *contents, FILE *out, drawingStates *states) {
+int U_PMF_BRUSH_draw(const char *contents, svgWriter *out,
+                     drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -425,8 +427,8 @@ int U_PMF_BRUSH_draw(const char *contents, FILE *out, drawingStates *states) {
   \param  Which      A string which is either "Start" or "End".
   EMF+ manual 2.2.1.2, Microsoft name: EmfPlusCustomLineCap Object
   */
-int U_PMF_CUSTOMLINECAP_draw(const char *contents, const char *Which, FILE *out,
-                             drawingStates *states) {
+int U_PMF_CUSTOMLINECAP_draw(const char *contents, const char *Which,
+                             svgWriter *out, drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -437,7 +439,8 @@ int U_PMF_CUSTOMLINECAP_draw(const char *contents, const char *Which, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.1.3, Microsoft name: EmfPlusFont Object
   */
-int U_PMF_FONT_draw(const char *contents, FILE *out, drawingStates *states) {
+int U_PMF_FONT_draw(const char *contents, svgWriter *out,
+                    drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -448,7 +451,8 @@ int U_PMF_FONT_draw(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.2.1.4, Microsoft name: EmfPlusImage Object
   */
-int U_PMF_IMAGE_draw(const char *contents, FILE *out, drawingStates *states) {
+int U_PMF_IMAGE_draw(const char *contents, svgWriter *out,
+                     drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -459,7 +463,7 @@ int U_PMF_IMAGE_draw(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.2.1.5, Microsoft name: EmfPlusImageAttributes Object
   */
-int U_PMF_IMAGEATTRIBUTES_draw(const char *contents, FILE *out,
+int U_PMF_IMAGEATTRIBUTES_draw(const char *contents, svgWriter *out,
                                drawingStates *states) {
     int status = 1;
     return (status);
@@ -471,7 +475,8 @@ int U_PMF_IMAGEATTRIBUTES_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.1.6, Microsoft name: EmfPlusPath Object
   */
-int U_PMF_PATH_draw(const char *contents, FILE *out, drawingStates *states) {
+int U_PMF_PATH_draw(const char *contents, svgWriter *out,
+                    drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -482,7 +487,8 @@ int U_PMF_PATH_draw(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.2.1.7, Microsoft name: EmfPlusPen Object
   */
-int U_PMF_PEN_draw(const char *contents, FILE *out, drawingStates *states) {
+int U_PMF_PEN_draw(const char *contents, svgWriter *out,
+                   drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -493,7 +499,8 @@ int U_PMF_PEN_draw(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.2.1.8, Microsoft name: EmfPlusRegion Object
   */
-int U_PMF_REGION_draw(const char *contents, FILE *out, drawingStates *states) {
+int U_PMF_REGION_draw(const char *contents, svgWriter *out,
+                      drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -504,7 +511,7 @@ int U_PMF_REGION_draw(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.2.1.9, Microsoft name: EmfPlusStringFormat Object
   */
-int U_PMF_STRINGFORMAT_draw(const char *contents, FILE *out,
+int U_PMF_STRINGFORMAT_draw(const char *contents, svgWriter *out,
                             drawingStates *states) {
     int status = 1;
     return (status);
@@ -516,7 +523,8 @@ int U_PMF_STRINGFORMAT_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.1, Microsoft name: EmfPlusARGB Object
   */
-int U_PMF_ARGB_draw(const char *contents, FILE *out, drawingStates *states) {
+int U_PMF_ARGB_draw(const char *contents, svgWriter *out,
+                    drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -527,7 +535,8 @@ int U_PMF_ARGB_draw(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.2, Microsoft name: EmfPlusBitmap Object
   */
-int U_PMF_BITMAP_draw(const char *contents, FILE *out, drawingStates *states) {
+int U_PMF_BITMAP_draw(const char *contents, svgWriter *out,
+                      drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -538,7 +547,7 @@ int U_PMF_BITMAP_draw(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.3, Microsoft name: EmfPlusBitmapData Object
   */
-int U_PMF_BITMAPDATA_draw(const char *contents, FILE *out,
+int U_PMF_BITMAPDATA_draw(const char *contents, svgWriter *out,
                           drawingStates *states) {
     int status = 1;
     return (status);
@@ -550,7 +559,7 @@ int U_PMF_BITMAPDATA_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.4, Microsoft name: EmfPlusBlendColors Object
   */
-int U_PMF_BLENDCOLORS_draw(const char *contents, FILE *out,
+int U_PMF_BLENDCOLORS_draw(const char *contents, svgWriter *out,
                            drawingStates *states) {
     int status = 1;
     return (status);
@@ -563,8 +572,8 @@ int U_PMF_BLENDCOLORS_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.5, Microsoft name: EmfPlusBlendFactors Object
   */
-int U_PMF_BLENDFACTORS_draw(const char *contents, const char *type, FILE *out,
-                            drawingStates *states) {
+int U_PMF_BLENDFACTORS_draw(const char *contents, const char *type,
+                            svgWriter *out, drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -575,7 +584,7 @@ int U_PMF_BLENDFACTORS_draw(const char *contents, const char *type, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.6, Microsoft name: EmfPlusBoundaryPathData Object
   */
-int U_PMF_BOUNDARYPATHDATA_draw(const char *contents, FILE *out,
+int U_PMF_BOUNDARYPATHDATA_draw(const char *contents, svgWriter *out,
                                 drawingStates *states) {
     int status = 1;
     return (status);
@@ -587,7 +596,7 @@ int U_PMF_BOUNDARYPATHDATA_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.7, Microsoft name: EmfPlusBoundaryPointData Object
   */
-int U_PMF_BOUNDARYPOINTDATA_draw(const char *contents, FILE *out,
+int U_PMF_BOUNDARYPOINTDATA_draw(const char *contents, svgWriter *out,
                                  drawingStates *states) {
     int status = 1;
     return (status);
@@ -599,7 +608,7 @@ int U_PMF_BOUNDARYPOINTDATA_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.8, Microsoft name: EmfPlusCharacterRange Object
   */
-int U_PMF_CHARACTERRANGE_draw(const char *contents, FILE *out,
+int U_PMF_CHARACTERRANGE_draw(const char *contents, svgWriter *out,
                               drawingStates *states) {
     int status = 1;
     return (status);
@@ -611,7 +620,7 @@ int U_PMF_CHARACTERRANGE_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.9, Microsoft name: EmfPlusCompoundLineData Object
   */
-int U_PMF_COMPOUNDLINEDATA_draw(const char *contents, FILE *out,
+int U_PMF_COMPOUNDLINEDATA_draw(const char *contents, svgWriter *out,
                                 drawingStates *states) {
     int status = 1;
     return (status);
@@ -626,7 +635,7 @@ int U_PMF_COMPOUNDLINEDATA_draw(const char *contents, FILE *out,
   This function does not do anything useful, but it is included so that all
   objects have a corresponding _get().
   */
-int U_PMF_COMPRESSEDIMAGE_draw(const char *contents, FILE *out,
+int U_PMF_COMPRESSEDIMAGE_draw(const char *contents, svgWriter *out,
                                drawingStates *states) {
     int status = 1;
     return (status);
@@ -638,7 +647,7 @@ int U_PMF_COMPRESSEDIMAGE_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.11, Microsoft name: EmfPlusCustomEndCapData Object
   */
-int U_PMF_CUSTOMENDCAPDATA_draw(const char *contents, FILE *out,
+int U_PMF_CUSTOMENDCAPDATA_draw(const char *contents, svgWriter *out,
                                 drawingStates *states) {
     int status = 1;
     return (status);
@@ -650,7 +659,7 @@ int U_PMF_CUSTOMENDCAPDATA_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.12, Microsoft name: EmfPlusCustomLineCapArrowData Object
   */
-int U_PMF_CUSTOMLINECAPARROWDATA_draw(const char *contents, FILE *out,
+int U_PMF_CUSTOMLINECAPARROWDATA_draw(const char *contents, svgWriter *out,
                                       drawingStates *states) {
     int status = 1;
     return (status);
@@ -662,7 +671,7 @@ int U_PMF_CUSTOMLINECAPARROWDATA_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.13, Microsoft name: EmfPlusCustomLineCapData Object
   */
-int U_PMF_CUSTOMLINECAPDATA_draw(const char *contents, FILE *out,
+int U_PMF_CUSTOMLINECAPDATA_draw(const char *contents, svgWriter *out,
                                  drawingStates *states) {
     int status = 1;
     return (status);
@@ -677,7 +686,8 @@ int U_PMF_CUSTOMLINECAPDATA_draw(const char *contents, FILE *out,
   EMF+ manual 2.2.2.14, Microsoft name: EmfPlusCustomLineCapOptionalData Object
   */
 int U_PMF_CUSTOMLINECAPOPTIONALDATA_draw(const char *contents, uint32_t Flags,
-                                         FILE *out, drawingStates *states) {
+                                         svgWriter *out,
+                                         drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -688,7 +698,7 @@ int U_PMF_CUSTOMLINECAPOPTIONALDATA_draw(const char *contents, uint32_t Flags,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.15, Microsoft name: EmfPlusCustomStartCapData Object
   */
-int U_PMF_CUSTOMSTARTCAPDATA_draw(const char *contents, FILE *out,
+int U_PMF_CUSTOMSTARTCAPDATA_draw(const char *contents, svgWriter *out,
                                   drawingStates *states) {
     int status = 1;
     return (status);
@@ -700,7 +710,7 @@ int U_PMF_CUSTOMSTARTCAPDATA_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.16, Microsoft name: EmfPlusDashedLineData Object
   */
-int U_PMF_DASHEDLINEDATA_draw(const char *contents, FILE *out,
+int U_PMF_DASHEDLINEDATA_draw(const char *contents, svgWriter *out,
                               drawingStates *states) {
     int status = 1;
     return (status);
@@ -712,7 +722,7 @@ int U_PMF_DASHEDLINEDATA_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.17, Microsoft name: EmfPlusFillPath Object
   */
-int U_PMF_FILLPATHOBJ_draw(const char *contents, FILE *out,
+int U_PMF_FILLPATHOBJ_draw(const char *contents, svgWriter *out,
                            drawingStates *states) {
     int status = 1;
     return (status);
@@ -724,7 +734,7 @@ int U_PMF_FILLPATHOBJ_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.18, Microsoft name: EmfPlusFocusScaleData Object
   */
-int U_PMF_FOCUSSCALEDATA_draw(const char *contents, FILE *out,
+int U_PMF_FOCUSSCALEDATA_draw(const char *contents, svgWriter *out,
                               drawingStates *states) {
     int status = 1;
     return (status);
@@ -736,7 +746,7 @@ int U_PMF_FOCUSSCALEDATA_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.19, Microsoft name: EmfPlusGraphicsVersion Object
   */
-int U_PMF_GRAPHICSVERSION_draw(const char *contents, FILE *out,
+int U_PMF_GRAPHICSVERSION_draw(const char *contents, svgWriter *out,
                                drawingStates *states) {
     int status = 1;
     return (status);
@@ -748,7 +758,7 @@ int U_PMF_GRAPHICSVERSION_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.20, Microsoft name: EmfPlusHatchBrushData Object
   */
-int U_PMF_HATCHBRUSHDATA_draw(const char *contents, FILE *out,
+int U_PMF_HATCHBRUSHDATA_draw(const char *contents, svgWriter *out,
                               drawingStates *states) {
     int status = 1;
     return (status);
@@ -760,7 +770,7 @@ int U_PMF_HATCHBRUSHDATA_draw(const char *contents, FILE *out,
   \param  LId   Record from which to print data
   EMF+ manual 2.2.2.23, Microsoft name: EmfPlusLanguageIdentifier Object
   */
-int U_PMF_LANGUAGEIDENTIFIER_draw(U_PMF_LANGUAGEIDENTIFIER LId, FILE *out,
+int U_PMF_LANGUAGEIDENTIFIER_draw(U_PMF_LANGUAGEIDENTIFIER LId, svgWriter *out,
                                   drawingStates *states) {
     int status = 1;
     return (status);
@@ -772,7 +782,7 @@ int U_PMF_LANGUAGEIDENTIFIER_draw(U_PMF_LANGUAGEIDENTIFIER LId, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.24, Microsoft name: EmfPlusLinearGradientBrushData Object
   */
-int U_PMF_LINEARGRADIENTBRUSHDATA_draw(const char *contents, FILE *out,
+int U_PMF_LINEARGRADIENTBRUSHDATA_draw(const char *contents, svgWriter *out,
                                        drawingStates *states) {
     int status = 1;
     return (status);
@@ -787,7 +797,7 @@ int U_PMF_LINEARGRADIENTBRUSHDATA_draw(const char *contents, FILE *out,
   Object
   */
 int U_PMF_LINEARGRADIENTBRUSHOPTIONALDATA_draw(const char *contents, int BDFlag,
-                                               FILE *out,
+                                               svgWriter *out,
                                                drawingStates *states) {
     int status = 1;
     return (status);
@@ -799,7 +809,7 @@ int U_PMF_LINEARGRADIENTBRUSHOPTIONALDATA_draw(const char *contents, int BDFlag,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.26, Microsoft name: EmfPlusLinePath Object
   */
-int U_PMF_LINEPATH_draw(const char *contents, FILE *out,
+int U_PMF_LINEPATH_draw(const char *contents, svgWriter *out,
                         drawingStates *states) {
     int status = 1;
     return (status);
@@ -811,7 +821,7 @@ int U_PMF_LINEPATH_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.27, Microsoft name: EmfPlusMetafile Object
   */
-int U_PMF_METAFILE_draw(const char *contents, FILE *out,
+int U_PMF_METAFILE_draw(const char *contents, svgWriter *out,
                         drawingStates *states) {
     int status = 1;
     return (status);
@@ -823,7 +833,8 @@ int U_PMF_METAFILE_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.28, Microsoft name: EmfPlusPalette Object
   */
-int U_PMF_PALETTE_draw(const char *contents, FILE *out, drawingStates *states) {
+int U_PMF_PALETTE_draw(const char *contents, svgWriter *out,
+                       drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -834,7 +845,7 @@ int U_PMF_PALETTE_draw(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.29, Microsoft name: EmfPlusPathGradientBrushData Object
   */
-int U_PMF_PATHGRADIENTBRUSHDATA_draw(const char *contents, FILE *out,
+int U_PMF_PATHGRADIENTBRUSHDATA_draw(const char *contents, svgWriter *out,
                                      drawingStates *states) {
     int status = 1;
     return (status);
@@ -849,7 +860,8 @@ int U_PMF_PATHGRADIENTBRUSHDATA_draw(const char *contents, FILE *out,
   Object
   */
 int U_PMF_PATHGRADIENTBRUSHOPTIONALDATA_draw(const char *contents, int BDFlag,
-                                             FILE *out, drawingStates *states) {
+                                             svgWriter *out,
+                                             drawingStates *states) {
     return (1);
 }
 
@@ -859,7 +871,7 @@ int U_PMF_PATHGRADIENTBRUSHOPTIONALDATA_draw(const char *contents, int BDFlag,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.31, Microsoft name: EmfPlusPathPointType Object
   */
-int U_PMF_PATHPOINTTYPE_draw(const char *contents, FILE *out,
+int U_PMF_PATHPOINTTYPE_draw(const char *contents, svgWriter *out,
                              drawingStates *states) {
     int status = 1;
     return (status);
@@ -871,7 +883,7 @@ int U_PMF_PATHPOINTTYPE_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.32, Microsoft name: EmfPlusPathPointTypeRLE Object
   */
-int U_PMF_PATHPOINTTYPERLE_draw(const char *contents, FILE *out,
+int U_PMF_PATHPOINTTYPERLE_draw(const char *contents, svgWriter *out,
                                 drawingStates *states) {
     int status = 1;
     return (status);
@@ -883,7 +895,8 @@ int U_PMF_PATHPOINTTYPERLE_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.33, Microsoft name: EmfPlusPenData Object
   */
-int U_PMF_PENDATA_draw(const char *contents, FILE *out, drawingStates *states) {
+int U_PMF_PENDATA_draw(const char *contents, svgWriter *out,
+                       drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -897,7 +910,7 @@ int U_PMF_PENDATA_draw(const char *contents, FILE *out, drawingStates *states) {
 
   EMF+ manual 2.2.2.34, Microsoft name: EmfPlusPenOptionalData Object
   */
-int U_PMF_PENOPTIONALDATA_draw(const char *contents, int Flags, FILE *out,
+int U_PMF_PENOPTIONALDATA_draw(const char *contents, int Flags, svgWriter *out,
                                drawingStates *states) {
     int status = 1;
     return (status);
@@ -908,7 +921,8 @@ int U_PMF_PENOPTIONALDATA_draw(const char *contents, int Flags, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.35, Microsoft name: EmfPlusPoint Object
   */
-int U_PMF_POINT_draw(const char **contents, FILE *out, drawingStates *states) {
+int U_PMF_POINT_draw(const char **contents, svgWriter *out,
+                     drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -919,7 +933,8 @@ int U_PMF_POINT_draw(const char **contents, FILE *out, drawingStates *states) {
   \param  Point   U_PMF_POINT Structure to print
   EMF+ manual 2.2.2.35, Microsoft name: EmfPlusPoint Object
   */
-int U_PMF_POINT_S_draw(U_PMF_POINT *Point, FILE *out, drawingStates *states) {
+int U_PMF_POINT_S_draw(U_PMF_POINT *Point, svgWriter *out,
+                       drawingStates *states) {
     return (1);
 }
 
@@ -929,7 +944,8 @@ int U_PMF_POINT_S_draw(U_PMF_POINT *Point, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.36, Microsoft name: EmfPlusPointF Object
   */
-int U_PMF_POINTF_draw(const char **contents, FILE *out, drawingStates *states) {
+int U_PMF_POINTF_draw(const char **contents, svgWriter *out,
+                      drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -940,7 +956,8 @@ int U_PMF_POINTF_draw(const char **contents, FILE *out, drawingStates *states) {
   \param  Point   U_PMF_POINTF Structure to print
   EMF+ manual 2.2.2.36, Microsoft name: EmfPlusPointF Object
   */
-int U_PMF_POINTF_S_draw(U_PMF_POINTF *Point, FILE *out, drawingStates *states) {
+int U_PMF_POINTF_S_draw(U_PMF_POINTF *Point, svgWriter *out,
+                        drawingStates *states) {
     return (1);
 }
 
@@ -958,7 +975,7 @@ int U_PMF_POINTF_S_draw(U_PMF_POINTF *Point, FILE *out, drawingStates *states) {
   EMF+ manual 2.2.2.37, Microsoft name: EmfPlusPointR Object
   */
 int U_PMF_POINTR_draw(const char **contents, U_FLOAT *Xpos, U_FLOAT *Ypos,
-                      FILE *out, drawingStates *states) {
+                      svgWriter *out, drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -969,7 +986,8 @@ int U_PMF_POINTR_draw(const char **contents, U_FLOAT *Xpos, U_FLOAT *Ypos,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.38, Microsoft name: EmfPlusRect Object
   */
-int U_PMF_RECT_draw(const char **contents, FILE *out, drawingStates *states) {
+int U_PMF_RECT_draw(const char **contents, svgWriter *out,
+                    drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -980,7 +998,7 @@ int U_PMF_RECT_draw(const char **contents, FILE *out, drawingStates *states) {
   \param  Rect   U_PMF_RECT structure
   EMF+ manual 2.2.2.39, Microsoft name: EmfPlusRectF Object
   */
-int U_PMF_RECT_S_draw(U_PMF_RECT *Rect, FILE *out, drawingStates *states) {
+int U_PMF_RECT_S_draw(U_PMF_RECT *Rect, svgWriter *out, drawingStates *states) {
     return (1);
 }
 
@@ -990,7 +1008,8 @@ int U_PMF_RECT_S_draw(U_PMF_RECT *Rect, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.39, Microsoft name: EmfPlusRectF Object
   */
-int U_PMF_RECTF_draw(const char **contents, FILE *out, drawingStates *states) {
+int U_PMF_RECTF_draw(const char **contents, svgWriter *out,
+                     drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -1001,7 +1020,8 @@ int U_PMF_RECTF_draw(const char **contents, FILE *out, drawingStates *states) {
   \param  Rect   U_PMF_RECTF Structure
   EMF+ manual 2.2.2.39, Microsoft name: EmfPlusRectF Object
   */
-int U_PMF_RECTF_S_draw(U_PMF_RECTF *Rect, FILE *out, drawingStates *states) {
+int U_PMF_RECTF_S_draw(U_PMF_RECTF *Rect, svgWriter *out,
+                       drawingStates *states) {
     return (1);
 }
 
@@ -1013,7 +1033,7 @@ int U_PMF_RECTF_S_draw(U_PMF_RECTF *Rect, FILE *out, drawingStates *states) {
   many levels. 1 is the top, >1 are child nodes.
   EMF+ manual 2.2.2.40, Microsoft name: EmfPlusRegionNode Object
   */
-int U_PMF_REGIONNODE_draw(const char *contents, int Level, FILE *out,
+int U_PMF_REGIONNODE_draw(const char *contents, int Level, svgWriter *out,
                           drawingStates *states) {
     int status = 1;
     return (status);
@@ -1027,8 +1047,8 @@ int U_PMF_REGIONNODE_draw(const char *contents, int Level, FILE *out,
   many levels. 1 is the top, >1 are child nodes.
   EMF+ manual 2.2.2.41, Microsoft name: EmfPlusRegionNodeChildNodes Object
   */
-int U_PMF_REGIONNODECHILDNODES_draw(const char *contents, int Level, FILE *out,
-                                    drawingStates *states) {
+int U_PMF_REGIONNODECHILDNODES_draw(const char *contents, int Level,
+                                    svgWriter *out, drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -1039,7 +1059,7 @@ int U_PMF_REGIONNODECHILDNODES_draw(const char *contents, int Level, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.42, Microsoft name: EmfPlusRegionNodePath Object
   */
-int U_PMF_REGIONNODEPATH_draw(const char *contents, FILE *out,
+int U_PMF_REGIONNODEPATH_draw(const char *contents, svgWriter *out,
                               drawingStates *states) {
     int status = 1;
     return (status);
@@ -1051,7 +1071,7 @@ int U_PMF_REGIONNODEPATH_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.43, Microsoft name: EmfPlusSolidBrushData Object
   */
-int U_PMF_SOLIDBRUSHDATA_draw(const char *contents, FILE *out,
+int U_PMF_SOLIDBRUSHDATA_draw(const char *contents, svgWriter *out,
                               drawingStates *states) {
     int status = 1;
     return (status);
@@ -1066,7 +1086,7 @@ int U_PMF_SOLIDBRUSHDATA_draw(const char *contents, FILE *out,
   EMF+ manual 2.2.2.44, Microsoft name: EmfPlusStringFormatData Object
   */
 int U_PMF_STRINGFORMATDATA_draw(const char *contents, uint32_t TabStopCount,
-                                uint32_t RangeCount, FILE *out,
+                                uint32_t RangeCount, svgWriter *out,
                                 drawingStates *states) {
     int status = 1;
     return (status);
@@ -1078,7 +1098,7 @@ int U_PMF_STRINGFORMATDATA_draw(const char *contents, uint32_t TabStopCount,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.45, Microsoft name: EmfPlusTextureBrushData Object
   */
-int U_PMF_TEXTUREBRUSHDATA_draw(const char *contents, FILE *out,
+int U_PMF_TEXTUREBRUSHDATA_draw(const char *contents, svgWriter *out,
                                 drawingStates *states) {
     int status = 1;
     return (status);
@@ -1093,7 +1113,7 @@ int U_PMF_TEXTUREBRUSHDATA_draw(const char *contents, FILE *out,
   EMF+ manual 2.2.2.46, Microsoft name: EmfPlusTextureBrushOptionalData Object
   */
 int U_PMF_TEXTUREBRUSHOPTIONALDATA_draw(const char *contents, int HasImage,
-                                        FILE *out, drawingStates *states) {
+                                        svgWriter *out, drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -1105,7 +1125,7 @@ int U_PMF_TEXTUREBRUSHOPTIONALDATA_draw(const char *contents, int HasImage,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.47, Microsoft name: EmfPlusTransformMatrix Object
   */
-int U_PMF_TRANSFORMMATRIX_draw(const char *contents, FILE *out,
+int U_PMF_TRANSFORMMATRIX_draw(const char *contents, svgWriter *out,
                                drawingStates *states) {
     int status = 1;
     return (status);
@@ -1117,7 +1137,7 @@ int U_PMF_TRANSFORMMATRIX_draw(const char *contents, FILE *out,
   \param  Tm  U_PMF_TRANSFORMMATRIX structure
   EMF+ manual 2.2.2.47, Microsoft name: EmfPlusTransformMatrix Object
   */
-int U_PMF_TRANSFORMMATRIX2_draw(U_PMF_TRANSFORMMATRIX *Tm, FILE *out,
+int U_PMF_TRANSFORMMATRIX2_draw(U_PMF_TRANSFORMMATRIX *Tm, svgWriter *out,
                                 drawingStates *states) {
     return (1);
 }
@@ -1129,7 +1149,7 @@ int U_PMF_TRANSFORMMATRIX2_draw(U_PMF_TRANSFORMMATRIX *Tm, FILE *out,
   NOT DOCUMENTED, like EMF+ manual 2.2.2.47, Microsoft name:
   EmfPlusTransformMatrix Object, but missing offset values
   */
-int U_PMF_ROTMATRIX2_draw(U_PMF_ROTMATRIX *Rm, FILE *out,
+int U_PMF_ROTMATRIX2_draw(U_PMF_ROTMATRIX *Rm, svgWriter *out,
                           drawingStates *states) {
     return (1);
 }
@@ -1140,7 +1160,8 @@ int U_PMF_ROTMATRIX2_draw(U_PMF_ROTMATRIX *Rm, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.3.1, Microsoft name: BlurEffect Object
   */
-int U_PMF_IE_BLUR_draw(const char *contents, FILE *out, drawingStates *states) {
+int U_PMF_IE_BLUR_draw(const char *contents, svgWriter *out,
+                       drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -1151,7 +1172,7 @@ int U_PMF_IE_BLUR_draw(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.2.3.2, Microsoft name: BrightnessContrastEffect Object
   */
-int U_PMF_IE_BRIGHTNESSCONTRAST_draw(const char *contents, FILE *out,
+int U_PMF_IE_BRIGHTNESSCONTRAST_draw(const char *contents, svgWriter *out,
                                      drawingStates *states) {
     int status = 1;
     return (status);
@@ -1163,7 +1184,7 @@ int U_PMF_IE_BRIGHTNESSCONTRAST_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.3.3, Microsoft name: ColorBalanceEffect Object
   */
-int U_PMF_IE_COLORBALANCE_draw(const char *contents, FILE *out,
+int U_PMF_IE_COLORBALANCE_draw(const char *contents, svgWriter *out,
                                drawingStates *states) {
     int status = 1;
     return (status);
@@ -1175,7 +1196,7 @@ int U_PMF_IE_COLORBALANCE_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.3.4, Microsoft name: ColorCurveEffect Object
   */
-int U_PMF_IE_COLORCURVE_draw(const char *contents, FILE *out,
+int U_PMF_IE_COLORCURVE_draw(const char *contents, svgWriter *out,
                              drawingStates *states) {
     int status = 1;
     return (status);
@@ -1187,7 +1208,7 @@ int U_PMF_IE_COLORCURVE_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.3.5, Microsoft name: ColorLookupTableEffect Object
   */
-int U_PMF_IE_COLORLOOKUPTABLE_draw(const char *contents, FILE *out,
+int U_PMF_IE_COLORLOOKUPTABLE_draw(const char *contents, svgWriter *out,
                                    drawingStates *states) {
     int status = 1;
     return (status);
@@ -1199,7 +1220,7 @@ int U_PMF_IE_COLORLOOKUPTABLE_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.3.6, Microsoft name: ColorMatrixEffect Object
   */
-int U_PMF_IE_COLORMATRIX_draw(const char *contents, FILE *out,
+int U_PMF_IE_COLORMATRIX_draw(const char *contents, svgWriter *out,
                               drawingStates *states) {
     int status = 1;
     return (status);
@@ -1211,7 +1232,7 @@ int U_PMF_IE_COLORMATRIX_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.3.7, Microsoft name: HueSaturationLightnessEffect Object
   */
-int U_PMF_IE_HUESATURATIONLIGHTNESS_draw(const char *contents, FILE *out,
+int U_PMF_IE_HUESATURATIONLIGHTNESS_draw(const char *contents, svgWriter *out,
                                          drawingStates *states) {
     int status = 1;
     return (status);
@@ -1223,7 +1244,7 @@ int U_PMF_IE_HUESATURATIONLIGHTNESS_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.3.8, Microsoft name: LevelsEffect Object
   */
-int U_PMF_IE_LEVELS_draw(const char *contents, FILE *out,
+int U_PMF_IE_LEVELS_draw(const char *contents, svgWriter *out,
                          drawingStates *states) {
     int status = 1;
     return (status);
@@ -1235,7 +1256,7 @@ int U_PMF_IE_LEVELS_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.3.9, Microsoft name: RedEyeCorrectionEffect Object
   */
-int U_PMF_IE_REDEYECORRECTION_draw(const char *contents, FILE *out,
+int U_PMF_IE_REDEYECORRECTION_draw(const char *contents, svgWriter *out,
                                    drawingStates *states) {
     int status = 1;
     return (status);
@@ -1247,7 +1268,7 @@ int U_PMF_IE_REDEYECORRECTION_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.3.10, Microsoft name: SharpenEffect Object
   */
-int U_PMF_IE_SHARPEN_draw(const char *contents, FILE *out,
+int U_PMF_IE_SHARPEN_draw(const char *contents, svgWriter *out,
                           drawingStates *states) {
     int status = 1;
     return (status);
@@ -1259,7 +1280,8 @@ int U_PMF_IE_SHARPEN_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.3.11, Microsoft name: TintEffect Object
   */
-int U_PMF_IE_TINT_draw(const char *contents, FILE *out, drawingStates *states) {
+int U_PMF_IE_TINT_draw(const char *contents, svgWriter *out,
+                       drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -1277,7 +1299,7 @@ int U_PMF_IE_TINT_draw(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.3.1.1, Microsoft name: EmfPlusOffsetClip Record,  Index 0x35
   */
-int U_PMR_OFFSETCLIP_draw(const char *contents, FILE *out,
+int U_PMR_OFFSETCLIP_draw(const char *contents, svgWriter *out,
                           drawingStates *states) {
     int status = 1;
     return (status);
@@ -1289,7 +1311,7 @@ int U_PMR_OFFSETCLIP_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.1.2, Microsoft name: EmfPlusResetClip Record, Index 0x31
   */
-int U_PMR_RESETCLIP_draw(const char *contents, FILE *out,
+int U_PMR_RESETCLIP_draw(const char *contents, svgWriter *out,
                          drawingStates *states) {
     return (U_PMR_NODATAREC_draw(contents, out, states));
 }
@@ -1300,7 +1322,7 @@ int U_PMR_RESETCLIP_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.1.3, Microsoft name: EmfPlusSetClipPath Record, Index 0x33
   */
-int U_PMR_SETCLIPPATH_draw(const char *contents, FILE *out,
+int U_PMR_SETCLIPPATH_draw(const char *contents, svgWriter *out,
                            drawingStates *states) {
     int status = 1;
     return (status);
@@ -1312,7 +1334,7 @@ int U_PMR_SETCLIPPATH_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.1.4, Microsoft name: EmfPlusSetClipRect Record, Index 0x32
   */
-int U_PMR_SETCLIPRECT_draw(const char *contents, FILE *out,
+int U_PMR_SETCLIPRECT_draw(const char *contents, svgWriter *out,
                            drawingStates *states) {
     int status = 1;
     return (status);
@@ -1324,7 +1346,7 @@ int U_PMR_SETCLIPRECT_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.1.5, Microsoft name: EmfPlusSetClipRegion Record, Index 0x34
   */
-int U_PMR_SETCLIPREGION_draw(const char *contents, FILE *out,
+int U_PMR_SETCLIPREGION_draw(const char *contents, svgWriter *out,
                              drawingStates *states) {
     int status = 1;
     return (status);
@@ -1336,7 +1358,8 @@ int U_PMR_SETCLIPREGION_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.2.1, Microsoft name: EmfPlusComment Record, Index 0x03
   */
-int U_PMR_COMMENT_draw(const char *contents, FILE *out, drawingStates *states) {
+int U_PMR_COMMENT_draw(const char *contents, svgWriter *out,
+                       drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -1347,7 +1370,7 @@ int U_PMR_COMMENT_draw(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.3.3.1, Microsoft name: EmfPlusEndOfFile Record, Index 0x02
   */
-int U_PMR_ENDOFFILE_draw(const char *contents, FILE *out,
+int U_PMR_ENDOFFILE_draw(const char *contents, svgWriter *out,
                          drawingStates *states) {
     return (U_PMR_NODATAREC_draw(contents, out, states));
 }
@@ -1358,7 +1381,8 @@ int U_PMR_ENDOFFILE_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.3.2, Microsoft name: EmfPlusGetDC Record, Index 0x04
   */
-int U_PMR_GETDC_draw(const char *contents, FILE *out, drawingStates *states) {
+int U_PMR_GETDC_draw(const char *contents, svgWriter *out,
+                     drawingStates *states) {
     return (U_PMR_NODATAREC_draw(contents, out, states));
 }
 
@@ -1368,7 +1392,8 @@ int U_PMR_GETDC_draw(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.3.3.3, Microsoft name: EmfPlusHeader Record, Index 0x01
   */
-int U_PMR_HEADER_draw(const char *contents, FILE *out, drawingStates *states) {
+int U_PMR_HEADER_draw(const char *contents, svgWriter *out,
+                      drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -1379,7 +1404,8 @@ int U_PMR_HEADER_draw(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.1, Microsoft name: EmfPlusClear Record, Index 0x09
   */
-int U_PMR_CLEAR_draw(const char *contents, FILE *out, drawingStates *states) {
+int U_PMR_CLEAR_draw(const char *contents, svgWriter *out,
+                     drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -1390,7 +1416,8 @@ int U_PMR_CLEAR_draw(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.2, Microsoft name: EmfPlusDrawArc Record, Index 0x12
   */
-int U_PMR_DRAWARC_draw(const char *contents, FILE *out, drawingStates *states) {
+int U_PMR_DRAWARC_draw(const char *contents, svgWriter *out,
+                       drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -1401,7 +1428,7 @@ int U_PMR_DRAWARC_draw(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.3, Microsoft name: EmfPlusDrawBeziers Record, Index 0x19
   */
-int U_PMR_DRAWBEZIERS_draw(const char *contents, FILE *out,
+int U_PMR_DRAWBEZIERS_draw(const char *contents, svgWriter *out,
                            drawingStates *states) {
     int status = 1;
     return (status);
@@ -1419,7 +1446,7 @@ http://msdn.microsoft.com/en-us/library/4cf6we5y(v=vs.110).aspx
 
 EMF+ manual 2.3.4.4, Microsoft name: EmfPlusDrawClosedCurve Record, Index 0x17
 */
-int U_PMR_DRAWCLOSEDCURVE_draw(const char *contents, FILE *out,
+int U_PMR_DRAWCLOSEDCURVE_draw(const char *contents, svgWriter *out,
                                drawingStates *states) {
     int status = 1;
     return (status);
@@ -1438,7 +1465,7 @@ http://msdn.microsoft.com/en-us/library/4cf6we5y(v=vs.110).aspx
 
 EMF+ manual 2.3.4.5, Microsoft name: EmfPlusDrawCurve Record, Index 0x18
 */
-int U_PMR_DRAWCURVE_draw(const char *contents, FILE *out,
+int U_PMR_DRAWCURVE_draw(const char *contents, svgWriter *out,
                          drawingStates *states) {
     int status = 1;
     return (status);
@@ -1451,7 +1478,7 @@ int U_PMR_DRAWCURVE_draw(const char *contents, FILE *out,
   EMF+ manual 2.3.4.6, Microsoft name: EmfPlusDrawDriverString Record, Index
   0x36
   */
-int U_PMR_DRAWDRIVERSTRING_draw(const char *contents, FILE *out,
+int U_PMR_DRAWDRIVERSTRING_draw(const char *contents, svgWriter *out,
                                 drawingStates *states) {
     int status = 1;
     return (status);
@@ -1463,7 +1490,7 @@ int U_PMR_DRAWDRIVERSTRING_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.7, Microsoft name: EmfPlusDrawEllipse Record, Index 0x0F
   */
-int U_PMR_DRAWELLIPSE_draw(const char *contents, FILE *out,
+int U_PMR_DRAWELLIPSE_draw(const char *contents, svgWriter *out,
                            drawingStates *states) {
     int status = 1;
     return (status);
@@ -1475,7 +1502,7 @@ int U_PMR_DRAWELLIPSE_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.8, Microsoft name: EmfPlusDrawImage Record, Index 0x1A
   */
-int U_PMR_DRAWIMAGE_draw(const char *contents, FILE *out,
+int U_PMR_DRAWIMAGE_draw(const char *contents, svgWriter *out,
                          drawingStates *states) {
     int status = 1;
     return (status);
@@ -1487,7 +1514,7 @@ int U_PMR_DRAWIMAGE_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.9, Microsoft name: EmfPlusDrawImagePoints Record, Index 0x1B
   */
-int U_PMR_DRAWIMAGEPOINTS_draw(const char *contents, FILE *out,
+int U_PMR_DRAWIMAGEPOINTS_draw(const char *contents, svgWriter *out,
                                drawingStates *states) {
     int status = 1;
     return (status);
@@ -1499,7 +1526,7 @@ int U_PMR_DRAWIMAGEPOINTS_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.10, Microsoft name: EmfPlusDrawLines Record, Index 0x0D
   */
-int U_PMR_DRAWLINES_draw(const char *contents, FILE *out,
+int U_PMR_DRAWLINES_draw(const char *contents, svgWriter *out,
                          drawingStates *states) {
     int status = 1;
     return (status);
@@ -1511,7 +1538,7 @@ int U_PMR_DRAWLINES_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.11, Microsoft name: EmfPlusDrawPath Record, Index 0x15
   */
-int U_PMR_DRAWPATH_draw(const char *contents, FILE *out,
+int U_PMR_DRAWPATH_draw(const char *contents, svgWriter *out,
                         drawingStates *states) {
     int status = 1;
     return (status);
@@ -1523,7 +1550,8 @@ int U_PMR_DRAWPATH_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.12, Microsoft name: EmfPlusDrawPie Record, Index 0x0D
   */
-int U_PMR_DRAWPIE_draw(const char *contents, FILE *out, drawingStates *states) {
+int U_PMR_DRAWPIE_draw(const char *contents, svgWriter *out,
+                       drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -1535,8 +1563,8 @@ int U_PMR_DRAWPIE_draw(const char *contents, FILE *out, drawingStates *states) {
   \param blimit      One byte past the last record in memory.
   EMF+ manual 2.3.4.13, Microsoft name: EmfPlusDrawRects Record, Index 0x0B
   */
-int U_PMR_DRAWRECTS_draw(const char *contents, const char *blimit, FILE *out,
-                         drawingStates *states) {
+int U_PMR_DRAWRECTS_draw(const char *contents, const char *blimit,
+                         svgWriter *out, drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -1547,7 +1575,7 @@ int U_PMR_DRAWRECTS_draw(const char *contents, const char *blimit, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.14, Microsoft name: EmfPlusDrawString Record, Index 0x1C
   */
-int U_PMR_DRAWSTRING_draw(const char *contents, FILE *out,
+int U_PMR_DRAWSTRING_draw(const char *contents, svgWriter *out,
                           drawingStates *states) {
     int status = 1;
     return (status);
@@ -1560,7 +1588,7 @@ int U_PMR_DRAWSTRING_draw(const char *contents, FILE *out,
   EMF+ manual 2.3.4.15, Microsoft name: EmfPlusFillClosedCurve Record, Index
   0x16
   */
-int U_PMR_FILLCLOSEDCURVE_draw(const char *contents, FILE *out,
+int U_PMR_FILLCLOSEDCURVE_draw(const char *contents, svgWriter *out,
                                drawingStates *states) {
     int status = 1;
     return (status);
@@ -1572,7 +1600,7 @@ int U_PMR_FILLCLOSEDCURVE_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.16, Microsoft name: EmfPlusFillEllipse Record, Index 0x0E
   */
-int U_PMR_FILLELLIPSE_draw(const char *contents, FILE *out,
+int U_PMR_FILLELLIPSE_draw(const char *contents, svgWriter *out,
                            drawingStates *states) {
     int status = 1;
     return (status);
@@ -1584,7 +1612,7 @@ int U_PMR_FILLELLIPSE_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.17, Microsoft name: EmfPlusFillPath Record, Index 0x14
   */
-int U_PMR_FILLPATH_draw(const char *contents, FILE *out,
+int U_PMR_FILLPATH_draw(const char *contents, svgWriter *out,
                         drawingStates *states) {
     int status = 1;
     return (status);
@@ -1596,7 +1624,8 @@ int U_PMR_FILLPATH_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.18, Microsoft name: EmfPlusFillPie Record, Index 0x10
   */
-int U_PMR_FILLPIE_draw(const char *contents, FILE *out, drawingStates *states) {
+int U_PMR_FILLPIE_draw(const char *contents, svgWriter *out,
+                       drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -1607,7 +1636,7 @@ int U_PMR_FILLPIE_draw(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.19, Microsoft name: EmfPlusFillPolygon Record, Index 0x0C
   */
-int U_PMR_FILLPOLYGON_draw(const char *contents, FILE *out,
+int U_PMR_FILLPOLYGON_draw(const char *contents, svgWriter *out,
                            drawingStates *states) {
     int status = 1;
     return (status);
@@ -1620,8 +1649,8 @@ int U_PMR_FILLPOLYGON_draw(const char *contents, FILE *out,
   \param blimit      One byte past the last record in memory.
   EMF+ manual 2.3.4.20, Microsoft name: EmfPlusFillRects Record, Index 0x0A
   */
-int U_PMR_FILLRECTS_draw(const char *contents, const char *blimit, FILE *out,
-                         drawingStates *states) {
+int U_PMR_FILLRECTS_draw(const char *contents, const char *blimit,
+                         svgWriter *out, drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -1632,7 +1661,7 @@ int U_PMR_FILLRECTS_draw(const char *contents, const char *blimit, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.21, Microsoft name: EmfPlusFillRegion Record, Index 0x13
   */
-int U_PMR_FILLREGION_draw(const char *contents, FILE *out,
+int U_PMR_FILLREGION_draw(const char *contents, svgWriter *out,
                           drawingStates *states) {
     int status = 1;
     return (status);
@@ -1649,7 +1678,7 @@ int U_PMR_FILLREGION_draw(const char *contents, FILE *out,
   EMF+ manual 2.3.5.1, Microsoft name: EmfPlusObject Record, Index 0x13
   */
 int U_PMR_OBJECT_draw(const char *contents, const char *blimit,
-                      U_OBJ_ACCUM *ObjCont, int term, FILE *out,
+                      U_OBJ_ACCUM *ObjCont, int term, svgWriter *out,
                       drawingStates *states) {
     U_PMF_CMN_HDR Header;
     uint32_t ObjID;
@@ -1760,7 +1789,7 @@ int U_PMR_OBJECT_draw(const char *contents, const char *blimit,
   EMF+ manual 2.3.5.2, Microsoft name: EmfPlusSerializableObject Record, Index
   0x38
   */
-int U_PMR_SERIALIZABLEOBJECT_draw(const char *contents, FILE *out,
+int U_PMR_SERIALIZABLEOBJECT_draw(const char *contents, svgWriter *out,
                                   drawingStates *states) {
     int status = 1;
     return (status);
@@ -1773,7 +1802,7 @@ int U_PMR_SERIALIZABLEOBJECT_draw(const char *contents, FILE *out,
   EMF+ manual 2.3.6.1, Microsoft name: EmfPlusSetAntiAliasMode Record, Index
   0x1E
   */
-int U_PMR_SETANTIALIASMODE_draw(const char *contents, FILE *out,
+int U_PMR_SETANTIALIASMODE_draw(const char *contents, svgWriter *out,
                                 drawingStates *states) {
     int status = 1;
     return (status);
@@ -1786,7 +1815,7 @@ int U_PMR_SETANTIALIASMODE_draw(const char *contents, FILE *out,
   EMF+ manual 2.3.6.2, Microsoft name: EmfPlusSetCompositingMode Record, Index
   0x23
   */
-int U_PMR_SETCOMPOSITINGMODE_draw(const char *contents, FILE *out,
+int U_PMR_SETCOMPOSITINGMODE_draw(const char *contents, svgWriter *out,
                                   drawingStates *states) {
     int status = 1;
     return (status);
@@ -1799,7 +1828,7 @@ int U_PMR_SETCOMPOSITINGMODE_draw(const char *contents, FILE *out,
   EMF+ manual 2.3.6.3, Microsoft name: EmfPlusSetCompositingQuality Record,
   Index 0x24
   */
-int U_PMR_SETCOMPOSITINGQUALITY_draw(const char *contents, FILE *out,
+int U_PMR_SETCOMPOSITINGQUALITY_draw(const char *contents, svgWriter *out,
                                      drawingStates *states) {
     int status = 1;
     return (status);
@@ -1812,7 +1841,7 @@ int U_PMR_SETCOMPOSITINGQUALITY_draw(const char *contents, FILE *out,
   EMF+ manual 2.3.6.4, Microsoft name: EmfPlusSetInterpolationMode Record, Index
   0x21
   */
-int U_PMR_SETINTERPOLATIONMODE_draw(const char *contents, FILE *out,
+int U_PMR_SETINTERPOLATIONMODE_draw(const char *contents, svgWriter *out,
                                     drawingStates *states) {
     int status = 1;
     return (status);
@@ -1825,7 +1854,7 @@ int U_PMR_SETINTERPOLATIONMODE_draw(const char *contents, FILE *out,
   EMF+ manual 2.3.6.5, Microsoft name: EmfPlusSetPixelOffsetMode Record, Index
   0x22
   */
-int U_PMR_SETPIXELOFFSETMODE_draw(const char *contents, FILE *out,
+int U_PMR_SETPIXELOFFSETMODE_draw(const char *contents, svgWriter *out,
                                   drawingStates *states) {
     int status = 1;
     return (status);
@@ -1838,7 +1867,7 @@ int U_PMR_SETPIXELOFFSETMODE_draw(const char *contents, FILE *out,
   EMF+ manual 2.3.6.6, Microsoft name: EmfPlusSetRenderingOrigin Record, Index
   0x1D
   */
-int U_PMR_SETRENDERINGORIGIN_draw(const char *contents, FILE *out,
+int U_PMR_SETRENDERINGORIGIN_draw(const char *contents, svgWriter *out,
                                   drawingStates *states) {
     int status = 1;
     return (status);
@@ -1850,7 +1879,7 @@ int U_PMR_SETRENDERINGORIGIN_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.6.7, Microsoft name: EmfPlusSetTextContrast Record, Index 0x20
   */
-int U_PMR_SETTEXTCONTRAST_draw(const char *contents, FILE *out,
+int U_PMR_SETTEXTCONTRAST_draw(const char *contents, svgWriter *out,
                                drawingStates *states) {
     int status = 1;
     return (status);
@@ -1863,7 +1892,7 @@ int U_PMR_SETTEXTCONTRAST_draw(const char *contents, FILE *out,
   EMF+ manual 2.3.6.8, Microsoft name: EmfPlusSetTextRenderingHint Record, Index
   0x1F
   */
-int U_PMR_SETTEXTRENDERINGHINT_draw(const char *contents, FILE *out,
+int U_PMR_SETTEXTRENDERINGHINT_draw(const char *contents, svgWriter *out,
                                     drawingStates *states) {
     int status = 1;
     return (status);
@@ -1875,7 +1904,7 @@ int U_PMR_SETTEXTRENDERINGHINT_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.7.1, Microsoft name: EmfPlusBeginContainer Record, Index 0x27
   */
-int U_PMR_BEGINCONTAINER_draw(const char *contents, FILE *out,
+int U_PMR_BEGINCONTAINER_draw(const char *contents, svgWriter *out,
                               drawingStates *states) {
     int status = 1;
     return (status);
@@ -1888,7 +1917,7 @@ int U_PMR_BEGINCONTAINER_draw(const char *contents, FILE *out,
   EMF+ manual 2.3.7.2, Microsoft name: EmfPlusBeginContainerNoParams Record,
   Index 0x28
   */
-int U_PMR_BEGINCONTAINERNOPARAMS_draw(const char *contents, FILE *out,
+int U_PMR_BEGINCONTAINERNOPARAMS_draw(const char *contents, svgWriter *out,
                                       drawingStates *states) {
     int status = 1;
     return (status);
@@ -1900,7 +1929,7 @@ int U_PMR_BEGINCONTAINERNOPARAMS_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.7.3, Microsoft name: EmfPlusEndContainer Record, Index 0x29
   */
-int U_PMR_ENDCONTAINER_draw(const char *contents, FILE *out,
+int U_PMR_ENDCONTAINER_draw(const char *contents, svgWriter *out,
                             drawingStates *states) {
     int status = 1;
     return (status);
@@ -1912,7 +1941,8 @@ int U_PMR_ENDCONTAINER_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.7.4, Microsoft name: EmfPlusRestore Record, Index 0x26
   */
-int U_PMR_RESTORE_draw(const char *contents, FILE *out, drawingStates *states) {
+int U_PMR_RESTORE_draw(const char *contents, svgWriter *out,
+                       drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -1923,7 +1953,8 @@ int U_PMR_RESTORE_draw(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.3.7.5, Microsoft name: EmfPlusSave Record, Index 0x25
   */
-int U_PMR_SAVE_draw(const char *contents, FILE *out, drawingStates *states) {
+int U_PMR_SAVE_draw(const char *contents, svgWriter *out,
+                    drawingStates *states) {
     int status = 1;
     return (status);
 }
@@ -1934,7 +1965,7 @@ int U_PMR_SAVE_draw(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.3.8.1, Microsoft name: EmfPlusSetTSClip Record, Index 0x3A
   */
-int U_PMR_SETTSCLIP_draw(const char *contents, FILE *out,
+int U_PMR_SETTSCLIP_draw(const char *contents, svgWriter *out,
                          drawingStates *states) {
     int status = 1;
     return (status);
@@ -1946,7 +1977,7 @@ int U_PMR_SETTSCLIP_draw(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.8.2, Microsoft name: EmfPlusSetTSGraphics Record, Index 0x39
   */
-int U_PMR_SETTSGRAPHICS_draw(const char *contents, FILE *out,
+int U_PMR_SETTSGRAPHICS_draw(const char *contents, svgWriter *out,
                              drawingStates *states) {
     int status = 1;
     return (status);
@@ -1959,7 +1990,7 @@ int U_PMR_SETTSGRAPHICS_draw(const char *contents, FILE *out,
   EMF+ manual 2.3.9.1, Microsoft name: EmfPlusMultiplyWorldTransform Record,
   Index 0x2C
   */
-int U_PMR_MULTIPLYWORLDTRANSFORM_draw(const char *contents, FILE *out,
+int U_PMR_MULTIPLYWORLDTRANSFORM_draw(const char *contents, svgWriter *out,
                                       drawingStates *states) {
     int status = 1;
     return (status);
@@ -1972,7 +2003,7 @@ int U_PMR_MULTIPLYWORLDTRANSFORM_draw(const char *contents, FILE *out,
   EMF+ manual 2.3.9.2, Microsoft name: EmfPlusResetWorldTransform Record, Index
   0x2B
   */
-int U_PMR_RESETWORLDTRANSFORM_draw(const char *contents, FILE *out,
+int U_PMR_RESETWORLDTRANSFORM_draw(const char *contents, svgWriter *out,
                                    drawingStates *states) {
     return (U_PMR_NODATAREC_draw(contents, out, states));
 }
@@ -1984,7 +2015,7 @@ int U_PMR_RESETWORLDTRANSFORM_draw(const char *contents, FILE *out,
   EMF+ manual 2.3.9.3, Microsoft name: EmfPlusRotateWorldTransform Record, Index
   0x2F
   */
-int U_PMR_ROTATEWORLDTRANSFORM_draw(const char *contents, FILE *out,
+int U_PMR_ROTATEWORLDTRANSFORM_draw(const char *contents, svgWriter *out,
                                     drawingStates *states) {
     int status = 1;
     return (status);
@@ -1997,7 +2028,7 @@ int U_PMR_ROTATEWORLDTRANSFORM_draw(const char *contents, FILE *out,
   EMF+ manual 2.3.9.4, Microsoft name: EmfPlusScaleWorldTransform Record, Index
   0x2E
   */
-int U_PMR_SCALEWORLDTRANSFORM_draw(const char *contents, FILE *out,
+int U_PMR_SCALEWORLDTRANSFORM_draw(const char *contents, svgWriter *out,
                                    drawingStates *states) {
     int status = 1;
     return (status);
@@ -2010,7 +2041,7 @@ int U_PMR_SCALEWORLDTRANSFORM_draw(const char *contents, FILE *out,
   EMF+ manual 2.3.9.5, Microsoft name: EmfPlusSetPageTransform Record, Index
   0x30
   */
-int U_PMR_SETPAGETRANSFORM_draw(const char *contents, FILE *out,
+int U_PMR_SETPAGETRANSFORM_draw(const char *contents, svgWriter *out,
                                 drawingStates *states) {
     int status = 1;
     return (status);
@@ -2023,7 +2054,7 @@ int U_PMR_SETPAGETRANSFORM_draw(const char *contents, FILE *out,
   EMF+ manual 2.3.9.6, Microsoft name: EmfPlusSetWorldTransform Record, Index
   0x2A
   */
-int U_PMR_SETWORLDTRANSFORM_draw(const char *contents, FILE *out,
+int U_PMR_SETWORLDTRANSFORM_draw(const char *contents, svgWriter *out,
                                  drawingStates *states) {
     int status = 1;
     return (status);
@@ -2036,7 +2067,7 @@ int U_PMR_SETWORLDTRANSFORM_draw(const char *contents, FILE *out,
   EMF+ manual 2.3.9.7, Microsoft name: EmfPlusTranslateWorldTransform Record,
   Index 0x2D
   */
-int U_PMR_TRANSLATEWORLDTRANSFORM_draw(const char *contents, FILE *out,
+int U_PMR_TRANSLATEWORLDTRANSFORM_draw(const char *contents, svgWriter *out,
                                        drawingStates *states) {
     int status = 1;
     return (status);
@@ -2047,7 +2078,7 @@ int U_PMR_TRANSLATEWORLDTRANSFORM_draw(const char *contents, FILE *out,
   \return 1 on success, 0 on error
   \param  contents    Record from which to print data
   */
-int U_PMR_STROKEFILLPATH_draw(const char *contents, FILE *out,
+int U_PMR_STROKEFILLPATH_draw(const char *contents, svgWriter *out,
                               drawingStates *states) {
     return (U_PMR_NODATAREC_draw(contents, out, states));
 }
@@ -2059,7 +2090,7 @@ int U_PMR_STROKEFILLPATH_draw(const char *contents, FILE *out,
   EMF+ manual mentioned in 2.1.1.1, reserved, not otherwise documented,
   Microsoft name: EmfPlusMultiFormatStart Record, Index 0x05
   */
-int U_PMR_MULTIFORMATSTART_draw(const char *contents, FILE *out,
+int U_PMR_MULTIFORMATSTART_draw(const char *contents, svgWriter *out,
                                 drawingStates *states) {
     return (U_PMR_NODATAREC_draw(contents, out, states));
 }
@@ -2071,7 +2102,7 @@ int U_PMR_MULTIFORMATSTART_draw(const char *contents, FILE *out,
   EMF+ manual mentioned in 2.1.1.1, reserved, not otherwise documented,
   Microsoft name: EmfPlusMultiFormatSection Record, Index 0x06
   */
-int U_PMR_MULTIFORMATSECTION_draw(const char *contents, FILE *out,
+int U_PMR_MULTIFORMATSECTION_draw(const char *contents, svgWriter *out,
                                   drawingStates *states) {
     return (U_PMR_NODATAREC_draw(contents, out, states));
 }
@@ -2083,7 +2114,7 @@ int U_PMR_MULTIFORMATSECTION_draw(const char *contents, FILE *out,
   EMF+ manual mentioned in 2.1.1.1, reserved, not otherwise documented,
   Microsoft name: EmfPlusMultiFormatEnd Record, Index 0x06
   */
-int U_PMR_MULTIFORMATEND_draw(const char *contents, FILE *out,
+int U_PMR_MULTIFORMATEND_draw(const char *contents, svgWriter *out,
                               drawingStates *states) {
     return (U_PMR_NODATAREC_draw(contents, out, states));
 }
@@ -43,7 +43,7 @@ extern "C" {
    this function is not visible in the API.  Print "data" for one of the many
    records that has none.
    */
-int U_PMR_NODATAREC_print(const char *contents, FILE *out,
+int U_PMR_NODATAREC_print(const char *contents, svgWriter *out,
                           drawingStates *states) {
     U_PMF_CMN_HDR Header;
     int status =
@@ -58,7 +58,7 @@ int U_PMR_NODATAREC_print(const char *contents, FILE *out,
    functions that draw points.
    */
 void U_PMF_VARPOINTS_print(const char **contents, int Flags, uint32_t Elements,
-                           const char *blimit, FILE *out,
+                           const char *blimit, svgWriter *out,
                            drawingStates *states) {
     unsigned int i;
     U_FLOAT Xpos, Ypos;
@@ -95,8 +95,8 @@ void U_PMF_VARPOINTS_print(const char **contents, int Flags, uint32_t Elements,
    this function is not visible in the API.  Common routine used by many
    functions that draw points.
    */
-void U_PMF_VARPOINTF_S_print(U_PMF_POINTF *Points, uint32_t Elements, FILE *out,
-                             drawingStates *states) {
+void U_PMF_VARPOINTF_S_print(U_PMF_POINTF *Points, uint32_t Elements,
+                             svgWriter *out, drawingStates *states) {
     unsigned int i;
     verbose_printf("   +  Points:");
     for (i = 0; i < Elements; i++, Points++) {
@@ -110,8 +110,8 @@ void U_PMF_VARPOINTF_S_print(U_PMF_POINTF *Points, uint32_t Elements, FILE *out,
    this function is not visible in the API.  Common routine used by many
    functions that draw rectangles.
    */
-int U_PMF_VARRECTF_S_print(U_PMF_RECTF *Rects, uint32_t Elements, FILE *out,
-                           drawingStates *states) {
+int U_PMF_VARRECTF_S_print(U_PMF_RECTF *Rects, uint32_t Elements,
+                           svgWriter *out, drawingStates *states) {
     if (!Elements)
         return (0);
     if (Elements == 1) {
@@ -133,7 +133,7 @@ int U_PMF_VARRECTF_S_print(U_PMF_RECTF *Rects, uint32_t Elements, FILE *out,
    this function is not visible in the API.  Common routine used by many
    functions.
    */
-int U_PMF_VARBRUSHID_print(int btype, uint32_t BrushID, FILE *out,
+int U_PMF_VARBRUSHID_print(int btype, uint32_t BrushID, svgWriter *out,
                            drawingStates *states) {
     if (btype) {
         verbose_printf(" Color:");
@@ -155,7 +155,7 @@ int U_PMF_VARBRUSHID_print(int btype, uint32_t BrushID, FILE *out,
   \param off        Offset from the beginning of the EMF+ file.
   */
 int U_pmf_onerec_print(const char *contents, const char *blimit, int recnum,
-                       int off, FILE *out, drawingStates *states) {
+                       int off, svgWriter *out, drawingStates *states) {
     int status;
     int rstatus;
     static U_OBJ_ACCUM ObjCont = {
@@ -384,7 +384,7 @@ int U_pmf_onerec_print(const char *contents, const char *blimit, int recnum,
   */
 
 int U_PMF_CMN_HDR_print(const char *contents, U_PMF_CMN_HDR Header, int precnum,
-                        int off, FILE *out, drawingStates *states) {
+                        int off, svgWriter *out, drawingStates *states) {
     verbose_printf(
         "   %-29srec+:%5d type:%X offset:%8d rsize:%8u dsize:%8u flags:%4.4X\n",
         U_pmr_names(Header.Type & U_PMR_TYPE_MASK), precnum, Header.Type, off,
@@ -401,7 +401,7 @@ int U_PMF_CMN_HDR_print(const char *contents, U_PMF_CMN_HDR Header, int precnum,
   \param  End        Text to follow array data
   */
 int U_PMF_UINT8_ARRAY_print(const char *Start, const uint8_t *Array,
-                            int Elements, char *End, FILE *out,
+                            int Elements, char *End, svgWriter *out,
                             drawingStates *states) {
     if (Start)
         verbose_printf("%s", Start);
@@ -419,7 +419,7 @@ int U_PMF_UINT8_ARRAY_print(const char *Start, const uint8_t *Array,
   \param otype    Value to print.
   EMF+ manual 2.1.1.3, Microsoft name: BrushType Enumeration
   */
-int U_PMF_BRUSHTYPEENUMERATION_print(int otype, FILE *out,
+int U_PMF_BRUSHTYPEENUMERATION_print(int otype, svgWriter *out,
                                      drawingStates *states) {
     int status = 1;
     switch (otype) {
@@ -452,7 +452,7 @@ int U_PMF_BRUSHTYPEENUMERATION_print(int otype, FILE *out,
   \param otype    Value to print.
   EMF+ manual 2.1.1.4, Microsoft name: BrushType Enumeration
   */
-int U_PMF_COMBINEMODEENUMERATION_print(int otype, FILE *out,
+int U_PMF_COMBINEMODEENUMERATION_print(int otype, svgWriter *out,
                                        drawingStates *states) {
     int status = 1;
     switch (otype) {
@@ -488,7 +488,7 @@ int U_PMF_COMBINEMODEENUMERATION_print(int otype, FILE *out,
   \param hstype    Value to print.
   EMF+ manual 2.1.1.13, Microsoft name: HatchStyle Enumeration
   */
-int U_PMF_HATCHSTYLEENUMERATION_print(int hstype, FILE *out,
+int U_PMF_HATCHSTYLEENUMERATION_print(int hstype, svgWriter *out,
                                       drawingStates *states) {
     int status = 1;
     switch (hstype) {
@@ -665,7 +665,7 @@ int U_PMF_HATCHSTYLEENUMERATION_print(int hstype, FILE *out,
   \param otype    Value to print.
   EMF+ manual 2.1.1.22, Microsoft name: ObjectType Enumeration
   */
-int U_PMF_OBJECTTYPEENUMERATION_print(int otype, FILE *out,
+int U_PMF_OBJECTTYPEENUMERATION_print(int otype, svgWriter *out,
                                       drawingStates *states) {
     int status = 1;
     switch (otype) {
@@ -713,7 +713,8 @@ int U_PMF_OBJECTTYPEENUMERATION_print(int otype, FILE *out,
   \param  Type   Value to print
   EMF+ manual 2.1.1.23, Microsoft name: PathPointType Enumeration
   */
-int U_PMF_PATHPOINTTYPE_ENUM_print(int Type, FILE *out, drawingStates *states) {
+int U_PMF_PATHPOINTTYPE_ENUM_print(int Type, svgWriter *out,
+                                   drawingStates *states) {
     switch (Type & U_PPT_MASK) {
     case U_PPT_Start:
         verbose_printf("Start");
@@ -737,7 +738,7 @@ int U_PMF_PATHPOINTTYPE_ENUM_print(int Type, FILE *out, drawingStates *states) {
   \param  pfe   A PixelFormat Enumeration value
   EMF+ manual 2.1.1.25, Microsoft name: PixelFormat Enumeration (U_PF_*)
   */
-int U_PMF_PX_FMT_ENUM_print(int pfe, FILE *out, drawingStates *states) {
+int U_PMF_PX_FMT_ENUM_print(int pfe, svgWriter *out, drawingStates *states) {
     FLAG_IGNORED;
     uint8_t idx;
     verbose_printf("   +  PxFmtEnum: ");
@@ -813,7 +814,7 @@ int U_PMF_PX_FMT_ENUM_print(int pfe, FILE *out, drawingStates *states) {
   EMF+ manual 2.1.1.27, Microsoft name: RegionNodeDataType Enumeration
   (U_RNDT_*)
   */
-int U_PMF_NODETYPE_print(int Type, FILE *out, drawingStates *states) {
+int U_PMF_NODETYPE_print(int Type, svgWriter *out, drawingStates *states) {
     if (Type == U_RNDT_And) {
         verbose_printf("And");
     } else if (Type == U_RNDT_Or) {
@@ -845,7 +846,7 @@ int U_PMF_NODETYPE_print(int Type, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.2.1.1, Microsoft name: EmfPlusBrush Object
   */
-int U_PMF_BRUSH_print(const char *contents, const char *blimit, FILE *out,
+int U_PMF_BRUSH_print(const char *contents, const char *blimit, svgWriter *out,
                       drawingStates *states) {
     FLAG_IGNORED;
     uint32_t Version, Type;
@@ -896,7 +897,7 @@ int U_PMF_BRUSH_print(const char *contents, const char *blimit, FILE *out,
   EMF+ manual 2.2.1.2, Microsoft name: EmfPlusCustomLineCap Object
   */
 int U_PMF_CUSTOMLINECAP_print(const char *contents, const char *Which,
-                              const char *blimit, FILE *out,
+                              const char *blimit, svgWriter *out,
                               drawingStates *states) {
     FLAG_IGNORED;
     uint32_t Version, Type;
@@ -930,7 +931,7 @@ int U_PMF_CUSTOMLINECAP_print(const char *contents, const char *Which,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.1.3, Microsoft name: EmfPlusFont Object
   */
-int U_PMF_FONT_print(const char *contents, const char *blimit, FILE *out,
+int U_PMF_FONT_print(const char *contents, const char *blimit, svgWriter *out,
                      drawingStates *states) {
     FLAG_IGNORED;
     uint32_t Version, SizeUnit, Length;
@@ -965,7 +966,7 @@ int U_PMF_FONT_print(const char *contents, const char *blimit, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.1.4, Microsoft name: EmfPlusImage Object
   */
-int U_PMF_IMAGE_print(const char *contents, const char *blimit, FILE *out,
+int U_PMF_IMAGE_print(const char *contents, const char *blimit, svgWriter *out,
                       drawingStates *states) {
     FLAG_IGNORED;
     uint32_t Version, Type;
@@ -1000,7 +1001,7 @@ int U_PMF_IMAGE_print(const char *contents, const char *blimit, FILE *out,
   EMF+ manual 2.2.1.5, Microsoft name: EmfPlusImageAttributes Object
   */
 int U_PMF_IMAGEATTRIBUTES_print(const char *contents, const char *blimit,
-                                FILE *out, drawingStates *states) {
+                                svgWriter *out, drawingStates *states) {
     FLAG_IGNORED;
     uint32_t Version, WrapMode, ClampColor, ObjectClamp;
     int status = U_PMF_IMAGEATTRIBUTES_get(contents, &Version, &WrapMode,
@@ -1023,7 +1024,7 @@ int U_PMF_IMAGEATTRIBUTES_print(const char *contents, const char *blimit,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.1.6, Microsoft name: EmfPlusPath Object
   */
-int U_PMF_PATH_print(const char *contents, const char *blimit, FILE *out,
+int U_PMF_PATH_print(const char *contents, const char *blimit, svgWriter *out,
                      drawingStates *states) {
     FLAG_IGNORED;
     unsigned int i, pos;
@@ -1070,7 +1071,7 @@ int U_PMF_PATH_print(const char *contents, const char *blimit, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.1.7, Microsoft name: EmfPlusPen Object
   */
-int U_PMF_PEN_print(const char *contents, const char *blimit, FILE *out,
+int U_PMF_PEN_print(const char *contents, const char *blimit, svgWriter *out,
                     drawingStates *states) {
     FLAG_IGNORED;
     uint32_t Version, Type;
@@ -1092,7 +1093,7 @@ int U_PMF_PEN_print(const char *contents, const char *blimit, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.1.8, Microsoft name: EmfPlusRegion Object
   */
-int U_PMF_REGION_print(const char *contents, const char *blimit, FILE *out,
+int U_PMF_REGION_print(const char *contents, const char *blimit, svgWriter *out,
                        drawingStates *states) {
     FLAG_IGNORED;
     uint32_t Version, Count;
@@ -1117,7 +1118,7 @@ int U_PMF_REGION_print(const char *contents, const char *blimit, FILE *out,
   EMF+ manual 2.2.1.9, Microsoft name: EmfPlusStringFormat Object
   */
 int U_PMF_STRINGFORMAT_print(const char *contents, const char *blimit,
-                             FILE *out, drawingStates *states) {
+                             svgWriter *out, drawingStates *states) {
     FLAG_IGNORED;
     U_PMF_STRINGFORMAT Sfs;
     const char *Data;
@@ -1153,7 +1154,8 @@ int U_PMF_STRINGFORMAT_print(const char *contents, const char *blimit,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.1, Microsoft name: EmfPlusARGB Object
   */
-int U_PMF_ARGB_print(const char *contents, FILE *out, drawingStates *states) {
+int U_PMF_ARGB_print(const char *contents, svgWriter *out,
+                     drawingStates *states) {
     uint8_t Blue, Green, Red, Alpha;
     int status = U_PMF_ARGB_get(contents, &Blue, &Green, &Red, &Alpha,
                                 contents + sizeof(U_RGBQUAD));
@@ -1170,7 +1172,7 @@ int U_PMF_ARGB_print(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.2, Microsoft name: EmfPlusBitmap Object
   */
-int U_PMF_BITMAP_print(const char *contents, const char *blimit, FILE *out,
+int U_PMF_BITMAP_print(const char *contents, const char *blimit, svgWriter *out,
                        drawingStates *states) {
     FLAG_IGNORED;
     U_PMF_BITMAP Bs;
@@ -1203,8 +1205,8 @@ int U_PMF_BITMAP_print(const char *contents, const char *blimit, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.3, Microsoft name: EmfPlusBitmapData Object
   */
-int U_PMF_BITMAPDATA_print(const char *contents, const char *blimit, FILE *out,
-                           drawingStates *states) {
+int U_PMF_BITMAPDATA_print(const char *contents, const char *blimit,
+                           svgWriter *out, drawingStates *states) {
     unsigned int i;
     U_PMF_PALETTE Ps;
     const char *Colors;
@@ -1227,8 +1229,8 @@ int U_PMF_BITMAPDATA_print(const char *contents, const char *blimit, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.4, Microsoft name: EmfPlusBlendColors Object
   */
-int U_PMF_BLENDCOLORS_print(const char *contents, const char *blimit, FILE *out,
-                            drawingStates *states) {
+int U_PMF_BLENDCOLORS_print(const char *contents, const char *blimit,
+                            svgWriter *out, drawingStates *states) {
     FLAG_IGNORED;
     unsigned int i;
     uint32_t Elements;
@@ -1260,7 +1262,7 @@ int U_PMF_BLENDCOLORS_print(const char *contents, const char *blimit, FILE *out,
   EMF+ manual 2.2.2.5, Microsoft name: EmfPlusBlendFactors Object
   */
 int U_PMF_BLENDFACTORS_print(const char *contents, const char *type,
-                             const char *blimit, FILE *out,
+                             const char *blimit, svgWriter *out,
                              drawingStates *states) {
     FLAG_IGNORED;
     unsigned int i;
@@ -1289,7 +1291,7 @@ int U_PMF_BLENDFACTORS_print(const char *contents, const char *type,
   EMF+ manual 2.2.2.6, Microsoft name: EmfPlusBoundaryPathData Object
   */
 int U_PMF_BOUNDARYPATHDATA_print(const char *contents, const char *blimit,
-                                 FILE *out, drawingStates *states) {
+                                 svgWriter *out, drawingStates *states) {
     FLAG_IGNORED;
     int32_t Size;
     const char *Data;
@@ -1308,7 +1310,7 @@ int U_PMF_BOUNDARYPATHDATA_print(const char *contents, const char *blimit,
   EMF+ manual 2.2.2.7, Microsoft name: EmfPlusBoundaryPointData Object
   */
 int U_PMF_BOUNDARYPOINTDATA_print(const char *contents, const char *blimit,
-                                  FILE *out, drawingStates *states) {
+                                  svgWriter *out, drawingStates *states) {
     int32_t Elements;
     U_PMF_POINTF *Points;
     int status =
@@ -1328,7 +1330,7 @@ int U_PMF_BOUNDARYPOINTDATA_print(const char *contents, const char *blimit,
   EMF+ manual 2.2.2.8, Microsoft name: EmfPlusCharacterRange Object
   */
 int U_PMF_CHARACTERRANGE_print(const char *contents, const char *blimit,
-                               FILE *out, drawingStates *states) {
+                               svgWriter *out, drawingStates *states) {
     int32_t First, Length;
     int status = U_PMF_CHARACTERRANGE_get(contents, &First, &Length, blimit);
     if (status) {
@@ -1344,7 +1346,7 @@ int U_PMF_CHARACTERRANGE_print(const char *contents, const char *blimit,
   EMF+ manual 2.2.2.9, Microsoft name: EmfPlusCompoundLineData Object
   */
 int U_PMF_COMPOUNDLINEDATA_print(const char *contents, const char *blimit,
-                                 FILE *out, drawingStates *states) {
+                                 svgWriter *out, drawingStates *states) {
     FLAG_IGNORED;
     int32_t Elements;
     U_FLOAT *Widths;
@@ -1374,7 +1376,7 @@ int U_PMF_COMPOUNDLINEDATA_print(const char *contents, const char *blimit,
   objects have a corresponding _get().
   */
 int U_PMF_COMPRESSEDIMAGE_print(const char *contents, const char *blimit,
-                                FILE *out, drawingStates *states) {
+                                svgWriter *out, drawingStates *states) {
     const char *Data;
     int status = U_PMF_COMPRESSEDIMAGE_get(contents, &Data, blimit);
     if (status) {
@@ -1390,7 +1392,7 @@ int U_PMF_COMPRESSEDIMAGE_print(const char *contents, const char *blimit,
   EMF+ manual 2.2.2.11, Microsoft name: EmfPlusCustomEndCapData Object
   */
 int U_PMF_CUSTOMENDCAPDATA_print(const char *contents, const char *blimit,
-                                 FILE *out, drawingStates *states) {
+                                 svgWriter *out, drawingStates *states) {
     FLAG_IGNORED;
     int32_t Size;
     const char *Data;
@@ -1409,7 +1411,7 @@ int U_PMF_CUSTOMENDCAPDATA_print(const char *contents, const char *blimit,
   EMF+ manual 2.2.2.12, Microsoft name: EmfPlusCustomLineCapArrowData Object
   */
 int U_PMF_CUSTOMLINECAPARROWDATA_print(const char *contents, const char *blimit,
-                                       FILE *out, drawingStates *states) {
+                                       svgWriter *out, drawingStates *states) {
     U_PMF_CUSTOMLINECAPARROWDATA Ccad;
     int status = U_PMF_CUSTOMLINECAPARROWDATA_get(contents, &Ccad, blimit);
     if (status) {
@@ -1439,7 +1441,7 @@ int U_PMF_CUSTOMLINECAPARROWDATA_print(const char *contents, const char *blimit,
   EMF+ manual 2.2.2.13, Microsoft name: EmfPlusCustomLineCapData Object
   */
 int U_PMF_CUSTOMLINECAPDATA_print(const char *contents, const char *blimit,
-                                  FILE *out, drawingStates *states) {
+                                  svgWriter *out, drawingStates *states) {
     FLAG_IGNORED;
     U_PMF_CUSTOMLINECAPDATA Clcd;
     const char *Data;
@@ -1474,7 +1476,7 @@ int U_PMF_CUSTOMLINECAPDATA_print(const char *contents, const char *blimit,
   EMF+ manual 2.2.2.14, Microsoft name: EmfPlusCustomLineCapOptionalData Object
   */
 int U_PMF_CUSTOMLINECAPOPTIONALDATA_print(const char *contents, uint32_t Flags,
-                                          const char *blimit, FILE *out,
+                                          const char *blimit, svgWriter *out,
                                           drawingStates *states) {
     FLAG_IGNORED;
     const char *FillData;
@@ -1507,7 +1509,7 @@ int U_PMF_CUSTOMLINECAPOPTIONALDATA_print(const char *contents, uint32_t Flags,
   EMF+ manual 2.2.2.15, Microsoft name: EmfPlusCustomStartCapData Object
   */
 int U_PMF_CUSTOMSTARTCAPDATA_print(const char *contents, const char *blimit,
-                                   FILE *out, drawingStates *states) {
+                                   svgWriter *out, drawingStates *states) {
     FLAG_IGNORED;
     int32_t Size;
     const char *Data;
@@ -1526,7 +1528,7 @@ int U_PMF_CUSTOMSTARTCAPDATA_print(const char *contents, const char *blimit,
   EMF+ manual 2.2.2.16, Microsoft name: EmfPlusDashedLineData Object
   */
 int U_PMF_DASHEDLINEDATA_print(const char *contents, const char *blimit,
-                               FILE *out, drawingStates *states) {
+                               svgWriter *out, drawingStates *states) {
     int32_t Elements;
     U_FLOAT *Lengths;
     U_FLOAT *hold;
@@ -1550,8 +1552,8 @@ int U_PMF_DASHEDLINEDATA_print(const char *contents, const char *blimit,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.17, Microsoft name: EmfPlusFillPath Object
   */
-int U_PMF_FILLPATHOBJ_print(const char *contents, const char *blimit, FILE *out,
-                            drawingStates *states) {
+int U_PMF_FILLPATHOBJ_print(const char *contents, const char *blimit,
+                            svgWriter *out, drawingStates *states) {
     int32_t Size;
     const char *Data;
     int status = U_PMF_FILLPATHOBJ_get(contents, &Size, &Data, blimit);
@@ -1571,7 +1573,7 @@ int U_PMF_FILLPATHOBJ_print(const char *contents, const char *blimit, FILE *out,
   EMF+ manual 2.2.2.18, Microsoft name: EmfPlusFocusScaleData Object
   */
 int U_PMF_FOCUSSCALEDATA_print(const char *contents, const char *blimit,
-                               FILE *out, drawingStates *states) {
+                               svgWriter *out, drawingStates *states) {
     uint32_t Count;
     U_FLOAT ScaleX, ScaleY;
     int status =
@@ -1595,7 +1597,7 @@ int U_PMF_FOCUSSCALEDATA_print(const char *contents, const char *blimit,
     a blimit for the general routine.
 
 */
-int U_PMF_GRAPHICSVERSION_memsafe_print(const char *contents, FILE *out,
+int U_PMF_GRAPHICSVERSION_memsafe_print(const char *contents, svgWriter *out,
                                         drawingStates *states) {
     const char *blimit = contents + sizeof(U_PMF_GRAPHICSVERSION);
     return (U_PMF_GRAPHICSVERSION_print(contents, blimit, out, states));
@@ -1609,7 +1611,7 @@ int U_PMF_GRAPHICSVERSION_memsafe_print(const char *contents, FILE *out,
     EMF+ manual 2.2.2.19, Microsoft name: EmfPlusGraphicsVersion Object
 */
 int U_PMF_GRAPHICSVERSION_print(const char *contents, const char *blimit,
-                                FILE *out, drawingStates *states) {
+                                svgWriter *out, drawingStates *states) {
     int Signature, GrfVersion;
     int status =
         U_PMF_GRAPHICSVERSION_get(contents, &Signature, &GrfVersion, blimit);
@@ -1627,7 +1629,7 @@ int U_PMF_GRAPHICSVERSION_print(const char *contents, const char *blimit,
   EMF+ manual 2.2.2.20, Microsoft name: EmfPlusHatchBrushData Object
   */
 int U_PMF_HATCHBRUSHDATA_print(const char *contents, const char *blimit,
-                               FILE *out, drawingStates *states) {
+                               svgWriter *out, drawingStates *states) {
     FLAG_IGNORED;
     uint32_t Style;
     U_PMF_ARGB Foreground, Background;
@@ -1651,7 +1653,7 @@ int U_PMF_HATCHBRUSHDATA_print(const char *contents, const char *blimit,
   \param  LId   Record from which to print data
   EMF+ manual 2.2.2.23, Microsoft name: EmfPlusLanguageIdentifier Object
   */
-int U_PMF_LANGUAGEIDENTIFIER_print(U_PMF_LANGUAGEIDENTIFIER LId, FILE *out,
+int U_PMF_LANGUAGEIDENTIFIER_print(U_PMF_LANGUAGEIDENTIFIER LId, svgWriter *out,
                                    drawingStates *states) {
     FLAG_IGNORED;
     int SubLId, PriLId;
@@ -1671,7 +1673,7 @@ int U_PMF_LANGUAGEIDENTIFIER_print(U_PMF_LANGUAGEIDENTIFIER LId, FILE *out,
   EMF+ manual 2.2.2.24, Microsoft name: EmfPlusLinearGradientBrushData Object
   */
 int U_PMF_LINEARGRADIENTBRUSHDATA_print(const char *contents,
-                                        const char *blimit, FILE *out,
+                                        const char *blimit, svgWriter *out,
                                         drawingStates *states) {
     U_PMF_LINEARGRADIENTBRUSHDATA Lgbd;
     const char *Data;
@@ -1709,7 +1711,7 @@ int U_PMF_LINEARGRADIENTBRUSHDATA_print(const char *contents,
   */
 int U_PMF_LINEARGRADIENTBRUSHOPTIONALDATA_print(const char *contents,
                                                 int BDFlag, const char *blimit,
-                                                FILE *out,
+                                                svgWriter *out,
                                                 drawingStates *states) {
     FLAG_IGNORED;
     U_PMF_TRANSFORMMATRIX Tm;
@@ -1753,8 +1755,8 @@ int U_PMF_LINEARGRADIENTBRUSHOPTIONALDATA_print(const char *contents,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.26, Microsoft name: EmfPlusLinePath Object
   */
-int U_PMF_LINEPATH_print(const char *contents, const char *blimit, FILE *out,
-                         drawingStates *states) {
+int U_PMF_LINEPATH_print(const char *contents, const char *blimit,
+                         svgWriter *out, drawingStates *states) {
     int32_t Size;
     const char *Data;
     int status = U_PMF_LINEPATH_get(contents, &Size, &Data, blimit);
@@ -1771,8 +1773,8 @@ int U_PMF_LINEPATH_print(const char *contents, const char *blimit, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.27, Microsoft name: EmfPlusMetafile Object
   */
-int U_PMF_METAFILE_print(const char *contents, const char *blimit, FILE *out,
-                         drawingStates *states) {
+int U_PMF_METAFILE_print(const char *contents, const char *blimit,
+                         svgWriter *out, drawingStates *states) {
     uint32_t Type;
     uint32_t Size;
     const char *Data;
@@ -1790,8 +1792,8 @@ int U_PMF_METAFILE_print(const char *contents, const char *blimit, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.28, Microsoft name: EmfPlusPalette Object
   */
-int U_PMF_PALETTE_print(const char *contents, const char *blimit, FILE *out,
-                        drawingStates *states) {
+int U_PMF_PALETTE_print(const char *contents, const char *blimit,
+                        svgWriter *out, drawingStates *states) {
     unsigned int i;
     uint32_t Flags;
     uint32_t Elements;
@@ -1816,7 +1818,7 @@ int U_PMF_PALETTE_print(const char *contents, const char *blimit, FILE *out,
   EMF+ manual 2.2.2.29, Microsoft name: EmfPlusPathGradientBrushData Object
   */
 int U_PMF_PATHGRADIENTBRUSHDATA_print(const char *contents, const char *blimit,
-                                      FILE *out, drawingStates *states) {
+                                      svgWriter *out, drawingStates *states) {
     FLAG_IGNORED;
     U_PMF_PATHGRADIENTBRUSHDATA Pgbd;
     const char *Gradient;
@@ -1860,7 +1862,8 @@ int U_PMF_PATHGRADIENTBRUSHDATA_print(const char *contents, const char *blimit,
   Object
   */
 int U_PMF_PATHGRADIENTBRUSHOPTIONALDATA_print(const char *contents, int BDFlag,
-                                              const char *blimit, FILE *out,
+                                              const char *blimit,
+                                              svgWriter *out,
                                               drawingStates *states) {
     FLAG_IGNORED;
     if (BDFlag & (U_BD_Transform | U_BD_PresetColors | U_BD_BlendFactorsH |
@@ -1893,7 +1896,7 @@ int U_PMF_PATHGRADIENTBRUSHOPTIONALDATA_print(const char *contents, int BDFlag,
   EMF+ manual 2.2.2.31, Microsoft name: EmfPlusPathPointType Object
   */
 int U_PMF_PATHPOINTTYPE_print(const char *contents, const char *blimit,
-                              FILE *out, drawingStates *states) {
+                              svgWriter *out, drawingStates *states) {
     int Flags, Type;
     int status = U_PMF_PATHPOINTTYPE_get(contents, &Flags, &Type, blimit);
     if (status) {
@@ -1911,7 +1914,7 @@ int U_PMF_PATHPOINTTYPE_print(const char *contents, const char *blimit,
   EMF+ manual 2.2.2.32, Microsoft name: EmfPlusPathPointTypeRLE Object
   */
 int U_PMF_PATHPOINTTYPERLE_print(const char *contents, const char *blimit,
-                                 FILE *out, drawingStates *states) {
+                                 svgWriter *out, drawingStates *states) {
     int Bezier, Elements, Type;
     int status =
         U_PMF_PATHPOINTTYPERLE_get(contents, &Bezier, &Elements, &Type, blimit);
@@ -1931,8 +1934,8 @@ int U_PMF_PATHPOINTTYPERLE_print(const char *contents, const char *blimit,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.33, Microsoft name: EmfPlusPenData Object
   */
-int U_PMF_PENDATA_print(const char *contents, const char *blimit, FILE *out,
-                        drawingStates *states) {
+int U_PMF_PENDATA_print(const char *contents, const char *blimit,
+                        svgWriter *out, drawingStates *states) {
     FLAG_IGNORED;
     uint32_t Flags, Unit;
     U_FLOAT Width;
@@ -1958,7 +1961,7 @@ int U_PMF_PENDATA_print(const char *contents, const char *blimit, FILE *out,
   EMF+ manual 2.2.2.34, Microsoft name: EmfPlusPenOptionalData Object
   */
 int U_PMF_PENOPTIONALDATA_print(const char *contents, int Flags,
-                                const char *blimit, FILE *out,
+                                const char *blimit, svgWriter *out,
                                 drawingStates *states) {
     U_PMF_TRANSFORMMATRIX Matrix;
     int32_t StartCap;
@@ -2035,7 +2038,7 @@ int U_PMF_PENOPTIONALDATA_print(const char *contents, int Flags,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.35, Microsoft name: EmfPlusPoint Object
   */
-int U_PMF_POINT_print(const char **contents, const char *blimit, FILE *out,
+int U_PMF_POINT_print(const char **contents, const char *blimit, svgWriter *out,
                       drawingStates *states) {
     U_FLOAT X, Y;
     int status = U_PMF_POINT_get(contents, &X, &Y, blimit);
@@ -2051,7 +2054,8 @@ int U_PMF_POINT_print(const char **contents, const char *blimit, FILE *out,
   \param  Point   U_PMF_POINT Structure to print
   EMF+ manual 2.2.2.35, Microsoft name: EmfPlusPoint Object
   */
-int U_PMF_POINT_S_print(U_PMF_POINT *Point, FILE *out, drawingStates *states) {
+int U_PMF_POINT_S_print(U_PMF_POINT *Point, svgWriter *out,
+                        drawingStates *states) {
     FLAG_IGNORED;
     if (!Point) {
         return (0);
@@ -2066,8 +2070,8 @@ int U_PMF_POINT_S_print(U_PMF_POINT *Point, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.36, Microsoft name: EmfPlusPointF Object
   */
-int U_PMF_POINTF_print(const char **contents, const char *blimit, FILE *out,
-                       drawingStates *states) {
+int U_PMF_POINTF_print(const char **contents, const char *blimit,
+                       svgWriter *out, drawingStates *states) {
     U_FLOAT X, Y;
     int status = U_PMF_POINTF_get(contents, &X, &Y, blimit);
     if (status) {
@@ -2082,7 +2086,7 @@ int U_PMF_POINTF_print(const char **contents, const char *blimit, FILE *out,
   \param  Point   U_PMF_POINTF Structure to print
   EMF+ manual 2.2.2.36, Microsoft name: EmfPlusPointF Object
   */
-int U_PMF_POINTF_S_print(U_PMF_POINTF *Point, FILE *out,
+int U_PMF_POINTF_S_print(U_PMF_POINTF *Point, svgWriter *out,
                          drawingStates *states) {
     if (!Point) {
         return (0);
@@ -2105,7 +2109,8 @@ int U_PMF_POINTF_S_print(U_PMF_POINTF *Point, FILE *out,
   EMF+ manual 2.2.2.37, Microsoft name: EmfPlusPointR Object
   */
 int U_PMF_POINTR_print(const char **contents, U_FLOAT *Xpos, U_FLOAT *Ypos,
-                       const char *blimit, FILE *out, drawingStates *states) {
+                       const char *blimit, svgWriter *out,
+                       drawingStates *states) {
     U_FLOAT X, Y;
     int status = U_PMF_POINTR_get(contents, &X, &Y, blimit);
     *Xpos += X;
@@ -2122,7 +2127,7 @@ int U_PMF_POINTR_print(const char **contents, U_FLOAT *Xpos, U_FLOAT *Ypos,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.38, Microsoft name: EmfPlusRect Object
   */
-int U_PMF_RECT_print(const char **contents, const char *blimit, FILE *out,
+int U_PMF_RECT_print(const char **contents, const char *blimit, svgWriter *out,
                      drawingStates *states) {
     int16_t X, Y, Width, Height;
     int status = U_PMF_RECT_get(contents, &X, &Y, &Width, &Height, blimit);
@@ -2138,7 +2143,8 @@ int U_PMF_RECT_print(const char **contents, const char *blimit, FILE *out,
   \param  Rect   U_PMF_RECT structure
   EMF+ manual 2.2.2.39, Microsoft name: EmfPlusRectF Object
   */
-int U_PMF_RECT_S_print(U_PMF_RECT *Rect, FILE *out, drawingStates *states) {
+int U_PMF_RECT_S_print(U_PMF_RECT *Rect, svgWriter *out,
+                       drawingStates *states) {
     verbose_printf("{UL{%d,%d},WH{%d,%d}}", Rect->X, Rect->Y, Rect->Width,
                    Rect->Height);
     return (1);
@@ -2150,7 +2156,7 @@ int U_PMF_RECT_S_print(U_PMF_RECT *Rect, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.2.2.39, Microsoft name: EmfPlusRectF Object
   */
-int U_PMF_RECTF_print(const char **contents, const char *blimit, FILE *out,
+int U_PMF_RECTF_print(const char **contents, const char *blimit, svgWriter *out,
                       drawingStates *states) {
     U_FLOAT X, Y, Width, Height;
     int status = U_PMF_RECTF_get(contents, &X, &Y, &Width, &Height, blimit);
@@ -2166,7 +2172,8 @@ int U_PMF_RECTF_print(const char **contents, const char *blimit, FILE *out,
   \param  Rect   U_PMF_RECTF Structure
   EMF+ manual 2.2.2.39, Microsoft name: EmfPlusRectF Object
   */
-int U_PMF_RECTF_S_print(U_PMF_RECTF *Rect, FILE *out, drawingStates *states) {
+int U_PMF_RECTF_S_print(U_PMF_RECTF *Rect, svgWriter *out,
+                        drawingStates *states) {
     verbose_printf("{UL{%f,%f},WH{%f,%f}}", Rect->X, Rect->Y, Rect->Width,
                    Rect->Height);
     return (1);
@@ -2181,7 +2188,7 @@ int U_PMF_RECTF_S_print(U_PMF_RECTF *Rect, FILE *out, drawingStates *states) {
   EMF+ manual 2.2.2.40, Microsoft name: EmfPlusRegionNode Object
   */
 int U_PMF_REGIONNODE_print(const char *contents, int Level, const char *blimit,
-                           FILE *out, drawingStates *states) {
+                           svgWriter *out, drawingStates *states) {
     FLAG_IGNORED;
     int len = 4; /* Type will always be present */
     uint32_t Type;
@@ -2223,7 +2230,7 @@ int U_PMF_REGIONNODE_print(const char *contents, int Level, const char *blimit,
   EMF+ manual 2.2.2.41, Microsoft name: EmfPlusRegionNodeChildNodes Object
   */
 int U_PMF_REGIONNODECHILDNODES_print(const char *contents, int Level,
-                                     const char *blimit, FILE *out,
+                                     const char *blimit, svgWriter *out,
                                      drawingStates *states) {
     uint32_t size, rsize;
     verbose_printf(" RegionNodeChildNodes:\n");
@@ -2247,7 +2254,7 @@ int U_PMF_REGIONNODECHILDNODES_print(const char *contents, int Level,
   EMF+ manual 2.2.2.42, Microsoft name: EmfPlusRegionNodePath Object
   */
 int U_PMF_REGIONNODEPATH_print(const char *contents, const char *blimit,
-                               FILE *out, drawingStates *states) {
+                               svgWriter *out, drawingStates *states) {
     int32_t Size;
     const char *Data;
     int status = U_PMF_REGIONNODEPATH_get(contents, &Size, &Data, blimit);
@@ -2266,7 +2273,7 @@ int U_PMF_REGIONNODEPATH_print(const char *contents, const char *blimit,
   EMF+ manual 2.2.2.43, Microsoft name: EmfPlusSolidBrushData Object
   */
 int U_PMF_SOLIDBRUSHDATA_print(const char *contents, const char *blimit,
-                               FILE *out, drawingStates *states) {
+                               svgWriter *out, drawingStates *states) {
     U_PMF_ARGB Color;
     int status = U_PMF_SOLIDBRUSHDATA_get(contents, &Color, blimit);
     if (status) {
@@ -2286,7 +2293,7 @@ int U_PMF_SOLIDBRUSHDATA_print(const char *contents, const char *blimit,
   */
 int U_PMF_STRINGFORMATDATA_print(const char *contents, uint32_t TabStopCount,
                                  uint32_t RangeCount, const char *blimit,
-                                 FILE *out, drawingStates *states) {
+                                 svgWriter *out, drawingStates *states) {
     const U_FLOAT *TabStops;
     const U_PMF_CHARACTERRANGE *CharRange;
     int status = U_PMF_STRINGFORMATDATA_get(contents, TabStopCount, RangeCount,
@@ -2317,7 +2324,7 @@ int U_PMF_STRINGFORMATDATA_print(const char *contents, uint32_t TabStopCount,
   EMF+ manual 2.2.2.45, Microsoft name: EmfPlusTextureBrushData Object
   */
 int U_PMF_TEXTUREBRUSHDATA_print(const char *contents, const char *blimit,
-                                 FILE *out, drawingStates *states) {
+                                 svgWriter *out, drawingStates *states) {
     FLAG_IGNORED;
     uint32_t Flags;
     int32_t WrapMode;
@@ -2340,7 +2347,8 @@ int U_PMF_TEXTUREBRUSHDATA_print(const char *contents, const char *blimit,
   */
 int U_PMF_TEXTUREBRUSHOPTIONALDATA_print(const char *contents, int HasMatrix,
                                          int HasImage, const char *blimit,
-                                         FILE *out, drawingStates *states) {
+                                         svgWriter *out,
+                                         drawingStates *states) {
     FLAG_IGNORED;
     U_PMF_TRANSFORMMATRIX Matrix;
     U_PMF_TRANSFORMMATRIX *pMatrix;
@@ -2368,7 +2376,7 @@ int U_PMF_TEXTUREBRUSHOPTIONALDATA_print(const char *contents, int HasMatrix,
   EMF+ manual 2.2.2.47, Microsoft name: EmfPlusTransformMatrix Object
   */
 int U_PMF_TRANSFORMMATRIX_print(const char *contents, const char *blimit,
-                                FILE *out, drawingStates *states) {
+                                svgWriter *out, drawingStates *states) {
     U_PMF_TRANSFORMMATRIX Tm;
     int status = U_PMF_TRANSFORMMATRIX_get(contents, &Tm, blimit);
     if (status) {
@@ -2383,7 +2391,7 @@ int U_PMF_TRANSFORMMATRIX_print(const char *contents, const char *blimit,
   \param  Tm  U_PMF_TRANSFORMMATRIX structure
   EMF+ manual 2.2.2.47, Microsoft name: EmfPlusTransformMatrix Object
   */
-int U_PMF_TRANSFORMMATRIX2_print(U_PMF_TRANSFORMMATRIX *Tm, FILE *out,
+int U_PMF_TRANSFORMMATRIX2_print(U_PMF_TRANSFORMMATRIX *Tm, svgWriter *out,
                                  drawingStates *states) {
     if (Tm) {
         verbose_printf(" Matrix:{%f,%f,%f,%f,%f,%f}", Tm->m11, Tm->m12, Tm->m21,
@@ -2401,7 +2409,7 @@ int U_PMF_TRANSFORMMATRIX2_print(U_PMF_TRANSFORMMATRIX *Tm, FILE *out,
   NOT DOCUMENTED, like EMF+ manual 2.2.2.47, Microsoft name:
   EmfPlusTransformMatrix Object, but missing offset values
   */
-int U_PMF_ROTMATRIX2_print(U_PMF_ROTMATRIX *Rm, FILE *out,
+int U_PMF_ROTMATRIX2_print(U_PMF_ROTMATRIX *Rm, svgWriter *out,
                            drawingStates *states) {
     verbose_printf(" Matrix:{%f,%f,%f,%f}", Rm->m11, Rm->m12, Rm->m21, Rm->m22);
     return (1);
@@ -2413,8 +2421,8 @@ int U_PMF_ROTMATRIX2_print(U_PMF_ROTMATRIX *Rm, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.3.1, Microsoft name: BlurEffect Object
   */
-int U_PMF_IE_BLUR_print(const char *contents, const char *blimit, FILE *out,
-                        drawingStates *states) {
+int U_PMF_IE_BLUR_print(const char *contents, const char *blimit,
+                        svgWriter *out, drawingStates *states) {
     U_FLOAT Radius;
     uint32_t ExpandEdge;
     int status = U_PMF_IE_BLUR_get(contents, &Radius, &ExpandEdge, blimit);
@@ -2432,7 +2440,7 @@ int U_PMF_IE_BLUR_print(const char *contents, const char *blimit, FILE *out,
   EMF+ manual 2.2.3.2, Microsoft name: BrightnessContrastEffect Object
   */
 int U_PMF_IE_BRIGHTNESSCONTRAST_print(const char *contents, const char *blimit,
-                                      FILE *out, drawingStates *states) {
+                                      svgWriter *out, drawingStates *states) {
     int32_t Brightness, Contrast;
     int status = U_PMF_IE_BRIGHTNESSCONTRAST_get(contents, &Brightness,
                                                  &Contrast, blimit);
@@ -2450,7 +2458,7 @@ int U_PMF_IE_BRIGHTNESSCONTRAST_print(const char *contents, const char *blimit,
   EMF+ manual 2.2.3.3, Microsoft name: ColorBalanceEffect Object
   */
 int U_PMF_IE_COLORBALANCE_print(const char *contents, const char *blimit,
-                                FILE *out, drawingStates *states) {
+                                svgWriter *out, drawingStates *states) {
     int32_t CyanRed, MagentaGreen, YellowBlue;
     int status = U_PMF_IE_COLORBALANCE_get(contents, &CyanRed, &MagentaGreen,
                                            &YellowBlue, blimit);
@@ -2469,7 +2477,7 @@ int U_PMF_IE_COLORBALANCE_print(const char *contents, const char *blimit,
   EMF+ manual 2.2.3.4, Microsoft name: ColorCurveEffect Object
   */
 int U_PMF_IE_COLORCURVE_print(const char *contents, const char *blimit,
-                              FILE *out, drawingStates *states) {
+                              svgWriter *out, drawingStates *states) {
     uint32_t Adjust, Channel;
     int32_t Intensity;
     int status = U_PMF_IE_COLORCURVE_get(contents, &Adjust, &Channel,
@@ -2488,7 +2496,7 @@ int U_PMF_IE_COLORCURVE_print(const char *contents, const char *blimit,
   EMF+ manual 2.2.3.5, Microsoft name: ColorLookupTableEffect Object
   */
 int U_PMF_IE_COLORLOOKUPTABLE_print(const char *contents, const char *blimit,
-                                    FILE *out, drawingStates *states) {
+                                    svgWriter *out, drawingStates *states) {
     const uint8_t *BLUT, *GLUT, *RLUT, *ALUT;
     int status = U_PMF_IE_COLORLOOKUPTABLE_get(contents, &BLUT, &GLUT, &RLUT,
                                                &ALUT, blimit);
@@ -2509,7 +2517,7 @@ int U_PMF_IE_COLORLOOKUPTABLE_print(const char *contents, const char *blimit,
   EMF+ manual 2.2.3.6, Microsoft name: ColorMatrixEffect Object
   */
 int U_PMF_IE_COLORMATRIX_print(const char *contents, const char *blimit,
-                               FILE *out, drawingStates *states) {
+                               svgWriter *out, drawingStates *states) {
     U_PMF_IE_COLORMATRIX Matrix;
     int i, j;
     int status = U_PMF_IE_COLORMATRIX_get(contents, &Matrix, blimit);
@@ -2534,7 +2542,7 @@ int U_PMF_IE_COLORMATRIX_print(const char *contents, const char *blimit,
   EMF+ manual 2.2.3.7, Microsoft name: HueSaturationLightnessEffect Object
   */
 int U_PMF_IE_HUESATURATIONLIGHTNESS_print(const char *contents,
-                                          const char *blimit, FILE *out,
+                                          const char *blimit, svgWriter *out,
                                           drawingStates *states) {
     int32_t Hue, Saturation, Lightness;
     int status = U_PMF_IE_HUESATURATIONLIGHTNESS_get(
@@ -2553,8 +2561,8 @@ int U_PMF_IE_HUESATURATIONLIGHTNESS_print(const char *contents,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.3.8, Microsoft name: LevelsEffect Object
   */
-int U_PMF_IE_LEVELS_print(const char *contents, const char *blimit, FILE *out,
-                          drawingStates *states) {
+int U_PMF_IE_LEVELS_print(const char *contents, const char *blimit,
+                          svgWriter *out, drawingStates *states) {
     int32_t Highlight, Midtone, Shadow;
     int status =
         U_PMF_IE_LEVELS_get(contents, &Highlight, &Midtone, &Shadow, blimit);
@@ -2572,7 +2580,7 @@ int U_PMF_IE_LEVELS_print(const char *contents, const char *blimit, FILE *out,
   EMF+ manual 2.2.3.9, Microsoft name: RedEyeCorrectionEffect Object
   */
 int U_PMF_IE_REDEYECORRECTION_print(const char *contents, const char *blimit,
-                                    FILE *out, drawingStates *states) {
+                                    svgWriter *out, drawingStates *states) {
     int32_t Elements;
     U_RECTL *Rects;
     int status =
@@ -2594,8 +2602,8 @@ int U_PMF_IE_REDEYECORRECTION_print(const char *contents, const char *blimit,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.3.10, Microsoft name: SharpenEffect Object
   */
-int U_PMF_IE_SHARPEN_print(const char *contents, const char *blimit, FILE *out,
-                           drawingStates *states) {
+int U_PMF_IE_SHARPEN_print(const char *contents, const char *blimit,
+                           svgWriter *out, drawingStates *states) {
     U_FLOAT Radius;
     int32_t Sharpen;
     int status = U_PMF_IE_SHARPEN_get(contents, &Radius, &Sharpen, blimit);
@@ -2611,8 +2619,8 @@ int U_PMF_IE_SHARPEN_print(const char *contents, const char *blimit, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.2.3.11, Microsoft name: TintEffect Object
   */
-int U_PMF_IE_TINT_print(const char *contents, const char *blimit, FILE *out,
-                        drawingStates *states) {
+int U_PMF_IE_TINT_print(const char *contents, const char *blimit,
+                        svgWriter *out, drawingStates *states) {
     int32_t Hue, Amount;
     int status = U_PMF_IE_TINT_get(contents, &Hue, &Amount, blimit);
     if (status) {
@@ -2634,7 +2642,7 @@ int U_PMF_IE_TINT_print(const char *contents, const char *blimit, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.1.1, Microsoft name: EmfPlusOffsetClip Record,  Index 0x35
   */
-int U_PMR_OFFSETCLIP_print(const char *contents, FILE *out,
+int U_PMR_OFFSETCLIP_print(const char *contents, svgWriter *out,
                            drawingStates *states) {
     FLAG_IGNORED;
     U_PMF_CMN_HDR Header;
@@ -2654,7 +2662,7 @@ int U_PMR_OFFSETCLIP_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.1.2, Microsoft name: EmfPlusResetClip Record, Index 0x31
   */
-int U_PMR_RESETCLIP_print(const char *contents, FILE *out,
+int U_PMR_RESETCLIP_print(const char *contents, svgWriter *out,
                           drawingStates *states) {
     FLAG_IGNORED;
     return (U_PMR_NODATAREC_print(contents, out, states));
@@ -2666,7 +2674,7 @@ int U_PMR_RESETCLIP_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.1.3, Microsoft name: EmfPlusSetClipPath Record, Index 0x33
   */
-int U_PMR_SETCLIPPATH_print(const char *contents, FILE *out,
+int U_PMR_SETCLIPPATH_print(const char *contents, svgWriter *out,
                             drawingStates *states) {
     FLAG_IGNORED;
     int CMenum;
@@ -2684,7 +2692,7 @@ int U_PMR_SETCLIPPATH_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.1.4, Microsoft name: EmfPlusSetClipRect Record, Index 0x32
   */
-int U_PMR_SETCLIPRECT_print(const char *contents, FILE *out,
+int U_PMR_SETCLIPRECT_print(const char *contents, svgWriter *out,
                             drawingStates *states) {
     FLAG_IGNORED;
     int CMenum;
@@ -2706,7 +2714,7 @@ int U_PMR_SETCLIPRECT_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.1.5, Microsoft name: EmfPlusSetClipRegion Record, Index 0x34
   */
-int U_PMR_SETCLIPREGION_print(const char *contents, FILE *out,
+int U_PMR_SETCLIPREGION_print(const char *contents, svgWriter *out,
                               drawingStates *states) {
     FLAG_IGNORED;
     int CMenum;
@@ -2726,7 +2734,7 @@ int U_PMR_SETCLIPREGION_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.2.1, Microsoft name: EmfPlusComment Record, Index 0x03
   */
-int U_PMR_COMMENT_print(const char *contents, FILE *out,
+int U_PMR_COMMENT_print(const char *contents, svgWriter *out,
                         drawingStates *states) {
     FLAG_IGNORED;
     U_PMF_CMN_HDR Header;
@@ -2757,7 +2765,7 @@ int U_PMR_COMMENT_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.3.1, Microsoft name: EmfPlusEndOfFile Record, Index 0x02
   */
-int U_PMR_ENDOFFILE_print(const char *contents, FILE *out,
+int U_PMR_ENDOFFILE_print(const char *contents, svgWriter *out,
                           drawingStates *states) {
     FLAG_IGNORED;
     return (U_PMR_NODATAREC_print(contents, out, states));
@@ -2769,7 +2777,8 @@ int U_PMR_ENDOFFILE_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.3.2, Microsoft name: EmfPlusGetDC Record, Index 0x04
   */
-int U_PMR_GETDC_print(const char *contents, FILE *out, drawingStates *states) {
+int U_PMR_GETDC_print(const char *contents, svgWriter *out,
+                      drawingStates *states) {
     FLAG_IGNORED;
     return (U_PMR_NODATAREC_print(contents, out, states));
 }
@@ -2780,7 +2789,8 @@ int U_PMR_GETDC_print(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.3.3.3, Microsoft name: EmfPlusHeader Record, Index 0x01
   */
-int U_PMR_HEADER_print(const char *contents, FILE *out, drawingStates *states) {
+int U_PMR_HEADER_print(const char *contents, svgWriter *out,
+                       drawingStates *states) {
     FLAG_IGNORED;
     U_PMF_GRAPHICSVERSION Version;
     int IsDual, IsVideo;
@@ -2805,7 +2815,8 @@ int U_PMR_HEADER_print(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.1, Microsoft name: EmfPlusClear Record, Index 0x09
   */
-int U_PMR_CLEAR_print(const char *contents, FILE *out, drawingStates *states) {
+int U_PMR_CLEAR_print(const char *contents, svgWriter *out,
+                      drawingStates *states) {
     U_PMF_ARGB Color;
     int status = U_PMR_CLEAR_get(contents, NULL, &Color);
     if (status) {
@@ -2823,7 +2834,7 @@ int U_PMR_CLEAR_print(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.2, Microsoft name: EmfPlusDrawArc Record, Index 0x12
   */
-int U_PMR_DRAWARC_print(const char *contents, FILE *out,
+int U_PMR_DRAWARC_print(const char *contents, svgWriter *out,
                         drawingStates *states) {
     FLAG_IGNORED;
     uint32_t PenID;
@@ -2847,7 +2858,7 @@ int U_PMR_DRAWARC_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.3, Microsoft name: EmfPlusDrawBeziers Record, Index 0x19
   */
-int U_PMR_DRAWBEZIERS_print(const char *contents, FILE *out,
+int U_PMR_DRAWBEZIERS_print(const char *contents, svgWriter *out,
                             drawingStates *states) {
     FLAG_IGNORED;
     uint32_t PenID;
@@ -2877,7 +2888,7 @@ http://msdn.microsoft.com/en-us/library/4cf6we5y(v=vs.110).aspx
 
 EMF+ manual 2.3.4.4, Microsoft name: EmfPlusDrawClosedCurve Record, Index 0x17
 */
-int U_PMR_DRAWCLOSEDCURVE_print(const char *contents, FILE *out,
+int U_PMR_DRAWCLOSEDCURVE_print(const char *contents, svgWriter *out,
                                 drawingStates *states) {
     FLAG_IGNORED;
     uint32_t PenID;
@@ -2909,7 +2920,7 @@ http://msdn.microsoft.com/en-us/library/4cf6we5y(v=vs.110).aspx
 
 EMF+ manual 2.3.4.5, Microsoft name: EmfPlusDrawCurve Record, Index 0x18
 */
-int U_PMR_DRAWCURVE_print(const char *contents, FILE *out,
+int U_PMR_DRAWCURVE_print(const char *contents, svgWriter *out,
                           drawingStates *states) {
     FLAG_IGNORED;
     uint32_t PenID;
@@ -2936,7 +2947,7 @@ int U_PMR_DRAWCURVE_print(const char *contents, FILE *out,
   EMF+ manual 2.3.4.6, Microsoft name: EmfPlusDrawDriverString Record, Index
   0x36
   */
-int U_PMR_DRAWDRIVERSTRING_print(const char *contents, FILE *out,
+int U_PMR_DRAWDRIVERSTRING_print(const char *contents, svgWriter *out,
                                  drawingStates *states) {
     FLAG_IGNORED;
     unsigned int i;
@@ -2992,7 +3003,7 @@ int U_PMR_DRAWDRIVERSTRING_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.7, Microsoft name: EmfPlusDrawEllipse Record, Index 0x0F
   */
-int U_PMR_DRAWELLIPSE_print(const char *contents, FILE *out,
+int U_PMR_DRAWELLIPSE_print(const char *contents, svgWriter *out,
                             drawingStates *states) {
     FLAG_IGNORED;
     uint32_t PenID;
@@ -3013,7 +3024,7 @@ int U_PMR_DRAWELLIPSE_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.8, Microsoft name: EmfPlusDrawImage Record, Index 0x1A
   */
-int U_PMR_DRAWIMAGE_print(const char *contents, FILE *out,
+int U_PMR_DRAWIMAGE_print(const char *contents, svgWriter *out,
                           drawingStates *states) {
     FLAG_IGNORED;
     uint32_t ImgID, ImgAttrID;
@@ -3041,7 +3052,7 @@ int U_PMR_DRAWIMAGE_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.9, Microsoft name: EmfPlusDrawImagePoints Record, Index 0x1B
   */
-int U_PMR_DRAWIMAGEPOINTS_print(const char *contents, FILE *out,
+int U_PMR_DRAWIMAGEPOINTS_print(const char *contents, svgWriter *out,
                                 drawingStates *states) {
     FLAG_IGNORED;
     uint32_t ImgID, ImgAttrID;
@@ -3071,7 +3082,7 @@ int U_PMR_DRAWIMAGEPOINTS_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.10, Microsoft name: EmfPlusDrawLines Record, Index 0x0D
   */
-int U_PMR_DRAWLINES_print(const char *contents, FILE *out,
+int U_PMR_DRAWLINES_print(const char *contents, svgWriter *out,
                           drawingStates *states) {
     FLAG_IGNORED;
     uint32_t PenIdx;
@@ -3095,7 +3106,7 @@ int U_PMR_DRAWLINES_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.11, Microsoft name: EmfPlusDrawPath Record, Index 0x15
   */
-int U_PMR_DRAWPATH_print(const char *contents, FILE *out,
+int U_PMR_DRAWPATH_print(const char *contents, svgWriter *out,
                          drawingStates *states) {
     FLAG_IGNORED;
     uint32_t PathIdx, PenIdx;
@@ -3112,7 +3123,7 @@ int U_PMR_DRAWPATH_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.12, Microsoft name: EmfPlusDrawPie Record, Index 0x0D
   */
-int U_PMR_DRAWPIE_print(const char *contents, FILE *out,
+int U_PMR_DRAWPIE_print(const char *contents, svgWriter *out,
                         drawingStates *states) {
     FLAG_IGNORED;
     uint32_t PenID;
@@ -3137,7 +3148,7 @@ int U_PMR_DRAWPIE_print(const char *contents, FILE *out,
   \param blimit      One byte past the last record in memory.
   EMF+ manual 2.3.4.13, Microsoft name: EmfPlusDrawRects Record, Index 0x0B
   */
-int U_PMR_DRAWRECTS_print(const char *contents, FILE *out,
+int U_PMR_DRAWRECTS_print(const char *contents, svgWriter *out,
                           drawingStates *states) {
     FLAG_IGNORED;
     uint32_t PenID;
@@ -3166,7 +3177,7 @@ int U_PMR_DRAWRECTS_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.14, Microsoft name: EmfPlusDrawString Record, Index 0x1C
   */
-int U_PMR_DRAWSTRING_print(const char *contents, FILE *out,
+int U_PMR_DRAWSTRING_print(const char *contents, svgWriter *out,
                            drawingStates *states) {
     FLAG_IGNORED;
     char *String8 = NULL;
@@ -3203,7 +3214,7 @@ int U_PMR_DRAWSTRING_print(const char *contents, FILE *out,
   EMF+ manual 2.3.4.15, Microsoft name: EmfPlusFillClosedCurve Record, Index
   0x16
   */
-int U_PMR_FILLCLOSEDCURVE_print(const char *contents, FILE *out,
+int U_PMR_FILLCLOSEDCURVE_print(const char *contents, svgWriter *out,
                                 drawingStates *states) {
     FLAG_IGNORED;
     uint32_t BrushID;
@@ -3231,7 +3242,7 @@ int U_PMR_FILLCLOSEDCURVE_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.16, Microsoft name: EmfPlusFillEllipse Record, Index 0x0E
   */
-int U_PMR_FILLELLIPSE_print(const char *contents, FILE *out,
+int U_PMR_FILLELLIPSE_print(const char *contents, svgWriter *out,
                             drawingStates *states) {
     FLAG_IGNORED;
     int btype, ctype;
@@ -3254,7 +3265,7 @@ int U_PMR_FILLELLIPSE_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.17, Microsoft name: EmfPlusFillPath Record, Index 0x14
   */
-int U_PMR_FILLPATH_print(const char *contents, FILE *out,
+int U_PMR_FILLPATH_print(const char *contents, svgWriter *out,
                          drawingStates *states) {
     FLAG_IGNORED;
     int btype;
@@ -3274,7 +3285,7 @@ int U_PMR_FILLPATH_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.18, Microsoft name: EmfPlusFillPie Record, Index 0x10
   */
-int U_PMR_FILLPIE_print(const char *contents, FILE *out,
+int U_PMR_FILLPIE_print(const char *contents, svgWriter *out,
                         drawingStates *states) {
     FLAG_IGNORED;
     int btype, ctype;
@@ -3298,7 +3309,7 @@ int U_PMR_FILLPIE_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.19, Microsoft name: EmfPlusFillPolygon Record, Index 0x0C
   */
-int U_PMR_FILLPOLYGON_print(const char *contents, FILE *out,
+int U_PMR_FILLPOLYGON_print(const char *contents, svgWriter *out,
                             drawingStates *states) {
     FLAG_IGNORED;
     int btype, ctype, RelAbs;
@@ -3324,7 +3335,7 @@ int U_PMR_FILLPOLYGON_print(const char *contents, FILE *out,
   \param blimit      One byte past the last record in memory.
   EMF+ manual 2.3.4.20, Microsoft name: EmfPlusFillRects Record, Index 0x0A
   */
-int U_PMR_FILLRECTS_print(const char *contents, FILE *out,
+int U_PMR_FILLRECTS_print(const char *contents, svgWriter *out,
                           drawingStates *states) {
     FLAG_IGNORED;
     int btype, ctype;
@@ -3350,7 +3361,7 @@ int U_PMR_FILLRECTS_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.4.21, Microsoft name: EmfPlusFillRegion Record, Index 0x13
   */
-int U_PMR_FILLREGION_print(const char *contents, FILE *out,
+int U_PMR_FILLREGION_print(const char *contents, svgWriter *out,
                            drawingStates *states) {
     FLAG_IGNORED;
     uint32_t RgnID, BrushID;
@@ -3376,7 +3387,7 @@ int U_PMR_FILLREGION_print(const char *contents, FILE *out,
   EMF+ manual 2.3.5.1, Microsoft name: EmfPlusObject Record, Index 0x13
   */
 int U_PMR_OBJECT_print(const char *contents, const char *blimit,
-                       U_OBJ_ACCUM *ObjCont, int term, FILE *out,
+                       U_OBJ_ACCUM *ObjCont, int term, svgWriter *out,
                        drawingStates *states) {
     U_PMF_CMN_HDR Header;
     uint32_t ObjID;
@@ -3514,7 +3525,7 @@ int U_PMR_OBJECT_print(const char *contents, const char *blimit,
   EMF+ manual 2.3.5.2, Microsoft name: EmfPlusSerializableObject Record, Index
   0x38
   */
-int U_PMR_SERIALIZABLEOBJECT_print(const char *contents, FILE *out,
+int U_PMR_SERIALIZABLEOBJECT_print(const char *contents, svgWriter *out,
                                    drawingStates *states) {
     FLAG_IGNORED;
     uint8_t GUID[16];
@@ -3601,7 +3612,7 @@ int U_PMR_SERIALIZABLEOBJECT_print(const char *contents, FILE *out,
   EMF+ manual 2.3.6.1, Microsoft name: EmfPlusSetAntiAliasMode Record, Index
   0x1E
   */
-int U_PMR_SETANTIALIASMODE_print(const char *contents, FILE *out,
+int U_PMR_SETANTIALIASMODE_print(const char *contents, svgWriter *out,
                                  drawingStates *states) {
     FLAG_IGNORED;
     int SMenum, aatype;
@@ -3620,7 +3631,7 @@ int U_PMR_SETANTIALIASMODE_print(const char *contents, FILE *out,
   EMF+ manual 2.3.6.2, Microsoft name: EmfPlusSetCompositingMode Record, Index
   0x23
   */
-int U_PMR_SETCOMPOSITINGMODE_print(const char *contents, FILE *out,
+int U_PMR_SETCOMPOSITINGMODE_print(const char *contents, svgWriter *out,
                                    drawingStates *states) {
     FLAG_IGNORED;
     int CMenum;
@@ -3638,7 +3649,7 @@ int U_PMR_SETCOMPOSITINGMODE_print(const char *contents, FILE *out,
   EMF+ manual 2.3.6.3, Microsoft name: EmfPlusSetCompositingQuality Record,
   Index 0x24
   */
-int U_PMR_SETCOMPOSITINGQUALITY_print(const char *contents, FILE *out,
+int U_PMR_SETCOMPOSITINGQUALITY_print(const char *contents, svgWriter *out,
                                       drawingStates *states) {
     FLAG_IGNORED;
     int CQenum;
@@ -3656,7 +3667,7 @@ int U_PMR_SETCOMPOSITINGQUALITY_print(const char *contents, FILE *out,
   EMF+ manual 2.3.6.4, Microsoft name: EmfPlusSetInterpolationMode Record, Index
   0x21
   */
-int U_PMR_SETINTERPOLATIONMODE_print(const char *contents, FILE *out,
+int U_PMR_SETINTERPOLATIONMODE_print(const char *contents, svgWriter *out,
                                      drawingStates *states) {
     FLAG_IGNORED;
     int IMenum;
@@ -3674,7 +3685,7 @@ int U_PMR_SETINTERPOLATIONMODE_print(const char *contents, FILE *out,
   EMF+ manual 2.3.6.5, Microsoft name: EmfPlusSetPixelOffsetMode Record, Index
   0x22
   */
-int U_PMR_SETPIXELOFFSETMODE_print(const char *contents, FILE *out,
+int U_PMR_SETPIXELOFFSETMODE_print(const char *contents, svgWriter *out,
                                    drawingStates *states) {
     FLAG_IGNORED;
     int POMenum;
@@ -3692,7 +3703,7 @@ int U_PMR_SETPIXELOFFSETMODE_print(const char *contents, FILE *out,
   EMF+ manual 2.3.6.6, Microsoft name: EmfPlusSetRenderingOrigin Record, Index
   0x1D
   */
-int U_PMR_SETRENDERINGORIGIN_print(const char *contents, FILE *out,
+int U_PMR_SETRENDERINGORIGIN_print(const char *contents, svgWriter *out,
                                    drawingStates *states) {
     FLAG_IGNORED;
     int32_t X, Y;
@@ -3709,7 +3720,7 @@ int U_PMR_SETRENDERINGORIGIN_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.6.7, Microsoft name: EmfPlusSetTextContrast Record, Index 0x20
   */
-int U_PMR_SETTEXTCONTRAST_print(const char *contents, FILE *out,
+int U_PMR_SETTEXTCONTRAST_print(const char *contents, svgWriter *out,
                                 drawingStates *states) {
     FLAG_IGNORED;
     int GC;
@@ -3727,7 +3738,7 @@ int U_PMR_SETTEXTCONTRAST_print(const char *contents, FILE *out,
   EMF+ manual 2.3.6.8, Microsoft name: EmfPlusSetTextRenderingHint Record, Index
   0x1F
   */
-int U_PMR_SETTEXTRENDERINGHINT_print(const char *contents, FILE *out,
+int U_PMR_SETTEXTRENDERINGHINT_print(const char *contents, svgWriter *out,
                                      drawingStates *states) {
     FLAG_IGNORED;
     int TRHenum;
@@ -3744,7 +3755,7 @@ int U_PMR_SETTEXTRENDERINGHINT_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.7.1, Microsoft name: EmfPlusBeginContainer Record, Index 0x27
   */
-int U_PMR_BEGINCONTAINER_print(const char *contents, FILE *out,
+int U_PMR_BEGINCONTAINER_print(const char *contents, svgWriter *out,
                                drawingStates *states) {
     FLAG_IGNORED;
     int UTenum;
@@ -3770,7 +3781,7 @@ int U_PMR_BEGINCONTAINER_print(const char *contents, FILE *out,
   EMF+ manual 2.3.7.2, Microsoft name: EmfPlusBeginContainerNoParams Record,
   Index 0x28
   */
-int U_PMR_BEGINCONTAINERNOPARAMS_print(const char *contents, FILE *out,
+int U_PMR_BEGINCONTAINERNOPARAMS_print(const char *contents, svgWriter *out,
                                        drawingStates *states) {
     FLAG_IGNORED;
     uint32_t StackID;
@@ -3787,7 +3798,7 @@ int U_PMR_BEGINCONTAINERNOPARAMS_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.7.3, Microsoft name: EmfPlusEndContainer Record, Index 0x29
   */
-int U_PMR_ENDCONTAINER_print(const char *contents, FILE *out,
+int U_PMR_ENDCONTAINER_print(const char *contents, svgWriter *out,
                              drawingStates *states) {
     FLAG_IGNORED;
     uint32_t StackID;
@@ -3804,7 +3815,7 @@ int U_PMR_ENDCONTAINER_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.7.4, Microsoft name: EmfPlusRestore Record, Index 0x26
   */
-int U_PMR_RESTORE_print(const char *contents, FILE *out,
+int U_PMR_RESTORE_print(const char *contents, svgWriter *out,
                         drawingStates *states) {
     FLAG_IGNORED;
     uint32_t StackID;
@@ -3821,7 +3832,8 @@ int U_PMR_RESTORE_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.7.5, Microsoft name: EmfPlusSave Record, Index 0x25
   */
-int U_PMR_SAVE_print(const char *contents, FILE *out, drawingStates *states) {
+int U_PMR_SAVE_print(const char *contents, svgWriter *out,
+                     drawingStates *states) {
     FLAG_IGNORED;
     uint32_t StackID;
     int status = U_PMR_SAVE_get(contents, NULL, &StackID);
@@ -3837,7 +3849,7 @@ int U_PMR_SAVE_print(const char *contents, FILE *out, drawingStates *states) {
   \param  contents   Record from which to print data
   EMF+ manual 2.3.8.1, Microsoft name: EmfPlusSetTSClip Record, Index 0x3A
   */
-int U_PMR_SETTSCLIP_print(const char *contents, FILE *out,
+int U_PMR_SETTSCLIP_print(const char *contents, svgWriter *out,
                           drawingStates *states) {
     FLAG_IGNORED;
     int ctype;
@@ -3859,7 +3871,7 @@ int U_PMR_SETTSCLIP_print(const char *contents, FILE *out,
   \param  contents   Record from which to print data
   EMF+ manual 2.3.8.2, Microsoft name: EmfPlusSetTSGraphics Record, Index 0x39
   */
-int U_PMR_SETTSGRAPHICS_print(const char *contents, FILE *out,
+int U_PMR_SETTSGRAPHICS_print(const char *contents, svgWriter *out,
                               drawingStates *states) {
     FLAG_IGNORED;
     int vgatype, pptype;
@@ -3899,7 +3911,7 @@ int U_PMR_SETTSGRAPHICS_print(const char *contents, FILE *out,
   EMF+ manual 2.3.9.1, Microsoft name: EmfPlusMultiplyWorldTransform Record,
   Index 0x2C
   */
-int U_PMR_MULTIPLYWORLDTRANSFORM_print(const char *contents, FILE *out,
+int U_PMR_MULTIPLYWORLDTRANSFORM_print(const char *contents, svgWriter *out,
                                        drawingStates *states) {
     FLAG_IGNORED;
     int xmtype;
@@ -3922,7 +3934,7 @@ int U_PMR_MULTIPLYWORLDTRANSFORM_print(const char *contents, FILE *out,
   EMF+ manual 2.3.9.2, Microsoft name: EmfPlusResetWorldTransform Record, Index
   0x2B
   */
-int U_PMR_RESETWORLDTRANSFORM_print(const char *contents, FILE *out,
+int U_PMR_RESETWORLDTRANSFORM_print(const char *contents, svgWriter *out,
                                     drawingStates *states) {
     FLAG_IGNORED;
     return (U_PMR_NODATAREC_print(contents, out, states));
@@ -3935,7 +3947,7 @@ int U_PMR_RESETWORLDTRANSFORM_print(const char *contents, FILE *out,
   EMF+ manual 2.3.9.3, Microsoft name: EmfPlusRotateWorldTransform Record, Index
   0x2F
   */
-int U_PMR_ROTATEWORLDTRANSFORM_print(const char *contents, FILE *out,
+int U_PMR_ROTATEWORLDTRANSFORM_print(const char *contents, svgWriter *out,
                                      drawingStates *states) {
     FLAG_IGNORED;
     int xmtype;
@@ -3956,7 +3968,7 @@ int U_PMR_ROTATEWORLDTRANSFORM_print(const char *contents, FILE *out,
   EMF+ manual 2.3.9.4, Microsoft name: EmfPlusScaleWorldTransform Record, Index
   0x2E
   */
-int U_PMR_SCALEWORLDTRANSFORM_print(const char *contents, FILE *out,
+int U_PMR_SCALEWORLDTRANSFORM_print(const char *contents, svgWriter *out,
                                     drawingStates *states) {
     FLAG_IGNORED;
     int xmtype;
@@ -3977,7 +3989,7 @@ int U_PMR_SCALEWORLDTRANSFORM_print(const char *contents, FILE *out,
   EMF+ manual 2.3.9.5, Microsoft name: EmfPlusSetPageTransform Record, Index
   0x30
   */
-int U_PMR_SETPAGETRANSFORM_print(const char *contents, FILE *out,
+int U_PMR_SETPAGETRANSFORM_print(const char *contents, svgWriter *out,
                                  drawingStates *states) {
     FLAG_IGNORED;
     int UTenum;
@@ -3996,7 +4008,7 @@ int U_PMR_SETPAGETRANSFORM_print(const char *contents, FILE *out,
   EMF+ manual 2.3.9.6, Microsoft name: EmfPlusSetWorldTransform Record, Index
   0x2A
   */
-int U_PMR_SETWORLDTRANSFORM_print(const char *contents, FILE *out,
+int U_PMR_SETWORLDTRANSFORM_print(const char *contents, svgWriter *out,
                                   drawingStates *states) {
     FLAG_IGNORED;
     U_PMF_TRANSFORMMATRIX Matrix;
@@ -4016,7 +4028,7 @@ int U_PMR_SETWORLDTRANSFORM_print(const char *contents, FILE *out,
   EMF+ manual 2.3.9.7, Microsoft name: EmfPlusTranslateWorldTransform Record,
   Index 0x2D
   */
-int U_PMR_TRANSLATEWORLDTRANSFORM_print(const char *contents, FILE *out,
+int U_PMR_TRANSLATEWORLDTRANSFORM_print(const char *contents, svgWriter *out,
                                         drawingStates *states) {
     FLAG_IGNORED;
     int xmtype;
@@ -4038,7 +4050,7 @@ int U_PMR_TRANSLATEWORLDTRANSFORM_print(const char *contents, FILE *out,
   \return 1 on success, 0 on error
   \param  contents    Record from which to print data
   */
-int U_PMR_STROKEFILLPATH_print(const char *contents, FILE *out,
+int U_PMR_STROKEFILLPATH_print(const char *contents, svgWriter *out,
                                drawingStates *states) {
     FLAG_IGNORED;
     return (U_PMR_NODATAREC_print(contents, out, states));
@@ -4051,7 +4063,7 @@ int U_PMR_STROKEFILLPATH_print(const char *contents, FILE *out,
   EMF+ manual mentioned in 2.1.1.1, reserved, not otherwise documented,
   Microsoft name: EmfPlusMultiFormatStart Record, Index 0x05
   */
-int U_PMR_MULTIFORMATSTART_print(const char *contents, FILE *out,
+int U_PMR_MULTIFORMATSTART_print(const char *contents, svgWriter *out,
                                  drawingStates *states) {
     FLAG_IGNORED;
     return (U_PMR_NODATAREC_print(contents, out, states));
@@ -4064,7 +4076,7 @@ int U_PMR_MULTIFORMATSTART_print(const char *contents, FILE *out,
   EMF+ manual mentioned in 2.1.1.1, reserved, not otherwise documented,
   Microsoft name: EmfPlusMultiFormatSection Record, Index 0x06
   */
-int U_PMR_MULTIFORMATSECTION_print(const char *contents, FILE *out,
+int U_PMR_MULTIFORMATSECTION_print(const char *contents, svgWriter *out,
                                    drawingStates *states) {
     FLAG_IGNORED;
     return (U_PMR_NODATAREC_print(contents, out, states));
@@ -4077,7 +4089,7 @@ int U_PMR_MULTIFORMATSECTION_print(const char *contents, FILE *out,
   EMF+ manual mentioned in 2.1.1.1, reserved, not otherwise documented,
   Microsoft name: EmfPlusMultiFormatEnd Record, Index 0x06
   */
-int U_PMR_MULTIFORMATEND_print(const char *contents, FILE *out,
+int U_PMR_MULTIFORMATEND_print(const char *contents, svgWriter *out,
                                drawingStates *states) {
     FLAG_IGNORED;
     return (U_PMR_NODATAREC_print(contents, out, states));
@@ -1,11 +1,1065 @@
+#ifndef DARWIN
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include <emf2svg.h>
+#include <emf2svg_private.h>
+#include <math.h>
+#include <png.h>
+#include <zlib.h>
 #include <sys/stat.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/mman.h>
 
+/* parallel conversion of emf (as in emf2svg() with options->index) where
+ * the first range has a clip the snapshots do not have: the ranges after
+ * it do not match and are dropped, the first one goes on to the end (NULL
+ * if the records are not converted over threads) */
+static char *parallel_fallback(char *emf, size_t size, generatorIndex *index,
+        generatorOptions *options, size_t *len){
+    svgWriter out;
+    drawingStates *states = states_new(emf, size, NULL, options);
+    if (states == NULL || !svg_writer_init(&out, NULL, NULL, NULL))
+        abort();
+    states->emfStructure.paths = (pathStruct *)index->pathData;
+    states->emfStructure.count = index->pathCount;
+    states->inPath = index->pathCount &&
+        index->paths[index->pathCount - 1].end == UINT32_MAX;
+    setTransformIdentity(states);
+    states->currentDeviceContext.dirty = DC_DIRTY_ALL;
+    if (!parallel_enabled(states, index, options)){
+        states_free(states);
+        svg_writer_free(&out);
+        return NULL;
+    }
+    /* far from any drawing, never used */
+    PATH *unused = NULL;
+    add_new_seg(&unused, SEG_MOVE);
+    unused->last->section.points->x = -1e9;
+    unused->last->section.points->y = -1e9;
+    add_new_seg(&unused, SEG_END);
+    if (clip_library_add(states, unused, hash_path(unused), false) == NULL)
+        abort();
+    free_path(&unused);
+    int recnum = 0;
+    parallel_draw(emf, size, index, &out, states, options, &recnum);
+    states_free(states);
+    if (!svg_writer_close(&out))
+        abort();
+    *len = out.len;
+    return out.buf;
+}
+
+/* trace callback, checks the decoded fields of the records (the verbose
+ * output goes to the events instead of stdout) */
+static void check_event(const generatorTraceEvent *event, void *ctx){
+    size_t *events = (size_t *)ctx;
+    (*events)++;
+    for(size_t i = 0; i < event->fieldCount; i++){
+        if (event->fields[i].name == NULL || event->fields[i].value == NULL)
+            abort();
+    }
+}
+
+/* progress callback cancelling the conversion */
+static bool cancel_progress(size_t offset, size_t length, size_t records,
+                            void *ctx){
+    (void)offset; (void)length; (void)ctx;
+    return records > 0;
+}
+
+/* winding number of the point (x, y) for the polygons of path */
+static int path_winding(PATH *path, double x, double y){
+    int w = 0;
+    POINT_D start = {0, 0}, cur = {0, 0};
+    for(PATH *p = path; p != NULL; p = p->next){
+        if (p->section.type == SEG_MOVE){
+            start = cur = p->section.points[0];
+            continue;
+        }
+        POINT_D next = p->section.type == SEG_END ? start :
+            p->section.points[0];
+        if ((cur.y <= y) != (next.y <= y) &&
+            cur.x + (y - cur.y) * (next.x - cur.x) / (next.y - cur.y) > x)
+            w += next.y > cur.y ? 1 : -1;
+        cur = next;
+    }
+    return w;
+}
+
+/* distance of the point (x, y) to the edges of path */
+static double path_distance(PATH *path, double x, double y){
+    double d = INFINITY;
+    POINT_D start = {0, 0}, cur = {0, 0};
+    for(PATH *p = path; p != NULL; p = p->next){
+        if (p->section.type == SEG_MOVE){
+            start = cur = p->section.points[0];
+            continue;
+        }
+        POINT_D next = p->section.type == SEG_END ? start :
+            p->section.points[0];
+        double dx = next.x - cur.x, dy = next.y - cur.y;
+        double t = dx || dy ?
+            ((x - cur.x) * dx + (y - cur.y) * dy) / (dx * dx + dy * dy) : 0;
+        t = t < 0 ? 0 : t > 1 ? 1 : t;
+        d = fmin(d, hypot(cur.x + t * dx - x, cur.y + t * dy - y));
+        cur = next;
+    }
+    return d;
+}
+
+/* random self-intersecting polygons, on a grid half of the time to get
+ * shared vertices and overlapping edges */
+static PATH *random_polygons(int grid){
+    PATH *path = NULL;
+    int subpaths = 1 + rand() % 2;
+    for(int i = 0; i < subpaths; i++){
+        int n = 3 + rand() % 10;
+        for(int j = 0; j < n; j++){
+            add_new_seg(&path, j ? SEG_LINE : SEG_MOVE);
+            POINT_D *pt = path->last->section.points;
+            pt->x = grid ? rand() % 11 * 10 : rand() % 100001 / 1000.0;
+            pt->y = grid ? rand() % 11 * 10 : rand() % 100001 / 1000.0;
+        }
+        add_new_seg(&path, SEG_END);
+    }
+    return path;
+}
+
+/* the clipping regions (polygon boolean operations) are checked against
+ * point sampling */
+static void check_region_mix(void){
+    static const uint32_t modes[] = {U_RGN_AND, U_RGN_OR, U_RGN_XOR,
+        U_RGN_DIFF, U_RGN_COPY};
+    srand(1);
+    for(int i = 0; i < 400; i++){
+        PATH *a = random_polygons(i & 4), *b = random_polygons(i & 4);
+        int fill_a = i & 1, fill_b = (i >> 1) & 1;
+        uint32_t mode = modes[i % 5];
+        bool error;
+        PATH *r = region_mix(a, fill_a, b, fill_b, mode, 0, &error);
+        if (error){fprintf(stderr, "region_mix failed\n"); abort();}
+        for(int j = 0; j < 400; j++){
+            double x = rand() % 1000001 / 10000.0;
+            double y = rand() % 1000001 / 10000.0;
+            if (path_distance(a, x, y) < 1e-4 || path_distance(b, x, y) < 1e-4)
+                continue;
+            int wa = path_winding(a, x, y), wb = path_winding(b, x, y);
+            bool in_a = fill_a == RGN_FILL_EVENODD ? wa & 1 : wa != 0;
+            bool in_b = fill_b == RGN_FILL_EVENODD ? wb & 1 : wb != 0;
+            bool expected = mode == U_RGN_AND ? in_a && in_b :
+                mode == U_RGN_OR ? in_a || in_b :
+                mode == U_RGN_XOR ? in_a != in_b :
+                mode == U_RGN_DIFF ? in_a && !in_b : in_b;
+            if (expected != (path_winding(r, x, y) != 0)){
+                fprintf(stderr, "wrong region at (%g, %g), mode %u\n", x, y,
+                        mode);
+                abort();
+            }
+        }
+        free_path(&a);
+        free_path(&b);
+        free_path(&r);
+    }
+}
+
+/* the clipping region of sequences of clipping records, starting without
+ * clipping region (the whole plane), is checked against point sampling */
+static void check_clip_mix(void){
+    static const uint32_t modes[] = {U_RGN_AND, U_RGN_OR, U_RGN_XOR,
+        U_RGN_DIFF, U_RGN_COPY};
+    drawingStates *states = calloc(1, sizeof(drawingStates));
+    EMF_DEVICE_CONTEXT *dc = &(states->currentDeviceContext);
+    srand(2);
+    for(int i = 0; i < 200; i++){
+        PATH *ops[4];
+        uint32_t op_modes[4];
+        for(int k = 0; k < 4; k++){
+            if (rand() % 2){
+                /* INTERSECTCLIPRECT / EXCLUDECLIPRECT */
+                POINT_D a = {rand() % 11 * 10, rand() % 11 * 10};
+                POINT_D b = {rand() % 11 * 10, rand() % 11 * 10};
+                RECT_D rect = rect_d(a, b);
+                op_modes[k] = rand() % 2 ? U_RGN_AND : U_RGN_DIFF;
+                ops[k] = NULL;
+                add_new_seg(&ops[k], SEG_MOVE);
+                ops[k]->last->section.points[0] = (POINT_D){rect.left, rect.top};
+                add_new_seg(&ops[k], SEG_LINE);
+                ops[k]->last->section.points[0] = (POINT_D){rect.right, rect.top};
+                add_new_seg(&ops[k], SEG_LINE);
+                ops[k]->last->section.points[0] =
+                    (POINT_D){rect.right, rect.bottom};
+                add_new_seg(&ops[k], SEG_LINE);
+                ops[k]->last->section.points[0] =
+                    (POINT_D){rect.left, rect.bottom};
+                add_new_seg(&ops[k], SEG_END);
+                clip_rgn_rect_mix(states, rect, op_modes[k]);
+            } else {
+                /* SELECTCLIPPATH */
+                op_modes[k] = modes[rand() % 5];
+                ops[k] = random_polygons(rand() % 2);
+                clip_rgn_mix(states, ops[k], op_modes[k]);
+            }
+        }
+        if (states->Error){fprintf(stderr, "clip_rgn_mix failed\n"); abort();}
+        for(int j = 0; j < 400; j++){
+            double x = rand() % 1200001 / 10000.0 - 10;
+            double y = rand() % 1200001 / 10000.0 - 10;
+            bool expected = true, near = false;
+            for(int k = 0; k < 4; k++){
+                near = near || path_distance(ops[k], x, y) < 1e-4;
+                bool in = path_winding(ops[k], x, y) != 0;
+                uint32_t mode = op_modes[k];
+                expected = mode == U_RGN_AND ? expected && in :
+                    mode == U_RGN_OR ? expected || in :
+                    mode == U_RGN_XOR ? expected != in :
+                    mode == U_RGN_DIFF ? expected && !in : in;
+            }
+            if (near)
+                continue;
+            bool inside = dc->clipRGN == NULL ||
+                ((path_winding(dc->clipRGN, x, y) != 0) != dc->clipInverted);
+            if (expected != inside){
+                fprintf(stderr, "wrong clipping region at (%g, %g)\n", x, y);
+                abort();
+            }
+        }
+        for(int k = 0; k < 4; k++)
+            free_path(&ops[k]);
+        freeDeviceContext(dc);
+        memset(dc, 0, sizeof(*dc));
+    }
+    free(states);
+}
+
+/* compact path data (relative coordinates) parsed back, the rounding of
+ * the coordinates must stay under 0.05 pixel after the world transform */
+static void check_path_data(void){
+    static const U_XFORM transforms[] = {{1, 0, 0, 1, 0, 0},
+        {109.2323f, 0, 0, 78.9413f, 0, 0}, {43.3f, 25, -25, 43.3f, 0, 0},
+        {0.01f, 0, 0, -0.01f, 0, 0}};
+    drawingStates *states = calloc(1, sizeof(drawingStates));
+    states->MapMode = U_MM_TEXT;
+    states->scaling = 1;
+    states->compactPaths = true;
+    srand(3);
+    for(size_t t = 0; t < sizeof(transforms) / sizeof(transforms[0]); t++){
+        U_XFORM w = transforms[t];
+        states->currentDeviceContext.worldTransform = w;
+        POINT_D pts[200];
+        svgWriter out;
+        svg_writer_init(&out, NULL, NULL, NULL);
+        emfPathData pd;
+        path_data_start(states, &pd);
+        for(int i = 0; i < 200; i++){
+            pts[i].x = rand() % 2000001 / 10000.0 - 100;
+            pts[i].y = rand() % 2000001 / 10000.0 - 100;
+            path_data_cmd(&pd, &out, i ? 'L' : 'M');
+            path_data_point(&pd, &out, pts[i]);
+        }
+        path_data_end(&pd, &out, true);
+        svg_append(&out, "", 1);
+
+        /* only m, l and z are written for moves and lines */
+        const char *c = out.buf;
+        double x = 0, y = 0;
+        for(int i = 0; i < 200; i++){
+            while (*c == 'm' || *c == 'l' || *c == ' ')
+                c++;
+            char *end;
+            x += strtod(c, &end);
+            y += strtod(end, &end);
+            c = end;
+            double dx = x - pts[i].x, dy = y - pts[i].y;
+            if (fabs(w.eM11 * dx + w.eM21 * dy) > 0.05 ||
+                fabs(w.eM12 * dx + w.eM22 * dy) > 0.05){
+                fprintf(stderr, "path data rounding too large (%g, %g)\n",
+                        dx, dy);
+                abort();
+            }
+        }
+        if (strcmp(c, "z\" ") != 0){
+            fprintf(stderr, "unexpected path data end '%s'\n", c);
+            abort();
+        }
+        svg_writer_free(&out);
+    }
+    free(states);
+}
+
+/* EMF files drawn with the libuemf record builders, for the conversions
+ * checked against what was drawn */
+typedef bool (*emf_draw)(EMFTRACK *et);
+
+static bool emf_record(char *rec, EMFTRACK *et){
+    return rec != NULL &&
+        emf_append((PU_ENHMETARECORD)rec, et, U_REC_FREE) == 0;
+}
+
+/* 100x100 mm at 10 px/mm, MM_TEXT: one logical unit is one pixel */
+static char *build_emf(emf_draw draw, size_t *size){
+    char name[] = "/tmp/emf2svg-test-XXXXXX";
+    int fd = mkstemp(name);
+    if (fd < 0){fprintf(stderr, "temporary file failed\n"); exit(1);}
+    close(fd);
+    EMFTRACK *et = NULL;
+    EMFHANDLES *eht = NULL;
+    U_SIZEL szlDev, szlMm;
+    U_RECTL rclBounds, rclFrame;
+    device_size(100, 100, 10, &szlDev, &szlMm);
+    drawing_size(100, 100, 10, &rclBounds, &rclFrame);
+    bool ok = emf_start(name, 1 << 16, 1 << 16, &et) == 0 &&
+        emf_htable_create(128, 128, &eht) == 0 &&
+        emf_record(U_EMRHEADER_set(rclBounds, rclFrame, NULL, 0, NULL,
+                                   szlDev, szlMm, 0), et) &&
+        emf_record(U_EMRSETMAPMODE_set(U_MM_TEXT), et) &&
+        draw(et) &&
+        emf_record(U_EMREOF_set(0, NULL, et), et) &&
+        emf_finish(et, eht) == 0;
+    if (et != NULL)
+        emf_free(&et);
+    if (eht != NULL)
+        emf_htable_free(&eht);
+
+    struct stat s;
+    char *emf = NULL;
+    FILE *f = fopen(name, "rb");
+    if (ok && f != NULL && stat(name, &s) == 0){
+        *size = s.st_size;
+        emf = malloc(*size);
+        ok = emf != NULL && fread(emf, 1, *size, f) == *size;
+    }
+    if (f != NULL)
+        fclose(f);
+    remove(name);
+    if (!ok || emf == NULL){fprintf(stderr, "EMF build failed\n"); exit(1);}
+    return emf;
+}
+
+static char *convert_emf(const char *emf, size_t size,
+                         generatorOptions *options, size_t *len){
+    char *out = NULL;
+    if (!emf2svg((char *)emf, size, &out, len, options) || out == NULL){
+        fprintf(stderr, "conversion of a built EMF failed\n");
+        abort();
+    }
+    return out;
+}
+
+/* points of a "M x,y L x,y ... Z" path data, up to max */
+static size_t path_points(const char *d, POINT_D *pts, size_t max){
+    size_t n = 0;
+    while (*d != '\0' && *d != '"'){
+        if (*d == 'M' || *d == 'L' || *d == ' ' || *d == 'Z'){
+            d++;
+            continue;
+        }
+        char *end;
+        double x = strtod(d, &end);
+        if (end == d || *end != ',' || n == max)
+            break;
+        pts[n].x = x;
+        pts[n].y = strtod(end + 1, &end);
+        n++;
+        d = end;
+    }
+    return n;
+}
+
+/* value of attribute name in the element starting at elt */
+static double attr_number(const char *elt, const char *name){
+    char key[32];
+    snprintf(key, sizeof(key), " %s=\"", name);
+    const char *a = strstr(elt, key);
+    if (a == NULL || a > strchr(elt, '>')){
+        fprintf(stderr, "missing attribute '%s'\n", name);
+        abort();
+    }
+    return strtod(a + strlen(key), NULL);
+}
+
+/* black, white and gray: vertex colors on a line of the RGB space */
+static U_TRIVERTEX gradient_tri[] = {{100, 100, 0, 0, 0, 0},
+    {700, 200, 0xff00, 0xff00, 0xff00, 0},
+    {250, 600, 0x8000, 0x8000, 0x8000, 0}};
+static uint32_t gradient_tri_obj[] = {0, 1, 2};
+/* red to blue ramp, a rectangle made of two triangles */
+static U_TRIVERTEX gradient_ramp[] = {{100, 700, 0xff00, 0, 0, 0},
+    {900, 700, 0, 0, 0xff00, 0}, {900, 900, 0, 0, 0xff00, 0},
+    {100, 900, 0xff00, 0, 0, 0}};
+static uint32_t gradient_ramp_obj[] = {0, 1, 2, 0, 2, 3};
+
+static bool draw_gradient(EMFTRACK *et){
+    U_RECTL tri_bounds = {100, 100, 700, 600};
+    U_RECTL ramp_bounds = {100, 700, 900, 900};
+    return emf_record(U_EMRGRADIENTFILL_set(tri_bounds, 3, 1,
+                U_GRADIENT_FILL_TRIANGLE, gradient_tri, gradient_tri_obj),
+                      et) &&
+        emf_record(U_EMRGRADIENTFILL_set(ramp_bounds, 4, 2,
+                U_GRADIENT_FILL_TRIANGLE, gradient_ramp, gradient_ramp_obj),
+                   et);
+}
+
+/* the color of the gradient at each vertex is the vertex color, the ramp
+ * over two triangles being one path */
+static void check_gradient(void){
+    size_t emf_size, svg_len;
+    char *emf = build_emf(draw_gradient, &emf_size);
+    generatorOptions *options = calloc(1, sizeof(generatorOptions));
+    options->svgDelimiter = true;
+    char *svg = convert_emf(emf, emf_size, options, &svg_len);
+
+    const char *p = svg;
+    int paths = 0;
+    while ((p = strstr(p, "<path d=\"")) != NULL && paths < 2){
+        const U_TRIVERTEX *vertices = paths ? gradient_ramp : gradient_tri;
+        const uint32_t *order = paths ? gradient_ramp_obj : gradient_tri_obj;
+        size_t expected_n = paths ? 6 : 3;
+        POINT_D pts[6];
+        size_t n = path_points(p + 9, pts, 6);
+        if (n != expected_n){
+            fprintf(stderr, "unexpected gradient path '%.80s'\n", p);
+            abort();
+        }
+        /* gradient of the path, in bounding box units */
+        unsigned id, from, to;
+        const char *fill = strstr(p, "fill=\"url(#grad-");
+        if (fill == NULL || sscanf(fill, "fill=\"url(#grad-%u)", &id) != 1){
+            fprintf(stderr, "gradient path without gradient\n");
+            abort();
+        }
+        char key[32];
+        snprintf(key, sizeof(key), " id=\"grad-%u\"", id);
+        const char *grad = strstr(svg, key);
+        const char *stop0 = grad ? strstr(grad, "stop-color=\"#") : NULL;
+        const char *stop1 = stop0 ? strstr(stop0 + 1, "stop-color=\"#") : NULL;
+        if (stop1 == NULL || sscanf(stop0, "stop-color=\"#%6x", &from) != 1 ||
+            sscanf(stop1, "stop-color=\"#%6x", &to) != 1){
+            fprintf(stderr, "gradient %u not defined\n", id);
+            abort();
+        }
+        double x1 = attr_number(grad, "x1"), y1 = attr_number(grad, "y1");
+        double x2 = attr_number(grad, "x2"), y2 = attr_number(grad, "y2");
+        RECT_D box = {pts[0].x, pts[0].y, pts[0].x, pts[0].y};
+        for (size_t i = 1; i < n; i++){
+            box.left = fmin(box.left, pts[i].x);
+            box.right = fmax(box.right, pts[i].x);
+            box.top = fmin(box.top, pts[i].y);
+            box.bottom = fmax(box.bottom, pts[i].y);
+        }
+        for (size_t i = 0; i < n; i++){
+            const U_TRIVERTEX *v = &vertices[order[i]];
+            double bx = (pts[i].x - box.left) / (box.right - box.left);
+            double by = (pts[i].y - box.top) / (box.bottom - box.top);
+            double s = ((bx - x1) * (x2 - x1) + (by - y1) * (y2 - y1)) /
+                ((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1));
+            s = fmin(1, fmax(0, s));
+            uint16_t expected[3] = {v->Red, v->Green, v->Blue};
+            for (int c = 0; c < 3; c++){
+                int shift = 16 - 8 * c;
+                double a = (from >> shift) & 0xff, b = (to >> shift) & 0xff;
+                if (fabs(a + (b - a) * s - expected[c] / 257.0) > 1.5){
+                    fprintf(stderr, "gradient color off at vertex %zu\n", i);
+                    abort();
+                }
+            }
+        }
+        paths++;
+        p++;
+    }
+    if (paths != 2 || p != NULL){
+        fprintf(stderr, "gradient triangles not drawn as two paths\n");
+        abort();
+    }
+    free(svg);
+    free(options);
+    free(emf);
+}
+
+/* pixels set by EMR_SETPIXELV, one logical unit each, the last ten set
+ * again with another color */
+#define PIXEL_COUNT 40
+static U_POINTL pixel_point(int i){
+    U_POINTL pt = {300 + (i % 30 * 7) % 23, 400 + (i % 30 * 5) % 11};
+    return pt;
+}
+
+static U_COLORREF pixel_color(int i){
+    return U_RGB(i * 6, 255 - i * 6, (i * 37) % 256);
+}
+
+static bool draw_pixels(EMFTRACK *et){
+    bool ok = true;
+    for (int i = 0; i < PIXEL_COUNT; i++)
+        ok = ok && emf_record(U_EMRSETPIXELV_set(pixel_point(i),
+                                                 pixel_color(i)), et);
+    return ok;
+}
+
+static size_t base64_decode(const char *in, unsigned char *out){
+    static const char *digits =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t n = 0;
+    uint32_t acc = 0;
+    int bits = 0;
+    for (; *in != '\0' && *in != '"' && *in != '='; in++){
+        const char *d = strchr(digits, *in);
+        if (d == NULL)
+            break;
+        acc = (acc << 6) | (uint32_t)(d - digits);
+        bits += 6;
+        if (bits >= 8){
+            bits -= 8;
+            out[n++] = (unsigned char)(acc >> bits);
+        }
+    }
+    return n;
+}
+
+/* a run of pixels is one png image, decoded back to the same pixels */
+static void check_pixels(void){
+    size_t emf_size, svg_len;
+    char *emf = build_emf(draw_pixels, &emf_size);
+    generatorOptions *options = calloc(1, sizeof(generatorOptions));
+    options->svgDelimiter = true;
+    char *svg = convert_emf(emf, emf_size, options, &svg_len);
+
+    const char *image = strstr(svg, "<image ");
+    const char *data = image ? strstr(image, "base64,") : NULL;
+    if (data == NULL || strstr(data, "<image ") != NULL){
+        fprintf(stderr, "pixels not drawn as one image\n");
+        abort();
+    }
+    U_RECTL box = {300, 400, 300, 400};
+    for (int i = 0; i < PIXEL_COUNT; i++){
+        U_POINTL pt = pixel_point(i);
+        box.left = pt.x < box.left ? pt.x : box.left;
+        box.right = pt.x > box.right ? pt.x : box.right;
+        box.top = pt.y < box.top ? pt.y : box.top;
+        box.bottom = pt.y > box.bottom ? pt.y : box.bottom;
+    }
+    int width = box.right - box.left + 1, height = box.bottom - box.top + 1;
+    if (attr_number(image, "x") != box.left ||
+        attr_number(image, "y") != box.top ||
+        attr_number(image, "width") != width ||
+        attr_number(image, "height") != height){
+        fprintf(stderr, "pixel image misplaced\n");
+        abort();
+    }
+
+    unsigned char *png = malloc(strlen(data));
+    size_t png_size = base64_decode(data + 7, png);
+    png_image decoded = {0};
+    decoded.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_memory(&decoded, png, png_size) ||
+        (int)decoded.width != width || (int)decoded.height != height){
+        fprintf(stderr, "pixel image not a %dx%d png\n", width, height);
+        abort();
+    }
+    decoded.format = PNG_FORMAT_RGBA;
+    unsigned char *rgba = calloc(width * height, 4);
+    if (!png_image_finish_read(&decoded, NULL, rgba, 0, NULL)){
+        fprintf(stderr, "pixel image decoding failed\n");
+        abort();
+    }
+    /* pixels set last win, the others are transparent */
+    unsigned char *expected = calloc(width * height, 4);
+    for (int i = 0; i < PIXEL_COUNT; i++){
+        U_POINTL pt = pixel_point(i);
+        U_COLORREF color = pixel_color(i);
+        unsigned char *px =
+            &expected[((pt.y - box.top) * width + pt.x - box.left) * 4];
+        px[0] = color.Red;
+        px[1] = color.Green;
+        px[2] = color.Blue;
+        px[3] = 0xff;
+    }
+    for (int i = 0; i < width * height; i++){
+        if (rgba[i * 4 + 3] != expected[i * 4 + 3] ||
+            (expected[i * 4 + 3] && memcmp(&rgba[i * 4], &expected[i * 4], 3))){
+            fprintf(stderr, "pixel %d,%d differs\n", i % width, i / width);
+            abort();
+        }
+    }
+    free(expected);
+    free(rgba);
+    free(png);
+    free(svg);
+    free(options);
+    free(emf);
+}
+
+/* noisy sine wave, one point per pixel */
+#define SIMPLIFY_COUNT 980
+static U_POINTL simplify_point(int i){
+    U_POINTL pt = {10 + i, 500 + (int)lround(300 * sin(i / 60.0)) +
+        (i * 7919) % 5 - 2};
+    return pt;
+}
+
+static bool draw_polyline(EMFTRACK *et){
+    U_POINTL pts[SIMPLIFY_COUNT];
+    U_RECTL bounds = {10, 198, 10 + SIMPLIFY_COUNT - 1, 802};
+    for (int i = 0; i < SIMPLIFY_COUNT; i++)
+        pts[i] = simplify_point(i);
+    return emf_record(U_EMRPOLYLINE_set(bounds, SIMPLIFY_COUNT, pts), et);
+}
+
+/* the simplified polyline keeps the end points, only has points of the
+ * original one and is within the tolerance of all of them */
+static void check_simplify(void){
+    static const double tolerances[] = {0.5, 1.5, 4, 20};
+    size_t emf_size, svg_len;
+    char *emf = build_emf(draw_polyline, &emf_size);
+    generatorOptions *options = calloc(1, sizeof(generatorOptions));
+    options->svgDelimiter = true;
+    size_t previous = SIMPLIFY_COUNT;
+    for (size_t t = 0; t < sizeof(tolerances) / sizeof(tolerances[0]); t++){
+        double tolerance = tolerances[t];
+        options->simplifyTolerance = tolerance;
+        char *svg = convert_emf(emf, emf_size, options, &svg_len);
+        const char *d = strstr(svg, "<path d=\"");
+        POINT_D pts[SIMPLIFY_COUNT + 1];
+        size_t n = d ? path_points(d + 9, pts, SIMPLIFY_COUNT + 1) : 0;
+        if (n < 2 || n > previous){
+            fprintf(stderr, "%zu points left at tolerance %g\n", n, tolerance);
+            abort();
+        }
+        previous = n;
+        U_POINTL first = simplify_point(0);
+        U_POINTL last = simplify_point(SIMPLIFY_COUNT - 1);
+        if (pts[0].x != first.x || pts[0].y != first.y ||
+            pts[n - 1].x != last.x || pts[n - 1].y != last.y){
+            fprintf(stderr, "end points not kept\n");
+            abort();
+        }
+        /* abscissas increase, the segment of a point is the one around it */
+        size_t seg = 0;
+        for (int i = 0; i < SIMPLIFY_COUNT; i++){
+            U_POINTL pt = simplify_point(i);
+            while (seg + 2 < n && pts[seg + 1].x <= pt.x)
+                seg++;
+            POINT_D a = pts[seg], b = pts[seg + 1];
+            if (pt.x == a.x && pt.y != a.y){
+                fprintf(stderr, "point %d,%d not from the polyline\n",
+                        (int)a.x, (int)a.y);
+                abort();
+            }
+            double dx = b.x - a.x, dy = b.y - a.y;
+            double px = pt.x - a.x, py = pt.y - a.y;
+            double u = fmin(1, fmax(0, (px * dx + py * dy) /
+                                    (dx * dx + dy * dy)));
+            double dist = hypot(px - u * dx, py - u * dy);
+            if (dist > tolerance + 1e-4){
+                fprintf(stderr, "point %d,%d at %g from the simplified "
+                        "polyline (tolerance %g)\n", (int)pt.x, (int)pt.y,
+                        dist, tolerance);
+                abort();
+            }
+        }
+        free(svg);
+    }
+    if (previous > SIMPLIFY_COUNT / 20){
+        fprintf(stderr, "%zu points left at the largest tolerance\n", previous);
+        abort();
+    }
+    free(options);
+    free(emf);
+}
+
+static bool cull_polygon(EMFTRACK *et, int x, int y){
+    U_POINTL pts[] = {{x, y}, {x + 200, y}, {x + 100, y + 200}};
+    return emf_record(U_EMRPOLYGON_set(U_RCL_DEF, 3, pts), et);
+}
+
+static bool cull_bitmap(EMFTRACK *et, int x, int y){
+    char rgba[2 * 2 * 4];
+    memset(rgba, 0x80, sizeof(rgba));
+    char *px = NULL;
+    uint32_t cbPx = 0;
+    PU_RGBQUAD ct = NULL;
+    int numCt = 0;
+    if (RGBA_to_DIB(&px, &cbPx, &ct, &numCt, rgba, 2, 2, 8, U_BCBM_COLOR24,
+                    U_CT_NO, U_ROW_ORDER_INVERT) != 0)
+        return false;
+    U_BITMAPINFOHEADER bmih = bitmapinfoheader_set(2, 2, 1, U_BCBM_COLOR24,
+            U_BI_RGB, 0, 3780, 3780, numCt, 0);
+    PU_BITMAPINFO bmi = bitmapinfo_set(bmih, ct);
+    U_POINTL dest = {x, y}, cDest = {100, 100}, src = {0, 0}, cSrc = {2, 2};
+    bool ok = emf_record(U_EMRSTRETCHDIBITS_set(U_RCL_DEF, dest, cDest, src,
+                cSrc, U_DIB_RGB_COLORS, U_SRCCOPY, bmi, cbPx, px), et);
+    free(bmi);
+    free(px);
+    free(ct);
+    return ok;
+}
+
+static bool cull_text(EMFTRACK *et, int x, int y, const char *text){
+    uint16_t *text16 = U_Utf8ToUtf16le(text, 0, NULL);
+    int len = wchar16len(text16);
+    uint32_t *dx = dx_set(-20, U_FW_NORMAL, len);
+    U_POINTL org = {x, y};
+    char *emrtext = emrtext_set(org, len, 2, text16, U_ETO_NONE, U_RCL_DEF,
+                                dx);
+    bool ok = emrtext != NULL &&
+        emf_record(U_EMREXTTEXTOUTW_set(U_RCL_DEF, U_GM_COMPATIBLE, 1.0, 1.0,
+                                        (PU_EMRTEXT)emrtext), et);
+    free(emrtext);
+    free(dx);
+    free(text16);
+    return ok;
+}
+
+/* one polygon, bitmap and text out of the 1000x1000 px frame, and one of
+ * each across its right edge */
+static bool draw_culling(EMFTRACK *et){
+    uint16_t *name = U_Utf8ToUtf16le("Courier New", 0, NULL);
+    U_LOGFONT lf = logfont_set(-20, 0, 0, 0, U_FW_NORMAL, U_FW_NOITALIC,
+            U_FW_NOUNDERLINE, U_FW_NOSTRIKEOUT, U_ANSI_CHARSET,
+            U_OUT_DEFAULT_PRECIS, U_CLIP_DEFAULT_PRECIS, U_DEFAULT_QUALITY,
+            U_DEFAULT_PITCH, name);
+    U_LOGFONT_PANOSE elfw = logfont_panose_set(lf, name, name, 0, U_PAN_ALL1);
+    free(name);
+    return emf_record(U_EMREXTCREATEFONTINDIRECTW_set(1, NULL,
+                                                      (char *)&elfw), et) &&
+        emf_record(U_EMRSELECTOBJECT_set(1), et) &&
+        cull_polygon(et, 1200, 100) && cull_polygon(et, 900, 400) &&
+        cull_bitmap(et, -300, 500) && cull_bitmap(et, 950, 800) &&
+        cull_text(et, 3000, 500, "far") && cull_text(et, 990, 200, "edge");
+}
+
+/* the records out of the frame are dropped and counted, the ones across
+ * its edge are kept */
+static void check_culling(void){
+    size_t emf_size, svg_len;
+    char *emf = build_emf(draw_culling, &emf_size);
+    generatorOptions *options = calloc(1, sizeof(generatorOptions));
+    options->svgDelimiter = true;
+    options->culling = true;
+    char *svg = convert_emf(emf, emf_size, options, &svg_len);
+    if (options->culledRecords != 3 || strstr(svg, "1200") != NULL ||
+        strstr(svg, "-300") != NULL || strstr(svg, "far") != NULL){
+        fprintf(stderr, "%zu records culled\n", options->culledRecords);
+        abort();
+    }
+    if (strstr(svg, "1100") == NULL || strstr(svg, "x=\"950.") == NULL ||
+        strstr(svg, "edge") == NULL){
+        fprintf(stderr, "record across the frame edge culled\n");
+        abort();
+    }
+    free(svg);
+    free(options);
+    free(emf);
+}
+
+/* the statistics count each record of the EMF of draw_culling(), its
+ * bytes and the svg it writes */
+static void check_stats(void){
+    size_t emf_size, svg_len;
+    char *emf = build_emf(draw_culling, &emf_size);
+    generatorOptions *options = calloc(1, sizeof(generatorOptions));
+    generatorStats *stats = calloc(1, sizeof(generatorStats));
+    options->svgDelimiter = true;
+    options->stats = stats;
+    char *svg = convert_emf(emf, emf_size, options, &svg_len);
+    size_t count = 0, bytes = 0, output = 0;
+    for(int i = 0; i < EMF2SVG_RECORD_TYPES; i++){
+        count += stats->records[i].count;
+        bytes += stats->records[i].bytes;
+        output += stats->records[i].output;
+    }
+    /* header, map mode, font, its selection, 2 polygons, 2 bitmaps, 2
+     * texts and end of file */
+    if (count != 11 || bytes != emf_size || output != svg_len ||
+        stats->records[U_EMR_POLYGON].count != 2 ||
+        stats->records[U_EMR_POLYGON].output == 0 ||
+        stats->records[U_EMR_STRETCHDIBITS].count != 2 ||
+        stats->records[U_EMR_EXTTEXTOUTW].count != 2 ||
+        stats->imageEncodes != 2 || stats->fontLookups != 0 ||
+        stats->bufferAllocations == 0){
+        fprintf(stderr, "wrong statistics: %zu records, %zu bytes, %zu "
+                "bytes of svg\n", count, bytes, output);
+        abort();
+    }
+    free(svg);
+    free(stats);
+    free(options);
+    free(emf);
+}
+
+/* the two 2x2 bitmaps of draw_culling() fit in 8 pixels, not in 4 */
+static void check_image_budget(void){
+    size_t emf_size, svg_len;
+    char *emf = build_emf(draw_culling, &emf_size);
+    generatorOptions *options = calloc(1, sizeof(generatorOptions));
+    options->svgDelimiter = true;
+    options->maxImagePixels = 8;
+    char *svg = convert_emf(emf, emf_size, options, &svg_len);
+    free(svg);
+    options->maxImagePixels = 4;
+    if (emf2svg(emf, emf_size, &svg, &svg_len, options) ||
+        options->budgetExceeded != EMF2SVG_BUDGET_IMAGE_PIXELS){
+        fprintf(stderr, "image budget not exceeded\n");
+        abort();
+    }
+    free(svg);
+    free(options);
+    free(emf);
+}
+
+/* a red pen at a handle near the end of a table of 0xFFFF handles */
+#define OBJECT_HANDLE 0xFFF0
+static bool draw_high_object(EMFTRACK *et){
+    U_LOGPEN pen = logpen_set(U_PS_SOLID, point32_set(1, 1),
+                              colorref3_set(0xFF, 0, 0));
+    return emf_record(U_EMRCREATEPEN_set(OBJECT_HANDLE, pen), et) &&
+        emf_record(U_EMRSELECTOBJECT_set(OBJECT_HANDLE), et) &&
+        cull_polygon(et, 100, 100);
+}
+
+/* the object table only allocates the page of the handle used, whatever
+ * the header claims, the handles above maxObjects are ignored and the
+ * ones above the header handles are errors */
+static void check_objects(void){
+    size_t emf_size, svg_len;
+    char *emf = build_emf(draw_high_object, &emf_size);
+    ((PU_EMRHEADER)emf)->nHandles = 0xFFFF;
+    generatorOptions *options = calloc(1, sizeof(generatorOptions));
+    options->svgDelimiter = true;
+
+    svgWriter out;
+    drawingStates *states = states_new(emf, emf_size, NULL, options);
+    if (states == NULL || !svg_writer_init(&out, NULL, NULL, NULL))
+        abort();
+    int result = 1, recnum = 0;
+    for(size_t off = 0; result > 0 && off < emf_size; off += result)
+        result = U_emf_onerec_draw(emf, emf + emf_size, recnum++, off, &out,
+                                   states);
+    size_t pages = 0;
+    for(int64_t i = 0; i <= states->objectTableSize / OBJECT_TABLE_PAGE; i++)
+        pages += states->objectTable[i] != NULL;
+    if (states->Error || states->objectTableSize != 0xFFFF || pages != 1){
+        fprintf(stderr, "%zu object table pages allocated\n", pages);
+        abort();
+    }
+    states_free(states);
+    svg_writer_free(&out);
+
+    char *svg = convert_emf(emf, emf_size, options, &svg_len);
+    if (strstr(svg, "stroke=\"#FF0000\"") == NULL){
+        fprintf(stderr, "pen of a high handle not used\n");
+        abort();
+    }
+    free(svg);
+    options->maxObjects = 64;
+    svg = convert_emf(emf, emf_size, options, &svg_len);
+    if (strstr(svg, "stroke=\"#FF0000\"") != NULL){
+        fprintf(stderr, "pen above maxObjects used\n");
+        abort();
+    }
+    free(svg);
+    options->maxObjects = 0;
+    ((PU_EMRHEADER)emf)->nHandles = 64;
+    if (emf2svg(emf, emf_size, &svg, &svg_len, options)){
+        fprintf(stderr, "handle above the header handles accepted\n");
+        abort();
+    }
+    free(svg);
+    free(options);
+    free(emf);
+}
+
+/* svg after its start tag (the size differs between the tiles) */
+static const char *svg_body(const char *svg){
+    const char *start = strstr(svg, "svg version=");
+    return start ? strchr(start, '>') : svg;
+}
+
+static int compare_lines(const void *a, const void *b){
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/* lines of svg (modified in place), count set */
+static char **svg_lines(char *svg, size_t *count){
+    size_t n = 1;
+    for(char *c = svg; *c; c++)
+        n += *c == '\n';
+    char **lines = malloc(n * sizeof(char *));
+    *count = 0;
+    for(char *line = svg; line != NULL;){
+        char *end = strchr(line, '\n');
+        if (end != NULL)
+            *end++ = '\0';
+        lines[(*count)++] = line;
+        line = end;
+    }
+    return lines;
+}
+
+/* box of a path with straight lines only or of an image, false if unknown */
+static bool element_box(const char *elt, RECT_D *box){
+    const char *d = strstr(elt, " d=\"");
+    if (strstr(elt, "transform=") != NULL)
+        return false;
+    if (strncmp(elt, "path ", 5) == 0 && d != NULL &&
+        d[4 + strspn(d + 4, "MLZ0123456789.,- ")] == '"'){
+        size_t max = 1;
+        for(const char *c = d + 4; *c != '"'; c++)
+            max += *c == ',';
+        POINT_D *pts = malloc(max * sizeof(POINT_D));
+        size_t n = path_points(d + 4, pts, max);
+        *box = (RECT_D){INFINITY, INFINITY, -INFINITY, -INFINITY};
+        for(size_t i = 0; i < n; i++){
+            box->left = fmin(box->left, pts[i].x);
+            box->top = fmin(box->top, pts[i].y);
+            box->right = fmax(box->right, pts[i].x);
+            box->bottom = fmax(box->bottom, pts[i].y);
+        }
+        free(pts);
+        return n > 0;
+    }
+    if (strncmp(elt, "image ", 6) == 0){
+        box->left = attr_number(elt, "x");
+        box->top = attr_number(elt, "y");
+        box->right = box->left + attr_number(elt, "width");
+        box->bottom = box->top + attr_number(elt, "height");
+        return true;
+    }
+    return false;
+}
+
+/* if box (with the margin of the stroke of elt) intersects view */
+static bool element_in(const char *elt, RECT_D box, RECT_D view){
+    const char *end = strchr(elt, '>');
+    const char *a = strstr(elt, " stroke-miterlimit=\"");
+    double miter = a && a < end ? attr_number(elt, "stroke-miterlimit") : 2;
+    a = strstr(elt, " stroke-width=\"");
+    double width = a && a < end ? attr_number(elt, "stroke-width") : 1;
+    double margin = 2 + fabs(width) * fmax(miter, 2) / 2;
+    return box.right + margin >= view.left && box.left - margin <= view.right &&
+        box.bottom + margin >= view.top && box.top - margin <= view.bottom;
+}
+
+/* each line of the conversion svg is in a tile, in one it intersects for
+ * the elements out of any transform or clip path with a known box (the
+ * elements of records without a box are in every tile) */
+static void check_tiles(char *svg, char **tiles, unsigned int columns,
+                        unsigned int rows){
+    unsigned int count = columns * rows;
+    RECT_D *views = malloc(count * sizeof(RECT_D));
+    RECT_D area = {INFINITY, INFINITY, -INFINITY, -INFINITY};
+    for(unsigned int i = 0; i < count; i++){
+        double x, y, w, h, tx = 0, ty = 0;
+        const char *view = strstr(tiles[i], "viewBox=\"");
+        const char *shift = strstr(tiles[i], "g transform=\"translate(");
+        if (view == NULL ||
+            sscanf(view + 9, "%lf %lf %lf %lf", &x, &y, &w, &h) != 4 ||
+            (shift && sscanf(shift + 23, "%lf, %lf", &tx, &ty) != 2)){
+            fprintf(stderr, "tile %u without its box\n", i);
+            abort();
+        }
+        /* in the coordinates of the elements */
+        views[i] = (RECT_D){x - tx, y - ty, x - tx + w, y - ty + h};
+        area.left = fmin(area.left, views[i].left);
+        area.top = fmin(area.top, views[i].top);
+        area.right = fmax(area.right, views[i].right);
+        area.bottom = fmax(area.bottom, views[i].bottom);
+    }
+    size_t total = 0;
+    char **placed = NULL;
+    for(unsigned int i = 0; i < count; i++){
+        size_t n;
+        char **lines = svg_lines((char *)svg_body(tiles[i]), &n);
+        placed = realloc(placed, (total + n) * sizeof(char *));
+        /* groups open, and groups with a transform (but the first one) */
+        int depth = 0, transformed = 0, defs = 0;
+        int *opened = calloc(n + 1, sizeof(int));
+        for(size_t l = 0; l < n; l++){
+            const char *elt = lines[l] + strspn(lines[l], " ");
+            RECT_D box;
+            if (*elt++ == '<'){
+                bool closing = *elt == '/';
+                elt += closing;
+                if (strncmp(elt, "svg:", 4) == 0)
+                    elt += 4;
+                if (strncmp(elt, "g ", 2) == 0 || strncmp(elt, "g>", 2) == 0){
+                    if (closing && depth > 0){
+                        transformed -= opened[depth--];
+                    } else if (!closing){
+                        depth++;
+                        opened[depth] = depth > 1 &&
+                            strstr(elt, "transform=") != NULL;
+                        transformed += opened[depth];
+                    }
+                } else if (strncmp(elt, "defs", 4) == 0 ||
+                           strncmp(elt, "clipPath", 8) == 0){
+                    defs += closing ? -1 : 1;
+                } else if (!transformed && !defs && element_box(elt, &box) &&
+                           !element_in(elt, box, views[i]) &&
+                           element_in(elt, box, area)){
+                    /* visible in another tile */
+                    continue;
+                }
+            }
+            placed[total++] = lines[l];
+        }
+        free(opened);
+        free(lines);
+    }
+    qsort(placed, total, sizeof(char *), compare_lines);
+    size_t n;
+    char **lines = svg_lines((char *)svg_body(svg), &n);
+    for(size_t l = 0; l < n; l++){
+        if (!bsearch(&lines[l], placed, total, sizeof(char *), compare_lines)){
+            fprintf(stderr, "element in no tile it intersects: %.80s\n",
+                    lines[l]);
+            abort();
+        }
+    }
+    free(lines);
+    free(placed);
+    free(views);
+}
+
+/* gzip data inflated (concatenated members included), NULL on error */
+static char *gunzip(const char *data, size_t size, size_t *len){
+    z_stream zs = {0};
+    if (inflateInit2(&zs, 16 + MAX_WBITS) != Z_OK)
+        return NULL;
+    zs.next_in = (Bytef *)data;
+    zs.avail_in = size;
+    size_t cap = 4 * size + 1024;
+    char *out = malloc(cap);
+    *len = 0;
+    while (out != NULL){
+        if (*len == cap){
+            char *grown = realloc(out, cap * 2);
+            if (grown == NULL){free(out); out = NULL; break;}
+            out = grown;
+            cap *= 2;
+        }
+        zs.next_out = (Bytef *)out + *len;
+        zs.avail_out = cap - *len;
+        int z = inflate(&zs, Z_NO_FLUSH);
+        *len = cap - zs.avail_out;
+        if (z == Z_STREAM_END && zs.avail_in == 0)
+            break;
+        if (z == Z_STREAM_END)
+            z = inflateReset(&zs);
+        if ((z != Z_OK && z != Z_BUF_ERROR) ||
+            (z == Z_BUF_ERROR && zs.avail_out != 0)){
+            free(out);
+            out = NULL;
+        }
+    }
+    inflateEnd(&zs);
+    return out;
+}
+
 /* to compile: gcc -Wall -std=c99 -lm -lemf2svg ./example.c -o test */
 int main(int argc, char *argv[]){
 
@@ -13,6 +1067,17 @@ int main(int argc, char *argv[]){
     if (argc < 2){fprintf(stderr, "not enough args\n"); exit(1);}
     int ret = 0;
 
+    check_region_mix();
+    check_clip_mix();
+    check_path_data();
+    check_gradient();
+    check_pixels();
+    check_simplify();
+    check_culling();
+    check_objects();
+    check_stats();
+    check_image_budget();
+
     for(int i = 0; i < argc; i++){
         struct stat s; const char * file_name = argv[i];
         fprintf(stderr, "opening file '%s'\n", argv[i]);
@@ -45,12 +1110,288 @@ int main(int argc, char *argv[]){
         options->svgDelimiter = true;
         options->imgWidth = 0;
         options->imgHeight = 0;
+        size_t events = 0;
+        options->trace = check_event;
+        options->traceCtx = &events;
+        options->traceFields = true;
 
         /***************************** conversion ******************************/
 
-        fclose(stdout);
         ret =+ emf2svg(emf_content, emf_size, &svg_out, &svg_out_len, options);
-        fopen("/dev/console", "w");
+        fprintf(stderr, "%zu trace events\n", events);
+
+        /* the record index is built once and reused by the conversions,
+         * same svg as without (the ids start from rand()) */
+        generatorIndex *index = emf2svg_index(emf_content, emf_size, NULL);
+        if (index != NULL){
+            char *plain_out = NULL, *indexed_out = NULL;
+            size_t plain_out_len = 0, indexed_out_len = 0;
+            options->verbose = false;
+            options->trace = NULL;
+            srand(1);
+            emf2svg(emf_content, emf_size, &plain_out, &plain_out_len, options);
+            options->index = index;
+            srand(1);
+            emf2svg(emf_content, emf_size, &indexed_out, &indexed_out_len,
+                    options);
+            if (plain_out_len != indexed_out_len ||
+                (plain_out_len && memcmp(plain_out, indexed_out, plain_out_len))){
+                fprintf(stderr, "different output with the index\n");
+                abort();
+            }
+            fprintf(stderr, "%u records indexed\n", index->count);
+            free(plain_out);
+            free(indexed_out);
+
+            /* ranges of records converted over threads, same svg as the
+             * sequential conversion (EMF+ records are sequential) */
+            char *sequential_out = NULL, *parallel_out = NULL;
+            size_t sequential_out_len = 0, parallel_out_len = 0;
+            options->emfplus = false;
+            srand(1);
+            emf2svg(emf_content, emf_size, &sequential_out, &sequential_out_len,
+                    options);
+            options->drawThreads = 4;
+            srand(1);
+            emf2svg(emf_content, emf_size, &parallel_out, &parallel_out_len,
+                    options);
+            if (sequential_out_len != parallel_out_len ||
+                (sequential_out_len &&
+                 memcmp(sequential_out, parallel_out, sequential_out_len)) ||
+                options->drawRanges < 1 || options->drawRanges > 4){
+                fprintf(stderr, "different output over threads\n");
+                abort();
+            }
+            free(parallel_out);
+
+            /* ranges not matching the end of the previous one */
+            parallel_out_len = 0;
+            srand(1);
+            parallel_out = parallel_fallback(emf_content, emf_size, index,
+                                             options, &parallel_out_len);
+            if (parallel_out != NULL &&
+                (sequential_out_len != parallel_out_len ||
+                 memcmp(sequential_out, parallel_out, sequential_out_len))){
+                fprintf(stderr, "different output after a fallback\n");
+                abort();
+            }
+            free(sequential_out);
+            free(parallel_out);
+
+            /* with EMF+, converted sequentially */
+            options->emfplus = true;
+            options->drawThreads = 0;
+            srand(1);
+            emf2svg(emf_content, emf_size, &sequential_out,
+                    &sequential_out_len, options);
+            options->drawThreads = 4;
+            srand(1);
+            emf2svg(emf_content, emf_size, &parallel_out, &parallel_out_len,
+                    options);
+            if (sequential_out_len != parallel_out_len ||
+                (sequential_out_len &&
+                 memcmp(sequential_out, parallel_out, sequential_out_len)) ||
+                options->drawRanges != 1){
+                fprintf(stderr, "different EMF+ output over threads\n");
+                abort();
+            }
+            free(sequential_out);
+            free(parallel_out);
+            emf2svg_index_free(index);
+            options->index = NULL;
+        }
+
+        /* svgz output, inflated back to the same svg (the ids start from
+         * rand()), with a single deflate stream and over threads */
+        if (ret){
+            char *plain_out = NULL;
+            size_t plain_out_len = 0;
+            options->drawThreads = 0;
+            srand(1);
+            emf2svg(emf_content, emf_size, &plain_out, &plain_out_len,
+                    options);
+            options->svgz = true;
+            for(unsigned int threads = 0; threads <= 4; threads += 4){
+                char *svgz_out = NULL, *inflated_out = NULL;
+                size_t svgz_out_len = 0, inflated_out_len = 0;
+                options->svgzThreads = threads;
+                srand(1);
+                if (emf2svg(emf_content, emf_size, &svgz_out, &svgz_out_len,
+                            options))
+                    inflated_out = gunzip(svgz_out, svgz_out_len,
+                                          &inflated_out_len);
+                if (inflated_out == NULL || inflated_out_len != plain_out_len ||
+                    memcmp(plain_out, inflated_out, plain_out_len)){
+                    fprintf(stderr, "different svgz output (%u threads)\n",
+                            threads);
+                    abort();
+                }
+                free(svgz_out);
+                free(inflated_out);
+            }
+            options->svgz = false;
+            options->svgzThreads = 0;
+            free(plain_out);
+        }
+
+        /* a single tile is the conversion culled to the image (but for the
+         * svg size), the elements of a 3x2 tiling are the ones of the
+         * conversion, each in the tiles it is visible in */
+        if (ret){
+            char *plain_out = NULL;
+            size_t plain_out_len = 0;
+            options->culling = true;
+            srand(1);
+            emf2svg(emf_content, emf_size, &plain_out, &plain_out_len,
+                    options);
+            char *tile_out[6];
+            size_t tile_out_len[6];
+            srand(1);
+            if (!emf2svg_tiles(emf_content, emf_size, 1, 1, tile_out,
+                               tile_out_len, options) ||
+                strcmp(svg_body(plain_out), svg_body(tile_out[0]))){
+                fprintf(stderr, "different output in a single tile\n");
+                abort();
+            }
+            free(tile_out[0]);
+            srand(1);
+            if (!emf2svg_tiles(emf_content, emf_size, 3, 2, tile_out,
+                               tile_out_len, options)){
+                fprintf(stderr, "3x2 tiling failed\n");
+                abort();
+            }
+            check_tiles(plain_out, tile_out, 3, 2);
+            for(int i = 0; i < 6; i++)
+                free(tile_out[i]);
+            options->culling = false;
+            free(plain_out);
+        }
+
+        /* generous budgets give the same svg as no budget, tiny ones make
+         * the conversion fail with the budget exceeded (the record budget
+         * is also checked against the index, before drawing) */
+        if (ret){
+            char *plain_out = NULL, *budget_out = NULL;
+            size_t plain_out_len = 0, budget_out_len = 0;
+            srand(1);
+            emf2svg(emf_content, emf_size, &plain_out, &plain_out_len,
+                    options);
+            options->maxTime = 3600;
+            options->maxOutput = SIZE_MAX;
+            options->maxRecords = SIZE_MAX;
+            options->maxImagePixels = UINT64_MAX;
+            options->maxMemory = SIZE_MAX;
+            srand(1);
+            if (!emf2svg(emf_content, emf_size, &budget_out, &budget_out_len,
+                         options) || plain_out_len != budget_out_len ||
+                memcmp(plain_out, budget_out, plain_out_len)){
+                fprintf(stderr, "different output with generous budgets\n");
+                abort();
+            }
+            free(budget_out);
+            options->maxTime = 0;
+            options->maxMemory = 0;
+            options->maxImagePixels = 0;
+            options->maxRecords = 0;
+            options->maxOutput = 1;
+            if (emf2svg(emf_content, emf_size, &budget_out, &budget_out_len,
+                        options) ||
+                options->budgetExceeded != EMF2SVG_BUDGET_OUTPUT){
+                fprintf(stderr, "output budget not exceeded\n");
+                abort();
+            }
+            free(budget_out);
+            options->maxOutput = 0;
+            options->maxRecords = 1;
+            if (emf2svg(emf_content, emf_size, &budget_out, &budget_out_len,
+                        options) ||
+                options->budgetExceeded != EMF2SVG_BUDGET_RECORDS){
+                fprintf(stderr, "record budget not exceeded\n");
+                abort();
+            }
+            free(budget_out);
+            options->index = emf2svg_index(emf_content, emf_size, NULL);
+            if (options->index == NULL ||
+                emf2svg(emf_content, emf_size, &budget_out, &budget_out_len,
+                        options) ||
+                options->budgetExceeded != EMF2SVG_BUDGET_RECORDS){
+                fprintf(stderr, "record budget not exceeded with the index\n");
+                abort();
+            }
+            free(budget_out);
+            emf2svg_index_free(options->index);
+            options->index = NULL;
+            options->maxRecords = 0;
+            /* a file without bitmaps converts as without budget */
+            options->maxImagePixels = 1;
+            srand(1);
+            if (emf2svg(emf_content, emf_size, &budget_out, &budget_out_len,
+                        options) ?
+                plain_out_len != budget_out_len ||
+                memcmp(plain_out, budget_out, plain_out_len) :
+                options->budgetExceeded != EMF2SVG_BUDGET_IMAGE_PIXELS){
+                fprintf(stderr, "image budget not exceeded\n");
+                abort();
+            }
+            free(budget_out);
+            options->maxImagePixels = 0;
+            free(plain_out);
+
+            /* over threads, the conversion stops on the same record with
+             * the same budget exceeded (EMF+ records are sequential) */
+            options->emfplus = false;
+            plain_out = NULL;
+            plain_out_len = 0;
+            emf2svg(emf_content, emf_size, &plain_out, &plain_out_len,
+                    options);
+            free(plain_out);
+            for(int i = 0; i < 4; i++){
+                char *sequential_out = NULL, *parallel_out = NULL;
+                size_t sequential_out_len = 0, parallel_out_len = 0;
+                options->maxOutput = i < 3 ? plain_out_len >> i : 0;
+                options->maxImagePixels = i < 3 ? 0 : 1;
+                options->drawThreads = 0;
+                srand(1);
+                int sequential_ret = emf2svg(emf_content, emf_size,
+                                             &sequential_out,
+                                             &sequential_out_len, options);
+                generatorBudget sequential_budget = options->budgetExceeded;
+                options->drawThreads = 4;
+                srand(1);
+                int parallel_ret = emf2svg(emf_content, emf_size,
+                                           &parallel_out, &parallel_out_len,
+                                           options);
+                if (sequential_ret != parallel_ret ||
+                    sequential_budget != options->budgetExceeded ||
+                    sequential_out_len != parallel_out_len ||
+                    (sequential_out_len &&
+                     memcmp(sequential_out, parallel_out,
+                            sequential_out_len))){
+                    fprintf(stderr, "different budgets over threads\n");
+                    abort();
+                }
+                free(sequential_out);
+                free(parallel_out);
+            }
+            options->drawThreads = 0;
+            options->maxOutput = 0;
+            options->maxImagePixels = 0;
+            options->emfplus = true;
+        }
+
+        /* a cancelled conversion fails, with the reason in the options */
+        if (ret){
+            char *cancelled_out = NULL;
+            size_t cancelled_out_len = 0;
+            options->progress = cancel_progress;
+            options->progressInterval = 1;
+            if (emf2svg(emf_content, emf_size, &cancelled_out,
+                        &cancelled_out_len, options) || !options->cancelled){
+                fprintf(stderr, "cancelled conversion not reported\n");
+                abort();
+            }
+            free(cancelled_out);
+        }
 
         /***********************************************************************/
 